@@ -0,0 +1,181 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This example sends downlinks to a fleet of Class B devices (e.g., actuators)
+ * through their ping slots. Devices send periodic uplinks, so that the network
+ * server knows which gateways can reach them, and each device is sent a
+ * downlink at a random time. The distribution of the downlink latency is
+ * printed at the end of the simulation.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/log.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-device-address-generator.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/network-module.h"
+#include "ns3/network-scheduler.h"
+#include "ns3/network-server-helper.h"
+#include "ns3/network-server.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("ClassBDownlinkExample");
+
+int
+main(int argc, char* argv[])
+{
+    int nDevices = 200;
+    int nGateways = 2;
+    double radiusMeters = 3000;
+    int pingSlotPeriodicity = 4;
+    double uplinkPeriodSeconds = 1800;
+    double simulationTimeSeconds = 7200;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nDevices", "Number of Class B devices", nDevices);
+    cmd.AddValue("nGateways", "Number of gateways", nGateways);
+    cmd.AddValue("radius", "Radius (m) of the deployment", radiusMeters);
+    cmd.AddValue("periodicity", "Ping slot periodicity of the devices (0-7)", pingSlotPeriodicity);
+    cmd.AddValue("uplinkPeriod", "Period (s) of the uplinks of the devices", uplinkPeriodSeconds);
+    cmd.AddValue("simulationTime", "Simulation time (s)", simulationTimeSeconds);
+    cmd.Parse(argc, argv);
+
+    LogComponentEnable("ClassBDownlinkExample", LOG_LEVEL_ALL);
+    LogComponentEnableAll(LOG_PREFIX_TIME);
+
+    Config::SetDefault("ns3::ClassBEndDeviceLorawanMac::PingSlotPeriodicity",
+                       UintegerValue(pingSlotPeriodicity));
+
+    // Channel
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    // Mobility
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                  "rho",
+                                  DoubleValue(radiusMeters),
+                                  "X",
+                                  DoubleValue(0.0),
+                                  "Y",
+                                  DoubleValue(0.0));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    // Helpers
+    LoraPhyHelper phyHelper = LoraPhyHelper();
+    phyHelper.SetChannel(channel);
+    LorawanMacHelper macHelper = LorawanMacHelper();
+    LoraHelper helper = LoraHelper();
+
+    // End devices
+    NodeContainer endDevices;
+    endDevices.Create(nDevices);
+    mobility.Install(endDevices);
+
+    Ptr<LoraDeviceAddressGenerator> addrGen = CreateObject<LoraDeviceAddressGenerator>(54, 1864);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_B);
+    macHelper.SetAddressGenerator(addrGen);
+    macHelper.SetRegion(LorawanMacHelper::EU);
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    // Gateways
+    NodeContainer gateways;
+    gateways.Create(nGateways);
+    mobility.Install(gateways);
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, gateways);
+
+    macHelper.SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    // Uplinks
+    PeriodicSenderHelper appHelper = PeriodicSenderHelper();
+    appHelper.SetPeriod(Seconds(uplinkPeriodSeconds));
+    ApplicationContainer appContainer = appHelper.Install(endDevices);
+    appContainer.Start(Seconds(0));
+    appContainer.Stop(Seconds(simulationTimeSeconds));
+
+    // Network server
+    Ptr<Node> networkServer = CreateObject<Node>();
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+    P2PGwRegistration_t gwRegistration;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+    {
+        auto container = p2p.Install(networkServer, *gw);
+        auto serverP2PNetDev = DynamicCast<PointToPointNetDevice>(container.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, *gw);
+    }
+    NetworkServerHelper networkServerHelper;
+    networkServerHelper.SetGatewaysP2P(gwRegistration);
+    networkServerHelper.SetEndDevices(endDevices);
+    networkServerHelper.Install(networkServer);
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(gateways);
+
+    // Downlinks, once every device had the time to send an uplink
+    Ptr<NetworkScheduler> scheduler =
+        networkServer->GetApplication(0)->GetObject<NetworkServer>()->GetNetworkScheduler();
+    Ptr<UniformRandomVariable> downlinkTime = CreateObject<UniformRandomVariable>();
+    downlinkTime->SetAttribute("Min", DoubleValue(uplinkPeriodSeconds));
+    downlinkTime->SetAttribute("Max", DoubleValue(simulationTimeSeconds - 600));
+    for (auto ed = endDevices.Begin(); ed != endDevices.End(); ++ed)
+    {
+        Ptr<LorawanMac> mac = (*ed)->GetDevice(0)->GetObject<LoraNetDevice>()->GetMac();
+        LoraDeviceAddress address = mac->GetObject<EndDeviceLorawanMac>()->GetDeviceAddress();
+        Simulator::Schedule(Seconds(downlinkTime->GetValue()),
+                            &NetworkScheduler::ScheduleClassBDownlink,
+                            scheduler,
+                            address,
+                            Create<Packet>(10));
+    }
+
+    Simulator::Stop(Seconds(simulationTimeSeconds));
+    Simulator::Run();
+
+    // Report
+    std::vector<Time> latencies = scheduler->GetClassBDownlinkLatencies();
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "Delivered downlinks: " << latencies.size() << "/" << nDevices
+              << ", failed: " << scheduler->GetNFailedClassBDownlinks() << std::endl;
+    if (!latencies.empty())
+    {
+        Time sum = Seconds(0);
+        for (const auto& latency : latencies)
+        {
+            sum += latency;
+        }
+        Time mean = sum / static_cast<int64_t>(latencies.size());
+        auto percentile = [&latencies](double p) {
+            return latencies[std::min<size_t>(latencies.size() * p, latencies.size() - 1)];
+        };
+        std::cout << "Latency (s): mean " << mean.GetSeconds() << ", p50 "
+                  << percentile(0.5).GetSeconds() << ", p90 " << percentile(0.9).GetSeconds()
+                  << ", p99 " << percentile(0.99).GetSeconds() << ", max "
+                  << latencies.back().GetSeconds() << std::endl;
+    }
+    std::cout << "Beacons: " << scheduler->GetBeaconTimeline()->GetNBeacons() << std::endl;
+
+    Simulator::Destroy();
+
+    return 0;
+}
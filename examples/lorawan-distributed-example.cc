@@ -0,0 +1,186 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This program simulates a network of end devices sending periodic uplinks to
+ * a grid of gateways, partitioned in stripes across the MPI ranks of a
+ * distributed simulation with the LoraDistributedHelper. Each rank prints the
+ * uplinks sent by its end devices and the packets received by its gateways,
+ * whose sums over the ranks are comparable to those printed by the sequential
+ * run of the same network, with --sequential.
+ *
+ * Run it with a local MPI runtime, e.g.:
+ * ./ns3 run lorawan-distributed-example --command-template="mpiexec -np 4 %s"
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/gateway-lora-phy.h"
+#include "ns3/hex-grid-position-allocator.h"
+#include "ns3/log.h"
+#include "ns3/lora-distributed-helper.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/position-allocator.h"
+
+#include <iostream>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanDistributedExample");
+
+// Counters of this rank
+uint32_t g_sent = 0;     //!< The uplinks sent by the end devices of this rank
+uint32_t g_received = 0; //!< The packets received by the gateways of this rank
+
+/**
+ * Count an uplink sent by an end device.
+ *
+ * \param packet The packet.
+ * \param nodeId The node of the end device.
+ */
+void
+OnSent(Ptr<const Packet> packet, uint32_t nodeId)
+{
+    g_sent++;
+}
+
+/**
+ * Count a packet received by a gateway.
+ *
+ * \param packet The packet.
+ * \param nodeId The node of the gateway.
+ */
+void
+OnReceived(Ptr<const Packet> packet, uint32_t nodeId)
+{
+    g_received++;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nDevices = 2000;
+    uint32_t nGatewayRings = 2;
+    double radius = 10000;
+    double simulationTime = 3600;
+    double maxRange = 0;
+    Time minEventSeparation = MicroSeconds(10);
+    bool sequential = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nDevices", "Number of end devices to include in the simulation", nDevices);
+    cmd.AddValue("nGatewayRings",
+                 "Number of rings of the hexagonal grid of gateways",
+                 nGatewayRings);
+    cmd.AddValue("radius", "The radius [m] of the area to simulate", radius);
+    cmd.AddValue("simulationTime", "The time [s] for which to simulate", simulationTime);
+    cmd.AddValue("maxRange", "The range [m] of the transmissions across partitions", maxRange);
+    cmd.AddValue("minEventSeparation",
+                 "The delay of the transmissions across partitions",
+                 minEventSeparation);
+    cmd.AddValue("sequential", "Run the same network without MPI", sequential);
+    cmd.Parse(argc, argv);
+
+    if (!sequential)
+    {
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::DistributedSimulatorImpl"));
+        MpiInterface::Enable(&argc, &argv);
+    }
+
+    /***********
+     *  Setup  *
+     ***********/
+
+    // The same network on every rank, from the same random values
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+
+    LoraDistributedHelper distributedHelper;
+    distributedHelper.SetPartitioning(-radius, radius);
+    distributedHelper.SetChannelAttribute("MinEventSeparation", TimeValue(minEventSeparation));
+    distributedHelper.SetChannelAttribute("MaxRange", DoubleValue(maxRange));
+
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = distributedHelper.CreateChannel(loss, delay);
+
+    Ptr<UniformDiscPositionAllocator> deviceAllocator =
+        CreateObject<UniformDiscPositionAllocator>();
+    deviceAllocator->SetRho(radius);
+    deviceAllocator->SetZ(1.2);
+    NodeContainer endDevices = distributedHelper.CreateNodes(nDevices, deviceAllocator);
+
+    // A hexagonal grid of gateways, with a ring covering about the area
+    double gatewayDistance = radius / (nGatewayRings + 0.5);
+    Ptr<HexGridPositionAllocator> gatewayAllocator =
+        CreateObject<HexGridPositionAllocator>(gatewayDistance / 2);
+    uint32_t nGateways = 1 + 3 * nGatewayRings * (nGatewayRings + 1);
+    NodeContainer gateways = distributedHelper.CreateNodes(nGateways, gatewayAllocator);
+
+    // Install the LoRa devices on the nodes of this rank only
+    NodeContainer localEndDevices = LoraDistributedHelper::GetLocalNodes(endDevices);
+    NodeContainer localGateways = LoraDistributedHelper::GetLocalNodes(gateways);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    LorawanMacHelper macHelper;
+    LoraHelper helper;
+
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    helper.Install(phyHelper, macHelper, localEndDevices);
+
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, localGateways);
+
+    // The spreading factors depend on all the gateways, local or not
+    LorawanMacHelper::SetSpreadingFactorsUp(localEndDevices, gateways, channel);
+
+    for (auto node = localEndDevices.Begin(); node != localEndDevices.End(); node++)
+    {
+        (*node)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy()->TraceConnectWithoutContext(
+            "StartSending",
+            MakeCallback(&OnSent));
+    }
+    for (auto node = localGateways.Begin(); node != localGateways.End(); node++)
+    {
+        (*node)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy()->TraceConnectWithoutContext(
+            "ReceivedPacket",
+            MakeCallback(&OnReceived));
+    }
+
+    PeriodicSenderHelper appHelper;
+    appHelper.SetPeriod(Seconds(600));
+    ApplicationContainer apps = appHelper.Install(localEndDevices);
+    apps.Start(Seconds(0));
+    apps.Stop(Seconds(simulationTime));
+
+    /****************
+     *  Simulation  *
+     ****************/
+
+    Simulator::Stop(Seconds(simulationTime + 10));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    uint32_t systemId = sequential ? 0 : MpiInterface::GetSystemId();
+    std::cout << "rank " << systemId << " devices " << localEndDevices.GetN() << " gateways "
+              << localGateways.GetN() << " sent " << g_sent << " received " << g_received
+              << std::endl;
+
+    if (!sequential)
+    {
+        MpiInterface::Disable();
+    }
+    return 0;
+}
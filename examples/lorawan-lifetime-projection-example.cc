@@ -0,0 +1,176 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This script projects the battery lifetime of the end devices of a network
+ * from a short simulation. After a warm-up, a LoraLifetimeProjector observes
+ * the PHY states and the retransmissions of every device during a window of a
+ * few traffic periods, and extrapolates the lifetime of each device, instead
+ * of simulating the depletion of an energy source.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/log.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-lifetime-projector.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/network-module.h"
+#include "ns3/network-server-helper.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/string.h"
+
+#include <sstream>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanLifetimeProjectionExample");
+
+int
+main(int argc, char* argv[])
+{
+    int nDevices = 100;
+    double radius = 5000;
+    double appPeriodSeconds = 600;
+    double warmUpSeconds = 600;
+    double windowSeconds = 3600;
+    double capacityMah = 2400;
+    bool confirmed = true;
+    bool printProjections = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nDevices", "Number of end devices to include in the simulation", nDevices);
+    cmd.AddValue("radius", "The radius (m) of the area to simulate", radius);
+    cmd.AddValue("appPeriod", "The period (s) of the uplinks", appPeriodSeconds);
+    cmd.AddValue("warmUp", "The time (s) before the observation window", warmUpSeconds);
+    cmd.AddValue("window", "The length (s) of the observation window", windowSeconds);
+    cmd.AddValue("capacity", "The battery capacity (mAh) of the devices", capacityMah);
+    cmd.AddValue("confirmed", "Whether the uplinks are confirmed", confirmed);
+    cmd.AddValue("print", "Whether to print the projection of each device", printProjections);
+    cmd.Parse(argc, argv);
+
+    LogComponentEnable("LorawanLifetimeProjectionExample", LOG_LEVEL_ALL);
+
+    // Channel
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    // Helpers
+    LoraPhyHelper phyHelper = LoraPhyHelper();
+    phyHelper.SetChannel(channel);
+    LorawanMacHelper macHelper = LorawanMacHelper();
+    LoraHelper helper = LoraHelper();
+
+    // End devices
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                  "rho",
+                                  DoubleValue(radius),
+                                  "X",
+                                  DoubleValue(0.0),
+                                  "Y",
+                                  DoubleValue(0.0),
+                                  "Z",
+                                  DoubleValue(1.2));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    NodeContainer endDevices;
+    endDevices.Create(nDevices);
+    mobility.Install(endDevices);
+
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    if (confirmed)
+    {
+        for (auto node = endDevices.Begin(); node != endDevices.End(); node++)
+        {
+            Ptr<LoraNetDevice> loraNetDevice = (*node)->GetDevice(0)->GetObject<LoraNetDevice>();
+            Ptr<EndDeviceLorawanMac> mac =
+                DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+            mac->SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
+        }
+    }
+
+    // Gateway, at the centre
+    NodeContainer gateways;
+    gateways.Create(1);
+    Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
+    allocator->Add(Vector(0, 0, 15.0));
+    mobility.SetPositionAllocator(allocator);
+    mobility.Install(gateways);
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, gateways);
+
+    LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    // Traffic
+    Time stopTime = Seconds(warmUpSeconds + windowSeconds);
+    PeriodicSenderHelper appHelper = PeriodicSenderHelper();
+    appHelper.SetPeriod(Seconds(appPeriodSeconds));
+    ApplicationContainer appContainer = appHelper.Install(endDevices);
+    appContainer.Start(Seconds(0));
+    appContainer.Stop(stopTime);
+
+    // Network server, to acknowledge the confirmed uplinks
+    Ptr<Node> networkServer = CreateObject<Node>();
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("10Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+    P2PGwRegistration_t gwRegistration;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+    {
+        auto container = p2p.Install(networkServer, *gw);
+        auto serverP2PNetDev = DynamicCast<PointToPointNetDevice>(container.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, *gw);
+    }
+    NetworkServerHelper nsHelper = NetworkServerHelper();
+    nsHelper.SetGatewaysP2P(gwRegistration);
+    nsHelper.SetEndDevices(endDevices);
+    nsHelper.Install(networkServer);
+    ForwarderHelper forHelper = ForwarderHelper();
+    forHelper.Install(gateways);
+
+    // Lifetime projection, over the steady state of the traffic
+    LoraLifetimeProjector projector;
+    projector.SetBatteryCapacity(capacityMah);
+    projector.Install(endDevices);
+    projector.SetWindow(Seconds(warmUpSeconds), stopTime);
+
+    Simulator::Stop(stopTime);
+    NS_LOG_INFO("Running simulation...");
+    Simulator::Run();
+
+    const double secondsPerYear = 365.25 * 24 * 3600;
+    NS_LOG_INFO("Projected lifetime (years): 5th percentile "
+                << projector.GetLifetimeQuantile(0.05) / secondsPerYear << " median "
+                << projector.GetLifetimeQuantile(0.5) / secondsPerYear << " 95th percentile "
+                << projector.GetLifetimeQuantile(0.95) / secondsPerYear);
+
+    if (printProjections)
+    {
+        std::stringstream projections;
+        projector.PrintProjections(projections);
+        NS_LOG_INFO("Projections (node, tx, rx, standby, sleep, transmissions, packets, "
+                    "transmissions per packet, current, years):\n"
+                    << projections.str());
+    }
+
+    Simulator::Destroy();
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This script simulates a network of end devices sending periodic uplinks,
+ * on top of which alarm events (e.g., a fire or a gas leak) trigger
+ * spatially correlated bursts of uplinks from all the devices around their
+ * epicentre. The metrics of interest are the throughput of the regular
+ * traffic and, for each alarm, the delivery ratio of its burst and the time
+ * until the first alarm reaches a gateway.
+ *
+ * It takes the same arguments as lorawan-network-sim, as used by
+ * runSimulator.sh.
+ */
+
+#include "ns3/alarm-traffic-helper.h"
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/log.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-device-address-generator.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/network-module.h"
+#include "ns3/network-server-helper.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/string.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanNetworkAlarmSimulator");
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nSeed = 1;
+    int nDevices = 200;
+    int nGateways = 1;
+    double radius = 6400;
+    double gatewayRadius = 0;
+    double simulationTime = 3600;
+    double appPeriodSeconds = 60;
+    std::string fileMetric = "./scratch/result-almSTAs";
+    std::string fileData = "";
+    bool printEDs = false;
+    int trial = 1;
+    int nEvents = 1;
+    double alarmSpeed = 1000;
+    double alarmRadius = 1000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nSeed", "Run number of the random number generator", nSeed);
+    cmd.AddValue("nDevices", "Number of end devices to include in the simulation", nDevices);
+    cmd.AddValue("nGateways", "Number of gateways to include", nGateways);
+    cmd.AddValue("radius", "The radius (m) of the area to simulate", radius);
+    cmd.AddValue("gatewayRadius",
+                 "The distance (m) of the gateways from the centre",
+                 gatewayRadius);
+    cmd.AddValue("simulationTime", "The time (s) for which to simulate", simulationTime);
+    cmd.AddValue("appPeriod", "The period (s) of the regular uplinks", appPeriodSeconds);
+    cmd.AddValue("file1", "Prefix of the files of the result metrics", fileMetric);
+    cmd.AddValue("file2", "File of the MAC packet counts", fileData);
+    cmd.AddValue("printEDs", "Whether to print the positions of the devices", printEDs);
+    cmd.AddValue("trial", "The trial, used in the paths of the printed positions", trial);
+    cmd.AddValue("nEvents", "Number of alarm events", nEvents);
+    cmd.AddValue("alarmSpeed", "Propagation speed (m/s) of the alarm events", alarmSpeed);
+    cmd.AddValue("alarmRadius", "Radius (m) of effect of the alarm events", alarmRadius);
+    cmd.Parse(argc, argv);
+
+    LogComponentEnable("LorawanNetworkAlarmSimulator", LOG_LEVEL_ALL);
+
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(nSeed);
+
+    // Channel
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    // Helpers
+    LoraPhyHelper phyHelper = LoraPhyHelper();
+    phyHelper.SetChannel(channel);
+    LorawanMacHelper macHelper = LorawanMacHelper();
+    LoraHelper helper = LoraHelper();
+    helper.EnablePacketTracking();
+
+    // End devices
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                  "rho",
+                                  DoubleValue(radius),
+                                  "X",
+                                  DoubleValue(0.0),
+                                  "Y",
+                                  DoubleValue(0.0),
+                                  "Z",
+                                  DoubleValue(1.2));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    NodeContainer endDevices;
+    endDevices.Create(nDevices);
+    mobility.Install(endDevices);
+
+    Ptr<LoraDeviceAddressGenerator> addrGen = CreateObject<LoraDeviceAddressGenerator>(54, 1864);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    macHelper.SetAddressGenerator(addrGen);
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    // Gateways, evenly spaced on a circle
+    NodeContainer gateways;
+    gateways.Create(nGateways);
+    Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
+    for (int i = 0; i < nGateways; i++)
+    {
+        double angle = 2 * M_PI * i / nGateways;
+        allocator->Add(
+            Vector(gatewayRadius * std::cos(angle), gatewayRadius * std::sin(angle), 15.0));
+    }
+    mobility.SetPositionAllocator(allocator);
+    mobility.Install(gateways);
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, gateways);
+
+    std::vector<uint16_t> sfQuant = macHelper.SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    // Regular traffic
+    Time appStopTime = Seconds(simulationTime);
+    PeriodicSenderHelper appHelper = PeriodicSenderHelper();
+    appHelper.SetPeriod(Seconds(appPeriodSeconds));
+    appHelper.SetPacketSize(19);
+    ApplicationContainer appContainer = appHelper.Install(endDevices);
+    appContainer.Start(Seconds(0));
+    appContainer.Stop(appStopTime);
+
+    // Alarm traffic
+    AlarmTrafficHelper alarmHelper;
+    alarmHelper.SetPropagationSpeed(alarmSpeed);
+    alarmHelper.SetRadius(alarmRadius);
+    alarmHelper.SetPacketSize(19);
+    alarmHelper.Install(endDevices);
+    alarmHelper.MonitorGateways(gateways);
+    alarmHelper.AddRandomEvents(nEvents, Seconds(0), appStopTime, Vector(0, 0, 0), radius);
+
+    // Network server
+    Ptr<Node> networkServer = CreateObject<Node>();
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("10Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+    P2PGwRegistration_t gwRegistration;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+    {
+        auto container = p2p.Install(networkServer, *gw);
+        auto serverP2PNetDev = DynamicCast<PointToPointNetDevice>(container.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, *gw);
+    }
+    NetworkServerHelper nsHelper = NetworkServerHelper();
+    nsHelper.SetGatewaysP2P(gwRegistration);
+    nsHelper.SetEndDevices(endDevices);
+    nsHelper.Install(networkServer);
+    ForwarderHelper forHelper = ForwarderHelper();
+    forHelper.Install(gateways);
+
+    if (printEDs)
+    {
+        std::string prefix = "./TestResult/test" + std::to_string(trial);
+        helper.DoPrintDeviceStatus(endDevices,
+                                   gateways,
+                                   prefix + "/endDevices" + std::to_string(nDevices) + ".dat");
+    }
+
+    Simulator::Stop(appStopTime + Hours(1));
+    NS_LOG_INFO("Running simulation...");
+    Simulator::Run();
+
+    // Network metrics, over both the regular and the alarm uplinks
+    double sent = 0;
+    double received = 0;
+    LoraPacketTracker& tracker = helper.GetPacketTracker();
+    std::stringstream(tracker.CountMacPacketsGlobally(Seconds(0), appStopTime + Hours(1))) >>
+        sent >> received;
+    double throughput = received / simulationTime;
+    double probSucc = sent > 0 ? received / sent : 0;
+
+    NS_LOG_INFO("SF Allocation: SF7=" << sfQuant.at(0) << " SF8=" << sfQuant.at(1)
+                                      << " SF9=" << sfQuant.at(2) << " SF10=" << sfQuant.at(3)
+                                      << " SF11=" << sfQuant.at(4) << " SF12=" << sfQuant.at(5));
+    NS_LOG_INFO("nDevices: " << nDevices << " throughput: " << throughput
+                             << " probSucc: " << probSucc << " probLoss: " << 1 - probSucc);
+
+    std::ofstream myfile;
+    myfile.open(fileMetric + ".dat", std::ios::out | std::ios::app);
+    myfile << nDevices << ", " << throughput << ", " << probSucc << ", " << 1 - probSucc << "\n";
+    myfile.close();
+
+    // Alarm metrics, averaged over the bursts that triggered some devices
+    double deliveryRatio = 0;
+    double timeToFirstReport = 0;
+    int nBursts = 0;
+    int nReported = 0;
+    for (uint32_t i = 0; i < alarmHelper.GetBursts().size(); i++)
+    {
+        if (alarmHelper.GetBursts()[i].nTriggered == 0)
+        {
+            continue;
+        }
+        nBursts++;
+        deliveryRatio += alarmHelper.GetDeliveryRatio(i);
+        Time ttfr = alarmHelper.GetTimeToFirstReport(i);
+        if (ttfr != Time::Max())
+        {
+            nReported++;
+            timeToFirstReport += ttfr.GetSeconds();
+        }
+    }
+    deliveryRatio = nBursts > 0 ? deliveryRatio / nBursts : 0;
+    timeToFirstReport = nReported > 0 ? timeToFirstReport / nReported : -1;
+
+    std::stringstream bursts;
+    alarmHelper.PrintBursts(bursts);
+    NS_LOG_INFO("Bursts (time, x, y, triggered, delivered, ratio, ttfr):\n" << bursts.str());
+    NS_LOG_INFO("Alarm delivery ratio: " << deliveryRatio
+                                         << " time to first report: " << timeToFirstReport);
+
+    myfile.open(fileMetric + "-alarm.dat", std::ios::out | std::ios::app);
+    myfile << nDevices << ", " << deliveryRatio << ", " << timeToFirstReport << "\n";
+    myfile.close();
+
+    if (!fileData.empty())
+    {
+        myfile.open(fileData, std::ios::out | std::ios::app);
+        myfile << "sent: " << sent << " succ: " << received << " drop: " << sent - received
+               << "\n";
+        myfile << "numDev: " << nDevices << " numGat: " << nGateways
+               << " simTime: " << simulationTime << " throughput: " << throughput << "\n";
+        myfile << "##################################################" << "\n\n";
+        myfile.close();
+    }
+
+    Simulator::Destroy();
+
+    return 0;
+}
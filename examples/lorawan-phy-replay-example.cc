@@ -0,0 +1,230 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This program simulates a network of end devices sending periodic uplinks to
+ * a grid of gateways, records the signals at the gateways with a
+ * LoraPhyRecorder, and replays the receptions of the gateways with a
+ * LoraPhyReplay under several PHY parameters: those of the simulation, the
+ * ALOHA collision matrix, a lower capture threshold, and fewer and more
+ * reception paths. With --replay, it only replays a file recorded earlier.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/gateway-lora-phy.h"
+#include "ns3/hex-grid-position-allocator.h"
+#include "ns3/log.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-phy-recorder.h"
+#include "ns3/lora-phy-replay.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/position-allocator.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanPhyReplayExample");
+
+uint64_t g_outcomes[LoraPhyReplay::N_OUTCOMES] = {}; //!< The outcomes at the gateways
+
+/**
+ * Count an outcome of a signal at a gateway.
+ *
+ * \param outcome The outcome.
+ * \param packet The packet.
+ * \param nodeId The node of the gateway.
+ */
+void
+OnOutcome(LoraPhyReplay::Outcome outcome, Ptr<const Packet> packet, uint32_t nodeId)
+{
+    g_outcomes[outcome]++;
+}
+
+/**
+ * Print the numbers of signals with each outcome.
+ *
+ * \param name The name of the PHY parameters.
+ * \param outcomes The number of signals with each outcome.
+ * \param seconds The wall clock time taken [s].
+ */
+void
+PrintOutcomes(std::string name, const uint64_t* outcomes, double seconds)
+{
+    std::cout << name << ": received " << outcomes[LoraPhyReplay::RECEIVED] << ", interfered "
+              << outcomes[LoraPhyReplay::INTERFERED] << ", under sensitivity "
+              << outcomes[LoraPhyReplay::UNDER_SENSITIVITY] << ", no more receivers "
+              << outcomes[LoraPhyReplay::NO_MORE_RECEIVERS] << ", transmitting "
+              << outcomes[LoraPhyReplay::TRANSMITTING] << " (" << seconds << " s)" << std::endl;
+}
+
+/**
+ * Simulate the network, recording the signals at its gateways.
+ *
+ * \param nDevices The number of end devices.
+ * \param nGatewayRings The number of rings of the grid of gateways.
+ * \param radius The radius of the area of the devices [m].
+ * \param simulationTime The time to simulate [s].
+ * \param recordFile The file of records.
+ */
+void
+Simulate(uint32_t nDevices,
+         uint32_t nGatewayRings,
+         double radius,
+         double simulationTime,
+         std::string recordFile)
+{
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                  "rho",
+                                  DoubleValue(radius),
+                                  "Z",
+                                  DoubleValue(1.2));
+    NodeContainer endDevices;
+    endDevices.Create(nDevices);
+    mobility.Install(endDevices);
+
+    // A hexagonal grid of gateways, with a ring covering about the area
+    double gatewayDistance = radius / (nGatewayRings + 0.5);
+    mobility.SetPositionAllocator(CreateObject<HexGridPositionAllocator>(gatewayDistance / 2));
+    NodeContainer gateways;
+    gateways.Create(1 + 3 * nGatewayRings * (nGatewayRings + 1));
+    mobility.Install(gateways);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    LorawanMacHelper macHelper;
+    LoraHelper helper;
+
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, gateways);
+
+    LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    PeriodicSenderHelper appHelper;
+    appHelper.SetPeriod(Seconds(600));
+    ApplicationContainer apps = appHelper.Install(endDevices);
+    apps.Start(Seconds(0));
+    apps.Stop(Seconds(simulationTime));
+
+    const std::pair<const char*, LoraPhyReplay::Outcome> traces[] = {
+        {"ReceivedPacket", LoraPhyReplay::RECEIVED},
+        {"LostPacketBecauseInterference", LoraPhyReplay::INTERFERED},
+        {"LostPacketBecauseUnderSensitivity", LoraPhyReplay::UNDER_SENSITIVITY},
+        {"LostPacketBecauseNoMoreReceivers", LoraPhyReplay::NO_MORE_RECEIVERS},
+        {"NoReceptionBecauseTransmitting", LoraPhyReplay::TRANSMITTING},
+    };
+    for (auto gw = gateways.Begin(); gw != gateways.End(); gw++)
+    {
+        Ptr<LoraPhy> phy = (*gw)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+        for (const auto& [name, outcome] : traces)
+        {
+            phy->TraceConnectWithoutContext(name, MakeBoundCallback(&OnOutcome, outcome));
+        }
+    }
+
+    LoraPhyRecorder recorder;
+    recorder.Open(recordFile);
+    recorder.Install(gateways);
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Stop(Seconds(simulationTime + 10));
+    Simulator::Run();
+    Simulator::Destroy();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    recorder.Close();
+    std::cout << recorder.GetNRecords() << " signals recorded to " << recordFile << std::endl;
+    PrintOutcomes("simulation", g_outcomes, elapsed.count());
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nDevices = 2000;
+    uint32_t nGatewayRings = 1;
+    double radius = 6000;
+    double simulationTime = 3600;
+    std::string recordFile = "lorawan-phy-records.bin";
+    bool replayOnly = false;
+    uint32_t nThreads = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nDevices", "Number of end devices to include in the simulation", nDevices);
+    cmd.AddValue("nGatewayRings",
+                 "Number of rings of the hexagonal grid of gateways",
+                 nGatewayRings);
+    cmd.AddValue("radius", "The radius [m] of the area to simulate", radius);
+    cmd.AddValue("simulationTime", "The time [s] for which to simulate", simulationTime);
+    cmd.AddValue("recordFile", "The file of the signals at the gateways", recordFile);
+    cmd.AddValue("replay", "Only replay the file of records", replayOnly);
+    cmd.AddValue("nThreads", "The threads of the replay, 0 for the hardware ones", nThreads);
+    cmd.Parse(argc, argv);
+
+    if (!replayOnly)
+    {
+        Simulate(nDevices, nGatewayRings, radius, simulationTime, recordFile);
+    }
+
+    LoraPhyReplay replay;
+    replay.Load(recordFile);
+    if (nThreads > 0)
+    {
+        replay.SetNThreads(nThreads);
+    }
+
+    LoraPhyReplay::Parameters aloha;
+    aloha.collisionSnir = LoraInterferenceHelper::collisionSnirAloha;
+    LoraPhyReplay::Parameters lowCapture;
+    for (uint8_t sf = 0; sf < 6; sf++)
+    {
+        lowCapture.collisionSnir[sf][sf] = 1;
+    }
+    LoraPhyReplay::Parameters fewPaths;
+    fewPaths.nReceptionPaths = 2;
+    LoraPhyReplay::Parameters manyPaths;
+    manyPaths.nReceptionPaths = 16;
+
+    const std::pair<const char*, LoraPhyReplay::Parameters> runs[] = {
+        {"replay", LoraPhyReplay::Parameters()},
+        {"ALOHA", aloha},
+        {"capture 1 dB", lowCapture},
+        {"2 paths", fewPaths},
+        {"16 paths", manyPaths},
+    };
+    for (const auto& [name, parameters] : runs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        replay.Run(parameters);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        uint64_t outcomes[LoraPhyReplay::N_OUTCOMES];
+        for (uint8_t outcome = 0; outcome < LoraPhyReplay::N_OUTCOMES; outcome++)
+        {
+            outcomes[outcome] = replay.GetNOutcomes(LoraPhyReplay::Outcome(outcome));
+        }
+        PrintOutcomes(name, outcomes, elapsed.count());
+        std::cout << "  packets received by a gateway: " << replay.GetNReceivedPackets()
+                  << std::endl;
+    }
+
+    return 0;
+}
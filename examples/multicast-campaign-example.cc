@@ -0,0 +1,164 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This example runs a multicast campaign (e.g., a firmware update) towards a
+ * group of Class C devices. The network server delivers the fragments through
+ * the gateways, and the campaign completion time and the airtime spent by each
+ * gateway are printed at the end of the simulation.
+ */
+
+#include "ns3/class-c-end-device-lorawan-mac.h"
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/log.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-device-address-generator.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/multicast-session.h"
+#include "ns3/network-module.h"
+#include "ns3/network-server-helper.h"
+#include "ns3/network-server.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/string.h"
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("MulticastCampaignExample");
+
+int
+main(int argc, char* argv[])
+{
+    int nDevices = 200;
+    int nGateways = 2;
+    double radiusMeters = 3000;
+    uint32_t nFragments = 20;
+    uint32_t fragmentSize = 50;
+    uint32_t repetitions = 3;
+    int dataRate = 0;
+    double simulationTimeSeconds = 7200;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nDevices", "Number of Class C devices in the multicast group", nDevices);
+    cmd.AddValue("nGateways", "Number of gateways", nGateways);
+    cmd.AddValue("radius", "Radius (m) of the deployment", radiusMeters);
+    cmd.AddValue("nFragments", "Number of fragments of the campaign", nFragments);
+    cmd.AddValue("fragmentSize", "Payload of each fragment (bytes)", fragmentSize);
+    cmd.AddValue("repetitions", "Maximum number of times the fragments are sent", repetitions);
+    cmd.AddValue("dataRate", "Data rate of the multicast downlinks", dataRate);
+    cmd.AddValue("simulationTime", "Simulation time (s)", simulationTimeSeconds);
+    cmd.Parse(argc, argv);
+
+    LogComponentEnable("MulticastCampaignExample", LOG_LEVEL_ALL);
+    LogComponentEnable("MulticastSession", LOG_LEVEL_INFO);
+    LogComponentEnableAll(LOG_PREFIX_TIME);
+
+    // Channel
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    // Mobility
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                  "rho",
+                                  DoubleValue(radiusMeters),
+                                  "X",
+                                  DoubleValue(0.0),
+                                  "Y",
+                                  DoubleValue(0.0));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    // Helpers
+    LoraPhyHelper phyHelper = LoraPhyHelper();
+    phyHelper.SetChannel(channel);
+    LorawanMacHelper macHelper = LorawanMacHelper();
+    LoraHelper helper = LoraHelper();
+
+    // End devices
+    NodeContainer endDevices;
+    endDevices.Create(nDevices);
+    mobility.Install(endDevices);
+
+    Ptr<LoraDeviceAddressGenerator> addrGen = CreateObject<LoraDeviceAddressGenerator>(54, 1864);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_C);
+    macHelper.SetAddressGenerator(addrGen);
+    macHelper.SetRegion(LorawanMacHelper::EU);
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    // Gateways
+    NodeContainer gateways;
+    gateways.Create(nGateways);
+    mobility.Install(gateways);
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, gateways);
+
+    // Network server
+    Ptr<Node> networkServer = CreateObject<Node>();
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+    P2PGwRegistration_t gwRegistration;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+    {
+        auto container = p2p.Install(networkServer, *gw);
+        auto serverP2PNetDev = DynamicCast<PointToPointNetDevice>(container.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, *gw);
+    }
+    NetworkServerHelper networkServerHelper;
+    networkServerHelper.SetGatewaysP2P(gwRegistration);
+    networkServerHelper.SetEndDevices(endDevices);
+    networkServerHelper.Install(networkServer);
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(gateways);
+
+    // Multicast session
+    Ptr<MulticastSession> session = CreateObject<MulticastSession>();
+    session->SetAttribute("NFragments", UintegerValue(nFragments));
+    session->SetAttribute("FragmentSize", UintegerValue(fragmentSize));
+    session->SetAttribute("Repetitions", UintegerValue(repetitions));
+    session->SetAttribute("DataRate", UintegerValue(dataRate));
+    session->SetGroupAddress(LoraDeviceAddress(uint8_t(54), uint32_t(0x1ffffff)));
+    for (auto ed = endDevices.Begin(); ed != endDevices.End(); ++ed)
+    {
+        Ptr<LorawanMac> mac = (*ed)->GetDevice(0)->GetObject<LoraNetDevice>()->GetMac();
+        session->AddMember(mac->GetObject<ClassCEndDeviceLorawanMac>());
+    }
+    networkServer->GetApplication(0)->GetObject<NetworkServer>()->AddMulticastSession(session,
+                                                                                     Seconds(1));
+
+    Simulator::Stop(Seconds(simulationTimeSeconds));
+    Simulator::Run();
+
+    // Report
+    if (session->IsComplete())
+    {
+        std::cout << "Campaign completed in " << session->GetCompletionTime().GetSeconds()
+                  << " s" << std::endl;
+    }
+    else
+    {
+        std::cout << "Campaign not completed: " << session->GetNCompletedMembers() << "/"
+                  << session->GetNMembers() << " devices received every fragment"
+                  << std::endl;
+    }
+    for (const auto& gw : session->GetAirtimePerGateway())
+    {
+        std::cout << "Gateway " << gw.first << " airtime: " << gw.second.GetSeconds() << " s"
+                  << std::endl;
+    }
+
+    Simulator::Destroy();
+
+    return 0;
+}
@@ -0,0 +1,331 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "alarm-traffic-helper.h"
+
+#include "ns3/double.h"
+#include "ns3/gateway-lorawan-mac.h"
+#include "ns3/log.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-phy.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("AlarmTrafficHelper");
+
+AlarmTrafficHelper::AlarmTrafficHelper()
+    : m_speed(1000),
+      m_radius(std::numeric_limits<double>::infinity()),
+      m_packetSize(10),
+      m_deliveryTimeout(0)
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<UniformRandomVariable> reaction = CreateObject<UniformRandomVariable>();
+    reaction->SetAttribute("Min", DoubleValue(0));
+    reaction->SetAttribute("Max", DoubleValue(1));
+    m_reaction = reaction;
+    m_eventRv = CreateObject<UniformRandomVariable>();
+}
+
+AlarmTrafficHelper::~AlarmTrafficHelper()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+AlarmTrafficHelper::SetPropagationSpeed(double metersPerSecond)
+{
+    NS_ASSERT(metersPerSecond > 0);
+    m_speed = metersPerSecond;
+}
+
+void
+AlarmTrafficHelper::SetRadius(double meters)
+{
+    m_radius = meters;
+}
+
+void
+AlarmTrafficHelper::SetReactionDelay(Ptr<RandomVariableStream> delay)
+{
+    m_reaction = delay;
+}
+
+void
+AlarmTrafficHelper::SetPacketSize(uint8_t size)
+{
+    m_packetSize = size;
+}
+
+void
+AlarmTrafficHelper::SetDeliveryTimeout(Time timeout)
+{
+    m_deliveryTimeout = timeout;
+}
+
+void
+AlarmTrafficHelper::Install(NodeContainer endDevices)
+{
+    NS_LOG_FUNCTION(this);
+
+    m_macs.reserve(m_macs.size() + endDevices.GetN());
+    m_mobilities.reserve(m_mobilities.size() + endDevices.GetN());
+    for (auto node = endDevices.Begin(); node != endDevices.End(); node++)
+    {
+        // Assumes there's only one device, like the sender applications
+        Ptr<LoraNetDevice> loraNetDevice = (*node)->GetDevice(0)->GetObject<LoraNetDevice>();
+        NS_ASSERT(loraNetDevice);
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        NS_ASSERT(mac);
+        Ptr<MobilityModel> mobility = (*node)->GetObject<MobilityModel>();
+        NS_ASSERT(mobility);
+        m_macs.push_back(mac);
+        m_mobilities.push_back(mobility);
+    }
+}
+
+void
+AlarmTrafficHelper::MonitorGateways(NodeContainer gateways)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto node = gateways.Begin(); node != gateways.End(); node++)
+    {
+        Ptr<LoraNetDevice> loraNetDevice = (*node)->GetDevice(0)->GetObject<LoraNetDevice>();
+        NS_ASSERT(loraNetDevice);
+        Ptr<GatewayLorawanMac> mac = DynamicCast<GatewayLorawanMac>(loraNetDevice->GetMac());
+        NS_ASSERT(mac);
+        mac->TraceConnectWithoutContext("ReceivedPacket",
+                                        MakeCallback(&AlarmTrafficHelper::ReceivedPacket, this));
+    }
+}
+
+void
+AlarmTrafficHelper::AddEvent(Time delay, Vector epicentre)
+{
+    NS_LOG_FUNCTION(this << delay << epicentre);
+
+    uint32_t burst = m_bursts.size();
+    m_bursts.push_back({Simulator::Now() + delay, epicentre, 0, 0, Time::Max()});
+    Simulator::Schedule(delay, &AlarmTrafficHelper::StartBurst, this, burst);
+}
+
+void
+AlarmTrafficHelper::AddRandomEvents(uint32_t nEvents,
+                                    Time start,
+                                    Time stop,
+                                    Vector centre,
+                                    double radius)
+{
+    NS_LOG_FUNCTION(this << nEvents << start << stop << centre << radius);
+
+    for (uint32_t i = 0; i < nEvents; i++)
+    {
+        Time delay = Seconds(m_eventRv->GetValue(start.GetSeconds(), stop.GetSeconds()));
+        // The square root makes epicentres uniform over the disc area
+        double rho = radius * std::sqrt(m_eventRv->GetValue(0, 1));
+        double theta = m_eventRv->GetValue(0, 2 * M_PI);
+        AddEvent(delay,
+                 Vector(centre.x + rho * std::cos(theta), centre.y + rho * std::sin(theta), 0));
+    }
+}
+
+int64_t
+AlarmTrafficHelper::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+
+    m_eventRv->SetStream(stream);
+    m_reaction->SetStream(stream + 1);
+    return 2;
+}
+
+const std::vector<AlarmTrafficHelper::Burst>&
+AlarmTrafficHelper::GetBursts() const
+{
+    return m_bursts;
+}
+
+double
+AlarmTrafficHelper::GetDeliveryRatio(uint32_t burst) const
+{
+    NS_ASSERT(burst < m_bursts.size());
+
+    const Burst& b = m_bursts[burst];
+    if (b.nTriggered == 0)
+    {
+        return 0;
+    }
+    return double(b.nDelivered) / b.nTriggered;
+}
+
+Time
+AlarmTrafficHelper::GetTimeToFirstReport(uint32_t burst) const
+{
+    NS_ASSERT(burst < m_bursts.size());
+
+    const Burst& b = m_bursts[burst];
+    if (b.firstReport == Time::Max())
+    {
+        return Time::Max();
+    }
+    return b.firstReport - b.eventTime;
+}
+
+uint32_t
+AlarmTrafficHelper::GetNTrackedAlarms() const
+{
+    return m_alarms.size();
+}
+
+void
+AlarmTrafficHelper::PrintBursts(std::ostream& os) const
+{
+    for (uint32_t i = 0; i < m_bursts.size(); i++)
+    {
+        const Burst& b = m_bursts[i];
+        Time ttfr = GetTimeToFirstReport(i);
+        os << b.eventTime.GetSeconds() << " " << b.epicentre.x << " " << b.epicentre.y << " "
+           << b.nTriggered << " " << b.nDelivered << " " << GetDeliveryRatio(i) << " "
+           << (ttfr == Time::Max() ? -1 : ttfr.GetSeconds()) << std::endl;
+    }
+}
+
+void
+AlarmTrafficHelper::StartBurst(uint32_t burst)
+{
+    NS_LOG_FUNCTION(this << burst);
+
+    const Vector& epicentre = m_bursts[burst].epicentre;
+    int64_t now = Simulator::Now().GetTimeStep();
+
+    PendingBurst& pending = m_pending[burst];
+    for (uint32_t device = 0; device < m_macs.size(); device++)
+    {
+        double distance = CalculateDistance(m_mobilities[device]->GetPosition(), epicentre);
+        if (distance > m_radius)
+        {
+            continue;
+        }
+        Time delay = Seconds(distance / m_speed + std::max(0.0, m_reaction->GetValue()));
+        pending.triggers.push_back({now + delay.GetTimeStep(), device});
+    }
+    m_bursts[burst].nTriggered = pending.triggers.size();
+
+    NS_LOG_DEBUG("Event " << burst << " at " << epicentre << " triggered "
+                          << pending.triggers.size() << " devices");
+
+    if (pending.triggers.empty())
+    {
+        m_pending.erase(burst);
+        return;
+    }
+
+    // Stable, so that devices triggered at the very same time send in order
+    std::stable_sort(pending.triggers.begin(),
+                     pending.triggers.end(),
+                     [](const Trigger& a, const Trigger& b) { return a.ts < b.ts; });
+    Simulator::Schedule(TimeStep(pending.triggers.front().ts - now),
+                        &AlarmTrafficHelper::SendDueAlarms,
+                        this,
+                        burst);
+}
+
+void
+AlarmTrafficHelper::SendDueAlarms(uint32_t burst)
+{
+    NS_LOG_FUNCTION(this << burst);
+
+    PendingBurst& pending = m_pending[burst];
+    int64_t now = Simulator::Now().GetTimeStep();
+    while (pending.next < pending.triggers.size() && pending.triggers[pending.next].ts <= now)
+    {
+        uint32_t device = pending.triggers[pending.next].device;
+        Ptr<Packet> packet = Create<Packet>(m_packetSize);
+        m_alarms[packet->GetUid()] = burst;
+        pending.alarms.push_back(packet->GetUid());
+        pending.timeout = std::max(pending.timeout, GetDeliveryTimeout(device));
+        m_macs[device]->Send(packet);
+        pending.next++;
+    }
+
+    if (pending.next == pending.triggers.size())
+    {
+        Simulator::Schedule(pending.timeout,
+                            &AlarmTrafficHelper::ExpireAlarms,
+                            this,
+                            std::move(pending.alarms));
+        m_pending.erase(burst);
+        return;
+    }
+    Simulator::Schedule(TimeStep(pending.triggers[pending.next].ts - now),
+                        &AlarmTrafficHelper::SendDueAlarms,
+                        this,
+                        burst);
+}
+
+Time
+AlarmTrafficHelper::GetDeliveryTimeout(uint32_t device) const
+{
+    if (!m_deliveryTimeout.IsZero())
+    {
+        return m_deliveryTimeout;
+    }
+
+    // The worst case: all transmissions at SF12, each followed by the off
+    // time of a 1% duty cycle, by the second receive window (which opens 2 s
+    // after the transmission) and by the longest ACK_TIMEOUT (3 s)
+    LoraTxParameters params;
+    params.sf = 12;
+    params.lowDataRateOptimizationEnabled = true;
+    // The 13 bytes of the MAC header, frame header and MIC
+    Ptr<Packet> frame = Create<Packet>(m_packetSize + 13);
+    Time airtime = LoraPhy::GetOnAirTime(frame, params);
+    return (airtime * 100 + Seconds(5)) * m_macs[device]->GetMaxNumberOfTransmissions();
+}
+
+void
+AlarmTrafficHelper::ExpireAlarms(std::vector<uint64_t> alarms)
+{
+    NS_LOG_FUNCTION(this << alarms.size());
+
+    for (uint64_t uid : alarms)
+    {
+        m_alarms.erase(uid);
+    }
+}
+
+void
+AlarmTrafficHelper::ReceivedPacket(Ptr<const Packet> packet)
+{
+    auto it = m_alarms.find(packet->GetUid());
+    if (it == m_alarms.end())
+    {
+        // Not an alarm, or already received by another gateway
+        return;
+    }
+
+    Burst& burst = m_bursts[it->second];
+    burst.nDelivered++;
+    if (burst.firstReport == Time::Max())
+    {
+        burst.firstReport = Simulator::Now();
+        NS_LOG_DEBUG("First report of event " << it->second << " after "
+                                              << (burst.firstReport - burst.eventTime).As(Time::S));
+    }
+    m_alarms.erase(it);
+}
+
+} // namespace lorawan
+} // namespace ns3
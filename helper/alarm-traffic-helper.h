@@ -0,0 +1,279 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef ALARM_TRAFFIC_HELPER_H
+#define ALARM_TRAFFIC_HELPER_H
+
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
+
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Generate alarm traffic: events (e.g., an earthquake, a gas leak) that
+ * trigger a spatially correlated burst of uplinks from the end devices around
+ * their epicentre.
+ *
+ * An event happens at a given time and epicentre, and propagates at a
+ * constant speed. Each device within the radius of effect of the event is
+ * triggered once the event reaches it, after an additional random reaction
+ * delay, and sends one uplink through its MAC layer.
+ *
+ * When the event happens, the trigger times of all the devices are computed
+ * and sorted, and the burst is driven by a single pending simulator event, at
+ * the next trigger time, instead of one timer per device.
+ *
+ * The uplinks of each burst are matched by packet uid to the packets received
+ * by the monitored gateways, to compute the delivery ratio of the burst (the
+ * fraction of triggered devices whose alarm was received by at least one
+ * gateway) and its time to first report (the delay between the event and the
+ * first alarm received). The alarms of a burst that are not received within a
+ * delivery timeout after its last trigger are dropped, so that they are not
+ * tracked for the rest of the simulation.
+ *
+ * The helper is connected to the trace sources of the gateways and schedules
+ * events on itself, so it must outlive the simulation.
+ */
+class AlarmTrafficHelper
+{
+  public:
+    /**
+     * The outcome of an alarm event.
+     */
+    struct Burst
+    {
+        Time eventTime;      //!< The time the event happened
+        Vector epicentre;    //!< The epicentre of the event
+        uint32_t nTriggered; //!< The number of devices triggered by the event
+        uint32_t nDelivered; //!< The number of alarms received by a gateway
+        Time firstReport;    //!< The time the first alarm was received
+    };
+
+    AlarmTrafficHelper();  //!< Default constructor
+    ~AlarmTrafficHelper(); //!< Destructor
+
+    AlarmTrafficHelper(const AlarmTrafficHelper&) = delete;            //!< Not copyable
+    AlarmTrafficHelper& operator=(const AlarmTrafficHelper&) = delete; //!< Not copyable
+
+    /**
+     * Set the propagation speed of the events.
+     *
+     * \param metersPerSecond The speed, in m/s.
+     */
+    void SetPropagationSpeed(double metersPerSecond);
+
+    /**
+     * Set the radius of effect of the events. Devices further away from the
+     * epicentre are not triggered.
+     *
+     * \param meters The radius, in meters.
+     */
+    void SetRadius(double meters);
+
+    /**
+     * Set the random variable of the reaction delay of a device, i.e., the
+     * time between the event reaching the device and its uplink.
+     *
+     * \param delay The random variable, in seconds.
+     */
+    void SetReactionDelay(Ptr<RandomVariableStream> delay);
+
+    /**
+     * Set the size of the alarm uplinks.
+     *
+     * \param size The size, in bytes.
+     */
+    void SetPacketSize(uint8_t size);
+
+    /**
+     * Set how long after the last trigger of a burst its undelivered alarms
+     * are still matched to the packets received by the gateways.
+     *
+     * By default, it is a bound on the time a device can take to deliver an
+     * alarm: its maximum number of transmissions, each with the airtime of
+     * the alarm at SF12 under a 1% duty cycle, followed by the second receive
+     * window and the longest ACK_TIMEOUT.
+     *
+     * \param timeout The timeout, or zero for the default.
+     */
+    void SetDeliveryTimeout(Time timeout);
+
+    /**
+     * Add the end devices that can be triggered by the events.
+     *
+     * \param endDevices The end device nodes, each with a LoraNetDevice as
+     * its first device and a MobilityModel.
+     */
+    void Install(NodeContainer endDevices);
+
+    /**
+     * Track the alarms received by the gateways.
+     *
+     * \param gateways The gateway nodes, each with a LoraNetDevice as its
+     * first device.
+     */
+    void MonitorGateways(NodeContainer gateways);
+
+    /**
+     * Add an event.
+     *
+     * \param delay The delay after which the event happens.
+     * \param epicentre The epicentre of the event.
+     */
+    void AddEvent(Time delay, Vector epicentre);
+
+    /**
+     * Add events at times uniformly distributed in an interval, with
+     * epicentres uniformly distributed in a disc.
+     *
+     * \param nEvents The number of events.
+     * \param start The start of the interval, as a delay from now.
+     * \param stop The end of the interval, as a delay from now.
+     * \param centre The centre of the disc.
+     * \param radius The radius of the disc, in meters.
+     */
+    void AddRandomEvents(uint32_t nEvents, Time start, Time stop, Vector centre, double radius);
+
+    /**
+     * Assign fixed random variable stream numbers to the random variables used
+     * by this helper.
+     *
+     * \param stream The first stream index to use.
+     * \return The number of stream indices assigned.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * Get the bursts of the events added so far.
+     *
+     * \return The bursts, in the order the events were added.
+     */
+    const std::vector<Burst>& GetBursts() const;
+
+    /**
+     * Get the delivery ratio of a burst.
+     *
+     * \param burst The index of the burst.
+     * \return The fraction of the triggered devices whose alarm was received,
+     * or zero if no device was triggered.
+     */
+    double GetDeliveryRatio(uint32_t burst) const;
+
+    /**
+     * Get the time to first report of a burst.
+     *
+     * \param burst The index of the burst.
+     * \return The delay between the event and the first alarm received, or
+     * Time::Max() if no alarm was received.
+     */
+    Time GetTimeToFirstReport(uint32_t burst) const;
+
+    /**
+     * Get the number of alarms still tracked, i.e., sent but neither received
+     * by a gateway nor past their delivery timeout.
+     *
+     * \return The number of alarms.
+     */
+    uint32_t GetNTrackedAlarms() const;
+
+    /**
+     * Print one line per burst: the event time, the epicentre, the number of
+     * triggered devices and of delivered alarms, the delivery ratio and the
+     * time to first report (-1 if no alarm was received), in seconds.
+     *
+     * \param os The output stream.
+     */
+    void PrintBursts(std::ostream& os) const;
+
+  private:
+    /**
+     * The trigger of a device.
+     */
+    struct Trigger
+    {
+        int64_t ts;      //!< The trigger time, in time steps
+        uint32_t device; //!< The index of the device
+    };
+
+    /**
+     * The triggers of a burst in progress.
+     */
+    struct PendingBurst
+    {
+        std::vector<Trigger> triggers; //!< The triggers, sorted by time
+        size_t next = 0;               //!< The index of the next trigger
+        std::vector<uint64_t> alarms;  //!< The uids of the alarms sent
+        Time timeout;                  //!< The delivery timeout of the alarms sent
+    };
+
+    /**
+     * Compute the triggers of an event and schedule the first one.
+     *
+     * \param burst The index of the burst.
+     */
+    void StartBurst(uint32_t burst);
+
+    /**
+     * Send the alarms of all the triggers of a burst due now, and schedule
+     * the next one.
+     *
+     * \param burst The index of the burst.
+     */
+    void SendDueAlarms(uint32_t burst);
+
+    /**
+     * Get the delivery timeout of an alarm sent by a device.
+     *
+     * \param device The index of the device.
+     * \return The timeout.
+     */
+    Time GetDeliveryTimeout(uint32_t device) const;
+
+    /**
+     * Stop tracking the alarms of a burst that were not received.
+     *
+     * \param alarms The uids of the alarms of the burst.
+     */
+    void ExpireAlarms(std::vector<uint64_t> alarms);
+
+    /**
+     * Match a packet received by a gateway to a burst.
+     *
+     * \param packet The packet.
+     */
+    void ReceivedPacket(Ptr<const Packet> packet);
+
+    double m_speed;                       //!< The propagation speed, in m/s
+    double m_radius;                      //!< The radius of effect, in meters
+    Ptr<RandomVariableStream> m_reaction; //!< The reaction delay, in seconds
+    Ptr<UniformRandomVariable> m_eventRv; //!< Draws the random events
+    uint8_t m_packetSize;                 //!< The size of the alarms, in bytes
+    Time m_deliveryTimeout;               //!< The delivery timeout, or zero for the default
+
+    std::vector<Ptr<EndDeviceLorawanMac>> m_macs; //!< The MAC layer of each device
+    std::vector<Ptr<MobilityModel>> m_mobilities; //!< The mobility model of each device
+
+    std::vector<Burst> m_bursts;                          //!< The bursts
+    std::unordered_map<uint32_t, PendingBurst> m_pending; //!< The bursts in progress
+    std::unordered_map<uint64_t, uint32_t> m_alarms;      //!< The burst of each undelivered alarm
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* ALARM_TRAFFIC_HELPER_H */
@@ -0,0 +1,138 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-distributed-helper.h"
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/log.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/pointer.h"
+#include "ns3/simple-net-device.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraDistributedHelper");
+
+LoraDistributedHelper::LoraDistributedHelper()
+    : m_xMin(0),
+      m_xMax(0)
+{
+    m_channelFactory.SetTypeId("ns3::LoraDistributedChannel");
+}
+
+LoraDistributedHelper::~LoraDistributedHelper()
+{
+}
+
+void
+LoraDistributedHelper::SetPartitioning(double xMin, double xMax)
+{
+    NS_LOG_FUNCTION(this << xMin << xMax);
+    NS_ASSERT(xMin < xMax);
+
+    m_xMin = xMin;
+    m_xMax = xMax;
+}
+
+void
+LoraDistributedHelper::SetChannelAttribute(std::string name, const AttributeValue& value)
+{
+    m_channelFactory.Set(name, value);
+}
+
+uint32_t
+LoraDistributedHelper::GetNPartitions() const
+{
+    return MpiInterface::IsEnabled() ? MpiInterface::GetSize() : 1;
+}
+
+uint32_t
+LoraDistributedHelper::GetSystemId(Vector position) const
+{
+    uint32_t nPartitions = GetNPartitions();
+    if (nPartitions == 1)
+    {
+        return 0;
+    }
+    NS_ASSERT_MSG(m_xMin < m_xMax, "The partitioning was not set");
+
+    double width = (m_xMax - m_xMin) / nPartitions;
+    double stripe = std::floor((position.x - m_xMin) / width);
+    return static_cast<uint32_t>(std::clamp(stripe, 0.0, nPartitions - 1.0));
+}
+
+Box
+LoraDistributedHelper::GetRegion(uint32_t systemId) const
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    double width = (m_xMax - m_xMin) / GetNPartitions();
+    double xMin = systemId == 0 ? -infinity : m_xMin + systemId * width;
+    double xMax = systemId == GetNPartitions() - 1 ? infinity : m_xMin + (systemId + 1) * width;
+    return Box(xMin, xMax, -infinity, infinity, -infinity, infinity);
+}
+
+NodeContainer
+LoraDistributedHelper::CreateNodes(uint32_t nNodes, Ptr<PositionAllocator> allocator) const
+{
+    NS_LOG_FUNCTION(this << nNodes << allocator);
+
+    NodeContainer nodes;
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        Vector position = allocator->GetNext();
+        Ptr<Node> node = CreateObject<Node>(GetSystemId(position));
+        Ptr<ConstantPositionMobilityModel> mobility =
+            CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(position);
+        node->AggregateObject(mobility);
+        nodes.Add(node);
+    }
+    return nodes;
+}
+
+Ptr<LoraDistributedChannel>
+LoraDistributedHelper::CreateChannel(Ptr<PropagationLossModel> loss,
+                                     Ptr<PropagationDelayModel> delay) const
+{
+    NS_LOG_FUNCTION(this << loss << delay);
+
+    Ptr<LoraDistributedChannel> channel = m_channelFactory.Create<LoraDistributedChannel>();
+    channel->SetAttribute("PropagationLossModel", PointerValue(loss));
+    channel->SetAttribute("PropagationDelayModel", PointerValue(delay));
+
+    // Every rank creates the nodes of all the partitions, so that the node
+    // ids agree
+    for (uint32_t systemId = 0; systemId < GetNPartitions(); systemId++)
+    {
+        Ptr<Node> node = CreateObject<Node>(systemId);
+        node->AddDevice(CreateObject<SimpleNetDevice>());
+        channel->AddPartition(systemId, GetRegion(systemId), node);
+    }
+    return channel;
+}
+
+NodeContainer
+LoraDistributedHelper::GetLocalNodes(NodeContainer nodes)
+{
+    uint32_t systemId = MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+    NodeContainer localNodes;
+    for (auto node = nodes.Begin(); node != nodes.End(); node++)
+    {
+        if ((*node)->GetSystemId() == systemId)
+        {
+            localNodes.Add(*node);
+        }
+    }
+    return localNodes;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,117 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_DISTRIBUTED_HELPER_H
+#define LORA_DISTRIBUTED_HELPER_H
+
+#include "ns3/lora-distributed-channel.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/position-allocator.h"
+
+#include <string>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Partition a LoRaWAN network spatially across the MPI ranks of a distributed
+ * simulation, in stripes of equal width along the x axis.
+ *
+ * All ranks make the same calls of the helper, in the same order, so that
+ * they create the same nodes: CreateNodes creates nodes with the rank of the
+ * stripe of their position as system id, and CreateChannel creates the
+ * LoraDistributedChannel of the rank with the partitions of all ranks. The
+ * LoRa devices are then installed on the nodes of the rank only, which
+ * GetLocalNodes selects. Without MPI there is a single partition.
+ */
+class LoraDistributedHelper
+{
+  public:
+    LoraDistributedHelper();  //!< Default constructor
+    ~LoraDistributedHelper(); //!< Destructor
+
+    /**
+     * Set the extent of the stripes along the x axis. The first and last
+     * stripes also hold the nodes before and after it.
+     *
+     * \param xMin The start of the first stripe [m].
+     * \param xMax The end of the last stripe [m].
+     */
+    void SetPartitioning(double xMin, double xMax);
+
+    /**
+     * Set an attribute of the channels created by the helper.
+     *
+     * \param name The name of the attribute.
+     * \param value The value of the attribute.
+     */
+    void SetChannelAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * Get the number of partitions, i.e., of MPI ranks.
+     *
+     * \return The number of partitions.
+     */
+    uint32_t GetNPartitions() const;
+
+    /**
+     * Get the rank of the partition of a position.
+     *
+     * \param position The position.
+     * \return The system id of the rank.
+     */
+    uint32_t GetSystemId(Vector position) const;
+
+    /**
+     * Create nodes at the positions of an allocator, each with a
+     * ConstantPositionMobilityModel and the system id of its partition.
+     *
+     * \param nNodes The number of nodes.
+     * \param allocator The allocator of the positions.
+     * \return The nodes.
+     */
+    NodeContainer CreateNodes(uint32_t nNodes, Ptr<PositionAllocator> allocator) const;
+
+    /**
+     * Create the channel of this rank, with a node per partition receiving its
+     * remote transmissions.
+     *
+     * \param loss The loss model of the channel.
+     * \param delay The delay model of the channel.
+     * \return The channel.
+     */
+    Ptr<LoraDistributedChannel> CreateChannel(Ptr<PropagationLossModel> loss,
+                                              Ptr<PropagationDelayModel> delay) const;
+
+    /**
+     * Select the nodes of this rank.
+     *
+     * \param nodes The nodes.
+     * \return The nodes whose system id is that of this rank.
+     */
+    static NodeContainer GetLocalNodes(NodeContainer nodes);
+
+  private:
+    /**
+     * Get the region of a partition.
+     *
+     * \param systemId The rank of the partition.
+     * \return The region.
+     */
+    Box GetRegion(uint32_t systemId) const;
+
+    double m_xMin;                  //!< The start of the first stripe [m]
+    double m_xMax;                  //!< The end of the last stripe [m]
+    ObjectFactory m_channelFactory; //!< The factory of the channels
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_DISTRIBUTED_HELPER_H */
@@ -0,0 +1,252 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-far-field-helper.h"
+
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/log.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraFarFieldHelper");
+
+// The LoRaWAN headers of an uplink without options: 1 byte of MAC header and
+// 8 of frame header
+static const uint8_t HEADERS_SIZE = 9; //!< The size of the headers of an uplink [bytes]
+
+LoraFarFieldHelper::LoraFarFieldHelper()
+    : m_distance(std::numeric_limits<double>::max()),
+      m_period(Seconds(600)),
+      m_packetSize(10),
+      m_txPowerDbm(14),
+      m_frequencies({868.1, 868.3, 868.5}),
+      m_nSignals(0)
+{
+    m_arrivalRv = CreateObject<ExponentialRandomVariable>();
+    m_powerRv = CreateObject<UniformRandomVariable>();
+}
+
+LoraFarFieldHelper::~LoraFarFieldHelper()
+{
+}
+
+void
+LoraFarFieldHelper::SetDistance(double meters)
+{
+    m_distance = meters;
+}
+
+void
+LoraFarFieldHelper::SetPeriod(Time period)
+{
+    NS_ASSERT(period.IsStrictlyPositive());
+    m_period = period;
+}
+
+void
+LoraFarFieldHelper::SetPacketSize(uint8_t size)
+{
+    m_packetSize = size;
+}
+
+void
+LoraFarFieldHelper::SetTxPower(double dBm)
+{
+    m_txPowerDbm = dBm;
+}
+
+void
+LoraFarFieldHelper::SetFrequencies(std::vector<double> frequenciesMHz)
+{
+    NS_ASSERT(!frequenciesMHz.empty());
+    m_frequencies = frequenciesMHz;
+}
+
+Ptr<ListPositionAllocator>
+LoraFarFieldHelper::Split(Ptr<PositionAllocator> allocator,
+                          uint32_t nDevices,
+                          NodeContainer gateways)
+{
+    NS_LOG_FUNCTION(this << allocator << nDevices);
+
+    Ptr<ListPositionAllocator> nearField = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < nDevices; i++)
+    {
+        Vector position = allocator->GetNext();
+        bool isNear = false;
+        for (auto gw = gateways.Begin(); gw != gateways.End() && !isNear; gw++)
+        {
+            Vector gwPosition = (*gw)->GetObject<MobilityModel>()->GetPosition();
+            isNear = CalculateDistance(position, gwPosition) <= m_distance;
+        }
+        if (isNear)
+        {
+            nearField->Add(position);
+        }
+        else
+        {
+            m_farPositions.push_back(position);
+        }
+    }
+    NS_LOG_INFO(nearField->GetSize() << " devices in the near field, " << m_farPositions.size()
+                                     << " in the far field");
+    return nearField;
+}
+
+void
+LoraFarFieldHelper::Install(NodeContainer gateways, Ptr<LoraChannel> channel)
+{
+    NS_LOG_FUNCTION(this << channel);
+
+    if (m_farPositions.empty())
+    {
+        return;
+    }
+
+    // The power of each far device at each gateway
+    std::vector<Ptr<MobilityModel>> gwMobilities;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); gw++)
+    {
+        gwMobilities.push_back((*gw)->GetObject<MobilityModel>());
+    }
+    Ptr<ConstantPositionMobilityModel> deviceMobility =
+        CreateObject<ConstantPositionMobilityModel>();
+    std::vector<std::vector<double>> rxPowers(m_farPositions.size(),
+                                              std::vector<double>(gateways.GetN()));
+    std::vector<uint8_t> sfs(m_farPositions.size());
+    for (uint32_t d = 0; d < m_farPositions.size(); d++)
+    {
+        deviceMobility->SetPosition(m_farPositions[d]);
+        double highestRxPower = -std::numeric_limits<double>::infinity();
+        for (uint32_t g = 0; g < gateways.GetN(); g++)
+        {
+            rxPowers[d][g] = channel->GetRxPower(m_txPowerDbm, deviceMobility, gwMobilities[g]);
+            highestRxPower = std::max(highestRxPower, rxPowers[d][g]);
+        }
+
+        // The spreading factor of LorawanMacHelper::SetSpreadingFactorsUp,
+        // SF12 for the devices out of range
+        sfs[d] = 12;
+        for (uint8_t sf = 7; sf < 12; sf++)
+        {
+            if (highestRxPower > EndDeviceLoraPhy::sensitivity[sf - 7])
+            {
+                sfs[d] = sf;
+                break;
+            }
+        }
+    }
+
+    // A process per gateway, channel and spreading factor
+    Ptr<Packet> packet = Create<Packet>(m_packetSize + HEADERS_SIZE);
+    double deviceRate = 1 / m_period.GetSeconds() / m_frequencies.size();
+    for (uint32_t g = 0; g < gateways.GetN(); g++)
+    {
+        Ptr<LoraPhy> phy = gateways.Get(g)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+        for (uint8_t sf = 7; sf <= 12; sf++)
+        {
+            std::vector<double> powers;
+            for (uint32_t d = 0; d < m_farPositions.size(); d++)
+            {
+                if (sfs[d] == sf)
+                {
+                    powers.push_back(rxPowers[d][g]);
+                }
+            }
+            if (powers.empty())
+            {
+                continue;
+            }
+
+            LoraTxParameters params;
+            params.sf = sf;
+            params.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(params) > MilliSeconds(16);
+            Time duration = LoraPhy::GetOnAirTime(packet, params);
+            for (double frequency : m_frequencies)
+            {
+                m_processes.push_back({phy,
+                                       gateways.Get(g)->GetId(),
+                                       frequency,
+                                       sf,
+                                       deviceRate * powers.size(),
+                                       duration,
+                                       powers});
+                ScheduleSignal(m_processes.size() - 1);
+            }
+        }
+    }
+}
+
+void
+LoraFarFieldHelper::ScheduleSignal(uint32_t process)
+{
+    double interval = m_arrivalRv->GetValue(1 / m_processes[process].rate, 0);
+    Simulator::Schedule(Seconds(interval), &LoraFarFieldHelper::AddSignal, this, process);
+}
+
+void
+LoraFarFieldHelper::AddSignal(uint32_t process)
+{
+    const Process& p = m_processes[process];
+    double rxPowerDbm = p.powers[m_powerRv->GetInteger(0, p.powers.size() - 1)];
+    NS_LOG_DEBUG("Signal at gateway " << p.gatewayId << ": " << rxPowerDbm << " dBm, SF"
+                                      << unsigned(p.sf) << ", " << p.frequencyMHz << " MHz");
+    p.phy->AddInterference(p.duration, rxPowerDbm, p.sf, p.frequencyMHz);
+    m_nSignals++;
+
+    ScheduleSignal(process);
+}
+
+uint32_t
+LoraFarFieldHelper::GetNFarDevices() const
+{
+    return m_farPositions.size();
+}
+
+uint64_t
+LoraFarFieldHelper::GetNSignals() const
+{
+    return m_nSignals;
+}
+
+void
+LoraFarFieldHelper::PrintProcesses(std::ostream& os) const
+{
+    for (const auto& p : m_processes)
+    {
+        // The mean of the powers in mW
+        double meanMw =
+            std::accumulate(p.powers.begin(),
+                            p.powers.end(),
+                            0.0,
+                            [](double sum, double dBm) { return sum + std::pow(10, dBm / 10); }) /
+            p.powers.size();
+        os << p.gatewayId << " " << p.frequencyMHz << " " << unsigned(p.sf) << " "
+           << p.powers.size() << " " << p.rate << " " << 10 * std::log10(meanMw) << " "
+           << p.duration.GetSeconds() << std::endl;
+    }
+}
+
+int64_t
+LoraFarFieldHelper::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+
+    m_arrivalRv->SetStream(stream);
+    m_powerRv->SetStream(stream + 1);
+    return 2;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,198 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_FAR_FIELD_HELPER_H
+#define LORA_FAR_FIELD_HELPER_H
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-phy.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+
+#include <ostream>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Replace the end devices far from the gateways with a statistical model of
+ * the interference they cause, so that the cost of a gateway-centric
+ * simulation scales with the devices close to the gateways only.
+ *
+ * Split draws the positions of the devices and keeps the far ones, those
+ * further than a distance from every gateway, returning the near ones, which
+ * are simulated with the full stack. Install then computes the power of each
+ * far device at each gateway through the channel, and its spreading factor as
+ * LorawanMacHelper::SetSpreadingFactorsUp would. For each gateway, channel and
+ * spreading factor, the far devices make a Poisson process of signals, with
+ * the rate of their periodic uplinks split evenly among the channels and the
+ * powers of the devices at the gateway as the distribution of the power of
+ * the signals. Each signal is added to the LoraInterferenceHelper of the
+ * gateway PHY with LoraPhy::AddInterference: it interferes with the
+ * receptions of the gateway, but is never received, nor occupies a reception
+ * path.
+ *
+ * The processes of different gateways are independent, while a real uplink
+ * reaches all gateways at once. The helper schedules events on itself, so it
+ * must outlive the simulation, and the processes never end, so the simulation
+ * must be stopped with Simulator::Stop.
+ */
+class LoraFarFieldHelper
+{
+  public:
+    LoraFarFieldHelper();  //!< Default constructor
+    ~LoraFarFieldHelper(); //!< Destructor
+
+    LoraFarFieldHelper(const LoraFarFieldHelper&) = delete;            //!< Not copyable
+    LoraFarFieldHelper& operator=(const LoraFarFieldHelper&) = delete; //!< Not copyable
+
+    /**
+     * Set the distance from the closest gateway beyond which devices are in the
+     * far field.
+     *
+     * \param meters The distance, in meters.
+     */
+    void SetDistance(double meters);
+
+    /**
+     * Set the period of the uplinks of the far devices.
+     *
+     * \param period The period.
+     */
+    void SetPeriod(Time period);
+
+    /**
+     * Set the application payload size of the uplinks of the far devices. The
+     * LoRaWAN headers are added to compute their duration.
+     *
+     * \param size The size, in bytes.
+     */
+    void SetPacketSize(uint8_t size);
+
+    /**
+     * Set the transmission power of the far devices.
+     *
+     * \param dBm The power, in dBm.
+     */
+    void SetTxPower(double dBm);
+
+    /**
+     * Set the channels the far devices transmit on, with equal probability.
+     *
+     * \param frequenciesMHz The frequencies of the channels, in MHz.
+     */
+    void SetFrequencies(std::vector<double> frequenciesMHz);
+
+    /**
+     * Draw the positions of the devices, keep those in the far field and
+     * return the others.
+     *
+     * \param allocator The allocator of the positions of the devices.
+     * \param nDevices The number of devices.
+     * \param gateways The gateway nodes, each with a MobilityModel.
+     * \return The positions of the devices in the near field, to be simulated
+     * with the full stack.
+     */
+    Ptr<ListPositionAllocator> Split(Ptr<PositionAllocator> allocator,
+                                     uint32_t nDevices,
+                                     NodeContainer gateways);
+
+    /**
+     * Calibrate the interference processes of the far devices kept by Split at
+     * the gateways, and start them.
+     *
+     * \param gateways The gateway nodes, each with a LoraNetDevice as its
+     * first device and a MobilityModel.
+     * \param channel The channel, whose loss model gives the power of the far
+     * devices at the gateways.
+     */
+    void Install(NodeContainer gateways, Ptr<LoraChannel> channel);
+
+    /**
+     * Get the number of devices in the far field.
+     *
+     * \return The number of devices.
+     */
+    uint32_t GetNFarDevices() const;
+
+    /**
+     * Get the number of signals added to the gateways so far.
+     *
+     * \return The number of signals.
+     */
+    uint64_t GetNSignals() const;
+
+    /**
+     * Print one line per interference process: the node id of the gateway,
+     * the frequency [MHz], the spreading factor, the number of devices, the
+     * rate [signals/s], the mean power [dBm] and the duration [s] of the
+     * signals.
+     *
+     * \param os The output stream.
+     */
+    void PrintProcesses(std::ostream& os) const;
+
+    /**
+     * Assign fixed random variable stream numbers to the random variables used
+     * by this helper.
+     *
+     * \param stream The first stream index to use.
+     * \return The number of stream indices assigned.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    /**
+     * The interference of the far devices on a spreading factor and a channel
+     * at a gateway.
+     */
+    struct Process
+    {
+        Ptr<LoraPhy> phy;           //!< The PHY of the gateway
+        uint32_t gatewayId;         //!< The node id of the gateway
+        double frequencyMHz;        //!< The frequency of the channel
+        uint8_t sf;                 //!< The spreading factor
+        double rate;                //!< The rate of the signals [1/s]
+        Time duration;              //!< The duration of the signals
+        std::vector<double> powers; //!< The power of each device at the gateway [dBm]
+    };
+
+    /**
+     * Add a signal of a process to its gateway, and schedule the next one.
+     *
+     * \param process The index of the process.
+     */
+    void AddSignal(uint32_t process);
+
+    /**
+     * Schedule the next signal of a process.
+     *
+     * \param process The index of the process.
+     */
+    void ScheduleSignal(uint32_t process);
+
+    double m_distance;                          //!< The distance of the far field [m]
+    Time m_period;                              //!< The period of the uplinks
+    uint8_t m_packetSize;                       //!< The payload size of the uplinks [bytes]
+    double m_txPowerDbm;                        //!< The transmission power [dBm]
+    std::vector<double> m_frequencies;          //!< The channels [MHz]
+    std::vector<Vector> m_farPositions;         //!< The positions of the far devices
+    std::vector<Process> m_processes;           //!< The interference processes
+    uint64_t m_nSignals;                        //!< The signals added so far
+    Ptr<ExponentialRandomVariable> m_arrivalRv; //!< Draws the time between signals
+    Ptr<UniformRandomVariable> m_powerRv;       //!< Draws the device of a signal
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_FAR_FIELD_HELPER_H */
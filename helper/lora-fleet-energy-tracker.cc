@@ -0,0 +1,324 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-fleet-energy-tracker.h"
+
+#include "ns3/log.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraFleetEnergyTracker");
+
+LoraFleetEnergyTracker::Listener::Listener(LoraFleetEnergyTracker* tracker, uint32_t nodeId)
+    : m_tracker(tracker),
+      m_nodeId(nodeId)
+{
+}
+
+void
+LoraFleetEnergyTracker::Listener::NotifyRxStart()
+{
+    m_tracker->StateChanged(m_nodeId,
+                            EndDeviceLoraPhy::RX,
+                            m_tracker->m_stateCurrentA[EndDeviceLoraPhy::RX]);
+}
+
+void
+LoraFleetEnergyTracker::Listener::NotifyTxStart(double txPowerDbm)
+{
+    m_tracker->StateChanged(m_nodeId,
+                            EndDeviceLoraPhy::TX,
+                            m_tracker->m_txCurrentModel->CalcTxCurrent(txPowerDbm));
+}
+
+void
+LoraFleetEnergyTracker::Listener::NotifySleep()
+{
+    m_tracker->StateChanged(m_nodeId,
+                            EndDeviceLoraPhy::SLEEP,
+                            m_tracker->m_stateCurrentA[EndDeviceLoraPhy::SLEEP]);
+}
+
+void
+LoraFleetEnergyTracker::Listener::NotifyStandby()
+{
+    m_tracker->StateChanged(m_nodeId,
+                            EndDeviceLoraPhy::STANDBY,
+                            m_tracker->m_stateCurrentA[EndDeviceLoraPhy::STANDBY]);
+}
+
+LoraFleetEnergyTracker::LoraFleetEnergyTracker()
+    : m_initialEnergyJ(10000),
+      m_voltageV(3.3),
+      m_txCurrentModel(CreateObject<ConstantLoraTxCurrentModel>()),
+      m_updateInterval(Seconds(0)),
+      m_nDepleted(0)
+{
+    NS_LOG_FUNCTION(this);
+
+    m_stateCurrentA[EndDeviceLoraPhy::SLEEP] = 0.0000015;
+    m_stateCurrentA[EndDeviceLoraPhy::STANDBY] = 0.0014;
+    m_stateCurrentA[EndDeviceLoraPhy::TX] = 0; // From the TX current model
+    m_stateCurrentA[EndDeviceLoraPhy::RX] = 0.0112;
+}
+
+LoraFleetEnergyTracker::~LoraFleetEnergyTracker()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (uint32_t i = 0; i < m_phys.size(); i++)
+    {
+        m_phys[i]->UnregisterListener(&m_listeners[i]);
+    }
+}
+
+void
+LoraFleetEnergyTracker::SetInitialEnergy(double energyJ)
+{
+    NS_ASSERT(energyJ > 0);
+    m_initialEnergyJ = energyJ;
+}
+
+void
+LoraFleetEnergyTracker::SetSupplyVoltage(double voltageV)
+{
+    NS_ASSERT(voltageV > 0);
+    m_voltageV = voltageV;
+}
+
+void
+LoraFleetEnergyTracker::SetCurrents(double rxCurrentA, double standbyCurrentA, double sleepCurrentA)
+{
+    m_stateCurrentA[EndDeviceLoraPhy::RX] = rxCurrentA;
+    m_stateCurrentA[EndDeviceLoraPhy::STANDBY] = standbyCurrentA;
+    m_stateCurrentA[EndDeviceLoraPhy::SLEEP] = sleepCurrentA;
+}
+
+void
+LoraFleetEnergyTracker::SetTxCurrentModel(Ptr<LoraTxCurrentModel> model)
+{
+    m_txCurrentModel = model;
+}
+
+void
+LoraFleetEnergyTracker::SetUpdateInterval(Time interval)
+{
+    NS_LOG_FUNCTION(this << interval);
+
+    m_updateInterval = interval;
+    Simulator::Cancel(m_updateEvent);
+    if (interval.IsStrictlyPositive())
+    {
+        m_updateEvent =
+            Simulator::Schedule(interval, &LoraFleetEnergyTracker::PeriodicUpdate, this);
+    }
+}
+
+void
+LoraFleetEnergyTracker::SetDepletionCallback(DepletionCallback callback)
+{
+    m_depletionCallback = callback;
+}
+
+void
+LoraFleetEnergyTracker::Install(NodeContainer endDevices)
+{
+    NS_LOG_FUNCTION(this);
+
+    uint32_t maxNodeId = 0;
+    for (auto node = endDevices.Begin(); node != endDevices.End(); node++)
+    {
+        maxNodeId = std::max(maxNodeId, (*node)->GetId());
+    }
+    if (maxNodeId >= m_state.size())
+    {
+        m_state.resize(maxNodeId + 1, UNTRACKED);
+        m_currentA.resize(maxNodeId + 1, 0);
+        m_lastChange.resize(maxNodeId + 1, 0);
+        m_consumedJ.resize(maxNodeId + 1, 0);
+        m_depletedAt.resize(maxNodeId + 1, std::numeric_limits<int64_t>::max());
+    }
+
+    int64_t now = Simulator::Now().GetTimeStep();
+    m_phys.reserve(m_phys.size() + endDevices.GetN());
+    for (auto node = endDevices.Begin(); node != endDevices.End(); node++)
+    {
+        uint32_t nodeId = (*node)->GetId();
+        NS_ASSERT_MSG(!IsTracked(nodeId), "Node " << nodeId << " is already tracked");
+
+        // Assumes there's only one device, like the sender applications
+        Ptr<LoraNetDevice> loraNetDevice = (*node)->GetDevice(0)->GetObject<LoraNetDevice>();
+        NS_ASSERT(loraNetDevice);
+        Ptr<EndDeviceLoraPhy> phy = loraNetDevice->GetPhy()->GetObject<EndDeviceLoraPhy>();
+        NS_ASSERT(phy);
+
+        // A device in TX keeps the TX current of the model at 0 dBm until its
+        // next state change
+        EndDeviceLoraPhy::State state = phy->GetState();
+        m_state[nodeId] = state;
+        m_currentA[nodeId] = state == EndDeviceLoraPhy::TX ? m_txCurrentModel->CalcTxCurrent(0)
+                                                           : m_stateCurrentA[state];
+        m_lastChange[nodeId] = now;
+
+        m_listeners.emplace_back(this, nodeId);
+        phy->RegisterListener(&m_listeners.back());
+        m_phys.push_back(phy);
+    }
+}
+
+double
+LoraFleetEnergyTracker::GetTotalEnergyConsumption(uint32_t nodeId) const
+{
+    NS_ASSERT(IsTracked(nodeId));
+    return std::min(m_consumedJ[nodeId] + GetPendingEnergy(nodeId), m_initialEnergyJ);
+}
+
+double
+LoraFleetEnergyTracker::GetFleetEnergyConsumption() const
+{
+    double consumedJ = 0;
+    for (uint32_t nodeId = 0; nodeId < m_state.size(); nodeId++)
+    {
+        if (IsTracked(nodeId))
+        {
+            consumedJ += GetTotalEnergyConsumption(nodeId);
+        }
+    }
+    return consumedJ;
+}
+
+double
+LoraFleetEnergyTracker::GetRemainingEnergy(uint32_t nodeId) const
+{
+    return m_initialEnergyJ - GetTotalEnergyConsumption(nodeId);
+}
+
+Time
+LoraFleetEnergyTracker::GetDepletionTime(uint32_t nodeId) const
+{
+    NS_ASSERT(IsTracked(nodeId));
+    int64_t depletedAt = m_depletedAt[nodeId];
+    return depletedAt == std::numeric_limits<int64_t>::max() ? Time::Max() : TimeStep(depletedAt);
+}
+
+uint32_t
+LoraFleetEnergyTracker::GetNDepleted() const
+{
+    return m_nDepleted;
+}
+
+void
+LoraFleetEnergyTracker::Update()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (uint32_t nodeId = 0; nodeId < m_state.size(); nodeId++)
+    {
+        if (IsTracked(nodeId))
+        {
+            Accrue(nodeId);
+        }
+    }
+}
+
+void
+LoraFleetEnergyTracker::ExportEnergy(std::ostream& os) const
+{
+    for (uint32_t nodeId = 0; nodeId < m_state.size(); nodeId++)
+    {
+        if (!IsTracked(nodeId))
+        {
+            continue;
+        }
+        double consumedJ = GetTotalEnergyConsumption(nodeId);
+        Time depletion = GetDepletionTime(nodeId);
+        os << nodeId << " " << unsigned(m_state[nodeId]) << " " << consumedJ << " "
+           << m_initialEnergyJ - consumedJ << " "
+           << (depletion == Time::Max() ? -1 : depletion.GetSeconds()) << std::endl;
+    }
+}
+
+void
+LoraFleetEnergyTracker::StateChanged(uint32_t nodeId,
+                                     EndDeviceLoraPhy::State state,
+                                     double currentA)
+{
+    NS_LOG_FUNCTION(this << nodeId << state << currentA);
+
+    Accrue(nodeId);
+    m_state[nodeId] = state;
+    m_currentA[nodeId] = currentA;
+}
+
+void
+LoraFleetEnergyTracker::Accrue(uint32_t nodeId)
+{
+    int64_t now = Simulator::Now().GetTimeStep();
+    if (m_depletedAt[nodeId] != std::numeric_limits<int64_t>::max())
+    {
+        m_lastChange[nodeId] = now;
+        return;
+    }
+
+    double consumedJ = m_consumedJ[nodeId] + GetPendingEnergy(nodeId);
+    if (consumedJ < m_initialEnergyJ)
+    {
+        m_consumedJ[nodeId] = consumedJ;
+        m_lastChange[nodeId] = now;
+        return;
+    }
+
+    // The energy ran out during the last state: find when, and stop there
+    double powerW = m_currentA[nodeId] * m_voltageV;
+    Time left = Seconds((m_initialEnergyJ - m_consumedJ[nodeId]) / powerW);
+    m_depletedAt[nodeId] = std::min(m_lastChange[nodeId] + left.GetTimeStep(), now);
+    m_consumedJ[nodeId] = m_initialEnergyJ;
+    m_lastChange[nodeId] = now;
+    m_nDepleted++;
+    NS_LOG_DEBUG("Node " << nodeId << " depleted its energy at "
+                         << TimeStep(m_depletedAt[nodeId]).As(Time::S));
+
+    if (!m_depletionCallback.IsNull())
+    {
+        m_depletionCallback(nodeId);
+    }
+}
+
+double
+LoraFleetEnergyTracker::GetPendingEnergy(uint32_t nodeId) const
+{
+    if (m_depletedAt[nodeId] != std::numeric_limits<int64_t>::max())
+    {
+        return 0;
+    }
+    int64_t elapsed = Simulator::Now().GetTimeStep() - m_lastChange[nodeId];
+    return m_currentA[nodeId] * m_voltageV * TimeStep(elapsed).GetSeconds();
+}
+
+bool
+LoraFleetEnergyTracker::IsTracked(uint32_t nodeId) const
+{
+    return nodeId < m_state.size() && m_state[nodeId] != UNTRACKED;
+}
+
+void
+LoraFleetEnergyTracker::PeriodicUpdate()
+{
+    NS_LOG_FUNCTION(this);
+
+    Update();
+    m_updateEvent =
+        Simulator::Schedule(m_updateInterval, &LoraFleetEnergyTracker::PeriodicUpdate, this);
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,262 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_FLEET_ENERGY_TRACKER_H
+#define LORA_FLEET_ENERGY_TRACKER_H
+
+#include "ns3/callback.h"
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/event-id.h"
+#include "ns3/lora-tx-current-model.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+#include <array>
+#include <deque>
+#include <ostream>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Track the energy consumption of a fleet of end devices, as a lightweight
+ * alternative to installing a LoraRadioEnergyModel and an EnergySource on
+ * each of them.
+ *
+ * The state of the devices is kept in contiguous arrays indexed by node id:
+ * the current drawn in the present PHY state, the time of the last state
+ * change, the energy consumed and the depletion time. Each device only adds a
+ * small listener to its EndDeviceLoraPhy, which updates these arrays on state
+ * changes: the energy spent in the previous state is accrued, and the current
+ * of the new state is looked up (for TX, from a LoraTxCurrentModel shared by
+ * the whole fleet).
+ *
+ * All the devices start with the same energy. The depletion of a device is
+ * detected at its first state change after it happens, or at the next
+ * periodic update if an update interval is set; the depletion time reported
+ * is the exact time the energy ran out. A depleted device stops consuming
+ * energy, and the depletion callback is invoked with its node id.
+ *
+ * The tracker registers as a listener of the PHY layers, so it must outlive
+ * the simulation.
+ */
+class LoraFleetEnergyTracker
+{
+  public:
+    /**
+     * Callback invoked when a device depletes its energy, with the id of
+     * its node.
+     */
+    typedef Callback<void, uint32_t> DepletionCallback;
+
+    LoraFleetEnergyTracker();  //!< Default constructor
+    ~LoraFleetEnergyTracker(); //!< Destructor
+
+    LoraFleetEnergyTracker(const LoraFleetEnergyTracker&) = delete;            //!< Not copyable
+    LoraFleetEnergyTracker& operator=(const LoraFleetEnergyTracker&) = delete; //!< Not copyable
+
+    /**
+     * Set the initial energy of the devices. Defaults to 10000 J.
+     *
+     * \param energyJ The initial energy [J].
+     */
+    void SetInitialEnergy(double energyJ);
+
+    /**
+     * Set the supply voltage of the devices. Defaults to 3.3 V.
+     *
+     * \param voltageV The supply voltage [V].
+     */
+    void SetSupplyVoltage(double voltageV);
+
+    /**
+     * Set the currents drawn in the states other than TX. The defaults are
+     * those of the LoraRadioEnergyModel.
+     *
+     * \param rxCurrentA The RX current [A].
+     * \param standbyCurrentA The STANDBY current [A].
+     * \param sleepCurrentA The SLEEP current [A].
+     */
+    void SetCurrents(double rxCurrentA, double standbyCurrentA, double sleepCurrentA);
+
+    /**
+     * Set the model of the current drawn in TX, shared by all the devices.
+     * Defaults to a ConstantLoraTxCurrentModel with its default attributes.
+     *
+     * \param model The TX current model.
+     */
+    void SetTxCurrentModel(Ptr<LoraTxCurrentModel> model);
+
+    /**
+     * Set the interval of the periodic depletion checks of the whole fleet.
+     * Defaults to zero, i.e., depletion is only checked on state changes.
+     *
+     * \param interval The interval.
+     */
+    void SetUpdateInterval(Time interval);
+
+    /**
+     * Set the callback invoked when a device depletes its energy.
+     *
+     * \param callback The callback.
+     */
+    void SetDepletionCallback(DepletionCallback callback);
+
+    /**
+     * Track the end devices.
+     *
+     * \param endDevices The end device nodes, each with a LoraNetDevice as its
+     * first device.
+     */
+    void Install(NodeContainer endDevices);
+
+    /**
+     * Get the energy consumed by a device so far.
+     *
+     * \param nodeId The id of the node of the device.
+     * \return The energy consumed [J].
+     */
+    double GetTotalEnergyConsumption(uint32_t nodeId) const;
+
+    /**
+     * Get the energy consumed by all the devices so far.
+     *
+     * \return The energy consumed [J].
+     */
+    double GetFleetEnergyConsumption() const;
+
+    /**
+     * Get the energy left to a device.
+     *
+     * \param nodeId The id of the node of the device.
+     * \return The remaining energy [J].
+     */
+    double GetRemainingEnergy(uint32_t nodeId) const;
+
+    /**
+     * Get the time a device depleted its energy.
+     *
+     * \param nodeId The id of the node of the device.
+     * \return The depletion time, or Time::Max() if the depletion of the
+     * device has not been detected yet.
+     */
+    Time GetDepletionTime(uint32_t nodeId) const;
+
+    /**
+     * Get the number of devices whose depletion has been detected.
+     *
+     * \return The number of depleted devices.
+     */
+    uint32_t GetNDepleted() const;
+
+    /**
+     * Bring the consumption of all the devices up to date, and check their
+     * depletion.
+     */
+    void Update();
+
+    /**
+     * Print one line per device: the node id, the PHY state, the energy
+     * consumed [J], the remaining energy [J] and the depletion time [s] (-1
+     * if the device is not depleted).
+     *
+     * \param os The output stream.
+     */
+    void ExportEnergy(std::ostream& os) const;
+
+  private:
+    /**
+     * The listener of the PHY layer of a device.
+     */
+    class Listener : public EndDeviceLoraPhyListener
+    {
+      public:
+        /**
+         * Constructor.
+         *
+         * \param tracker The tracker.
+         * \param nodeId The id of the node of the device.
+         */
+        Listener(LoraFleetEnergyTracker* tracker, uint32_t nodeId);
+
+        void NotifyRxStart() override;
+        void NotifyTxStart(double txPowerDbm) override;
+        void NotifySleep() override;
+        void NotifyStandby() override;
+
+      private:
+        LoraFleetEnergyTracker* m_tracker; //!< The tracker
+        uint32_t m_nodeId;                 //!< The id of the node of the device
+    };
+
+    /**
+     * Record a state change of a device.
+     *
+     * \param nodeId The id of the node of the device.
+     * \param state The new state.
+     * \param currentA The current drawn in the new state [A].
+     */
+    void StateChanged(uint32_t nodeId, EndDeviceLoraPhy::State state, double currentA);
+
+    /**
+     * Add the energy spent by a device since its last state change, and
+     * check its depletion.
+     *
+     * \param nodeId The id of the node of the device.
+     */
+    void Accrue(uint32_t nodeId);
+
+    /**
+     * Get the energy spent by a device since its last state change.
+     *
+     * \param nodeId The id of the node of the device.
+     * \return The energy [J].
+     */
+    double GetPendingEnergy(uint32_t nodeId) const;
+
+    /**
+     * Check whether a device is tracked.
+     *
+     * \param nodeId The id of the node.
+     * \return True if the device is tracked.
+     */
+    bool IsTracked(uint32_t nodeId) const;
+
+    /**
+     * Update the fleet and schedule the next periodic update.
+     */
+    void PeriodicUpdate();
+
+    /// The state value of the node ids that are not tracked
+    static constexpr uint8_t UNTRACKED = 0xff;
+
+    double m_initialEnergyJ;                  //!< The initial energy [J]
+    double m_voltageV;                        //!< The supply voltage [V]
+    std::array<double, 4> m_stateCurrentA;    //!< The current of each state but TX [A]
+    Ptr<LoraTxCurrentModel> m_txCurrentModel; //!< The TX current model
+    Time m_updateInterval;                    //!< The interval of the periodic updates
+    EventId m_updateEvent;                    //!< The next periodic update
+    DepletionCallback m_depletionCallback;    //!< The depletion callback
+
+    // The state of the devices, indexed by node id
+    std::vector<uint8_t> m_state;      //!< The PHY state, or UNTRACKED
+    std::vector<double> m_currentA;    //!< The current drawn in the PHY state [A]
+    std::vector<int64_t> m_lastChange; //!< The time of the last state change [time steps]
+    std::vector<double> m_consumedJ;   //!< The energy consumed up to the last change [J]
+    std::vector<int64_t> m_depletedAt; //!< The depletion time [time steps], or INT64_MAX
+    uint32_t m_nDepleted;              //!< The number of depleted devices
+
+    std::vector<Ptr<EndDeviceLoraPhy>> m_phys; //!< The PHY layers of the devices
+    std::deque<Listener> m_listeners;          //!< The listeners, in the order of m_phys
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_FLEET_ENERGY_TRACKER_H */
@@ -81,6 +81,9 @@ LoraHelper::Install(const LoraPhyHelper& phyHelper,
                 phy->TraceConnectWithoutContext(
                     "NoReceptionBecauseTransmitting",
                     MakeCallback(&LoraPacketTracker::LostBecauseTxCallback, m_packetTracker));
+                phy->TraceConnectWithoutContext(
+                    "HypothesisOutcome",
+                    MakeCallback(&LoraPacketTracker::HypothesisOutcomeCallback, m_packetTracker));
             }
         }
 
@@ -0,0 +1,322 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-lifetime-projector.h"
+
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/log.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraLifetimeProjector");
+
+LoraLifetimeProjector::Listener::Listener(LoraLifetimeProjector* projector, uint32_t device)
+    : m_projector(projector),
+      m_device(device)
+{
+}
+
+void
+LoraLifetimeProjector::Listener::NotifyRxStart()
+{
+    m_projector->StateChanged(m_device, EndDeviceLoraPhy::RX, 0);
+}
+
+void
+LoraLifetimeProjector::Listener::NotifyTxStart(double txPowerDbm)
+{
+    m_projector->StateChanged(m_device, EndDeviceLoraPhy::TX, txPowerDbm);
+}
+
+void
+LoraLifetimeProjector::Listener::NotifySleep()
+{
+    m_projector->StateChanged(m_device, EndDeviceLoraPhy::SLEEP, 0);
+}
+
+void
+LoraLifetimeProjector::Listener::NotifyStandby()
+{
+    m_projector->StateChanged(m_device, EndDeviceLoraPhy::STANDBY, 0);
+}
+
+void
+LoraLifetimeProjector::Listener::RequiredTransmissions(uint8_t nTransmissions,
+                                                       uint8_t sf,
+                                                       bool success,
+                                                       Time firstAttempt,
+                                                       Ptr<Packet> packet)
+{
+    m_projector->RequiredTransmissions(m_device, nTransmissions, sf, success, firstAttempt, packet);
+}
+
+LoraLifetimeProjector::LoraLifetimeProjector()
+    : m_txCurrentModel(CreateObject<LinearLoraTxCurrentModel>()),
+      m_rxCurrentA(0.0112),
+      m_standbyCurrentA(0.0014),
+      m_sleepCurrentA(0.0000015),
+      m_capacityC(2400 * 3.6),
+      m_windowStart(Seconds(0)),
+      m_windowStop(Time::Max())
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LoraLifetimeProjector::~LoraLifetimeProjector()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto& device : m_devices)
+    {
+        device.phy->UnregisterListener(device.listener.get());
+    }
+}
+
+void
+LoraLifetimeProjector::SetTxCurrentModel(Ptr<LoraTxCurrentModel> model)
+{
+    m_txCurrentModel = model;
+}
+
+void
+LoraLifetimeProjector::SetCurrents(double rxCurrentA, double standbyCurrentA, double sleepCurrentA)
+{
+    m_rxCurrentA = rxCurrentA;
+    m_standbyCurrentA = standbyCurrentA;
+    m_sleepCurrentA = sleepCurrentA;
+}
+
+void
+LoraLifetimeProjector::SetBatteryCapacity(double capacityMah)
+{
+    NS_ASSERT(capacityMah > 0);
+    m_capacityC = capacityMah * 3.6;
+}
+
+void
+LoraLifetimeProjector::Install(NodeContainer endDevices)
+{
+    NS_LOG_FUNCTION(this);
+
+    m_devices.reserve(m_devices.size() + endDevices.GetN());
+    for (auto node = endDevices.Begin(); node != endDevices.End(); node++)
+    {
+        // Assumes there's only one device, like the sender applications
+        Ptr<LoraNetDevice> loraNetDevice = (*node)->GetDevice(0)->GetObject<LoraNetDevice>();
+        NS_ASSERT(loraNetDevice);
+        Ptr<EndDeviceLoraPhy> phy = loraNetDevice->GetPhy()->GetObject<EndDeviceLoraPhy>();
+        NS_ASSERT(phy);
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        NS_ASSERT(mac);
+
+        // The listener is allocated separately, so that its address does not
+        // change when the vector of devices grows
+        uint32_t index = m_devices.size();
+        Device device;
+        device.nodeId = (*node)->GetId();
+        device.phy = phy;
+        device.listener = std::make_unique<Listener>(this, index);
+        device.state = phy->GetState();
+        device.txPowerDbm = 0;
+        device.lastChange = Simulator::Now();
+        device.stateDuration.fill(Seconds(0));
+        device.nTransmissions = 0;
+        device.nPackets = 0;
+        device.nPacketTransmissions = 0;
+
+        phy->RegisterListener(device.listener.get());
+        mac->TraceConnectWithoutContext(
+            "RequiredTransmissions",
+            MakeCallback(&LoraLifetimeProjector::Listener::RequiredTransmissions,
+                         device.listener.get()));
+        m_devices.push_back(std::move(device));
+    }
+}
+
+void
+LoraLifetimeProjector::SetWindow(Time start, Time stop)
+{
+    NS_LOG_FUNCTION(this << start << stop);
+    NS_ASSERT(start < stop);
+
+    // Close the previous window of the devices at the old boundaries
+    for (auto& device : m_devices)
+    {
+        Accrue(device);
+    }
+    m_windowStart = Simulator::Now() + start;
+    m_windowStop = Simulator::Now() + stop;
+}
+
+std::vector<LoraLifetimeProjector::Projection>
+LoraLifetimeProjector::Project() const
+{
+    NS_LOG_FUNCTION(this);
+
+    std::vector<Projection> projections;
+    projections.reserve(m_devices.size());
+    for (const auto& device : m_devices)
+    {
+        // Add the time spent in the current state, which is not accrued yet
+        std::array<Time, 4> stateDuration = device.stateDuration;
+        std::map<double, Time> txDuration = device.txDuration;
+        Time pending = GetOverlap(device.lastChange, Simulator::Now());
+        stateDuration[device.state] += pending;
+        if (device.state == EndDeviceLoraPhy::TX)
+        {
+            txDuration[device.txPowerDbm] += pending;
+        }
+
+        Projection p;
+        p.nodeId = device.nodeId;
+        p.nTransmissions = device.nTransmissions;
+        p.nPackets = device.nPackets;
+        p.transmissionsPerPacket =
+            device.nPackets > 0 ? double(device.nPacketTransmissions) / device.nPackets : 0;
+
+        double windowS = 0;
+        for (const auto& duration : stateDuration)
+        {
+            windowS += duration.GetSeconds();
+        }
+        if (windowS <= 0)
+        {
+            p.txFraction = p.rxFraction = p.standbyFraction = p.sleepFraction = 0;
+            p.averageCurrentA = 0;
+            p.lifetimeS = std::numeric_limits<double>::infinity();
+            projections.push_back(p);
+            continue;
+        }
+
+        p.txFraction = stateDuration[EndDeviceLoraPhy::TX].GetSeconds() / windowS;
+        p.rxFraction = stateDuration[EndDeviceLoraPhy::RX].GetSeconds() / windowS;
+        p.standbyFraction = stateDuration[EndDeviceLoraPhy::STANDBY].GetSeconds() / windowS;
+        p.sleepFraction = stateDuration[EndDeviceLoraPhy::SLEEP].GetSeconds() / windowS;
+
+        // The TX current is evaluated once per power level used in the window
+        double txChargeC = 0;
+        for (const auto& [txPowerDbm, duration] : txDuration)
+        {
+            txChargeC += m_txCurrentModel->CalcTxCurrent(txPowerDbm) * duration.GetSeconds();
+        }
+        p.averageCurrentA = txChargeC / windowS + p.rxFraction * m_rxCurrentA +
+                            p.standbyFraction * m_standbyCurrentA +
+                            p.sleepFraction * m_sleepCurrentA;
+        p.lifetimeS = p.averageCurrentA > 0 ? m_capacityC / p.averageCurrentA
+                                            : std::numeric_limits<double>::infinity();
+        projections.push_back(p);
+    }
+    return projections;
+}
+
+double
+LoraLifetimeProjector::GetLifetimeQuantile(double q) const
+{
+    NS_LOG_FUNCTION(this << q);
+    NS_ASSERT(q >= 0 && q <= 1);
+
+    std::vector<Projection> projections = Project();
+    if (projections.empty())
+    {
+        return 0;
+    }
+    std::vector<double> lifetimes;
+    lifetimes.reserve(projections.size());
+    for (const auto& p : projections)
+    {
+        lifetimes.push_back(p.lifetimeS);
+    }
+    auto nth = lifetimes.begin() + std::lround(q * (lifetimes.size() - 1));
+    std::nth_element(lifetimes.begin(), nth, lifetimes.end());
+    return *nth;
+}
+
+void
+LoraLifetimeProjector::PrintProjections(std::ostream& os) const
+{
+    const double secondsPerYear = 365.25 * 24 * 3600;
+    for (const auto& p : Project())
+    {
+        os << p.nodeId << " " << p.txFraction << " " << p.rxFraction << " " << p.standbyFraction
+           << " " << p.sleepFraction << " " << p.nTransmissions << " " << p.nPackets << " "
+           << p.transmissionsPerPacket << " " << p.averageCurrentA << " "
+           << p.lifetimeS / secondsPerYear << std::endl;
+    }
+}
+
+void
+LoraLifetimeProjector::StateChanged(uint32_t device,
+                                    EndDeviceLoraPhy::State state,
+                                    double txPowerDbm)
+{
+    NS_LOG_FUNCTION(this << device << state << txPowerDbm);
+
+    Device& d = m_devices[device];
+    Accrue(d);
+    d.state = state;
+    d.txPowerDbm = txPowerDbm;
+    if (state == EndDeviceLoraPhy::TX && IsInWindow())
+    {
+        d.nTransmissions++;
+    }
+}
+
+void
+LoraLifetimeProjector::Accrue(Device& device)
+{
+    Time now = Simulator::Now();
+    Time duration = GetOverlap(device.lastChange, now);
+    device.stateDuration[device.state] += duration;
+    if (device.state == EndDeviceLoraPhy::TX && duration.IsStrictlyPositive())
+    {
+        device.txDuration[device.txPowerDbm] += duration;
+    }
+    device.lastChange = now;
+}
+
+Time
+LoraLifetimeProjector::GetOverlap(Time from, Time to) const
+{
+    Time start = Max(from, m_windowStart);
+    Time stop = Min(to, m_windowStop);
+    return stop > start ? stop - start : Seconds(0);
+}
+
+void
+LoraLifetimeProjector::RequiredTransmissions(uint32_t device,
+                                             uint8_t nTransmissions,
+                                             uint8_t sf,
+                                             bool success,
+                                             Time firstAttempt,
+                                             Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << device << unsigned(nTransmissions) << success);
+
+    if (!IsInWindow())
+    {
+        return;
+    }
+    Device& d = m_devices[device];
+    d.nPackets++;
+    d.nPacketTransmissions += nTransmissions;
+}
+
+bool
+LoraLifetimeProjector::IsInWindow() const
+{
+    Time now = Simulator::Now();
+    return now >= m_windowStart && now < m_windowStop;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,259 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_LIFETIME_PROJECTOR_H
+#define LORA_LIFETIME_PROJECTOR_H
+
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/lora-tx-current-model.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Project the battery lifetime of end devices from a short simulation.
+ *
+ * During an observation window, which should cover the steady state of the
+ * traffic, the projector records the time each device spends in each state of
+ * its EndDeviceLoraPhy, with the time spent transmitting split by transmission
+ * power, and the transmissions required by its confirmed packets. The average
+ * current of a device over the window is obtained from the RX, standby and
+ * sleep currents and from a LoraTxCurrentModel, and the lifetime is the time
+ * it takes to draw the battery capacity at that current.
+ *
+ * The projection assumes that the window is representative of the whole
+ * lifetime of the device: a window of some traffic periods is enough to
+ * project a lifetime of years, without simulating it or installing an energy
+ * model on the devices.
+ *
+ * The projector registers as a listener of the PHY layers and connects to the
+ * trace sources of the MAC layers, so it must outlive the simulation.
+ */
+class LoraLifetimeProjector
+{
+  public:
+    /**
+     * The projection of a device.
+     */
+    struct Projection
+    {
+        uint32_t nodeId;               //!< The id of the node of the device
+        double txFraction;             //!< The fraction of the window spent in TX
+        double rxFraction;             //!< The fraction of the window spent in RX
+        double standbyFraction;        //!< The fraction of the window spent in STANDBY
+        double sleepFraction;          //!< The fraction of the window spent in SLEEP
+        uint32_t nTransmissions;       //!< The number of transmissions in the window
+        uint32_t nPackets;             //!< The number of confirmed packets completed
+        double transmissionsPerPacket; //!< The mean transmissions per confirmed packet
+        double averageCurrentA;        //!< The average current [A]
+        double lifetimeS;              //!< The projected lifetime [s]
+    };
+
+    LoraLifetimeProjector();  //!< Default constructor
+    ~LoraLifetimeProjector(); //!< Destructor
+
+    LoraLifetimeProjector(const LoraLifetimeProjector&) = delete;            //!< Not copyable
+    LoraLifetimeProjector& operator=(const LoraLifetimeProjector&) = delete; //!< Not copyable
+
+    /**
+     * Set the model of the current drawn in TX. Defaults to a
+     * LinearLoraTxCurrentModel with its default attributes.
+     *
+     * \param model The TX current model.
+     */
+    void SetTxCurrentModel(Ptr<LoraTxCurrentModel> model);
+
+    /**
+     * Set the currents drawn in the other states. The defaults are those of
+     * the LoraRadioEnergyModel.
+     *
+     * \param rxCurrentA The RX current [A].
+     * \param standbyCurrentA The STANDBY current [A].
+     * \param sleepCurrentA The SLEEP current [A].
+     */
+    void SetCurrents(double rxCurrentA, double standbyCurrentA, double sleepCurrentA);
+
+    /**
+     * Set the capacity of the battery of the devices.
+     *
+     * \param capacityMah The capacity [mAh]. Defaults to 2400 mAh.
+     */
+    void SetBatteryCapacity(double capacityMah);
+
+    /**
+     * Track the end devices.
+     *
+     * \param endDevices The end device nodes, each with a LoraNetDevice as its
+     * first device.
+     */
+    void Install(NodeContainer endDevices);
+
+    /**
+     * Set the observation window. Defaults to the whole simulation.
+     *
+     * \param start The start of the window, as a delay from now.
+     * \param stop The end of the window, as a delay from now.
+     */
+    void SetWindow(Time start, Time stop);
+
+    /**
+     * Project the lifetime of every device, from the window observed so far.
+     *
+     * \return The projections, in the order the devices were installed.
+     */
+    std::vector<Projection> Project() const;
+
+    /**
+     * Get a quantile of the projected lifetimes of the fleet.
+     *
+     * \param q The quantile, between 0 and 1.
+     * \return The lifetime [s].
+     */
+    double GetLifetimeQuantile(double q) const;
+
+    /**
+     * Print one line per device: the node id, the fractions of time in TX, RX,
+     * STANDBY and SLEEP, the number of transmissions and of confirmed packets,
+     * the transmissions per packet, the average current [A] and the projected
+     * lifetime [years].
+     *
+     * \param os The output stream.
+     */
+    void PrintProjections(std::ostream& os) const;
+
+  private:
+    /**
+     * The listener of the PHY layer of a device.
+     */
+    class Listener : public EndDeviceLoraPhyListener
+    {
+      public:
+        /**
+         * Constructor.
+         *
+         * \param projector The projector.
+         * \param device The index of the device.
+         */
+        Listener(LoraLifetimeProjector* projector, uint32_t device);
+
+        void NotifyRxStart() override;
+        void NotifyTxStart(double txPowerDbm) override;
+        void NotifySleep() override;
+        void NotifyStandby() override;
+
+        /**
+         * Forward the RequiredTransmissions trace of the MAC layer.
+         *
+         * \param nTransmissions The number of transmissions.
+         * \param sf The spreading factor.
+         * \param success Whether the packet was acknowledged.
+         * \param firstAttempt The time of the first transmission.
+         * \param packet The packet.
+         */
+        void RequiredTransmissions(uint8_t nTransmissions,
+                                   uint8_t sf,
+                                   bool success,
+                                   Time firstAttempt,
+                                   Ptr<Packet> packet);
+
+      private:
+        LoraLifetimeProjector* m_projector; //!< The projector
+        uint32_t m_device;                  //!< The index of the device
+    };
+
+    /**
+     * The observations of a device.
+     */
+    struct Device
+    {
+        uint32_t nodeId;                    //!< The id of the node
+        Ptr<EndDeviceLoraPhy> phy;          //!< The PHY layer
+        std::unique_ptr<Listener> listener; //!< The listener of the PHY and MAC layers
+        EndDeviceLoraPhy::State state;      //!< The current state
+        double txPowerDbm;                  //!< The power of the current TX
+        Time lastChange;                    //!< The time of the last state change
+        std::array<Time, 4> stateDuration;  //!< The time in each state, by state value
+        std::map<double, Time> txDuration;  //!< The time in TX, by power [dBm]
+        uint32_t nTransmissions;            //!< The number of TX starts
+        uint32_t nPackets;                  //!< The number of confirmed packets
+        uint32_t nPacketTransmissions;      //!< The transmissions of these packets
+    };
+
+    /**
+     * Record a state change of a device.
+     *
+     * \param device The index of the device.
+     * \param state The new state.
+     * \param txPowerDbm The transmission power, if the new state is TX.
+     */
+    void StateChanged(uint32_t device, EndDeviceLoraPhy::State state, double txPowerDbm);
+
+    /**
+     * Add the time spent by a device in its current state, within the window.
+     *
+     * \param device The device.
+     */
+    void Accrue(Device& device);
+
+    /**
+     * Get the part of an interval within the window.
+     *
+     * \param from The start of the interval.
+     * \param to The end of the interval.
+     * \return The duration of the intersection of the interval and the window.
+     */
+    Time GetOverlap(Time from, Time to) const;
+
+    /**
+     * Record the transmissions required by a confirmed packet.
+     *
+     * \param device The index of the device.
+     * \param nTransmissions The number of transmissions.
+     * \param sf The spreading factor.
+     * \param success Whether the packet was acknowledged.
+     * \param firstAttempt The time of the first transmission.
+     * \param packet The packet.
+     */
+    void RequiredTransmissions(uint32_t device,
+                               uint8_t nTransmissions,
+                               uint8_t sf,
+                               bool success,
+                               Time firstAttempt,
+                               Ptr<Packet> packet);
+
+    /**
+     * Check whether the window is open.
+     *
+     * \return True if the window is open now.
+     */
+    bool IsInWindow() const;
+
+    Ptr<LoraTxCurrentModel> m_txCurrentModel; //!< The TX current model
+    double m_rxCurrentA;                      //!< The RX current [A]
+    double m_standbyCurrentA;                 //!< The STANDBY current [A]
+    double m_sleepCurrentA;                   //!< The SLEEP current [A]
+    double m_capacityC;                       //!< The battery capacity [C]
+    Time m_windowStart;                       //!< The start of the window
+    Time m_windowStop;                        //!< The end of the window
+
+    std::vector<Device> m_devices; //!< The devices
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_LIFETIME_PROJECTOR_H */
@@ -0,0 +1,225 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-memory-census.h"
+
+#include "ns3/end-device-status.h"
+#include "ns3/log.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/network-status.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraMemoryCensus");
+
+// Approximate overheads of the nodes of the standard containers, on top of
+// the values they hold: a std::map node has three pointers and a color, a
+// std::list node two pointers, and a std::unordered_map node a pointer and
+// the hash
+static const uint64_t MAP_NODE_BYTES = 4 * sizeof(void*);  //!< Overhead of a std::map node
+static const uint64_t LIST_NODE_BYTES = 2 * sizeof(void*); //!< Overhead of a std::list node
+static const uint64_t HASH_NODE_BYTES = 2 * sizeof(void*); //!< Overhead of a hash map node
+
+uint64_t
+LoraMemoryCensus::Census::GetTotalBytes() const
+{
+    return interferenceBytes + chaseCombiningBytes + trackerBytes + receivedPacketBytes +
+           shadowingBytes;
+}
+
+LoraMemoryCensus::LoraMemoryCensus()
+    : m_tracker(nullptr),
+      m_printed(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LoraMemoryCensus::~LoraMemoryCensus()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+LoraMemoryCensus::AddPhys(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto node = nodes.Begin(); node != nodes.End(); node++)
+    {
+        Ptr<LoraNetDevice> loraNetDevice = (*node)->GetDevice(0)->GetObject<LoraNetDevice>();
+        NS_ASSERT(loraNetDevice);
+        m_phys.push_back(loraNetDevice->GetPhy());
+        m_phyNodeIds.push_back((*node)->GetId());
+    }
+}
+
+void
+LoraMemoryCensus::SetPacketTracker(const LoraPacketTracker& tracker)
+{
+    m_tracker = &tracker;
+}
+
+void
+LoraMemoryCensus::SetNetworkServer(Ptr<Node> networkServer)
+{
+    NS_LOG_FUNCTION(this << networkServer);
+
+    m_networkServer = nullptr;
+    for (uint32_t i = 0; i < networkServer->GetNApplications(); i++)
+    {
+        m_networkServer = DynamicCast<NetworkServer>(networkServer->GetApplication(i));
+        if (m_networkServer)
+        {
+            break;
+        }
+    }
+    NS_ASSERT_MSG(m_networkServer, "The node has no NetworkServer application");
+}
+
+void
+LoraMemoryCensus::AddShadowingModel(Ptr<CorrelatedShadowingPropagationLossModel> model)
+{
+    m_shadowing.push_back(model);
+}
+
+LoraMemoryCensus::Census
+LoraMemoryCensus::TakeCensus() const
+{
+    NS_LOG_FUNCTION(this);
+
+    Census census;
+    census.time = Simulator::Now();
+
+    uint64_t chaseCombiningDevices = 0;
+    for (const auto& phy : m_phys)
+    {
+        const LoraInterferenceHelper& interference = phy->GetInterferenceHelper();
+        uint32_t nEvents = interference.GetNEvents();
+        census.interferenceEvents += nEvents;
+        census.maxPhyEvents = std::max(census.maxPhyEvents, nEvents);
+        census.chaseCombiningValues += interference.GetNChaseCombiningValues();
+        chaseCombiningDevices += interference.GetNChaseCombiningDevices();
+    }
+    census.interferenceBytes =
+        census.interferenceEvents * (LIST_NODE_BYTES + sizeof(Ptr<LoraInterferenceHelper::Event>) +
+                                     sizeof(LoraInterferenceHelper::Event));
+    census.chaseCombiningBytes =
+        census.chaseCombiningValues * sizeof(double) +
+        chaseCombiningDevices *
+            (HASH_NODE_BYTES + sizeof(std::pair<uint16_t, std::vector<std::vector<double>>>));
+
+    if (m_tracker)
+    {
+        uint64_t nReceptions = m_tracker->GetNReceptions();
+        census.trackerEntries = m_tracker->GetNPhyPackets() + m_tracker->GetNMacPackets() +
+                                m_tracker->GetNRetransmissions() + nReceptions;
+        census.trackerBytes =
+            m_tracker->GetNPhyPackets() * (MAP_NODE_BYTES + sizeof(PhyPacketData::value_type)) +
+            m_tracker->GetNMacPackets() * (MAP_NODE_BYTES + sizeof(MacPacketData::value_type)) +
+            m_tracker->GetNRetransmissions() *
+                (MAP_NODE_BYTES + sizeof(RetransmissionData::value_type)) +
+            nReceptions * (MAP_NODE_BYTES + sizeof(std::pair<int, Time>));
+    }
+
+    if (m_networkServer)
+    {
+        uint64_t nReceptions = 0;
+        Ptr<NetworkStatus> networkStatus = m_networkServer->GetNetworkStatus();
+        for (const auto& [address, status] : networkStatus->m_endDeviceStatuses)
+        {
+            census.receivedPackets += status->GetNReceivedPackets();
+            nReceptions += status->GetNReceptions();
+        }
+        census.receivedPacketBytes =
+            census.receivedPackets *
+                (LIST_NODE_BYTES + sizeof(EndDeviceStatus::ReceivedPacketList::value_type)) +
+            nReceptions * (MAP_NODE_BYTES + sizeof(EndDeviceStatus::GatewayList::value_type));
+    }
+
+    uint64_t nShadowingMaps = 0;
+    for (const auto& model : m_shadowing)
+    {
+        census.shadowingValues += model->GetNShadowingValues();
+        nShadowingMaps += model->GetNShadowingMaps();
+    }
+    census.shadowingBytes =
+        census.shadowingValues *
+            (MAP_NODE_BYTES +
+             sizeof(std::pair<CorrelatedShadowingPropagationLossModel::Position, double>)) +
+        nShadowingMaps *
+            (MAP_NODE_BYTES +
+             sizeof(std::pair<std::pair<int, int>,
+                              Ptr<CorrelatedShadowingPropagationLossModel::ShadowingMap>>) +
+             sizeof(CorrelatedShadowingPropagationLossModel::ShadowingMap));
+
+    return census;
+}
+
+void
+LoraMemoryCensus::PrintCensus(std::ostream& os) const
+{
+    Census census = TakeCensus();
+    os << census.time.GetSeconds() << " " << census.interferenceEvents << " "
+       << census.interferenceBytes << " " << census.maxPhyEvents << " "
+       << census.chaseCombiningValues << " " << census.chaseCombiningBytes << " "
+       << census.trackerEntries << " " << census.trackerBytes << " " << census.receivedPackets
+       << " " << census.receivedPacketBytes << " " << census.shadowingValues << " "
+       << census.shadowingBytes << " " << census.GetTotalBytes() << std::endl;
+}
+
+void
+LoraMemoryCensus::PrintPhyCensus(std::ostream& os) const
+{
+    for (uint32_t i = 0; i < m_phys.size(); i++)
+    {
+        const LoraInterferenceHelper& interference = m_phys[i]->GetInterferenceHelper();
+        uint32_t nEvents = interference.GetNEvents();
+        os << m_phyNodeIds[i] << " " << nEvents << " "
+           << nEvents * (LIST_NODE_BYTES + sizeof(Ptr<LoraInterferenceHelper::Event>) +
+                         sizeof(LoraInterferenceHelper::Event))
+           << " " << interference.GetNChaseCombiningValues() << std::endl;
+    }
+}
+
+void
+LoraMemoryCensus::EnablePeriodicPrinting(std::string filename, Time interval)
+{
+    NS_LOG_FUNCTION(this << filename << interval);
+
+    m_printed = false;
+    Simulator::ScheduleNow(&LoraMemoryCensus::DoPrintCensus, this, filename, interval);
+}
+
+void
+LoraMemoryCensus::DoPrintCensus(std::string filename, Time interval)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ofstream outputFile;
+    if (!m_printed)
+    {
+        // Delete contents of the file as it is opened
+        outputFile.open(filename, std::ofstream::out | std::ofstream::trunc);
+        m_printed = true;
+    }
+    else
+    {
+        // Only append to the file
+        outputFile.open(filename, std::ofstream::out | std::ofstream::app);
+    }
+    PrintCensus(outputFile);
+    outputFile.close();
+
+    Simulator::Schedule(interval, &LoraMemoryCensus::DoPrintCensus, this, filename, interval);
+}
+
+} // namespace lorawan
+} // namespace ns3
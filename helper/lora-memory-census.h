@@ -0,0 +1,164 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_MEMORY_CENSUS_H
+#define LORA_MEMORY_CENSUS_H
+
+#include "ns3/correlated-shadowing-propagation-loss-model.h"
+#include "ns3/lora-packet-tracker.h"
+#include "ns3/lora-phy.h"
+#include "ns3/network-server.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Take a census of the memory held by the state of the module that grows
+ * with the simulated network and time: the events of the
+ * LoraInterferenceHelper of each PHY, the chase combining state of the
+ * gateways, the entries of the LoraPacketTracker, the received packet lists
+ * of the EndDeviceStatus objects of the network server, and the values of
+ * CorrelatedShadowingPropagationLossModel maps.
+ *
+ * Each census counts the live entries of each subsystem, and approximates
+ * their bytes from the size of the entries and the overhead of the nodes of
+ * the containers holding them. The packets themselves, which are shared
+ * among subsystems, are not counted. The census can be printed periodically
+ * as a time series, to find which subsystem grows in a scenario.
+ *
+ * The census holds pointers to the objects it inspects, so it must outlive
+ * the simulation when the printing is periodic.
+ */
+class LoraMemoryCensus
+{
+  public:
+    /**
+     * The counts and approximate bytes of the subsystems at a time.
+     */
+    struct Census
+    {
+        Time time;                         //!< The time of the census
+        uint64_t interferenceEvents = 0;   //!< The events of all the PHYs
+        uint64_t interferenceBytes = 0;    //!< The bytes of the events
+        uint32_t maxPhyEvents = 0;         //!< The events of the PHY with the most
+        uint64_t chaseCombiningValues = 0; //!< The chase combining SNIR values
+        uint64_t chaseCombiningBytes = 0;  //!< The bytes of the chase combining state
+        uint64_t trackerEntries = 0;       //!< The packets and receptions tracked
+        uint64_t trackerBytes = 0;         //!< The bytes of the tracker entries
+        uint64_t receivedPackets = 0;      //!< The packets of the received packet lists
+        uint64_t receivedPacketBytes = 0;  //!< The bytes of the received packet lists
+        uint64_t shadowingValues = 0;      //!< The values of the shadowing maps
+        uint64_t shadowingBytes = 0;       //!< The bytes of the shadowing maps
+
+        /**
+         * Get the bytes of all the subsystems.
+         *
+         * \return The bytes.
+         */
+        uint64_t GetTotalBytes() const;
+    };
+
+    LoraMemoryCensus();  //!< Default constructor
+    ~LoraMemoryCensus(); //!< Destructor
+
+    LoraMemoryCensus(const LoraMemoryCensus&) = delete;            //!< Not copyable
+    LoraMemoryCensus& operator=(const LoraMemoryCensus&) = delete; //!< Not copyable
+
+    /**
+     * Count the interference events and the chase combining state of the PHY
+     * layers of some nodes.
+     *
+     * \param nodes The nodes, end devices or gateways, each with a
+     * LoraNetDevice as its first device.
+     */
+    void AddPhys(NodeContainer nodes);
+
+    /**
+     * Count the entries of a packet tracker.
+     *
+     * \param tracker The packet tracker, e.g., that of the LoraHelper.
+     */
+    void SetPacketTracker(const LoraPacketTracker& tracker);
+
+    /**
+     * Count the received packet lists of the end devices of a network server.
+     *
+     * \param networkServer The node with the NetworkServer application.
+     */
+    void SetNetworkServer(Ptr<Node> networkServer);
+
+    /**
+     * Count the values of a correlated shadowing model.
+     *
+     * \param model The shadowing model.
+     */
+    void AddShadowingModel(Ptr<CorrelatedShadowingPropagationLossModel> model);
+
+    /**
+     * Take a census of the subsystems now.
+     *
+     * \return The census.
+     */
+    Census TakeCensus() const;
+
+    /**
+     * Take a census now and print it as a line of the time series: the time
+     * [s], then the count and bytes of the interference events, the events of
+     * the PHY with the most, and the count and bytes of the chase combining
+     * state, the tracker, the received packet lists and the shadowing maps,
+     * and finally the total bytes.
+     *
+     * \param os The output stream.
+     */
+    void PrintCensus(std::ostream& os) const;
+
+    /**
+     * Print one line per PHY: the node id, the number of interference events
+     * and their bytes, and the number of chase combining values.
+     *
+     * \param os The output stream.
+     */
+    void PrintPhyCensus(std::ostream& os) const;
+
+    /**
+     * Periodically print the census to a file, as a time series. The file is
+     * truncated at the first print.
+     *
+     * \param filename The name of the file.
+     * \param interval The interval between the censuses.
+     */
+    void EnablePeriodicPrinting(std::string filename, Time interval);
+
+  private:
+    /**
+     * Print the census to a file.
+     *
+     * \param filename The name of the file.
+     * \param interval The interval until the next census.
+     */
+    void DoPrintCensus(std::string filename, Time interval);
+
+    std::vector<Ptr<LoraPhy>> m_phys;   //!< The PHY layers
+    std::vector<uint32_t> m_phyNodeIds; //!< The nodes of m_phys
+    const LoraPacketTracker* m_tracker; //!< The packet tracker
+    Ptr<NetworkServer> m_networkServer; //!< The network server
+    bool m_printed;                     //!< Whether the file was printed
+    std::vector<Ptr<CorrelatedShadowingPropagationLossModel>>
+        m_shadowing; //!< The shadowing models
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_MEMORY_CENSUS_H */
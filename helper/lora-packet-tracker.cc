@@ -198,6 +198,49 @@ LoraPacketTracker::IsUplink(Ptr<const Packet> packet)
 // Counting Functions //
 ////////////////////////
 
+void
+LoraPacketTracker::HypothesisOutcomeCallback(Ptr<const Packet> packet,
+                                             uint32_t gwId,
+                                             uint32_t hypothesis,
+                                             GatewayLoraPhy::HypothesisOutcome outcome)
+{
+    if (IsUplink(packet))
+    {
+        NS_LOG_INFO("PHY packet " << packet << " has outcome " << unsigned(outcome)
+                                  << " under hypothesis " << hypothesis << " at gateway "
+                                  << gwId);
+
+        auto it = m_packetTracker.find(packet);
+        if (it == m_packetTracker.end())
+        {
+            return;
+        }
+        std::vector<enum PhyPacketOutcome>& outcomes = (*it).second.hypothesisOutcomes[gwId];
+        if (outcomes.size() <= hypothesis)
+        {
+            outcomes.resize(hypothesis + 1, UNSET);
+        }
+        switch (outcome)
+        {
+        case GatewayLoraPhy::HYPOTHESIS_RECEIVED:
+            outcomes[hypothesis] = RECEIVED;
+            break;
+        case GatewayLoraPhy::HYPOTHESIS_INTERFERED:
+            outcomes[hypothesis] = INTERFERED;
+            break;
+        case GatewayLoraPhy::HYPOTHESIS_NO_MORE_RECEIVERS:
+            outcomes[hypothesis] = NO_MORE_RECEIVERS;
+            break;
+        case GatewayLoraPhy::HYPOTHESIS_UNDER_SENSITIVITY:
+            outcomes[hypothesis] = UNDER_SENSITIVITY;
+            break;
+        case GatewayLoraPhy::HYPOTHESIS_LOST_BECAUSE_TX:
+            outcomes[hypothesis] = LOST_BECAUSE_TX;
+            break;
+        }
+    }
+}
+
 std::vector<int>
 LoraPacketTracker::CountPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
 {
@@ -252,6 +295,36 @@ LoraPacketTracker::CountPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
     return packetCounts;
 }
 
+std::vector<int>
+LoraPacketTracker::CountPhyPacketsPerGw(Time startTime,
+                                        Time stopTime,
+                                        int gwId,
+                                        uint32_t hypothesis)
+{
+    // Same fields as the counts under the actual parameters of the gateway
+    std::vector<int> packetCounts(6, 0);
+
+    for (const auto& [packet, status] : m_packetTracker)
+    {
+        if (status.sendTime < startTime || status.sendTime > stopTime)
+        {
+            continue;
+        }
+        packetCounts.at(0)++;
+
+        auto it = status.hypothesisOutcomes.find(gwId);
+        if (it == status.hypothesisOutcomes.end() || it->second.size() <= hypothesis ||
+            it->second[hypothesis] == UNSET)
+        {
+            continue;
+        }
+        // The outcomes from RECEIVED to LOST_BECAUSE_TX are counted in order
+        packetCounts.at(1 + it->second[hypothesis])++;
+    }
+
+    return packetCounts;
+}
+
 std::string
 LoraPacketTracker::PrintPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
 {
@@ -499,6 +572,42 @@ LoraPacketTracker::CountMacPacketsGloballyDelay (Time startTime, Time stopTime,
 
 }
 
+uint32_t
+LoraPacketTracker::GetNPhyPackets() const
+{
+    return m_packetTracker.size();
+}
+
+uint32_t
+LoraPacketTracker::GetNMacPackets() const
+{
+    return m_macPacketTracker.size();
+}
+
+uint32_t
+LoraPacketTracker::GetNRetransmissions() const
+{
+    return m_reTransmissionTracker.size();
+}
+
+uint64_t
+LoraPacketTracker::GetNReceptions() const
+{
+    uint64_t nReceptions = 0;
+    for (const auto& [packet, status] : m_packetTracker)
+    {
+        nReceptions += status.outcomes.size();
+        for (const auto& [gwId, outcomes] : status.hypothesisOutcomes)
+        {
+            nReceptions += outcomes.size();
+        }
+    }
+    for (const auto& [packet, status] : m_macPacketTracker)
+    {
+        nReceptions += status.receptionTimes.size();
+    }
+    return nReceptions;
+}
 
 } // namespace lorawan
 } // namespace ns3
@@ -9,11 +9,13 @@
 #ifndef LORA_PACKET_TRACKER_H
 #define LORA_PACKET_TRACKER_H
 
+#include "ns3/gateway-lora-phy.h"
 #include "ns3/nstime.h"
 #include "ns3/packet.h"
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace ns3
 {
@@ -42,6 +44,9 @@ struct PacketStatus
     Time sendTime;                                 //!< Timestamp of pkt radio tx start
     std::map<int, enum PhyPacketOutcome> outcomes; //!< Reception outcome of this pkt at the end of
                                                    //!< the tx, mapped by gateway's node id
+    std::map<int, std::vector<enum PhyPacketOutcome>>
+        hypothesisOutcomes; //!< Reception outcome of this pkt under each reception hypothesis,
+                            //!< mapped by gateway's node id
 };
 
 /**
@@ -143,6 +148,18 @@ class LoraPacketTracker
      * \param systemId Id of the gateway losing the packet.
      */
     void LostBecauseTxCallback(Ptr<const Packet> packet, uint32_t systemId);
+    /**
+     * Trace the outcome of a packet at a gateway under a reception hypothesis.
+     *
+     * \param packet The packet being evaluated.
+     * \param systemId Id of the gateway evaluating the packet.
+     * \param hypothesis Index of the hypothesis.
+     * \param outcome The outcome under the hypothesis.
+     */
+    void HypothesisOutcomeCallback(Ptr<const Packet> packet,
+                                   uint32_t systemId,
+                                   uint32_t hypothesis,
+                                   GatewayLoraPhy::HypothesisOutcome outcome);
 
     ///////////////////////////
     // MAC layer trace sinks //
@@ -219,6 +236,23 @@ class LoraPacketTracker
      */
     std::string PrintPhyPacketsPerGw(Time startTime, Time stopTime, int systemId);
 
+    /**
+     * Count packets in a time interval to evaluate the performance at PHY level of a specific
+     * gateway under one of its reception hypotheses, as CountPhyPacketsPerGw does under its
+     * actual parameters.
+     *
+     * \param startTime Timestamp of the start of the measurement.
+     * \param stopTime Timestamp of the end of the measurement.
+     * \param systemId Node id of the gateway.
+     * \param hypothesis Index of the hypothesis.
+     * \return A vector comprised of the following fields: [totPacketsSent, receivedPackets,
+     * interferedPackets, noMoreGwPackets, underSensitivityPackets, lostBecauseTxPackets].
+     */
+    std::vector<int> CountPhyPacketsPerGw(Time startTime,
+                                          Time stopTime,
+                                          int systemId,
+                                          uint32_t hypothesis);
+
     /**
      * Count packets in a time interval to evaluate the performance at MAC level of a specific
      * gateway.
@@ -292,6 +326,35 @@ class LoraPacketTracker
 
 
 
+    /**
+     * Get the number of packets tracked at the PHY layer.
+     *
+     * \return The number of packets.
+     */
+    uint32_t GetNPhyPackets() const;
+
+    /**
+     * Get the number of packets tracked at the MAC layer.
+     *
+     * \return The number of packets.
+     */
+    uint32_t GetNMacPackets() const;
+
+    /**
+     * Get the number of tracked retransmission processes.
+     *
+     * \return The number of processes.
+     */
+    uint32_t GetNRetransmissions() const;
+
+    /**
+     * Get the number of per-receiver entries of the tracked packets: the PHY
+     * outcomes at the gateways and the MAC reception times.
+     *
+     * \return The number of entries.
+     */
+    uint64_t GetNReceptions() const;
+
   private:
     PhyPacketData m_packetTracker;              //!< Packet map of PHY layer metrics
     MacPacketData m_macPacketTracker;           //!< Packet map of MAC layer metrics
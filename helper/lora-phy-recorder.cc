@@ -0,0 +1,179 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-phy-recorder.h"
+
+#include "ns3/log.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-tag.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraPhyRecorder");
+
+/**
+ * Write the bytes of a value.
+ *
+ * \param os The output stream.
+ * \param value The value.
+ */
+template <typename T>
+static void
+WriteValue(std::ostream& os, T value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Read the bytes of a value.
+ *
+ * \param is The input stream.
+ * \param value The value.
+ */
+template <typename T>
+static void
+ReadValue(std::istream& is, T& value)
+{
+    is.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+void
+LoraPhyRecord::Write(std::ostream& os) const
+{
+    WriteValue<uint8_t>(os, kind);
+    WriteValue(os, gatewayId);
+    WriteValue(os, packetUid);
+    WriteValue(os, nodeId);
+    WriteValue(os, numTx);
+    WriteValue(os, sf);
+    WriteValue<int64_t>(os, start.GetNanoSeconds());
+    WriteValue<int64_t>(os, duration.GetNanoSeconds());
+    WriteValue(os, powerDbm);
+    WriteValue(os, frequencyMHz);
+}
+
+bool
+LoraPhyRecord::Read(std::istream& is)
+{
+    uint8_t kindValue;
+    int64_t startNs;
+    int64_t durationNs;
+    ReadValue(is, kindValue);
+    ReadValue(is, gatewayId);
+    ReadValue(is, packetUid);
+    ReadValue(is, nodeId);
+    ReadValue(is, numTx);
+    ReadValue(is, sf);
+    ReadValue(is, startNs);
+    ReadValue(is, durationNs);
+    ReadValue(is, powerDbm);
+    ReadValue(is, frequencyMHz);
+    if (!is)
+    {
+        return false;
+    }
+    kind = static_cast<Kind>(kindValue);
+    start = NanoSeconds(startNs);
+    duration = NanoSeconds(durationNs);
+    return true;
+}
+
+const char LoraPhyRecorder::MAGIC[4] = {'L', 'P', 'H', 'Y'};
+const uint32_t LoraPhyRecorder::VERSION = 1;
+
+LoraPhyRecorder::LoraPhyRecorder()
+    : m_nRecords(0)
+{
+}
+
+LoraPhyRecorder::~LoraPhyRecorder()
+{
+    Close();
+}
+
+void
+LoraPhyRecorder::Open(std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    Close();
+    m_file.open(filename, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Cannot open the file of records " << filename);
+    m_file.write(MAGIC, sizeof(MAGIC));
+    WriteValue(m_file, VERSION);
+}
+
+void
+LoraPhyRecorder::Install(NodeContainer gateways)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto gw = gateways.Begin(); gw != gateways.End(); gw++)
+    {
+        uint32_t gatewayId = (*gw)->GetId();
+        Ptr<LoraPhy> phy = (*gw)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+        phy->TraceConnectWithoutContext(
+            "SignalArrival",
+            MakeCallback(&LoraPhyRecorder::Record, this).Bind(LoraPhyRecord::RECEPTION, gatewayId));
+        phy->TraceConnectWithoutContext(
+            "SignalTransmission",
+            MakeCallback(&LoraPhyRecorder::Record, this)
+                .Bind(LoraPhyRecord::TRANSMISSION, gatewayId));
+    }
+}
+
+void
+LoraPhyRecorder::Close()
+{
+    if (m_file.is_open())
+    {
+        NS_LOG_INFO(m_nRecords << " signals recorded");
+        m_file.close();
+    }
+}
+
+uint64_t
+LoraPhyRecorder::GetNRecords() const
+{
+    return m_nRecords;
+}
+
+void
+LoraPhyRecorder::Record(LoraPhyRecord::Kind kind,
+                        uint32_t gatewayId,
+                        Ptr<const Packet> packet,
+                        double powerDbm,
+                        uint8_t sf,
+                        Time duration,
+                        double frequencyMHz)
+{
+    if (!m_file.is_open())
+    {
+        return;
+    }
+
+    LoraTag tag;
+    packet->PeekPacketTag(tag);
+
+    LoraPhyRecord record;
+    record.kind = kind;
+    record.gatewayId = gatewayId;
+    record.packetUid = packet->GetUid();
+    record.nodeId = tag.GetNodeId();
+    record.numTx = tag.GetNumTx();
+    record.sf = sf;
+    record.start = Simulator::Now();
+    record.duration = duration;
+    record.powerDbm = powerDbm;
+    record.frequencyMHz = frequencyMHz;
+    record.Write(m_file);
+    m_nRecords++;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,148 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_PHY_RECORDER_H
+#define LORA_PHY_RECORDER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * A signal at a gateway PHY, as recorded by LoraPhyRecorder and replayed by
+ * LoraPhyReplay: a signal reaching the gateway, or a transmission of the
+ * gateway.
+ */
+struct LoraPhyRecord
+{
+    /**
+     * The kinds of signals.
+     */
+    enum Kind : uint8_t
+    {
+        RECEPTION,    //!< A signal reaching the gateway
+        TRANSMISSION, //!< A transmission of the gateway
+    };
+
+    Kind kind;           //!< The kind of signal
+    uint32_t gatewayId;  //!< The node id of the gateway
+    uint64_t packetUid;  //!< The uid of the packet, shared by all gateways
+    uint16_t nodeId;     //!< The node id in the LoraTag of the packet
+    uint8_t numTx;       //!< The transmissions left in the LoraTag of the packet
+    uint8_t sf;          //!< The spreading factor
+    Time start;          //!< The start of the signal at the gateway
+    Time duration;       //!< The on-air duration of the signal
+    double powerDbm;     //!< The received or transmitted power [dBm]
+    double frequencyMHz; //!< The frequency of the signal [MHz]
+
+    static const uint32_t SERIALIZED_SIZE = 49; //!< The size of a record in a file [bytes]
+
+    /**
+     * Write the record, with the byte order of the host.
+     *
+     * \param os The output stream.
+     */
+    void Write(std::ostream& os) const;
+
+    /**
+     * Read a record written by Write.
+     *
+     * \param is The input stream.
+     * \return Whether a whole record was read.
+     */
+    bool Read(std::istream& is);
+};
+
+/**
+ * \ingroup lorawan
+ *
+ * Record every signal at the PHYs of a set of gateways to a binary file, for
+ * LoraPhyReplay to evaluate the receptions again under other PHY parameters.
+ *
+ * The file starts with the magic "LPHY" and a 32-bit version, followed by a
+ * fixed-size LoraPhyRecord per signal reaching a gateway, with the power it
+ * was received with, or transmitted by a gateway, in the order of the
+ * simulation. The recorder connects to the SignalArrival and
+ * SignalTransmission trace sources of the gateway PHYs, so it must outlive the
+ * simulation.
+ */
+class LoraPhyRecorder
+{
+  public:
+    LoraPhyRecorder();  //!< Default constructor
+    ~LoraPhyRecorder(); //!< Destructor
+
+    LoraPhyRecorder(const LoraPhyRecorder&) = delete;            //!< Not copyable
+    LoraPhyRecorder& operator=(const LoraPhyRecorder&) = delete; //!< Not copyable
+
+    /**
+     * Start a file of records, replacing any file of the same name.
+     *
+     * \param filename The name of the file.
+     */
+    void Open(std::string filename);
+
+    /**
+     * Record the signals at a set of gateways.
+     *
+     * \param gateways The gateway nodes, each with a LoraNetDevice as its
+     * first device.
+     */
+    void Install(NodeContainer gateways);
+
+    /**
+     * Flush and close the file. The destructor does it too.
+     */
+    void Close();
+
+    /**
+     * Get the number of signals recorded so far.
+     *
+     * \return The number of records.
+     */
+    uint64_t GetNRecords() const;
+
+    static const char MAGIC[4];     //!< The first bytes of a file of records
+    static const uint32_t VERSION; //!< The version of the format of the files
+
+  private:
+    /**
+     * Record a signal at a gateway.
+     *
+     * \param kind The kind of signal.
+     * \param gatewayId The node id of the gateway.
+     * \param packet The packet carried by the signal.
+     * \param powerDbm The received or transmitted power [dBm].
+     * \param sf The spreading factor.
+     * \param duration The on-air duration.
+     * \param frequencyMHz The frequency [MHz].
+     */
+    void Record(LoraPhyRecord::Kind kind,
+                uint32_t gatewayId,
+                Ptr<const Packet> packet,
+                double powerDbm,
+                uint8_t sf,
+                Time duration,
+                double frequencyMHz);
+
+    std::ofstream m_file; //!< The file of records
+    uint64_t m_nRecords;  //!< The signals recorded so far
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_PHY_RECORDER_H */
@@ -0,0 +1,317 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-phy-replay.h"
+
+#include "ns3/gateway-lora-phy.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <unordered_set>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraPhyReplay");
+
+LoraPhyReplay::Parameters::Parameters()
+    : collisionSnir(LoraInterferenceHelper::collisionMatrix == LoraInterferenceHelper::ALOHA
+                        ? LoraInterferenceHelper::collisionSnirAloha
+                        : LoraInterferenceHelper::collisionSnirGoursaud),
+      incrementalRedundancy(LoraInterferenceHelper::NOREDUNDANCY),
+      nReceptionPaths(8),
+      sensitivity(std::begin(GatewayLoraPhy::sensitivity), std::end(GatewayLoraPhy::sensitivity))
+{
+}
+
+LoraPhyReplay::LoraPhyReplay()
+    : m_nThreads(std::max(1U, std::thread::hardware_concurrency()))
+{
+}
+
+LoraPhyReplay::~LoraPhyReplay()
+{
+}
+
+void
+LoraPhyReplay::Load(std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ifstream file(filename, std::ifstream::in | std::ifstream::binary);
+    NS_ABORT_MSG_IF(!file.is_open(), "Cannot open the file of records " << filename);
+
+    char magic[sizeof(LoraPhyRecorder::MAGIC)];
+    uint32_t version = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    bool isRecordFile =
+        file && std::equal(std::begin(magic), std::end(magic), LoraPhyRecorder::MAGIC);
+    NS_ABORT_MSG_IF(!isRecordFile, filename << " is not a file of records");
+    NS_ABORT_MSG_IF(version != LoraPhyRecorder::VERSION,
+                    "Unsupported version " << version << " of the file of records " << filename);
+
+    LoraPhyRecord record;
+    while (record.Read(file))
+    {
+        Add(record);
+    }
+    NS_LOG_INFO(GetNRecords() << " records of " << m_records.size() << " gateways loaded");
+}
+
+void
+LoraPhyReplay::Add(const LoraPhyRecord& record)
+{
+    auto it = m_gatewayIndices.find(record.gatewayId);
+    if (it == m_gatewayIndices.end())
+    {
+        it = m_gatewayIndices.emplace(record.gatewayId, m_records.size()).first;
+        m_gatewayIds.push_back(record.gatewayId);
+        m_records.emplace_back();
+    }
+    m_records[it->second].push_back(record);
+}
+
+void
+LoraPhyReplay::SetNThreads(uint32_t nThreads)
+{
+    NS_ASSERT(nThreads > 0);
+    m_nThreads = nThreads;
+}
+
+void
+LoraPhyReplay::Run(const Parameters& parameters)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(parameters.collisionSnir.size() == 6 && parameters.sensitivity.size() == 6);
+
+    m_outcomes.assign(m_records.size(), {});
+
+    uint32_t nThreads = std::min<uint32_t>(m_nThreads, m_records.size());
+#ifdef LORAWAN_PROFILE
+    nThreads = 1;
+#endif
+
+    // Each thread replays the next gateway not taken yet
+    std::atomic<uint32_t> nextGateway(0);
+    auto replayGateways = [&]() {
+        for (uint32_t g = nextGateway++; g < m_records.size(); g = nextGateway++)
+        {
+            ReplayGateway(m_records[g], parameters, m_outcomes[g]);
+        }
+    };
+    if (nThreads <= 1)
+    {
+        replayGateways();
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < nThreads; t++)
+    {
+        threads.emplace_back(replayGateways);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void
+LoraPhyReplay::ReplayGateway(const std::vector<LoraPhyRecord>& records,
+                             const Parameters& parameters,
+                             std::vector<Outcome>& outcomes)
+{
+    const uint32_t FREE = std::numeric_limits<uint32_t>::max();
+
+    LoraInterferenceHelper interference;
+    interference.SetCollisionSnir(parameters.collisionSnir);
+    interference.SetIncrementalRedundancy(parameters.incrementalRedundancy);
+    bool incrementalRedundancy =
+        parameters.incrementalRedundancy != LoraInterferenceHelper::NOREDUNDANCY;
+
+    // The record each reception path is locked on, and the event of each
+    // reception in progress
+    std::vector<uint32_t> paths(parameters.nReceptionPaths, FREE);
+    std::vector<Ptr<LoraInterferenceHelper::Event>> events(records.size());
+    bool isTransmitting = false;
+    outcomes.assign(records.size(), N_OUTCOMES);
+
+    // The ends of the receptions and transmissions in progress, by time, then
+    // by start
+    using End = std::pair<Time, uint32_t>;
+    std::priority_queue<End, std::vector<End>, std::greater<End>> ends;
+
+    // Clear the chase combining state of a device after its last transmission
+    auto clearIfLast = [&](const LoraPhyRecord& record) {
+        if (record.numTx == 0 && incrementalRedundancy)
+        {
+            interference.ClearIndexUmap(record.nodeId);
+        }
+    };
+
+    auto endSignal = [&](uint32_t i) {
+        const LoraPhyRecord& record = records[i];
+        if (record.kind == LoraPhyRecord::TRANSMISSION)
+        {
+            isTransmitting = false;
+            return;
+        }
+
+        // Receptions interrupted by a transmission have no path anymore
+        auto path = std::find(paths.begin(), paths.end(), i);
+        if (path == paths.end())
+        {
+            return;
+        }
+        *path = FREE;
+
+        if (interference.IsDestroyedByInterference(events[i]) != 0)
+        {
+            clearIfLast(record);
+            outcomes[i] = INTERFERED;
+        }
+        else
+        {
+            if (incrementalRedundancy)
+            {
+                interference.ClearIndexUmap(record.nodeId);
+            }
+            outcomes[i] = RECEIVED;
+        }
+        events[i] = nullptr;
+    };
+
+    for (uint32_t i = 0; i < records.size(); i++)
+    {
+        const LoraPhyRecord& record = records[i];
+        while (!ends.empty() && ends.top().first <= record.start)
+        {
+            uint32_t ended = ends.top().second;
+            ends.pop();
+            endSignal(ended);
+        }
+
+        if (record.kind == LoraPhyRecord::TRANSMISSION)
+        {
+            // Interrupt all receptions
+            for (auto& path : paths)
+            {
+                if (path != FREE)
+                {
+                    outcomes[path] = TRANSMITTING;
+                    events[path] = nullptr;
+                    path = FREE;
+                }
+            }
+            isTransmitting = true;
+            ends.emplace(record.start + record.duration, i);
+            continue;
+        }
+
+        if (isTransmitting)
+        {
+            clearIfLast(record);
+            outcomes[i] = TRANSMITTING;
+            continue;
+        }
+
+        Ptr<LoraInterferenceHelper::Event> event =
+            interference.Add(record.start,
+                             record.duration,
+                             record.powerDbm,
+                             record.sf,
+                             parameters.incrementalRedundancy,
+                             record.nodeId,
+                             nullptr,
+                             record.frequencyMHz);
+
+        auto path = std::find(paths.begin(), paths.end(), FREE);
+        if (path == paths.end())
+        {
+            clearIfLast(record);
+            outcomes[i] = NO_MORE_RECEIVERS;
+        }
+        else if (record.powerDbm < parameters.sensitivity[record.sf - 7])
+        {
+            clearIfLast(record);
+            outcomes[i] = UNDER_SENSITIVITY;
+        }
+        else
+        {
+            *path = i;
+            events[i] = event;
+            ends.emplace(record.start + record.duration, i);
+        }
+    }
+    while (!ends.empty())
+    {
+        uint32_t ended = ends.top().second;
+        ends.pop();
+        endSignal(ended);
+    }
+}
+
+uint64_t
+LoraPhyReplay::GetNRecords() const
+{
+    uint64_t nRecords = 0;
+    for (const auto& records : m_records)
+    {
+        nRecords += records.size();
+    }
+    return nRecords;
+}
+
+uint64_t
+LoraPhyReplay::GetNOutcomes(Outcome outcome) const
+{
+    uint64_t nOutcomes = 0;
+    for (const auto& outcomes : m_outcomes)
+    {
+        nOutcomes += std::count(outcomes.begin(), outcomes.end(), outcome);
+    }
+    return nOutcomes;
+}
+
+uint64_t
+LoraPhyReplay::GetNReceivedPackets() const
+{
+    std::unordered_set<uint64_t> packets;
+    for (uint32_t g = 0; g < m_outcomes.size(); g++)
+    {
+        for (uint32_t i = 0; i < m_outcomes[g].size(); i++)
+        {
+            if (m_outcomes[g][i] == RECEIVED)
+            {
+                packets.insert(m_records[g][i].packetUid);
+            }
+        }
+    }
+    return packets.size();
+}
+
+void
+LoraPhyReplay::PrintOutcomes(std::ostream& os) const
+{
+    for (uint32_t g = 0; g < m_outcomes.size(); g++)
+    {
+        os << m_gatewayIds[g];
+        for (uint8_t outcome = 0; outcome < N_OUTCOMES; outcome++)
+        {
+            os << " " << std::count(m_outcomes[g].begin(), m_outcomes[g].end(), outcome);
+        }
+        os << std::endl;
+    }
+}
+
+} // namespace lorawan
+} // namespace ns3
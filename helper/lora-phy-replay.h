@@ -0,0 +1,163 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_PHY_REPLAY_H
+#define LORA_PHY_REPLAY_H
+
+#include "ns3/lora-interference-helper.h"
+#include "ns3/lora-phy-recorder.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Evaluate again the receptions of the gateways recorded by LoraPhyRecorder,
+ * under other PHY parameters, without simulating the rest of the network.
+ *
+ * Each gateway is replayed as SimpleGatewayLoraPhy receives: a signal is
+ * dropped while the gateway transmits, is otherwise added to a
+ * LoraInterferenceHelper, and takes a free reception path if it is above the
+ * sensitivity; at its end, the interference helper decides whether it is
+ * received. A transmission of the gateway interrupts the receptions in
+ * progress. Signals starting when another ends see it ended.
+ *
+ * The gateways are independent, so they are replayed in parallel, by a number
+ * of threads. The replay does not use the simulator, but the logging of the
+ * interference helper prints the time of the simulator, and the profiler of
+ * the LORAWAN_PROFILE builds is not thread safe, so those builds replay with a
+ * single thread. The outcomes of the replay with the parameters of the
+ * recorded simulation are those of the simulation, but for the order of
+ * simultaneous events. The replay does not close the loop with the MACs: the
+ * recorded retransmissions and downlinks are replayed as they are, whatever
+ * the outcomes of the uplinks that caused them.
+ */
+class LoraPhyReplay
+{
+  public:
+    /**
+     * The PHY parameters of the gateways.
+     */
+    struct Parameters
+    {
+        Parameters(); //!< The parameters of the default gateways
+
+        /// The isolation [dB] each spreading factor needs from each other
+        std::vector<std::vector<double>> collisionSnir;
+        /// The incremental redundancy of the receptions
+        LoraInterferenceHelper::IncrementalRedundancy incrementalRedundancy;
+        uint32_t nReceptionPaths;        //!< The number of reception paths
+        std::vector<double> sensitivity; //!< The sensitivity by spreading factor [dBm]
+    };
+
+    /**
+     * The outcomes of a signal reaching a gateway, as fired by the trace
+     * sources of the gateway PHYs.
+     */
+    enum Outcome : uint8_t
+    {
+        RECEIVED,          //!< The signal was received
+        INTERFERED,        //!< The signal was destroyed by interference
+        UNDER_SENSITIVITY, //!< The signal was below the sensitivity
+        NO_MORE_RECEIVERS, //!< No reception path was free
+        TRANSMITTING,      //!< The gateway was transmitting
+        N_OUTCOMES,        //!< The number of outcomes
+    };
+
+    LoraPhyReplay();  //!< Default constructor
+    ~LoraPhyReplay(); //!< Destructor
+
+    /**
+     * Load the records of a file written by LoraPhyRecorder.
+     *
+     * \param filename The name of the file.
+     */
+    void Load(std::string filename);
+
+    /**
+     * Add a record, after the records of its gateway added so far.
+     *
+     * \param record The record.
+     */
+    void Add(const LoraPhyRecord& record);
+
+    /**
+     * Set the number of threads replaying the gateways, by default that of
+     * the hardware.
+     *
+     * \param nThreads The number of threads.
+     */
+    void SetNThreads(uint32_t nThreads);
+
+    /**
+     * Replay the receptions of all gateways under a set of parameters,
+     * replacing the outcomes of any previous run.
+     *
+     * \param parameters The parameters.
+     */
+    void Run(const Parameters& parameters);
+
+    /**
+     * Get the number of records loaded.
+     *
+     * \return The number of records.
+     */
+    uint64_t GetNRecords() const;
+
+    /**
+     * Get the number of signals with an outcome at all gateways in the last
+     * run.
+     *
+     * \param outcome The outcome.
+     * \return The number of signals.
+     */
+    uint64_t GetNOutcomes(Outcome outcome) const;
+
+    /**
+     * Get the number of packets received by at least one gateway in the last
+     * run.
+     *
+     * \return The number of packets.
+     */
+    uint64_t GetNReceivedPackets() const;
+
+    /**
+     * Print a line per gateway with the outcomes of the last run: the node id
+     * of the gateway, and its number of signals with each Outcome, in order.
+     *
+     * \param os The output stream.
+     */
+    void PrintOutcomes(std::ostream& os) const;
+
+  private:
+    /**
+     * Replay the receptions of a gateway.
+     *
+     * \param records The records of the gateway, in time order.
+     * \param parameters The parameters.
+     * \param outcomes The outcome of each reception record, filled.
+     */
+    static void ReplayGateway(const std::vector<LoraPhyRecord>& records,
+                              const Parameters& parameters,
+                              std::vector<Outcome>& outcomes);
+
+    uint32_t m_nThreads;                               //!< The number of threads
+    std::map<uint32_t, uint32_t> m_gatewayIndices;     //!< The index of each gateway, by node id
+    std::vector<uint32_t> m_gatewayIds;                //!< The node id of each gateway
+    std::vector<std::vector<LoraPhyRecord>> m_records; //!< The records of each gateway
+    std::vector<std::vector<Outcome>> m_outcomes;      //!< The outcomes of each gateway
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_PHY_REPLAY_H */
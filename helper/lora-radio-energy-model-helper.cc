@@ -64,6 +64,12 @@ LoraRadioEnergyModelHelper::SetTxCurrentModel(std::string name,
     m_txCurrentModel = factory;
 }
 
+void
+LoraRadioEnergyModelHelper::SetTxCurrentModel(Ptr<LoraTxCurrentModel> model)
+{
+    m_sharedTxCurrentModel = model;
+}
+
 /*
  * Private function starts here.
  */
@@ -94,7 +100,11 @@ LoraRadioEnergyModelHelper::DoInstall(Ptr<NetDevice> device, Ptr<EnergySource> s
     // create and register energy model phy listener
     loraPhy->RegisterListener(model->GetPhyListener());
 
-    if (m_txCurrentModel.GetTypeId().GetUid())
+    if (m_sharedTxCurrentModel)
+    {
+        model->SetTxCurrentModel(m_sharedTxCurrentModel);
+    }
+    else if (m_txCurrentModel.GetTypeId().GetUid())
     {
         Ptr<LoraTxCurrentModel> txcurrent = m_txCurrentModel.Create<LoraTxCurrentModel>();
         model->SetTxCurrentModel(txcurrent);
@@ -77,6 +77,16 @@ class LoraRadioEnergyModelHelper : public DeviceEnergyModelHelper
                            std::string n7 = "",
                            const AttributeValue& v7 = EmptyAttributeValue());
 
+    /**
+     * \param model The transmission current model.
+     *
+     * Configure a Transmission Current model instance shared by all the
+     * installed energy models, instead of creating one per device. The model
+     * must not hold per-device state, like TableLoraTxCurrentModel. Takes
+     * precedence over the model configured by name.
+     */
+    void SetTxCurrentModel(Ptr<LoraTxCurrentModel> model);
+
   private:
     /**
      * \param device Pointer to the NetDevice to install DeviceEnergyModel.
@@ -89,8 +99,9 @@ class LoraRadioEnergyModelHelper : public DeviceEnergyModelHelper
                                      Ptr<EnergySource> source) const override;
 
   private:
-    ObjectFactory m_radioEnergy;    ///< radio energy
-    ObjectFactory m_txCurrentModel; ///< transmit current model
+    ObjectFactory m_radioEnergy;                    ///< radio energy
+    ObjectFactory m_txCurrentModel;                 ///< transmit current model
+    Ptr<LoraTxCurrentModel> m_sharedTxCurrentModel; ///< shared transmit current model
 };
 
 } // namespace lorawan
@@ -0,0 +1,383 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-virtual-fleet.h"
+
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/log.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-tag.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraVirtualFleet");
+
+LoraVirtualFleet::LoraVirtualFleet()
+    : m_period(Seconds(600)),
+      m_packetSize(10),
+      m_txPowerDbm(14),
+      m_dutyCycle(0.01),
+      m_frequencies({868.1, 868.3, 868.5}),
+      m_addressBase(LoraDeviceAddress(127, 0).Get()),
+      m_next(0),
+      m_periodStart(0),
+      m_stop(0),
+      m_nodeIdBase(0),
+      m_nSent(0),
+      m_nDutyCycleDrops(0)
+{
+    m_senderMobility = CreateObject<ConstantPositionMobilityModel>();
+    m_offsetRv = CreateObject<UniformRandomVariable>();
+    m_channelRv = CreateObject<UniformRandomVariable>();
+}
+
+LoraVirtualFleet::~LoraVirtualFleet()
+{
+}
+
+void
+LoraVirtualFleet::SetPeriod(Time period)
+{
+    NS_ASSERT(period.IsStrictlyPositive());
+    m_period = period;
+}
+
+void
+LoraVirtualFleet::SetPacketSize(uint8_t size)
+{
+    m_packetSize = size;
+
+    // The durations of the uplinks are computed again on the next ones
+    std::fill(std::begin(m_durations), std::end(m_durations), Time(0));
+}
+
+void
+LoraVirtualFleet::SetTxPower(double dBm)
+{
+    m_txPowerDbm = dBm;
+}
+
+void
+LoraVirtualFleet::SetDutyCycle(double dutyCycle)
+{
+    NS_ASSERT(dutyCycle > 0 && dutyCycle <= 1);
+    m_dutyCycle = dutyCycle;
+}
+
+void
+LoraVirtualFleet::SetFrequencies(std::vector<double> frequenciesMHz)
+{
+    NS_ASSERT(!frequenciesMHz.empty());
+    m_frequencies = frequenciesMHz;
+}
+
+void
+LoraVirtualFleet::SetAddressBase(LoraDeviceAddress address)
+{
+    m_addressBase = address.Get();
+}
+
+uint32_t
+LoraVirtualFleet::AddDevices(uint32_t nDevices, Ptr<PositionAllocator> allocator)
+{
+    NS_LOG_FUNCTION(this << nDevices << allocator);
+
+    uint32_t first = m_positions.size();
+    uint32_t size = first + nDevices;
+    m_positions.reserve(size);
+    for (uint32_t i = 0; i < nDevices; i++)
+    {
+        m_positions.push_back(allocator->GetNext());
+    }
+    m_dataRates.resize(size, 0);
+    m_txPowers.resize(size, static_cast<int8_t>(m_txPowerDbm));
+    m_fCnts.resize(size, 0);
+    m_offDutyEnds.resize(size, std::numeric_limits<int64_t>::min());
+    m_offsets.resize(size, 0);
+    m_isVirtual.resize(size, 1);
+    return first;
+}
+
+void
+LoraVirtualFleet::SetSpreadingFactorsUp(NodeContainer gateways, Ptr<LoraChannel> channel)
+{
+    NS_LOG_FUNCTION(this << channel);
+
+    std::vector<Ptr<MobilityModel>> gwMobilities;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); gw++)
+    {
+        gwMobilities.push_back((*gw)->GetObject<MobilityModel>());
+    }
+
+    Ptr<ConstantPositionMobilityModel> deviceMobility =
+        CreateObject<ConstantPositionMobilityModel>();
+    for (uint32_t d = 0; d < m_positions.size(); d++)
+    {
+        deviceMobility->SetPosition(m_positions[d]);
+        double highestRxPower = -std::numeric_limits<double>::infinity();
+        for (const auto& gwMobility : gwMobilities)
+        {
+            double rxPower = channel->GetRxPower(m_txPowers[d], deviceMobility, gwMobility);
+            highestRxPower = std::max(highestRxPower, rxPower);
+        }
+
+        // Data rate 0 (SF12) for the devices out of range
+        m_dataRates[d] = 0;
+        for (uint8_t sf = 7; sf < 12; sf++)
+        {
+            if (highestRxPower > EndDeviceLoraPhy::sensitivity[sf - 7])
+            {
+                m_dataRates[d] = 12 - sf;
+                break;
+            }
+        }
+    }
+}
+
+NodeContainer
+LoraVirtualFleet::Instantiate(const std::vector<uint32_t>& devices,
+                              const LoraHelper& helper,
+                              const LoraPhyHelper& phyHelper,
+                              const LorawanMacHelper& macHelper)
+{
+    NS_LOG_FUNCTION(this << devices.size());
+    NS_ASSERT_MSG(!m_channel, "Devices must be promoted before Install");
+
+    NodeContainer nodes;
+    for (uint32_t d : devices)
+    {
+        NS_ASSERT(d < m_positions.size() && m_isVirtual[d]);
+
+        Ptr<Node> node = CreateObject<Node>();
+        Ptr<ConstantPositionMobilityModel> mobility =
+            CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(m_positions[d]);
+        node->AggregateObject(mobility);
+        helper.Install(phyHelper, macHelper, node);
+
+        Ptr<EndDeviceLorawanMac> mac = node->GetDevice(0)
+                                           ->GetObject<LoraNetDevice>()
+                                           ->GetMac()
+                                           ->GetObject<EndDeviceLorawanMac>();
+        NS_ASSERT_MSG(mac, "The MAC helper must install end devices");
+        mac->SetDeviceAddress(GetAddress(d));
+        mac->SetDataRate(m_dataRates[d]);
+
+        m_isVirtual[d] = 0;
+        nodes.Add(node);
+    }
+    return nodes;
+}
+
+void
+LoraVirtualFleet::Install(Ptr<LoraChannel> channel, Time start, Time stop)
+{
+    NS_LOG_FUNCTION(this << channel << start << stop);
+    NS_ASSERT(start >= Simulator::Now());
+
+    m_channel = channel;
+    m_periodStart = start.GetTimeStep();
+    m_stop = stop.GetTimeStep();
+    m_next = 0;
+
+    // The node ids of the nodes created so far, including the promoted
+    // devices, are taken: the LoraTags use the ids above them
+    const uint32_t nNodeIds = std::numeric_limits<uint16_t>::max() + 1;
+    m_nodeIdBase = std::min(NodeList::GetNNodes(), nNodeIds - 1);
+    if (m_positions.size() > nNodeIds - m_nodeIdBase)
+    {
+        for (std::size_t i = 0; i < channel->GetNDevices(); i++)
+        {
+            Ptr<LoraNetDevice> device = DynamicCast<LoraNetDevice>(channel->GetDevice(i));
+            if (!device)
+            {
+                continue;
+            }
+            const LoraInterferenceHelper& interference =
+                device->GetPhy()->GetInterferenceHelper();
+            NS_ABORT_MSG_IF(interference.GetIncrementalRedundancy() ==
+                                LoraInterferenceHelper::CHASECOMBINING,
+                            "Chase combining needs unique node ids, but the "
+                                << m_positions.size() << " devices of the fleet share "
+                                << nNodeIds - m_nodeIdBase << " free ones");
+        }
+    }
+
+    // The offset of each virtual device in the period, and the order of the
+    // uplinks in each period
+    m_order.clear();
+    for (uint32_t d = 0; d < m_positions.size(); d++)
+    {
+        if (m_isVirtual[d])
+        {
+            m_offsets[d] = static_cast<int64_t>(m_offsetRv->GetValue(0, m_period.GetTimeStep()));
+            m_order.push_back(d);
+        }
+    }
+    std::stable_sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) {
+        return m_offsets[a] < m_offsets[b];
+    });
+    NS_LOG_INFO(m_order.size() << " virtual devices out of " << m_positions.size());
+
+    if (!m_order.empty() && GetNextTimeStep() < m_stop)
+    {
+        Simulator::Schedule(TimeStep(GetNextTimeStep()) - Simulator::Now(),
+                            &LoraVirtualFleet::SendDue,
+                            this);
+    }
+}
+
+int64_t
+LoraVirtualFleet::GetNextTimeStep() const
+{
+    return m_periodStart + m_offsets[m_order[m_next]];
+}
+
+void
+LoraVirtualFleet::SendDue()
+{
+    NS_LOG_FUNCTION(this);
+
+    int64_t now = Simulator::Now().GetTimeStep();
+    while (GetNextTimeStep() <= now)
+    {
+        SendUplink(m_order[m_next]);
+        if (++m_next == m_order.size())
+        {
+            m_next = 0;
+            m_periodStart += m_period.GetTimeStep();
+        }
+    }
+
+    if (GetNextTimeStep() < m_stop)
+    {
+        Simulator::Schedule(TimeStep(GetNextTimeStep() - now), &LoraVirtualFleet::SendDue, this);
+    }
+}
+
+void
+LoraVirtualFleet::SendUplink(uint32_t device)
+{
+    int64_t now = Simulator::Now().GetTimeStep();
+    if (now < m_offDutyEnds[device])
+    {
+        NS_LOG_DEBUG("Uplink of device " << device << " blocked by the duty cycle");
+        m_nDutyCycleDrops++;
+        return;
+    }
+
+    // The packet, as a Class A MAC and PHY would build it
+    Ptr<Packet> packet = Create<Packet>(m_packetSize);
+    LoraFrameHeader frameHdr;
+    frameHdr.SetAsUplink();
+    frameHdr.SetFPort(1);
+    frameHdr.SetAddress(GetAddress(device));
+    frameHdr.SetAdr(false);
+    frameHdr.SetAdrAckReq(false);
+    frameHdr.SetFCnt(m_fCnts[device]);
+    packet->AddHeader(frameHdr);
+    LorawanMacHeader macHdr;
+    macHdr.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_UP);
+    macHdr.SetMajor(1);
+    packet->AddHeader(macHdr);
+
+    uint8_t dataRate = m_dataRates[device];
+    LoraTxParameters params;
+    params.sf = 12 - dataRate;
+    params.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(params) > MilliSeconds(16);
+
+    LoraTag tag;
+    tag.SetSpreadingFactor(params.sf);
+    tag.SetNodeId(GetTagNodeId(device));
+    packet->AddPacketTag(tag);
+
+    // All uplinks have the same size, hence the same duration on a data rate
+    if (m_durations[dataRate].IsZero())
+    {
+        m_durations[dataRate] = LoraPhy::GetOnAirTime(packet, params);
+    }
+    Time duration = m_durations[dataRate];
+    double frequency = m_frequencies[m_channelRv->GetInteger(0, m_frequencies.size() - 1)];
+
+    NS_LOG_DEBUG("Uplink of device " << device << ": SF" << unsigned(params.sf) << ", "
+                                     << frequency << " MHz");
+    m_senderMobility->SetPosition(m_positions[device]);
+    m_channel->SendFrom(m_senderMobility, packet, m_txPowers[device], params, duration, frequency);
+
+    m_offDutyEnds[device] = now + static_cast<int64_t>(duration.GetTimeStep() / m_dutyCycle);
+    m_fCnts[device]++;
+    m_nSent++;
+}
+
+uint16_t
+LoraVirtualFleet::GetTagNodeId(uint32_t device) const
+{
+    return m_nodeIdBase + device % (std::numeric_limits<uint16_t>::max() + 1 - m_nodeIdBase);
+}
+
+uint32_t
+LoraVirtualFleet::GetNDevices() const
+{
+    return m_positions.size();
+}
+
+Vector
+LoraVirtualFleet::GetPosition(uint32_t device) const
+{
+    return m_positions.at(device);
+}
+
+uint8_t
+LoraVirtualFleet::GetDataRate(uint32_t device) const
+{
+    return m_dataRates.at(device);
+}
+
+LoraDeviceAddress
+LoraVirtualFleet::GetAddress(uint32_t device) const
+{
+    return LoraDeviceAddress(m_addressBase + device);
+}
+
+uint16_t
+LoraVirtualFleet::GetFCnt(uint32_t device) const
+{
+    return m_fCnts.at(device);
+}
+
+uint64_t
+LoraVirtualFleet::GetNSentPackets() const
+{
+    return m_nSent;
+}
+
+uint64_t
+LoraVirtualFleet::GetNDutyCycleDrops() const
+{
+    return m_nDutyCycleDrops;
+}
+
+int64_t
+LoraVirtualFleet::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+
+    m_offsetRv->SetStream(stream);
+    m_channelRv->SetStream(stream + 1);
+    return 2;
+}
+
+} // namespace lorawan
+} // namespace ns3
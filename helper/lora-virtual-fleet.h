@@ -0,0 +1,278 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_VIRTUAL_FLEET_H
+#define LORA_VIRTUAL_FLEET_H
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-device-address.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * A fleet of virtual end devices, sending periodic unconfirmed uplinks
+ * without a node, a LoraNetDevice, a MAC or a PHY each, so that networks of
+ * millions of devices fit in memory.
+ *
+ * The state of the devices is held in arrays indexed by device, one per
+ * field: the position, data rate, transmission power, frame counter, duty
+ * cycle and offset of the periodic uplinks, about 50 bytes per device. The
+ * uplinks are built as a Class A MAC builds them, with the LoRaWAN headers and
+ * a LoraTag, and sent in the channel with LoraChannel::SendFrom, so that
+ * gateways receive them as any other uplink. A single event is pending at any
+ * time, for the next uplink of the fleet in the order of the offsets.
+ *
+ * The devices of the fleet that need downlinks or applications other than
+ * periodic uplinks are promoted to full Class A devices with Instantiate,
+ * before Install: they get a node with the full stack, and the fleet no longer
+ * sends their uplinks.
+ *
+ * The duty cycle is enforced per device, as if all channels were in the same
+ * sub-band, and the uplinks it blocks are dropped. The node id of the LoraTag,
+ * used by gateways for chase combining, is taken from the 16-bit ids above
+ * those of the nodes created before Install, so that it does not collide with
+ * the ids of real devices; fleets larger than that range share ids, which
+ * Install refuses if a gateway on the channel uses chase combining. A single
+ * mobility model places all the uplinks in the channel, so loss models keeping
+ * a state per mobility model, such as BuildingPenetrationLoss, see the fleet as
+ * a single device. The helper schedules events on itself, so it must outlive
+ * the simulation.
+ */
+class LoraVirtualFleet
+{
+  public:
+    LoraVirtualFleet();  //!< Default constructor
+    ~LoraVirtualFleet(); //!< Destructor
+
+    LoraVirtualFleet(const LoraVirtualFleet&) = delete;            //!< Not copyable
+    LoraVirtualFleet& operator=(const LoraVirtualFleet&) = delete; //!< Not copyable
+
+    /**
+     * Set the period of the uplinks.
+     *
+     * \param period The period.
+     */
+    void SetPeriod(Time period);
+
+    /**
+     * Set the application payload size of the uplinks.
+     *
+     * \param size The size, in bytes.
+     */
+    void SetPacketSize(uint8_t size);
+
+    /**
+     * Set the transmission power of the devices added from now on.
+     *
+     * \param dBm The power, in dBm.
+     */
+    void SetTxPower(double dBm);
+
+    /**
+     * Set the duty cycle of the devices.
+     *
+     * \param dutyCycle The fraction of time a device may transmit.
+     */
+    void SetDutyCycle(double dutyCycle);
+
+    /**
+     * Set the channels the devices transmit on, with equal probability.
+     *
+     * \param frequenciesMHz The frequencies of the channels, in MHz.
+     */
+    void SetFrequencies(std::vector<double> frequenciesMHz);
+
+    /**
+     * Set the address of the first device. The address of each device is
+     * this one plus its index.
+     *
+     * \param address The address of the first device.
+     */
+    void SetAddressBase(LoraDeviceAddress address);
+
+    /**
+     * Add devices to the fleet, at the positions of an allocator and with
+     * data rate 0.
+     *
+     * \param nDevices The number of devices.
+     * \param allocator The allocator of the positions of the devices.
+     * \return The index of the first device added.
+     */
+    uint32_t AddDevices(uint32_t nDevices, Ptr<PositionAllocator> allocator);
+
+    /**
+     * Set the data rate of each device from its best gateway, as
+     * LorawanMacHelper::SetSpreadingFactorsUp does.
+     *
+     * \param gateways The gateway nodes, each with a MobilityModel.
+     * \param channel The channel, whose loss model gives the power of the
+     * devices at the gateways.
+     */
+    void SetSpreadingFactorsUp(NodeContainer gateways, Ptr<LoraChannel> channel);
+
+    /**
+     * Promote devices of the fleet to full Class A end devices.
+     *
+     * Each device gets a node at its position, with a
+     * ConstantPositionMobilityModel and the LoRa stack of the helpers, whose
+     * device type must be the end device one; its MAC gets the address and
+     * data rate of the device. The applications are left to the caller.
+     *
+     * \param devices The indices of the devices.
+     * \param helper The helper installing the stack.
+     * \param phyHelper The helper of the PHYs.
+     * \param macHelper The helper of the MACs.
+     * \return The nodes of the devices, in the order of the indices.
+     */
+    NodeContainer Instantiate(const std::vector<uint32_t>& devices,
+                              const LoraHelper& helper,
+                              const LoraPhyHelper& phyHelper,
+                              const LorawanMacHelper& macHelper);
+
+    /**
+     * Send the uplinks of the virtual devices in a channel, each device once
+     * per period from a random offset.
+     *
+     * \param channel The channel.
+     * \param start The time of the start of the first period.
+     * \param stop The time from which no uplink is sent.
+     */
+    void Install(Ptr<LoraChannel> channel, Time start, Time stop);
+
+    /**
+     * Get the number of devices of the fleet, virtual or promoted.
+     *
+     * \return The number of devices.
+     */
+    uint32_t GetNDevices() const;
+
+    /**
+     * Get the position of a device.
+     *
+     * \param device The index of the device.
+     * \return The position.
+     */
+    Vector GetPosition(uint32_t device) const;
+
+    /**
+     * Get the data rate of a device.
+     *
+     * \param device The index of the device.
+     * \return The data rate.
+     */
+    uint8_t GetDataRate(uint32_t device) const;
+
+    /**
+     * Get the address of a device.
+     *
+     * \param device The index of the device.
+     * \return The address.
+     */
+    LoraDeviceAddress GetAddress(uint32_t device) const;
+
+    /**
+     * Get the number of uplinks sent by a virtual device so far.
+     *
+     * \param device The index of the device.
+     * \return The frame counter of the device.
+     */
+    uint16_t GetFCnt(uint32_t device) const;
+
+    /**
+     * Get the number of uplinks sent by the fleet so far.
+     *
+     * \return The number of uplinks.
+     */
+    uint64_t GetNSentPackets() const;
+
+    /**
+     * Get the number of uplinks the duty cycle blocked so far.
+     *
+     * \return The number of uplinks.
+     */
+    uint64_t GetNDutyCycleDrops() const;
+
+    /**
+     * Assign fixed random variable stream numbers to the random variables used
+     * by this helper.
+     *
+     * \param stream The first stream index to use.
+     * \return The number of stream indices assigned.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    /**
+     * Send the uplinks due, and schedule the next one.
+     */
+    void SendDue();
+
+    /**
+     * Send an uplink of a virtual device, if its duty cycle allows it.
+     *
+     * \param device The index of the device.
+     */
+    void SendUplink(uint32_t device);
+
+    /**
+     * Get the time of the next uplink of the fleet.
+     *
+     * \return The time, in time steps.
+     */
+    int64_t GetNextTimeStep() const;
+
+    /**
+     * Get the node id of the LoraTag of the uplinks of a device.
+     *
+     * \param device The index of the device.
+     * \return The node id.
+     */
+    uint16_t GetTagNodeId(uint32_t device) const;
+
+    Time m_period;                                       //!< The period of the uplinks
+    uint8_t m_packetSize;                                //!< The payload size [bytes]
+    double m_txPowerDbm;                                 //!< The power of the next devices [dBm]
+    double m_dutyCycle;                                  //!< The duty cycle of the devices
+    std::vector<double> m_frequencies;                   //!< The channels [MHz]
+    uint32_t m_addressBase;                              //!< The address of the first device
+    std::vector<Vector> m_positions;                     //!< The position of each device
+    std::vector<uint8_t> m_dataRates;                    //!< The data rate of each device
+    std::vector<int8_t> m_txPowers;                      //!< The power of each device [dBm]
+    std::vector<uint16_t> m_fCnts;                       //!< The frame counter of each device
+    std::vector<int64_t> m_offDutyEnds;                  //!< The end of each off time [steps]
+    std::vector<int64_t> m_offsets;                      //!< The offset of each device [steps]
+    std::vector<uint8_t> m_isVirtual;                    //!< Whether each device is not promoted
+    std::vector<uint32_t> m_order;                       //!< The virtual devices, by offset
+    uint32_t m_next;                                     //!< The next uplink, in m_order
+    int64_t m_periodStart;                               //!< The start of the period [steps]
+    int64_t m_stop;                                      //!< The end of the uplinks [steps]
+    uint32_t m_nodeIdBase;                               //!< The first node id of the LoraTags
+    Time m_durations[6];                                 //!< The duration of uplinks, by data rate
+    Ptr<LoraChannel> m_channel;                          //!< The channel
+    Ptr<ConstantPositionMobilityModel> m_senderMobility; //!< Places the uplinks
+    uint64_t m_nSent;                                    //!< The uplinks sent so far
+    uint64_t m_nDutyCycleDrops;                          //!< The uplinks the duty cycle blocked
+    Ptr<UniformRandomVariable> m_offsetRv;               //!< Draws the offsets of the uplinks
+    Ptr<UniformRandomVariable> m_channelRv;              //!< Draws the channel of each uplink
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_VIRTUAL_FLEET_H */
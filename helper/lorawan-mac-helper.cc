@@ -14,6 +14,8 @@
 #include "ns3/lora-net-device.h"
 #include "ns3/random-variable-stream.h"
 
+#include <cstdlib>
+
 namespace ns3
 {
 namespace lorawan
@@ -22,7 +24,8 @@ namespace lorawan
 NS_LOG_COMPONENT_DEFINE("LorawanMacHelper");
 
 LorawanMacHelper::LorawanMacHelper()
-    : m_region(LorawanMacHelper::EU)
+    : m_region(LorawanMacHelper::EU),
+      m_frequencySubBand(0)
 {
 }
 
@@ -44,6 +47,12 @@ LorawanMacHelper::SetDeviceType(enum DeviceType dt)
     case ED_A:
         m_mac.SetTypeId("ns3::ClassAEndDeviceLorawanMac");
         break;
+    case ED_B:
+        m_mac.SetTypeId("ns3::ClassBEndDeviceLorawanMac");
+        break;
+    case ED_C:
+        m_mac.SetTypeId("ns3::ClassCEndDeviceLorawanMac");
+        break;
     }
     m_deviceType = dt;
 }
@@ -62,6 +71,13 @@ LorawanMacHelper::SetRegion(enum LorawanMacHelper::Regions region)
     m_region = region;
 }
 
+void
+LorawanMacHelper::SetFrequencySubBand(int subBand)
+{
+    NS_ASSERT(subBand < 8);
+    m_frequencySubBand = subBand;
+}
+
 Ptr<LorawanMac>
 LorawanMacHelper::Create(Ptr<Node> node, Ptr<NetDevice> device) const
 {
@@ -69,14 +85,15 @@ LorawanMacHelper::Create(Ptr<Node> node, Ptr<NetDevice> device) const
     mac->SetDevice(device);
 
     // If we are operating on an end device, add an address to it
-    if (m_deviceType == ED_A && m_addrGen)
+    bool isEndDevice = (m_deviceType == ED_A || m_deviceType == ED_B || m_deviceType == ED_C);
+    if (isEndDevice && m_addrGen)
     {
         mac->GetObject<ClassAEndDeviceLorawanMac>()->SetDeviceAddress(m_addrGen->NextAddress());
     }
 
     // Add a basic list of channels based on the region where the device is
     // operating
-    if (m_deviceType == ED_A)
+    if (isEndDevice)
     {
         Ptr<ClassAEndDeviceLorawanMac> edMac = mac->GetObject<ClassAEndDeviceLorawanMac>();
         switch (m_region)
@@ -85,6 +102,11 @@ LorawanMacHelper::Create(Ptr<Node> node, Ptr<NetDevice> device) const
             ConfigureForEuRegion(edMac);
             break;
         }
+        case LorawanMacHelper::US:
+        case LorawanMacHelper::Australia: {
+            ConfigureForUsRegion(edMac);
+            break;
+        }
         case LorawanMacHelper::SingleChannel: {
             ConfigureForSingleChannelRegion(edMac);
             break;
@@ -108,6 +130,11 @@ LorawanMacHelper::Create(Ptr<Node> node, Ptr<NetDevice> device) const
             ConfigureForEuRegion(gwMac);
             break;
         }
+        case LorawanMacHelper::US:
+        case LorawanMacHelper::Australia: {
+            ConfigureForUsRegion(gwMac);
+            break;
+        }
         case LorawanMacHelper::SingleChannel: {
             ConfigureForSingleChannelRegion(gwMac);
             break;
@@ -351,6 +378,200 @@ LorawanMacHelper::ApplyCommonEuConfigurations(Ptr<LorawanMac> lorawanMac) const
 
 ///////////////////////////////
 
+void
+LorawanMacHelper::ConfigureForUsRegion(Ptr<ClassAEndDeviceLorawanMac> edMac) const
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    ApplyCommonUsConfigurations(edMac);
+
+    /////////////////////////////////////////////////////
+    // TxPower -> Transmission power in dBm conversion //
+    /////////////////////////////////////////////////////
+    edMac->SetTxDbmForTxPower(
+        std::vector<double>{30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2});
+
+    ////////////////////////////////////////////////////////////
+    // Matrix to know which data rate the gateway will respond with //
+    ////////////////////////////////////////////////////////////
+    LorawanMac::ReplyDataRateMatrix matrix;
+    if (m_region == LorawanMacHelper::US)
+    {
+        matrix = {{{{10, 9, 8, 8, 8, 8}},
+                   {{11, 10, 9, 8, 8, 8}},
+                   {{12, 11, 10, 9, 9, 9}},
+                   {{13, 12, 11, 10, 10, 10}},
+                   {{13, 13, 12, 11, 11, 11}},
+                   {{13, 13, 12, 11, 11, 11}},
+                   {{13, 13, 12, 11, 11, 11}},
+                   {{13, 13, 12, 11, 11, 11}}}};
+    }
+    else
+    {
+        matrix = {{{{8, 8, 8, 8, 8, 8}},
+                   {{9, 8, 8, 8, 8, 8}},
+                   {{10, 9, 8, 8, 8, 8}},
+                   {{11, 10, 9, 8, 8, 8}},
+                   {{12, 11, 10, 9, 8, 8}},
+                   {{13, 12, 11, 10, 9, 8}},
+                   {{13, 13, 12, 11, 10, 9}},
+                   {{13, 13, 12, 11, 10, 9}}}};
+    }
+    edMac->SetReplyDataRateMatrix(matrix);
+
+    /////////////////////
+    // Preamble length //
+    /////////////////////
+    edMac->SetNPreambleSymbols(8);
+
+    //////////////////////////////////////
+    // Second receive window parameters //
+    //////////////////////////////////////
+    edMac->SetSecondReceiveWindowDataRate(8);
+    edMac->SetSecondReceiveWindowFrequency(923.3);
+
+    //////////////////
+    // Channel mask //
+    //////////////////
+    if (m_frequencySubBand >= 0)
+    {
+        LogicalLoraChannelHelper::ChannelMask mask;
+        for (int i = 0; i < 8; i++)
+        {
+            mask.set(8 * m_frequencySubBand + i);
+        }
+        mask.set(64 + m_frequencySubBand);
+        LogicalLoraChannelHelper channelHelper = edMac->GetLogicalLoraChannelHelper();
+        channelHelper.SetChannelMask(mask);
+        edMac->SetLogicalLoraChannelHelper(channelHelper);
+    }
+}
+
+void
+LorawanMacHelper::ConfigureForUsRegion(Ptr<GatewayLorawanMac> gwMac) const
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    NS_ABORT_MSG_IF(m_frequencySubBand < 0, "A gateway listens to a single frequency sub-band");
+
+    ///////////////////////////////
+    // ReceivePath configuration //
+    ///////////////////////////////
+    Ptr<GatewayLoraPhy> gwPhy =
+        gwMac->GetDevice()->GetObject<LoraNetDevice>()->GetPhy()->GetObject<GatewayLoraPhy>();
+
+    ApplyCommonUsConfigurations(gwMac);
+
+    if (gwPhy) // If cast is successful, there's a GatewayLoraPhy
+    {
+        NS_LOG_DEBUG("Resetting reception paths");
+        gwPhy->ResetReceptionPaths();
+
+        // The 8 channels at 125 kHz and the channel at 500 kHz of the sub-band
+        std::vector<Ptr<LogicalLoraChannel>> channels =
+            gwMac->GetLogicalLoraChannelHelper().GetChannelList();
+        for (int i = 0; i < 8; i++)
+        {
+            gwPhy->AddFrequency(channels.at(8 * m_frequencySubBand + i)->GetFrequency());
+        }
+        gwPhy->AddFrequency(channels.at(64 + m_frequencySubBand)->GetFrequency());
+
+        int receptionPaths = 0;
+        int maxReceptionPaths = 8;
+        while (receptionPaths < maxReceptionPaths)
+        {
+            gwPhy->GetObject<GatewayLoraPhy>()->AddReceptionPath();
+            receptionPaths++;
+        }
+    }
+}
+
+void
+LorawanMacHelper::ApplyCommonUsConfigurations(Ptr<LorawanMac> lorawanMac) const
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    bool us = m_region == LorawanMacHelper::US;
+
+    //////////////
+    // SubBands //
+    //////////////
+
+    // No duty cycle: the regulations limit the dwell time instead
+    LogicalLoraChannelHelper channelHelper;
+    channelHelper.AddSubBand(us ? 902 : 915, 928, 1, 30);
+
+    //////////////////////
+    // Default channels //
+    //////////////////////
+
+    // 64 channels at 125 kHz, and 8 channels at 500 kHz
+    double first125kHz = us ? 902.3 : 915.2;
+    double first500kHz = us ? 903.0 : 915.9;
+    for (int i = 0; i < 64; i++)
+    {
+        channelHelper.AddChannel(
+            CreateObject<LogicalLoraChannel>(first125kHz + 0.2 * i, 0, us ? 3 : 5));
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        channelHelper.AddChannel(
+            CreateObject<LogicalLoraChannel>(first500kHz + 1.6 * i, us ? 4 : 6, us ? 4 : 6));
+    }
+
+    lorawanMac->SetLogicalLoraChannelHelper(channelHelper);
+
+    ///////////////////////////////////////////////////////////
+    // Data rate -> Spreading factor, Data rate -> Bandwidth //
+    // and Data rate -> MaxAppPayload conversions            //
+    ///////////////////////////////////////////////////////////
+    // Reserved data rates map to 0, so that they are rejected
+    if (us)
+    {
+        lorawanMac->SetSfForDataRate(
+            std::vector<uint8_t>{10, 9, 8, 7, 8, 0, 0, 0, 12, 11, 10, 9, 8, 7});
+        lorawanMac->SetBandwidthForDataRate(std::vector<double>{125000,
+                                                                125000,
+                                                                125000,
+                                                                125000,
+                                                                500000,
+                                                                0,
+                                                                0,
+                                                                0,
+                                                                500000,
+                                                                500000,
+                                                                500000,
+                                                                500000,
+                                                                500000,
+                                                                500000});
+        lorawanMac->SetMaxAppPayloadForDataRate(
+            std::vector<uint32_t>{11, 53, 125, 242, 242, 0, 0, 0, 53, 129, 242, 242, 242, 242});
+    }
+    else
+    {
+        lorawanMac->SetSfForDataRate(
+            std::vector<uint8_t>{12, 11, 10, 9, 8, 7, 8, 0, 12, 11, 10, 9, 8, 7});
+        lorawanMac->SetBandwidthForDataRate(std::vector<double>{125000,
+                                                                125000,
+                                                                125000,
+                                                                125000,
+                                                                125000,
+                                                                125000,
+                                                                500000,
+                                                                0,
+                                                                500000,
+                                                                500000,
+                                                                500000,
+                                                                500000,
+                                                                500000,
+                                                                500000});
+        lorawanMac->SetMaxAppPayloadForDataRate(
+            std::vector<uint32_t>{59, 59, 59, 123, 230, 230, 230, 0, 41, 117, 230, 230, 230, 230});
+    }
+}
+
+///////////////////////////////
+
 void
 LorawanMacHelper::ConfigureForSingleChannelRegion(Ptr<ClassAEndDeviceLorawanMac> edMac) const
 {
@@ -506,42 +727,20 @@ LorawanMacHelper::SetSpreadingFactorsUp(NodeContainer endDevices,
         Ptr<EndDeviceLoraPhy> edPhy = loraNetDevice->GetPhy()->GetObject<EndDeviceLoraPhy>();
         const double* edSensitivity = EndDeviceLoraPhy::sensitivity;
 
-        if (rxPower > *edSensitivity)
-        {
-            mac->SetDataRate(5);
-            sfQuantity[0] = sfQuantity[0] + 1;
-        }
-        else if (rxPower > *(edSensitivity + 1))
+        // Use the lowest spreading factor whose sensitivity the power is above,
+        // or SF12 if the device is out of range
+        uint8_t sf = 12;
+        for (uint8_t i = 0; i < 6; i++)
         {
-            mac->SetDataRate(4);
-            sfQuantity[1] = sfQuantity[1] + 1;
-        }
-        else if (rxPower > *(edSensitivity + 2))
-        {
-            mac->SetDataRate(3);
-            sfQuantity[2] = sfQuantity[2] + 1;
-        }
-        else if (rxPower > *(edSensitivity + 3))
-        {
-            mac->SetDataRate(2);
-            sfQuantity[3] = sfQuantity[3] + 1;
-        }
-        else if (rxPower > *(edSensitivity + 4))
-        {
-            mac->SetDataRate(1);
-            sfQuantity[4] = sfQuantity[4] + 1;
-        }
-        else if (rxPower > *(edSensitivity+5))
-        {
-            mac->SetDataRate (0);
-            sfQuantity[5] = sfQuantity[5] + 1;
-
-        }
-        else // Device is out of range. Assign SF12.
-        {
-            mac->SetDataRate (0);
-            sfQuantity[5] = sfQuantity[5] + 1;
+            if (rxPower > edSensitivity[i])
+            {
+                sf = 7 + i;
+                break;
+            }
         }
+        uint8_t dataRate = GetDataRateForSf(mac, sf);
+        mac->SetDataRate(dataRate);
+        sfQuantity[mac->GetSfFromDataRate(dataRate) - 7]++;
         /*
 
         // Get the Gw sensitivity
@@ -637,42 +836,54 @@ LorawanMacHelper::SetSpreadingFactorsGivenDistribution(NodeContainer endDevices,
         double prob = uniformRV->GetValue(0, 1);
 
         // NS_LOG_DEBUG ("Probability: " << prob);
-        if (prob < cumdistr[0])
-        {
-            mac->SetDataRate(5);
-            sfQuantity[0] = sfQuantity[0] + 1;
-        }
-        else if (prob > cumdistr[0] && prob < cumdistr[1])
+        uint8_t sf = 12;
+        for (uint8_t i = 0; i < 5; i++)
         {
-            mac->SetDataRate(4);
-            sfQuantity[1] = sfQuantity[1] + 1;
-        }
-        else if (prob > cumdistr[1] && prob < cumdistr[2])
-        {
-            mac->SetDataRate(3);
-            sfQuantity[2] = sfQuantity[2] + 1;
+            if (prob < cumdistr[i])
+            {
+                sf = 7 + i;
+                break;
+            }
         }
-        else if (prob > cumdistr[2] && prob < cumdistr[3])
+        uint8_t dataRate = GetDataRateForSf(mac, sf);
+        mac->SetDataRate(dataRate);
+        sfQuantity[mac->GetSfFromDataRate(dataRate) - 7]++;
+
+    } // end loop on nodes
+
+    return sfQuantity;
+
+} //  end function
+
+uint8_t
+LorawanMacHelper::GetDataRateForSf(Ptr<ClassAEndDeviceLorawanMac> mac, uint8_t sf)
+{
+    // Look for the 125 kHz data rate of the spreading factor in the data rates
+    // of the region of the device, or else for the closest spreading factor
+    const uint8_t maxDataRate = 16;
+    int closest = -1;
+    for (uint8_t dataRate = 0; dataRate < maxDataRate; dataRate++)
+    {
+        uint8_t drSf = mac->GetSfFromDataRate(dataRate);
+        if (drSf == 0 || mac->GetBandwidthFromDataRate(dataRate) != 125000)
         {
-            mac->SetDataRate(2);
-            sfQuantity[3] = sfQuantity[3] + 1;
+            continue;
         }
-        else if (prob > cumdistr[3] && prob < cumdistr[4])
+        if (drSf == sf)
         {
-            mac->SetDataRate(1);
-            sfQuantity[4] = sfQuantity[4] + 1;
+            return dataRate;
         }
-        else
+        if (closest < 0 || std::abs(drSf - sf) < std::abs(mac->GetSfFromDataRate(closest) - sf))
         {
-            mac->SetDataRate(0);
-            sfQuantity[5] = sfQuantity[5] + 1;
+            closest = dataRate;
         }
+    }
+    NS_ABORT_MSG_IF(closest < 0, "The region of the device has no 125 kHz uplink data rate");
 
-    } // end loop on nodes
-
-    return sfQuantity;
-
-} //  end function
+    NS_LOG_WARN("SF" << unsigned(sf) << " has no uplink data rate in the region of the device, "
+                     << "using SF" << unsigned(mac->GetSfFromDataRate(closest)));
+    return closest;
+}
 
 } // namespace lorawan
 } // namespace ns3
@@ -34,12 +34,15 @@ class LorawanMacHelper
 {
   public:
     /**
-     * Define the kind of device. Can be either GW (Gateway) or ED (End Device).
+     * Define the kind of device. Can be either GW (Gateway) or ED (End Device),
+     * of Class A, Class B or Class C.
      */
     enum DeviceType
     {
         GW,
-        ED_A
+        ED_A,
+        ED_B,
+        ED_C
     };
 
     /**
@@ -90,6 +93,20 @@ class LorawanMacHelper
      */
     void SetRegion(enum Regions region);
 
+    /**
+     * Set the frequency sub-band of the US and Australia regions, i.e., the
+     * group of 8 consecutive 125 kHz channels (plus the matching 500 kHz
+     * channel) out of 64 that the devices use.
+     *
+     * Gateways only listen to the channels of their sub-band, so that several
+     * gateways tuned to different sub-bands cover more channels. End devices
+     * only enable the channels of their sub-band, or all the channels if the
+     * sub-band is negative. Defaults to the first sub-band.
+     *
+     * \param subBand The index of the sub-band, from 0 to 7.
+     */
+    void SetFrequencySubBand(int subBand);
+
     /**
      * Create the LorawanMac instance and connect it to a device.
      *
@@ -128,6 +145,12 @@ class LorawanMacHelper
      * v[5] -> number of devices using DR0, in range of at least a gateway \n
      * v[6] -> number of devices using DR0, out of range                   \n
      *
+     * The data rates of the EU region are given for reference: each device is
+     * assigned the 125 kHz data rate of the spreading factor in its own region
+     * (e.g., DR3 for SF7 in the US region), or of the closest spreading factor
+     * if its region has none (e.g., SF10 for SF12 in the US region), and the
+     * counters are by spreading factor, from SF7.
+     *
      * \param endDevices The end devices to configure.
      * \param gateways The gateways to consider for RSSI measurements.
      * \param channel The radio channel to consider for RSSI measurements.
@@ -165,6 +188,12 @@ class LorawanMacHelper
      * v[5] -> number of devices using DR0 \n
      *
      *
+     * The data rates of the EU region are given for reference: each device is
+     * assigned the 125 kHz data rate of the spreading factor in its own region
+     * (e.g., DR3 for SF7 in the US region), or of the closest spreading factor
+     * if its region has none (e.g., SF10 for SF12 in the US region), and the
+     * counters are by spreading factor, from SF7.
+     *
      * \param endDevices The end devices to configure.
      * \param gateways The gateways in the network (this is only a placeholder parameter).
      * \param distribution The distribution (probability mass function) of DR assignment.
@@ -177,6 +206,16 @@ class LorawanMacHelper
                                                                  std::vector<double> distribution);
 
   private:
+    /**
+     * Get the 125 kHz data rate of a spreading factor in the region of a
+     * device, or of the closest spreading factor if there is none.
+     *
+     * \param mac The MAC layer of the device.
+     * \param sf The spreading factor.
+     * \return The data rate.
+     */
+    static uint8_t GetDataRateForSf(Ptr<ClassAEndDeviceLorawanMac> mac, uint8_t sf);
+
     /**
      * Perform region-specific configurations for the 868 MHz EU band.
      *
@@ -243,10 +282,35 @@ class LorawanMacHelper
      */
     void ApplyCommonAlohaConfigurations(Ptr<LorawanMac> lorawanMac) const;
 
+    /**
+     * Perform region-specific configurations for the US 902-928 MHz and
+     * Australia 915-928 MHz bands.
+     *
+     * \param edMac Pointer to the device MAC layer to configure.
+     */
+    void ConfigureForUsRegion(Ptr<ClassAEndDeviceLorawanMac> edMac) const;
+
+    /**
+     * Perform region-specific configurations for the US 902-928 MHz and
+     * Australia 915-928 MHz bands.
+     *
+     * \param gwMac Pointer to the gateway MAC layer to configure.
+     */
+    void ConfigureForUsRegion(Ptr<GatewayLorawanMac> gwMac) const;
+
+    /**
+     * Apply configurations that are common both for the GatewayLorawanMac and the
+     * ClassAEndDeviceLorawanMac classes.
+     *
+     * \param lorawanMac Pointer to the MAC layer to configure.
+     */
+    void ApplyCommonUsConfigurations(Ptr<LorawanMac> lorawanMac) const;
+
     ObjectFactory m_mac;                       //!< MAC-layer object factory
     Ptr<LoraDeviceAddressGenerator> m_addrGen; //!< Pointer to the address generator to use
     enum DeviceType m_deviceType;              //!< The kind of device to install
     enum Regions m_region;                     //!< The region in which the device will operate
+    int m_frequencySubBand;                    //!< The US and Australia frequency sub-band
 };
 
 } // namespace lorawan
@@ -10,7 +10,9 @@
 
 #include "ns3/double.h"
 #include "ns3/log.h"
+#include "ns3/lora-packet-pool.h"
 #include "ns3/one-shot-sender.h"
+#include "ns3/pointer.h"
 #include "ns3/simulator.h"
 #include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
@@ -25,6 +27,8 @@ NS_LOG_COMPONENT_DEFINE("OneShotSenderHelper");
 OneShotSenderHelper::OneShotSenderHelper()
 {
     m_factory.SetTypeId("ns3::OneShotSender");
+    // The apps installed by this helper share a pool
+    m_factory.Set("PacketPool", PointerValue(CreateObject<LoraPacketPool>()));
 }
 
 OneShotSenderHelper::~OneShotSenderHelper()
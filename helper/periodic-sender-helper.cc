@@ -10,7 +10,9 @@
 
 #include "ns3/double.h"
 #include "ns3/log.h"
+#include "ns3/lora-packet-pool.h"
 #include "ns3/periodic-sender.h"
+#include "ns3/pointer.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
 #include "ns3/string.h"
@@ -26,6 +28,8 @@ NS_LOG_COMPONENT_DEFINE("PeriodicSenderHelper");
 PeriodicSenderHelper::PeriodicSenderHelper()
 {
     m_factory.SetTypeId("ns3::PeriodicSender");
+    // The apps installed by this helper share a pool
+    m_factory.Set("PacketPool", PointerValue(CreateObject<LoraPacketPool>()));
 
     // m_factory.Set ("PacketSizeRandomVariable", StringValue
     //                  ("ns3::ParetoRandomVariable[Bound=10|Shape=2.5]"));
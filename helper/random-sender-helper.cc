@@ -20,6 +20,8 @@
 #include "ns3/random-sender-helper.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/random-sender.h"
+#include "ns3/lora-packet-pool.h"
+#include "ns3/pointer.h"
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
@@ -33,6 +35,8 @@ NS_LOG_COMPONENT_DEFINE ("RandomSenderHelper");
 
 RandomSenderHelper::RandomSenderHelper (){
 	m_factory.SetTypeId ("ns3::RandomSender");
+	// The apps installed by this helper share a pool
+	m_factory.Set ("PacketPool", PointerValue (CreateObject<LoraPacketPool> ()));
 
 	m_factory.Set ("PacketSize", StringValue
                    ("ns3::ParetoRandomVariable[Bound=10|Shape=2.5]"));
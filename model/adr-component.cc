@@ -8,6 +8,8 @@
 
 #include "adr-component.h"
 
+#include "lora-profiler.h"
+
 namespace ns3
 {
 namespace lorawan
@@ -76,6 +78,7 @@ AdrComponent::OnReceivedPacket(Ptr<const Packet> packet,
                                Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this->GetTypeId() << packet << networkStatus);
+    LORAWAN_PROFILE_SCOPE("AdrComponent::OnReceivedPacket");
 
     // We will only act just before reply, when all Gateways will have received
     // the packet, since we need their respective received power.
@@ -85,6 +88,7 @@ void
 AdrComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this << status << networkStatus);
+    LORAWAN_PROFILE_SCOPE("AdrComponent::BeforeSendingReply");
 
     Ptr<Packet> myPacket = status->GetLastPacketReceivedFromDevice()->Copy();
     LorawanMacHeader mHdr;
@@ -109,6 +113,15 @@ AdrComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus>
             // Get the spreading factor used by the device
             uint8_t spreadingFactor = status->GetFirstReceiveWindowSpreadingFactor();
 
+            // The algorithm uses the data rates, and the LinkAdrReq the default
+            // channels, of the EU region
+            Ptr<ClassAEndDeviceLorawanMac> mac = status->GetMac();
+            NS_ABORT_MSG_IF(mac->GetLogicalLoraChannelHelper().GetChannelList().size() > 16 ||
+                                mac->GetSfFromDataRate(SfToDr(spreadingFactor)) !=
+                                    spreadingFactor,
+                            "AdrComponent only supports the data rates and channels of the EU "
+                            "region");
+
             // Get the device transmission power (dBm)
             uint8_t transmissionPower = status->GetMac()->GetTransmissionPower();
 
@@ -163,6 +176,7 @@ void
 AdrComponent::OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this->GetTypeId() << networkStatus);
+    LORAWAN_PROFILE_SCOPE("AdrComponent::OnFailedReply");
 }
 
 void
@@ -15,6 +15,7 @@
 #include "end-device-lora-phy.h"
 #include "end-device-lorawan-mac.h"
 
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 
 #include <algorithm>
@@ -34,15 +35,26 @@ ClassAEndDeviceLorawanMac::GetTypeId()
     static TypeId tid = TypeId("ns3::ClassAEndDeviceLorawanMac")
                             .SetParent<EndDeviceLorawanMac>()
                             .SetGroupName("lorawan")
-                            .AddConstructor<ClassAEndDeviceLorawanMac>();
+                            .AddConstructor<ClassAEndDeviceLorawanMac>()
+                            .AddAttribute("LazyReceiveWindows",
+                                          "Whether to skip the receive window events after "
+                                          "uplinks that cannot be answered by the network "
+                                          "server and whose PHY state is not observed",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(
+                                              &ClassAEndDeviceLorawanMac::m_lazyReceiveWindows),
+                                          MakeBooleanChecker());
     return tid;
 }
 
 ClassAEndDeviceLorawanMac::ClassAEndDeviceLorawanMac()
-    : // LoraWAN default
+    : m_lazyReceiveWindows(false),
+      // LoraWAN default
       m_receiveDelay1(Seconds(1)),
       // LoraWAN default
       m_receiveDelay2(Seconds(2)),
+      m_firstReceiveWindowFrequency(0),
+      m_secondReceiveWindowDataRate(0),
       m_rx1DrOffset(0)
 {
     NS_LOG_FUNCTION(this);
@@ -54,6 +66,8 @@ ClassAEndDeviceLorawanMac::ClassAEndDeviceLorawanMac()
     m_closeSecondWindow.Cancel();
     m_secondReceiveWindow = EventId();
     m_secondReceiveWindow.Cancel();
+    m_skippedWindowsEnd = EventId();
+    m_skippedWindowsEnd.Cancel();
 }
 
 ClassAEndDeviceLorawanMac::~ClassAEndDeviceLorawanMac()
@@ -61,6 +75,30 @@ ClassAEndDeviceLorawanMac::~ClassAEndDeviceLorawanMac()
     NS_LOG_FUNCTION_NOARGS();
 }
 
+void
+ClassAEndDeviceLorawanMac::SetPhy(Ptr<LoraPhy> phy)
+{
+    LorawanMac::SetPhy(phy);
+
+    // Avoid an aggregate lookup at each receive window
+    m_edPhy = DynamicCast<EndDeviceLoraPhy>(phy);
+    NS_ASSERT_MSG(m_edPhy, "A Class A end device needs an EndDeviceLoraPhy.");
+}
+
+void
+ClassAEndDeviceLorawanMac::SetSfForDataRate(std::vector<uint8_t> sfForDataRate)
+{
+    LorawanMac::SetSfForDataRate(sfForDataRate);
+    RefreshReceiveWindowDurations();
+}
+
+void
+ClassAEndDeviceLorawanMac::SetBandwidthForDataRate(std::vector<double> bandwidthForDataRate)
+{
+    LorawanMac::SetBandwidthForDataRate(bandwidthForDataRate);
+    RefreshReceiveWindowDurations();
+}
+
 /////////////////////
 // Sending methods //
 /////////////////////
@@ -113,17 +151,8 @@ ClassAEndDeviceLorawanMac::SendToPhy(Ptr<Packet> packetToSend)
     // Prepare for the downlink //
     //////////////////////////////
 
-    // Switch the PHY to the channel so that it will listen here for downlink
-    m_phy->GetObject<EndDeviceLoraPhy>()->SetFrequency(txChannel->GetFrequency());
-
-    // Instruct the PHY on the right Spreading Factor to listen for during the window
-    // create a SetReplyDataRate function?
-    uint8_t replyDataRate = GetFirstReceiveWindowDataRate();
-    NS_LOG_DEBUG("m_dataRate: " << unsigned(m_dataRate)
-                                << ", m_rx1DrOffset: " << unsigned(m_rx1DrOffset)
-                                << ", replyDataRate: " << unsigned(replyDataRate) << ".");
-
-    m_phy->GetObject<EndDeviceLoraPhy>()->SetSpreadingFactor(GetSfFromDataRate(replyDataRate));
+    // The first receive window will listen for downlink on this channel
+    m_firstReceiveWindowFrequency = txChannel->GetFrequency();
 }
 
 //////////////////////////
@@ -229,7 +258,7 @@ ClassAEndDeviceLorawanMac::Receive(Ptr<const Packet> packet)
         }
     }
 
-    m_phy->GetObject<EndDeviceLoraPhy>()->SwitchToSleep();
+    EnterIdleState();
 }
 
 void
@@ -237,8 +266,8 @@ ClassAEndDeviceLorawanMac::FailedReception(Ptr<const Packet> packet)
 {
     NS_LOG_FUNCTION(this << packet);
 
-    // Switch to sleep after a failed reception
-    m_phy->GetObject<EndDeviceLoraPhy>()->SwitchToSleep();
+    // Go back to idle (sleep) after a failed reception
+    EnterIdleState();
 
     if (m_secondReceiveWindow.IsExpired() && m_retxParams.waitingAck)
     {
@@ -266,24 +295,99 @@ ClassAEndDeviceLorawanMac::TxFinished(Ptr<const Packet> packet)
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    // Schedule the opening of the first receive window
-    Simulator::Schedule(m_receiveDelay1, &ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow, this);
-
-    // Schedule the opening of the second receive window
-    m_secondReceiveWindow = Simulator::Schedule(m_receiveDelay2,
-                                                &ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow,
-                                                this);
-    // // Schedule the opening of the first receive window
-    // Simulator::Schedule (m_receiveDelay1,
-    //                      &ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow, this);
-    //
-    // // Schedule the opening of the second receive window
-    // m_secondReceiveWindow = Simulator::Schedule (m_receiveDelay2,
-    //                                              &ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow,
-    //                                              this);
-
-    // Switch the PHY to sleep
-    m_phy->GetObject<EndDeviceLoraPhy>()->SwitchToSleep();
+    m_txFinishedTime = Simulator::Now();
+
+    if (NeedsReceiveWindows())
+    {
+        // Schedule the opening of the first receive window
+        Simulator::Schedule(m_receiveDelay1,
+                            &ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow,
+                            this);
+
+        // Schedule the opening of the second receive window
+        m_secondReceiveWindow =
+            Simulator::Schedule(m_receiveDelay2,
+                                &ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow,
+                                this);
+    }
+    else
+    {
+        // Nothing can be received in the windows and nobody observes the PHY
+        // standing by: only keep track of the end of the second window
+        m_skippedWindowsEnd =
+            Simulator::Schedule(m_receiveDelay2 + m_secondReceiveWindowDuration,
+                                &ClassAEndDeviceLorawanMac::EndSkippedReceiveWindows,
+                                this);
+    }
+
+    // Switch the PHY to its idle state
+    EnterIdleState();
+}
+
+bool
+ClassAEndDeviceLorawanMac::NeedsReceiveWindows() const
+{
+    return !m_lazyReceiveWindows || m_retxParams.waitingAck || m_uplinkSolicitsReply ||
+           m_edPhy->HasListeners();
+}
+
+void
+ClassAEndDeviceLorawanMac::MaterializeReceiveWindows()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    if (m_skippedWindowsEnd.IsExpired())
+    {
+        // Windows are already scheduled, or are over
+        return;
+    }
+
+    Time elapsed = Simulator::Now() - m_txFinishedTime;
+
+    if (elapsed <= m_receiveDelay1)
+    {
+        Simulator::Schedule(m_receiveDelay1 - elapsed,
+                            &ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow,
+                            this);
+    }
+    else
+    {
+        NS_LOG_WARN("Too late to open the first receive window.");
+    }
+
+    if (elapsed <= m_receiveDelay2)
+    {
+        Simulator::Cancel(m_skippedWindowsEnd);
+        m_secondReceiveWindow =
+            Simulator::Schedule(m_receiveDelay2 - elapsed,
+                                &ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow,
+                                this);
+    }
+    else
+    {
+        NS_LOG_WARN("Too late to open the second receive window.");
+    }
+}
+
+void
+ClassAEndDeviceLorawanMac::EnterIdleState()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    m_edPhy->SwitchToSleep();
+}
+
+void
+ClassAEndDeviceLorawanMac::EndSkippedReceiveWindows()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    // Leave the PHY tuned as the second receive window would have
+    m_edPhy->SetFrequency(m_secondReceiveWindowFrequency);
+    m_edPhy->SetSpreadingFactor(GetSfFromDataRate(m_secondReceiveWindowDataRate));
+
+    // The PHY is asleep: this performs the end-of-window bookkeeping
+    CloseSecondReceiveWindow();
 }
 
 void
@@ -291,19 +395,42 @@ ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow()
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    // Set Phy in Standby mode
-    m_phy->GetObject<EndDeviceLoraPhy>()->SwitchToStandby();
+    // Check the Phy layer's state: a device that keeps listening after the
+    // uplink (e.g., Class C) may already be in standby, or locked on a
+    // downlink, which the window must not interrupt. Its EnterIdleState
+    // brings it back to continuous reception once the reception ends.
+    switch (m_edPhy->GetState())
+    {
+    case EndDeviceLoraPhy::RX:
+        NS_LOG_INFO("Won't open first receive window since we are in RX mode.");
+        return;
+    case EndDeviceLoraPhy::STANDBY:
+        // Already listening: only retune the PHY
+        break;
+    case EndDeviceLoraPhy::TX:
+    case EndDeviceLoraPhy::SLEEP:
+        // Set Phy in Standby mode
+        m_edPhy->SwitchToStandby();
+        break;
+    }
 
-    // Calculate the duration of a single symbol for the first receive window data rate
-    double tSym = pow(2, GetSfFromDataRate(GetFirstReceiveWindowDataRate())) /
-                  GetBandwidthFromDataRate(GetFirstReceiveWindowDataRate());
+    // Switch the PHY to the channel of the uplink, and instruct it on the right
+    // Spreading Factor to listen for during the window
+    uint8_t replyDataRate = GetFirstReceiveWindowDataRate();
+    NS_LOG_DEBUG("m_dataRate: " << unsigned(m_dataRate)
+                                << ", m_rx1DrOffset: " << unsigned(m_rx1DrOffset)
+                                << ", replyDataRate: " << unsigned(replyDataRate) << ".");
+
+    m_edPhy->SetFrequency(m_firstReceiveWindowFrequency);
+    m_edPhy->SetSpreadingFactor(GetSfFromDataRate(replyDataRate));
 
     // Schedule return to sleep after "at least the time required by the end
     // device's radio transceiver to effectively detect a downlink preamble"
     // (LoraWAN specification)
-    m_closeFirstWindow = Simulator::Schedule(Seconds(m_receiveWindowDurationInSymbols * tSym),
-                                             &ClassAEndDeviceLorawanMac::CloseFirstReceiveWindow,
-                                             this); // m_receiveWindowDuration
+    m_closeFirstWindow =
+        Simulator::Schedule(GetReceiveWindowDuration(replyDataRate),
+                            &ClassAEndDeviceLorawanMac::CloseFirstReceiveWindow,
+                            this);
 }
 
 void
@@ -311,14 +438,12 @@ ClassAEndDeviceLorawanMac::CloseFirstReceiveWindow()
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    Ptr<EndDeviceLoraPhy> phy = m_phy->GetObject<EndDeviceLoraPhy>();
-
     // Check the Phy layer's state:
     // - RX -> We are receiving a preamble.
     // - STANDBY -> Nothing was received.
     // - SLEEP -> We have received a packet.
     // We should never be in TX or SLEEP mode at this point
-    switch (phy->GetState())
+    switch (m_edPhy->GetState())
     {
     case EndDeviceLoraPhy::TX:
         NS_ABORT_MSG("PHY was in TX mode when attempting to close a receive window.");
@@ -330,7 +455,7 @@ ClassAEndDeviceLorawanMac::CloseFirstReceiveWindow()
         break;
     case EndDeviceLoraPhy::STANDBY:
         // Turn PHY layer to SLEEP
-        phy->SwitchToSleep();
+        EnterIdleState();
         break;
     }
 }
@@ -342,32 +467,31 @@ ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow()
 
     // Check for receiver status: if it's locked on a packet, don't open this
     // window at all.
-    if (m_phy->GetObject<EndDeviceLoraPhy>()->GetState() == EndDeviceLoraPhy::RX)
+    if (m_edPhy->GetState() == EndDeviceLoraPhy::RX)
     {
         NS_LOG_INFO("Won't open second receive window since we are in RX mode.");
 
         return;
     }
 
-    // Set Phy in Standby mode
-    m_phy->GetObject<EndDeviceLoraPhy>()->SwitchToStandby();
+    // Set Phy in Standby mode, unless it is already listening
+    if (m_edPhy->GetState() != EndDeviceLoraPhy::STANDBY)
+    {
+        m_edPhy->SwitchToStandby();
+    }
 
     // Switch to appropriate channel and data rate
     NS_LOG_INFO("Using parameters: " << m_secondReceiveWindowFrequency << "Hz, DR"
                                      << unsigned(m_secondReceiveWindowDataRate));
 
-    m_phy->GetObject<EndDeviceLoraPhy>()->SetFrequency(m_secondReceiveWindowFrequency);
-    m_phy->GetObject<EndDeviceLoraPhy>()->SetSpreadingFactor(
+    m_edPhy->SetFrequency(m_secondReceiveWindowFrequency);
+    m_edPhy->SetSpreadingFactor(
         GetSfFromDataRate(m_secondReceiveWindowDataRate));
 
-    // Calculate the duration of a single symbol for the second receive window data rate
-    double tSym = pow(2, GetSfFromDataRate(GetSecondReceiveWindowDataRate())) /
-                  GetBandwidthFromDataRate(GetSecondReceiveWindowDataRate());
-
     // Schedule return to sleep after "at least the time required by the end
     // device's radio transceiver to effectively detect a downlink preamble"
     // (LoraWAN specification)
-    m_closeSecondWindow = Simulator::Schedule(Seconds(m_receiveWindowDurationInSymbols * tSym),
+    m_closeSecondWindow = Simulator::Schedule(m_secondReceiveWindowDuration,
                                               &ClassAEndDeviceLorawanMac::CloseSecondReceiveWindow,
                                               this);
 }
@@ -377,15 +501,13 @@ ClassAEndDeviceLorawanMac::CloseSecondReceiveWindow()
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    Ptr<EndDeviceLoraPhy> phy = m_phy->GetObject<EndDeviceLoraPhy>();
-
-    // NS_ASSERT (phy->m_state != EndDeviceLoraPhy::TX &&
-    // phy->m_state != EndDeviceLoraPhy::SLEEP);
+    // NS_ASSERT (m_edPhy->m_state != EndDeviceLoraPhy::TX &&
+    // m_edPhy->m_state != EndDeviceLoraPhy::SLEEP);
 
     // Check the Phy layer's state:
     // - RX -> We have received a preamble.
     // - STANDBY -> Nothing was detected.
-    switch (phy->GetState())
+    switch (m_edPhy->GetState())
     {
     case EndDeviceLoraPhy::TX:
     case EndDeviceLoraPhy::SLEEP:
@@ -396,7 +518,7 @@ ClassAEndDeviceLorawanMac::CloseSecondReceiveWindow()
         return;
     case EndDeviceLoraPhy::STANDBY:
         // Turn PHY layer to sleep
-        phy->SwitchToSleep();
+        EnterIdleState();
         break;
     }
 
@@ -411,7 +533,7 @@ ClassAEndDeviceLorawanMac::CloseSecondReceiveWindow()
         }
 
         else if (m_retxParams.retxLeft == 0 &&
-                 m_phy->GetObject<EndDeviceLoraPhy>()->GetState() != EndDeviceLoraPhy::RX)
+                 m_edPhy->GetState() != EndDeviceLoraPhy::RX)
         {
             uint8_t txs = m_maxNumbTx - (m_retxParams.retxLeft);
             m_requiredTxCallback(txs, GetSfFromDataRate (m_dataRate), false, m_retxParams.firstAttempt, m_retxParams.packet);
@@ -453,17 +575,21 @@ ClassAEndDeviceLorawanMac::GetNextClassTransmissionDelay(Time waitingTime)
     // second receive window (if the second receive window has not closed yet)
     if (!m_retxParams.waitingAck)
     {
-        if (!m_closeFirstWindow.IsExpired() || !m_closeSecondWindow.IsExpired() ||
-            !m_secondReceiveWindow.IsExpired())
+        if (!m_skippedWindowsEnd.IsExpired())
+        {
+            NS_LOG_WARN(
+                "Attempting to send when there are receive windows: Transmission postponed.");
+            waitingTime =
+                std::max(waitingTime, Time(m_skippedWindowsEnd.GetTs()) - Simulator::Now());
+        }
+        else if (!m_closeFirstWindow.IsExpired() || !m_closeSecondWindow.IsExpired() ||
+                 !m_secondReceiveWindow.IsExpired())
         {
             NS_LOG_WARN(
                 "Attempting to send when there are receive windows: Transmission postponed.");
-            // Compute the duration of a single symbol for the second receive window data rate
-            double tSym = pow(2, GetSfFromDataRate(GetSecondReceiveWindowDataRate())) /
-                          GetBandwidthFromDataRate(GetSecondReceiveWindowDataRate());
             // Compute the closing time of the second receive window
-            Time endSecondRxWindow = Time(m_secondReceiveWindow.GetTs()) +
-                                     Seconds(m_receiveWindowDurationInSymbols * tSym);
+            Time endSecondRxWindow =
+                Time(m_secondReceiveWindow.GetTs()) + m_secondReceiveWindowDuration;
 
             NS_LOG_DEBUG("Duration until endSecondRxWindow for new transmission:"
                          << (endSecondRxWindow - Simulator::Now()).GetSeconds());
@@ -498,6 +624,7 @@ void
 ClassAEndDeviceLorawanMac::SetSecondReceiveWindowDataRate(uint8_t dataRate)
 {
     m_secondReceiveWindowDataRate = dataRate;
+    m_secondReceiveWindowDuration = GetReceiveWindowDuration(dataRate);
 }
 
 uint8_t
@@ -518,6 +645,43 @@ ClassAEndDeviceLorawanMac::GetSecondReceiveWindowFrequency() const
     return m_secondReceiveWindowFrequency;
 }
 
+void
+ClassAEndDeviceLorawanMac::RefreshReceiveWindowDurations()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    size_t nDataRates = std::min(m_sfForDataRate.size(), m_bandwidthForDataRate.size());
+    m_receiveWindowDurationForDataRate.assign(nDataRates, Seconds(0));
+    for (size_t dr = 0; dr < nDataRates; dr++)
+    {
+        // Duration of a single symbol at this data rate
+        double tSym = pow(2, m_sfForDataRate.at(dr)) / m_bandwidthForDataRate.at(dr);
+        m_receiveWindowDurationForDataRate.at(dr) =
+            Seconds(m_receiveWindowDurationInSymbols * tSym);
+    }
+
+    m_secondReceiveWindowDuration = GetReceiveWindowDuration(m_secondReceiveWindowDataRate);
+}
+
+bool
+ClassAEndDeviceLorawanMac::HasPendingReceiveWindows() const
+{
+    return !m_closeFirstWindow.IsExpired() || !m_secondReceiveWindow.IsExpired() ||
+           !m_closeSecondWindow.IsExpired();
+}
+
+Time
+ClassAEndDeviceLorawanMac::GetReceiveWindowDuration(uint8_t dataRate) const
+{
+    if (dataRate < m_receiveWindowDurationForDataRate.size())
+    {
+        return m_receiveWindowDurationForDataRate[dataRate];
+    }
+
+    NS_LOG_WARN("No receive window duration for DR" << unsigned(dataRate) << ".");
+    return Seconds(0);
+}
+
 /////////////////////////
 // MAC command methods //
 /////////////////////////
@@ -549,7 +713,7 @@ ClassAEndDeviceLorawanMac::OnRxClassParamSetupReq(Ptr<RxParamSetupReq> rxParamSe
     }
 
     // For now, don't check for validity of frequency
-    m_secondReceiveWindowDataRate = rx2DataRate;
+    SetSecondReceiveWindowDataRate(rx2DataRate);
     m_rx1DrOffset = rx1DrOffset;
     m_secondReceiveWindowFrequency = frequency;
 
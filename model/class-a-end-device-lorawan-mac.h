@@ -12,6 +12,7 @@
 #ifndef CLASS_A_END_DEVICE_LORAWAN_MAC_H
 #define CLASS_A_END_DEVICE_LORAWAN_MAC_H
 
+#include "end-device-lora-phy.h"    // EndDeviceLoraPhy
 #include "end-device-lorawan-mac.h" // EndDeviceLorawanMac
 #include "lora-frame-header.h"      // RxParamSetupReq
 #include "lorawan-mac.h"            // Packet
@@ -42,6 +43,34 @@ class ClassAEndDeviceLorawanMac : public EndDeviceLorawanMac
     ClassAEndDeviceLorawanMac();           //!< Default constructor
     ~ClassAEndDeviceLorawanMac() override; //!< Destructor
 
+    /**
+     * Set the underlying PHY layer, which is expected to be an EndDeviceLoraPhy.
+     *
+     * \param phy The phy layer.
+     */
+    void SetPhy(Ptr<LoraPhy> phy) override;
+
+    /**
+     * Set the vector to use to check up correspondence between spreading factor and data rate.
+     *
+     * This also refreshes the receive window durations.
+     *
+     * \param sfForDataRate A vector that contains at position i the spreading factor that
+     * should correspond to data rate i.
+     */
+    void SetSfForDataRate(std::vector<uint8_t> sfForDataRate) override;
+
+    /**
+     * Set the vector to use to check up correspondence between bandwidth and
+     * data rate.
+     *
+     * This also refreshes the receive window durations.
+     *
+     * \param bandwidthForDataRate A vector that contains at position i the
+     * bandwidth that should correspond to data rate i in this MAC's region.
+     */
+    void SetBandwidthForDataRate(std::vector<double> bandwidthForDataRate) override;
+
     /////////////////////
     // Sending methods //
     /////////////////////
@@ -91,6 +120,16 @@ class ClassAEndDeviceLorawanMac : public EndDeviceLorawanMac
      */
     void CloseSecondReceiveWindow();
 
+    /**
+     * Make sure the receive windows following the last uplink are opened.
+     *
+     * When the device runs in lazy receive window mode and skipped the windows
+     * of its last uplink, this schedules the ones that can still be opened on
+     * time. The network server calls this when it knows that a downlink is going
+     * to be sent to this device. Otherwise, this method does nothing.
+     */
+    void MaterializeReceiveWindows();
+
     /////////////////////////
     // Getters and Setters //
     /////////////////////////
@@ -155,7 +194,65 @@ class ClassAEndDeviceLorawanMac : public EndDeviceLorawanMac
      */
     void OnRxClassParamSetupReq(Ptr<RxParamSetupReq> rxParamSetupReq) override;
 
+  protected:
+    /**
+     * Put the PHY in the state it keeps outside transmissions and receive
+     * windows. This is SLEEP for Class A devices.
+     */
+    virtual void EnterIdleState();
+
+    /**
+     * Check whether one of the receive windows of the last uplink is open or
+     * still has to be opened.
+     *
+     * \return True if a receive window is pending.
+     */
+    bool HasPendingReceiveWindows() const;
+
+    /**
+     * Get the duration of a receive window opened at a certain data rate.
+     *
+     * \param dataRate The data rate of the receive window.
+     * \return The duration of the window.
+     */
+    Time GetReceiveWindowDuration(uint8_t dataRate) const;
+
+    Ptr<EndDeviceLoraPhy> m_edPhy; //!< The PHY layer, as an EndDeviceLoraPhy
+
   private:
+    /**
+     * Check whether the receive windows following the last uplink need to be
+     * simulated event by event.
+     *
+     * Windows can only be skipped in lazy mode, when no downlink can be expected
+     * for the last uplink and no listener is observing the PHY state.
+     *
+     * \return True if the windows need to be opened.
+     */
+    bool NeedsReceiveWindows() const;
+
+    /**
+     * Perform the operations of the end of the second receive window for an
+     * uplink whose receive windows were skipped.
+     */
+    void EndSkippedReceiveWindows();
+
+    /**
+     * Recompute the duration of a receive window for each data rate, and the
+     * duration of the second receive window.
+     */
+    void RefreshReceiveWindowDurations();
+
+    /**
+     * The duration of a receive window for each data rate, computed as
+     * m_receiveWindowDurationInSymbols symbols at the data rate's SF and bandwidth.
+     */
+    std::vector<Time> m_receiveWindowDurationForDataRate;
+
+    Time m_secondReceiveWindowDuration; //!< The duration of the second receive window
+
+    bool m_lazyReceiveWindows; //!< Whether to skip receive windows that cannot receive anything
+
     Time m_receiveDelay1; //!< The interval between when a packet is done sending and when the first
                           //!< receive window is opened.
 
@@ -187,6 +284,19 @@ class ClassAEndDeviceLorawanMac : public EndDeviceLorawanMac
      */
     EventId m_secondReceiveWindow;
 
+    /**
+     * The event marking the end of the second receive window of an uplink whose
+     * receive windows were skipped.
+     */
+    EventId m_skippedWindowsEnd;
+
+    Time m_txFinishedTime; //!< The time the last uplink transmission ended
+
+    /**
+     * The frequency to listen on for the first receive window.
+     */
+    double m_firstReceiveWindowFrequency;
+
     /**
      * The frequency to listen on for the second receive window.
      */
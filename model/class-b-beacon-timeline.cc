@@ -0,0 +1,249 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "class-b-beacon-timeline.h"
+
+#include "gateway-status.h"
+#include "lora-tag.h"
+
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/hash.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("ClassBBeaconTimeline");
+
+NS_OBJECT_ENSURE_REGISTERED(ClassBBeaconTimeline);
+
+/// The interval between two beacons, in ms
+static const int64_t BEACON_PERIOD_MS = 128000;
+/// The time reserved for the beacon at the start of a beacon period, in ms
+static const int64_t BEACON_RESERVED_MS = 2120;
+/// The duration of a ping slot, in ms
+static const int64_t SLOT_LENGTH_MS = 30;
+/// The number of ping slots in a beacon period
+static const uint32_t N_SLOTS = 4096;
+
+TypeId
+ClassBBeaconTimeline::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ClassBBeaconTimeline")
+            .SetParent<Object>()
+            .SetGroupName("lorawan")
+            .AddConstructor<ClassBBeaconTimeline>()
+            .AddAttribute("TransmitBeacons",
+                          "Whether the gateways transmit the beacons on the channel",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&ClassBBeaconTimeline::m_transmitBeacons),
+                          MakeBooleanChecker())
+            .AddAttribute("BeaconDataRate",
+                          "The data rate of the beacons",
+                          UintegerValue(3),
+                          MakeUintegerAccessor(&ClassBBeaconTimeline::m_beaconDataRate),
+                          MakeUintegerChecker<uint8_t>(0, 7))
+            .AddAttribute("BeaconFrequency",
+                          "The frequency of the beacons, in MHz",
+                          DoubleValue(869.525),
+                          MakeDoubleAccessor(&ClassBBeaconTimeline::m_beaconFrequency),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("BeaconSize",
+                          "The size of the beacon frame, in bytes",
+                          UintegerValue(17),
+                          MakeUintegerAccessor(&ClassBBeaconTimeline::m_beaconSize),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+ClassBBeaconTimeline::ClassBBeaconTimeline()
+    : m_started(false),
+      m_nBeacons(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ClassBBeaconTimeline::~ClassBBeaconTimeline()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+ClassBBeaconTimeline::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    Simulator::Cancel(m_nextBeacon);
+    m_pingSlotActions.clear();
+    m_status = nullptr;
+
+    Object::DoDispose();
+}
+
+void
+ClassBBeaconTimeline::SetNetworkStatus(Ptr<NetworkStatus> status)
+{
+    m_status = status;
+}
+
+void
+ClassBBeaconTimeline::Start()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_started)
+    {
+        return;
+    }
+    m_started = true;
+
+    // Beacons are aligned to multiples of the beacon period
+    int64_t period = MilliSeconds(BEACON_PERIOD_MS).GetTimeStep();
+    int64_t now = Simulator::Now().GetTimeStep();
+    Time firstBeacon = TimeStep((now + period - 1) / period * period);
+    m_nextBeacon = Simulator::Schedule(firstBeacon - Simulator::Now(),
+                                       &ClassBBeaconTimeline::EmitBeacon,
+                                       this);
+}
+
+bool
+ClassBBeaconTimeline::IsStarted() const
+{
+    return m_started;
+}
+
+uint32_t
+ClassBBeaconTimeline::GetPingOffset(uint32_t beaconTime,
+                                    LoraDeviceAddress address,
+                                    uint32_t pingPeriod)
+{
+    // Same input as the AES block of the specification: beacon time and
+    // device address, little endian
+    uint32_t devAddr = address.Get();
+    char buffer[8];
+    for (int i = 0; i < 4; i++)
+    {
+        buffer[i] = static_cast<char>((beaconTime >> (8 * i)) & 0xff);
+        buffer[4 + i] = static_cast<char>((devAddr >> (8 * i)) & 0xff);
+    }
+    uint32_t rand = Hash32(buffer, sizeof(buffer));
+
+    return (rand & 0xffff) % pingPeriod;
+}
+
+Time
+ClassBBeaconTimeline::GetNextPingSlot(LoraDeviceAddress address,
+                                      uint8_t periodicity,
+                                      Time after) const
+{
+    NS_LOG_FUNCTION(this << address << unsigned(periodicity) << after);
+
+    NS_ASSERT(periodicity <= 7);
+    uint32_t pingNb = 1 << (7 - periodicity);
+    uint32_t pingPeriod = N_SLOTS / pingNb;
+
+    int64_t period = MilliSeconds(BEACON_PERIOD_MS).GetTimeStep();
+    for (int64_t beacon = std::max(after.GetTimeStep(), int64_t(0)) / period;; beacon++)
+    {
+        Time beaconStart = TimeStep(beacon * period);
+        uint32_t offset =
+            GetPingOffset(static_cast<uint32_t>(beaconStart.GetSeconds()), address, pingPeriod);
+        for (uint32_t n = 0; n < pingNb; n++)
+        {
+            Time slotStart =
+                beaconStart +
+                MilliSeconds(BEACON_RESERVED_MS + SLOT_LENGTH_MS * (offset + n * pingPeriod));
+            if (slotStart >= after)
+            {
+                return slotStart;
+            }
+        }
+    }
+}
+
+void
+ClassBBeaconTimeline::ScheduleAtPingSlot(Time slotStart, Callback<void> action)
+{
+    NS_LOG_FUNCTION(this << slotStart);
+
+    NS_ASSERT(slotStart >= Simulator::Now());
+
+    auto it = m_pingSlotActions.find(slotStart);
+    if (it == m_pingSlotActions.end())
+    {
+        // First action in this slot
+        it = m_pingSlotActions.emplace(slotStart, std::vector<Callback<void>>()).first;
+        Simulator::Schedule(slotStart - Simulator::Now(),
+                            &ClassBBeaconTimeline::ProcessPingSlot,
+                            this,
+                            slotStart);
+    }
+    it->second.push_back(action);
+}
+
+uint32_t
+ClassBBeaconTimeline::GetNBeacons() const
+{
+    return m_nBeacons;
+}
+
+void
+ClassBBeaconTimeline::EmitBeacon()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_nBeacons++;
+    NS_LOG_DEBUG("Beacon " << m_nBeacons);
+
+    if (m_transmitBeacons && m_status)
+    {
+        for (const auto& gw : m_status->m_gatewayStatuses)
+        {
+            Ptr<Packet> beacon = Create<Packet>(m_beaconSize);
+            LoraTag tag;
+            tag.SetDataRate(m_beaconDataRate);
+            tag.SetFrequency(m_beaconFrequency);
+            beacon->AddPacketTag(tag);
+
+            // Beacons are generated by the gateways themselves, on their own
+            // GPS-synchronized clock
+            gw.second->GetGatewayMac()->Send(beacon);
+        }
+    }
+
+    m_nextBeacon = Simulator::Schedule(MilliSeconds(BEACON_PERIOD_MS),
+                                       &ClassBBeaconTimeline::EmitBeacon,
+                                       this);
+}
+
+void
+ClassBBeaconTimeline::ProcessPingSlot(Time slotStart)
+{
+    NS_LOG_FUNCTION(this << slotStart);
+
+    auto it = m_pingSlotActions.find(slotStart);
+    if (it == m_pingSlotActions.end())
+    {
+        return;
+    }
+
+    // Actions may register new ones
+    std::vector<Callback<void>> actions = std::move(it->second);
+    m_pingSlotActions.erase(it);
+    for (auto& action : actions)
+    {
+        action();
+    }
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,153 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef CLASS_B_BEACON_TIMELINE_H
+#define CLASS_B_BEACON_TIMELINE_H
+
+#include "lora-device-address.h"
+#include "network-status.h"
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * The network-wide timeline of Class B beacons and ping slots.
+ *
+ * The gateways of the network emit a beacon every beacon period (128 s). After
+ * the beacon reserved time, the rest of the period is divided into 4096 slots of
+ * 30 ms. A device with ping slot periodicity p opens a ping slot every
+ * pingPeriod = 2^(5 + p) slots, starting from a pseudo-random offset that
+ * depends on the beacon time and on the device address, and changes at every
+ * beacon period.
+ *
+ * All the devices of the network share this timeline: it schedules one event
+ * per beacon period and one event per ping slot carrying at least one
+ * downlink, rather than per-device periodic timers. The number of events
+ * therefore depends on the downlink traffic, not on the number of Class B
+ * devices.
+ */
+class ClassBBeaconTimeline : public Object
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    ClassBBeaconTimeline();           //!< Default constructor
+    ~ClassBBeaconTimeline() override; //!< Destructor
+
+    /**
+     * Set the NetworkStatus object used to reach the gateways.
+     *
+     * \param status A pointer to the NetworkStatus object.
+     */
+    void SetNetworkStatus(Ptr<NetworkStatus> status);
+
+    /**
+     * Start emitting beacons, from the next beacon time on. Calling this
+     * method again has no effect.
+     */
+    void Start();
+
+    /**
+     * Check whether the timeline was started.
+     *
+     * \return True if beacons are being emitted.
+     */
+    bool IsStarted() const;
+
+    /**
+     * Compute the offset of the first ping slot of a device in a beacon period.
+     *
+     * The LoRaWAN specification derives the offset from the AES encryption of
+     * the beacon time and of the device address with a null key. Since the
+     * simulator does not model encryption, a 32-bit hash of the same fields is
+     * used instead: the offset is still deterministic, uniformly spread and
+     * different at every beacon period.
+     *
+     * \param beaconTime The time of the beacon, in seconds.
+     * \param address The address of the device.
+     * \param pingPeriod The number of slots between two ping slots.
+     * \return The offset, between 0 and pingPeriod - 1.
+     */
+    static uint32_t GetPingOffset(uint32_t beaconTime,
+                                  LoraDeviceAddress address,
+                                  uint32_t pingPeriod);
+
+    /**
+     * Get the start of the first ping slot of a device that does not start
+     * before a certain time.
+     *
+     * \param address The address of the device.
+     * \param periodicity The ping slot periodicity of the device.
+     * \param after The earliest start of the ping slot.
+     * \return The start of the ping slot.
+     */
+    Time GetNextPingSlot(LoraDeviceAddress address, uint8_t periodicity, Time after) const;
+
+    /**
+     * Register an action to be performed at the start of a ping slot.
+     *
+     * Actions registered for the same ping slot share a single event.
+     *
+     * \param slotStart The start of the ping slot.
+     * \param action The action.
+     */
+    void ScheduleAtPingSlot(Time slotStart, Callback<void> action);
+
+    /**
+     * Get the number of beacon periods that started since the timeline was
+     * started.
+     *
+     * \return The number of beacons.
+     */
+    uint32_t GetNBeacons() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * Emit a beacon through every gateway, and schedule the next one.
+     */
+    void EmitBeacon();
+
+    /**
+     * Perform the actions registered for a ping slot.
+     *
+     * \param slotStart The start of the ping slot.
+     */
+    void ProcessPingSlot(Time slotStart);
+
+    Ptr<NetworkStatus> m_status; //!< The status of the network
+    bool m_transmitBeacons;      //!< Whether the gateways transmit the beacons on the channel
+    uint8_t m_beaconDataRate;    //!< The data rate of the beacons
+    double m_beaconFrequency;    //!< The frequency of the beacons, in MHz
+    uint32_t m_beaconSize;       //!< The size of the beacon frame, in bytes
+
+    bool m_started;       //!< Whether the timeline was started
+    uint32_t m_nBeacons;  //!< The number of beacons since the start
+    EventId m_nextBeacon; //!< The next beacon
+
+    std::map<Time, std::vector<Callback<void>>> m_pingSlotActions; //!< Actions by ping slot
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* CLASS_B_BEACON_TIMELINE_H */
@@ -0,0 +1,113 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "class-b-end-device-lorawan-mac.h"
+
+#include "end-device-lora-phy.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("ClassBEndDeviceLorawanMac");
+
+NS_OBJECT_ENSURE_REGISTERED(ClassBEndDeviceLorawanMac);
+
+TypeId
+ClassBEndDeviceLorawanMac::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ClassBEndDeviceLorawanMac")
+            .SetParent<ClassAEndDeviceLorawanMac>()
+            .SetGroupName("lorawan")
+            .AddConstructor<ClassBEndDeviceLorawanMac>()
+            .AddAttribute("PingSlotPeriodicity",
+                          "The device opens 2^(7 - PingSlotPeriodicity) ping slots per "
+                          "beacon period",
+                          UintegerValue(7),
+                          MakeUintegerAccessor(&ClassBEndDeviceLorawanMac::m_pingSlotPeriodicity),
+                          MakeUintegerChecker<uint8_t>(0, 7))
+            .AddAttribute("PingSlotDataRate",
+                          "The data rate of the ping slots",
+                          UintegerValue(3),
+                          MakeUintegerAccessor(&ClassBEndDeviceLorawanMac::m_pingSlotDataRate),
+                          MakeUintegerChecker<uint8_t>(0, 7))
+            .AddAttribute("PingSlotFrequency",
+                          "The frequency of the ping slots, in MHz",
+                          DoubleValue(869.525),
+                          MakeDoubleAccessor(&ClassBEndDeviceLorawanMac::m_pingSlotFrequency),
+                          MakeDoubleChecker<double>());
+    return tid;
+}
+
+ClassBEndDeviceLorawanMac::ClassBEndDeviceLorawanMac()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ClassBEndDeviceLorawanMac::~ClassBEndDeviceLorawanMac()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+bool
+ClassBEndDeviceLorawanMac::OpenPingSlot()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    // Class A windows take precedence over ping slots
+    if (m_edPhy->GetState() != EndDeviceLoraPhy::SLEEP || HasPendingReceiveWindows())
+    {
+        NS_LOG_DEBUG("PHY is busy: skipping the ping slot.");
+        return false;
+    }
+
+    m_edPhy->SwitchToStandby();
+    m_edPhy->SetFrequency(m_pingSlotFrequency);
+    m_edPhy->SetSpreadingFactor(GetSfFromDataRate(m_pingSlotDataRate));
+
+    m_closePingSlot = Simulator::Schedule(GetReceiveWindowDuration(m_pingSlotDataRate),
+                                          &ClassBEndDeviceLorawanMac::ClosePingSlot,
+                                          this);
+    return true;
+}
+
+void
+ClassBEndDeviceLorawanMac::ClosePingSlot()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    // If a reception started, the device goes back to sleep when it ends
+    if (m_edPhy->GetState() == EndDeviceLoraPhy::STANDBY)
+    {
+        EnterIdleState();
+    }
+}
+
+uint8_t
+ClassBEndDeviceLorawanMac::GetPingSlotPeriodicity() const
+{
+    return m_pingSlotPeriodicity;
+}
+
+uint8_t
+ClassBEndDeviceLorawanMac::GetPingSlotDataRate() const
+{
+    return m_pingSlotDataRate;
+}
+
+double
+ClassBEndDeviceLorawanMac::GetPingSlotFrequency() const
+{
+    return m_pingSlotFrequency;
+}
+
+} /* namespace lorawan */
+} /* namespace ns3 */
@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef CLASS_B_END_DEVICE_LORAWAN_MAC_H
+#define CLASS_B_END_DEVICE_LORAWAN_MAC_H
+
+#include "class-a-end-device-lorawan-mac.h" // ClassAEndDeviceLorawanMac
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Class representing the MAC layer of a Class B LoRaWAN device.
+ *
+ * On top of the Class A receive windows, Class B devices synchronize to the
+ * beacons emitted by the gateways and open short ping slots at instants derived
+ * from the beacon time and their address (see ClassBBeaconTimeline). The
+ * network server can reach them in the next ping slot instead of waiting for
+ * an uplink.
+ *
+ * Devices do not keep periodic timers of their own: the beacon timeline of the
+ * network server opens the ping slots that carry a downlink. The empty ping
+ * slots, in which the device would go back to sleep after a few symbols
+ * without receiving anything, are not simulated.
+ */
+class ClassBEndDeviceLorawanMac : public ClassAEndDeviceLorawanMac
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    ClassBEndDeviceLorawanMac();           //!< Default constructor
+    ~ClassBEndDeviceLorawanMac() override; //!< Destructor
+
+    /**
+     * Open a ping slot, if the device is not already busy transmitting or in a
+     * Class A receive window.
+     *
+     * \return True if the slot was opened.
+     */
+    bool OpenPingSlot();
+
+    /**
+     * Get the ping slot periodicity: the device opens 2^(7 - periodicity) ping
+     * slots per beacon period.
+     *
+     * \return The periodicity, between 0 and 7.
+     */
+    uint8_t GetPingSlotPeriodicity() const;
+
+    /**
+     * Get the data rate of the ping slots.
+     *
+     * \return The data rate.
+     */
+    uint8_t GetPingSlotDataRate() const;
+
+    /**
+     * Get the frequency of the ping slots.
+     *
+     * \return The frequency, in MHz.
+     */
+    double GetPingSlotFrequency() const;
+
+  private:
+    /**
+     * Close the ping slot, unless a reception is ongoing.
+     */
+    void ClosePingSlot();
+
+    uint8_t m_pingSlotPeriodicity; //!< The ping slot periodicity
+    uint8_t m_pingSlotDataRate;    //!< The data rate of the ping slots
+    double m_pingSlotFrequency;    //!< The frequency of the ping slots, in MHz
+
+    EventId m_closePingSlot; //!< The event closing the ongoing ping slot
+
+}; /* ClassBEndDeviceLorawanMac */
+} /* namespace lorawan */
+} /* namespace ns3 */
+#endif /* CLASS_B_END_DEVICE_LORAWAN_MAC_H */
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#include "class-c-end-device-lorawan-mac.h"
+
+#include "end-device-lora-phy.h"
+#include "lora-frame-header.h"
+#include "lorawan-mac-header.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("ClassCEndDeviceLorawanMac");
+
+NS_OBJECT_ENSURE_REGISTERED(ClassCEndDeviceLorawanMac);
+
+TypeId
+ClassCEndDeviceLorawanMac::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::ClassCEndDeviceLorawanMac")
+            .SetParent<ClassAEndDeviceLorawanMac>()
+            .SetGroupName("lorawan")
+            .AddConstructor<ClassCEndDeviceLorawanMac>()
+            .AddTraceSource(
+                "ReceivedMulticast",
+                "Trace source that is fired when a multicast downlink is received",
+                MakeTraceSourceAccessor(&ClassCEndDeviceLorawanMac::m_receivedMulticast),
+                "ns3::lorawan::ClassCEndDeviceLorawanMac::ReceivedMulticastTracedCallback");
+    return tid;
+}
+
+ClassCEndDeviceLorawanMac::ClassCEndDeviceLorawanMac()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ClassCEndDeviceLorawanMac::~ClassCEndDeviceLorawanMac()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+void
+ClassCEndDeviceLorawanMac::SetPhy(Ptr<LoraPhy> phy)
+{
+    ClassAEndDeviceLorawanMac::SetPhy(phy);
+
+    // Start listening once the device is fully configured
+    Simulator::Cancel(m_startListening);
+    m_startListening =
+        Simulator::ScheduleNow(&ClassCEndDeviceLorawanMac::EnterIdleState, this);
+}
+
+void
+ClassCEndDeviceLorawanMac::SendToPhy(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+
+    if (m_edPhy->GetState() == EndDeviceLoraPhy::RX)
+    {
+        NS_LOG_INFO("PHY is receiving: transmission postponed to the end of the reception.");
+        if (m_pendingUplink)
+        {
+            NS_LOG_WARN("Replacing an uplink that was waiting for the end of a reception.");
+        }
+        m_pendingUplink = packet;
+        return;
+    }
+
+    ClassAEndDeviceLorawanMac::SendToPhy(packet);
+}
+
+void
+ClassCEndDeviceLorawanMac::Receive(Ptr<const Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+
+    // Look for downlinks addressed to one of our multicast groups
+    Ptr<Packet> packetCopy = packet->Copy();
+    LorawanMacHeader mHdr;
+    packetCopy->RemoveHeader(mHdr);
+
+    if (!mHdr.IsUplink())
+    {
+        LoraFrameHeader fHdr;
+        fHdr.SetAsDownlink();
+        packetCopy->RemoveHeader(fHdr);
+
+        if (IsMulticastMember(fHdr.GetAddress()))
+        {
+            NS_LOG_INFO("Received a downlink for multicast group " << fHdr.GetAddress());
+
+            // Multicast downlinks carry no MAC commands and are never
+            // acknowledged: just notify the reception
+            m_receivedPacket(packet);
+            m_receivedMulticast(packet, fHdr.GetAddress(), fHdr.GetFCnt());
+
+            EnterIdleState();
+            SendPendingUplink();
+            return;
+        }
+    }
+
+    ClassAEndDeviceLorawanMac::Receive(packet);
+    SendPendingUplink();
+}
+
+void
+ClassCEndDeviceLorawanMac::FailedReception(Ptr<const Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+
+    ClassAEndDeviceLorawanMac::FailedReception(packet);
+    SendPendingUplink();
+}
+
+void
+ClassCEndDeviceLorawanMac::AddMulticastAddress(LoraDeviceAddress groupAddress)
+{
+    NS_LOG_FUNCTION(this << groupAddress);
+
+    m_multicastAddresses.insert(groupAddress);
+}
+
+bool
+ClassCEndDeviceLorawanMac::IsMulticastMember(LoraDeviceAddress groupAddress) const
+{
+    return m_multicastAddresses.find(groupAddress) != m_multicastAddresses.end();
+}
+
+void
+ClassCEndDeviceLorawanMac::EnterIdleState()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    // The PHY will come back here at the end of the transmission or reception
+    EndDeviceLoraPhy::State state = m_edPhy->GetState();
+    if (state == EndDeviceLoraPhy::TX || state == EndDeviceLoraPhy::RX)
+    {
+        return;
+    }
+
+    // Listen continuously with the second receive window parameters
+    m_edPhy->SwitchToStandby();
+    m_edPhy->SetFrequency(GetSecondReceiveWindowFrequency());
+    m_edPhy->SetSpreadingFactor(GetSfFromDataRate(GetSecondReceiveWindowDataRate()));
+}
+
+void
+ClassCEndDeviceLorawanMac::SendPendingUplink()
+{
+    if (!m_pendingUplink || m_edPhy->GetState() == EndDeviceLoraPhy::TX ||
+        m_edPhy->GetState() == EndDeviceLoraPhy::RX)
+    {
+        return;
+    }
+
+    NS_LOG_INFO("Sending the uplink postponed by a reception.");
+    Ptr<Packet> packet = m_pendingUplink;
+    m_pendingUplink = nullptr;
+    ClassAEndDeviceLorawanMac::SendToPhy(packet);
+}
+
+} /* namespace lorawan */
+} /* namespace ns3 */
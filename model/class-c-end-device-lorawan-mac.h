@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef CLASS_C_END_DEVICE_LORAWAN_MAC_H
+#define CLASS_C_END_DEVICE_LORAWAN_MAC_H
+
+#include "class-a-end-device-lorawan-mac.h" // ClassAEndDeviceLorawanMac
+#include "lora-device-address.h"
+
+#include "ns3/traced-callback.h"
+
+#include <set>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Class representing the MAC layer of a Class C LoRaWAN device.
+ *
+ * Class C devices open the same receive windows as Class A devices after each
+ * uplink but, instead of sleeping, keep listening with the second receive
+ * window parameters whenever they are not transmitting or receiving. They can
+ * also be members of multicast groups: downlinks addressed to one of the group
+ * addresses of the device are accepted as well as unicast ones.
+ */
+class ClassCEndDeviceLorawanMac : public ClassAEndDeviceLorawanMac
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    ClassCEndDeviceLorawanMac();           //!< Default constructor
+    ~ClassCEndDeviceLorawanMac() override; //!< Destructor
+
+    /**
+     * TracedCallback signature for the reception of multicast downlinks.
+     *
+     * \param packet The received packet.
+     * \param groupAddress The multicast address the packet was sent to.
+     * \param fCnt The frame counter of the downlink.
+     */
+    typedef void (*ReceivedMulticastTracedCallback)(Ptr<const Packet> packet,
+                                                    LoraDeviceAddress groupAddress,
+                                                    uint16_t fCnt);
+
+    /**
+     * Set the underlying PHY layer, and start listening as soon as the
+     * simulation starts.
+     *
+     * \param phy The phy layer.
+     */
+    void SetPhy(Ptr<LoraPhy> phy) override;
+
+    /**
+     * Add headers and send a packet with the sending function of the physical layer.
+     *
+     * If the PHY is busy receiving a downlink, the transmission is started as
+     * soon as the reception ends.
+     *
+     * \param packet The packet to send.
+     */
+    void SendToPhy(Ptr<Packet> packet) override;
+
+    /**
+     * Receive a packet, either unicast or addressed to one of the multicast
+     * groups of this device.
+     *
+     * \param packet The received packet.
+     */
+    void Receive(Ptr<const Packet> packet) override;
+
+    void FailedReception(Ptr<const Packet> packet) override;
+
+    /**
+     * Make this device a member of a multicast group.
+     *
+     * \param groupAddress The address of the multicast group.
+     */
+    void AddMulticastAddress(LoraDeviceAddress groupAddress);
+
+    /**
+     * Check whether this device is a member of a multicast group.
+     *
+     * \param groupAddress The address of the multicast group.
+     * \return True if the device belongs to the group.
+     */
+    bool IsMulticastMember(LoraDeviceAddress groupAddress) const;
+
+  protected:
+    /**
+     * Keep listening with the second receive window parameters.
+     */
+    void EnterIdleState() override;
+
+  private:
+    /**
+     * Send the uplink that was postponed because the PHY was receiving, if any.
+     */
+    void SendPendingUplink();
+
+    std::set<LoraDeviceAddress> m_multicastAddresses; //!< The multicast groups of this device
+
+    Ptr<Packet> m_pendingUplink; //!< Uplink waiting for the end of a reception
+
+    EventId m_startListening; //!< The event starting continuous reception
+
+    /**
+     * The trace source fired when a multicast downlink is received.
+     */
+    TracedCallback<Ptr<const Packet>, LoraDeviceAddress, uint16_t> m_receivedMulticast;
+
+}; /* ClassCEndDeviceLorawanMac */
+} /* namespace lorawan */
+} /* namespace ns3 */
+#endif /* CLASS_C_END_DEVICE_LORAWAN_MAC_H */
@@ -42,6 +42,23 @@ CorrelatedShadowingPropagationLossModel::CorrelatedShadowingPropagationLossModel
 {
 }
 
+uint32_t
+CorrelatedShadowingPropagationLossModel::GetNShadowingMaps() const
+{
+    return m_shadowingGrid.size();
+}
+
+uint64_t
+CorrelatedShadowingPropagationLossModel::GetNShadowingValues() const
+{
+    uint64_t nValues = 0;
+    for (const auto& [square, shadowingMap] : m_shadowingGrid)
+    {
+        nValues += shadowingMap->GetSize();
+    }
+    return nValues;
+}
+
 double
 CorrelatedShadowingPropagationLossModel::DoCalcRxPower(double txPowerDbm,
                                                        Ptr<MobilityModel> a,
@@ -246,6 +263,12 @@ CorrelatedShadowingPropagationLossModel::ShadowingMap::GetLoss(
     return m_shadowingMap[position];
 }
 
+uint32_t
+CorrelatedShadowingPropagationLossModel::ShadowingMap::GetSize() const
+{
+    return m_shadowingMap.size();
+}
+
 /*****************************
  *  Position Implementation  *
  *****************************/
@@ -104,6 +104,14 @@ class CorrelatedShadowingPropagationLossModel : public PropagationLossModel
          */
         double GetLoss(CorrelatedShadowingPropagationLossModel::Position position);
 
+        /**
+         * Get the number of shadowing values in the map, including those of
+         * the grid.
+         *
+         * \return The number of values.
+         */
+        uint32_t GetSize() const;
+
       private:
         /**
          * For each Position, this map gives a corresponding loss.
@@ -139,6 +147,20 @@ class CorrelatedShadowingPropagationLossModel : public PropagationLossModel
 
     CorrelatedShadowingPropagationLossModel(); //!< Default constructor
 
+    /**
+     * Get the number of squares of the grid with a ShadowingMap.
+     *
+     * \return The number of shadowing maps.
+     */
+    uint32_t GetNShadowingMaps() const;
+
+    /**
+     * Get the number of shadowing values kept by all the ShadowingMaps.
+     *
+     * \return The number of values.
+     */
+    uint64_t GetNShadowingValues() const;
+
   private:
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
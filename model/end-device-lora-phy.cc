@@ -205,5 +205,11 @@ EndDeviceLoraPhy::UnregisterListener(EndDeviceLoraPhyListener* listener)
     }
 }
 
+bool
+EndDeviceLoraPhy::HasListeners() const
+{
+    return !m_listeners.empty();
+}
+
 } // namespace lorawan
 } // namespace ns3
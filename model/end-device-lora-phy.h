@@ -223,6 +223,14 @@ class EndDeviceLoraPhy : public LoraPhy
      */
     void UnregisterListener(EndDeviceLoraPhyListener* listener);
 
+    /**
+     * Whether any object (e.g., an energy model) is listening to the state
+     * changes of this PHY.
+     *
+     * \return True if at least one listener is registered.
+     */
+    bool HasListeners() const;
+
     static const double sensitivity[6]; //!< The sensitivity vector of this device to different SFs
 
   protected:
@@ -13,6 +13,7 @@
 
 #include "class-a-end-device-lorawan-mac.h"
 #include "end-device-lora-phy.h"
+#include "lora-profiler.h"
 
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -109,11 +110,16 @@ EndDeviceLorawanMac::EndDeviceLorawanMac()
       m_address(LoraDeviceAddress(0)),
       // LoraWAN default
       m_receiveWindowDurationInSymbols(8),
+      m_uplinkSolicitsReply(false),
       // LoraWAN default
       m_controlDataRate(false),
       m_lastKnownLinkMargin(0),
       m_lastKnownGatewayCount(0),
       m_aggregatedDutyCycle(1),
+      m_postponedUntil(Seconds(0)),
+      m_nDeferred(0),
+      m_timeBlocked(Seconds(0)),
+      m_blockedUntil(Seconds(0)),
       m_mType(LorawanMacHeader::UNCONFIRMED_DATA_UP),
       m_currentFCnt(0)
 {
@@ -185,9 +191,35 @@ void
 EndDeviceLorawanMac::postponeTransmission(Time netxTxDelay, Ptr<Packet> packet)
 {
     NS_LOG_FUNCTION(this);
-    // Delete previously scheduled transmissions if any.
-    Simulator::Cancel(m_nextTx);
-    m_nextTx = Simulator::Schedule(netxTxDelay, &EndDeviceLorawanMac::DoSend, this, packet);
+
+    Time now = Simulator::Now();
+    Time releaseTime = now + netxTxDelay;
+
+    // Account for the time blocked, without counting twice the overlap with
+    // a previous deferral, only if the duty cycle, and not the receive windows
+    // or the ACK_TIMEOUT, is what postpones the transmission
+    Time dutyCycleDelay = m_channelHelper.GetEarliestWaitingTime();
+    if (dutyCycleDelay.IsStrictlyPositive() && dutyCycleDelay >= netxTxDelay)
+    {
+        m_nDeferred++;
+        if (releaseTime > m_blockedUntil)
+        {
+            m_timeBlocked += releaseTime - Max(now, m_blockedUntil);
+            m_blockedUntil = releaseTime;
+        }
+    }
+
+    // The newer packet replaces the previously scheduled one, if any. The
+    // timer is kept if it expires no later than the new release time
+    m_postponedPacket = packet;
+    m_postponedUntil = releaseTime;
+    if (!m_nextTx.IsPending() || Simulator::GetDelayLeft(m_nextTx) > netxTxDelay)
+    {
+        Simulator::Cancel(m_nextTx);
+        m_nextTx = Simulator::Schedule(netxTxDelay,
+                                       &EndDeviceLorawanMac::ReleasePostponedTransmission,
+                                       this);
+    }
     NS_LOG_WARN("Attempting to send, but the aggregate duty cycle won't allow it. Scheduling a tx "
                 "at a delay "
                 << netxTxDelay.GetSeconds() << ".");
@@ -197,6 +229,7 @@ void
 EndDeviceLorawanMac::DoSend(Ptr<Packet> packet)
 {
     NS_LOG_FUNCTION(this);
+    LORAWAN_PROFILE_SCOPE("EndDeviceLorawanMac::DoSend");
     // Checking if this is the transmission of a new packet
     if (packet != m_retxParams.packet)
     {
@@ -382,7 +415,8 @@ EndDeviceLorawanMac::ParseCommands(LoraFrameHeader frameHeader)
             // Call the appropriate function to take action
             OnLinkAdrReq(linkAdrReq->GetDataRate(),
                          linkAdrReq->GetTxPower(),
-                         linkAdrReq->GetEnabledChannelsList(),
+                         linkAdrReq->GetChannelMaskControl(),
+                         linkAdrReq->GetChannelMask(),
                          linkAdrReq->GetRepetitions());
 
             break;
@@ -459,6 +493,10 @@ EndDeviceLorawanMac::ApplyNecessaryOptions(LoraFrameHeader& frameHeader)
     // FPending does not exist in uplink messages
     frameHeader.SetFCnt(m_currentFCnt);
 
+    // Both the ADR bit and MAC commands (e.g., LinkCheckReq) may trigger a
+    // reply from the network server
+    m_uplinkSolicitsReply = m_controlDataRate || !m_macCommandList.empty();
+
     // Add listed MAC commands
     for (const auto& command : m_macCommandList)
     {
@@ -510,89 +548,49 @@ EndDeviceLorawanMac::GetNextTransmissionDelay()
 
     //    Check duty cycle    //
 
-    // Pick a random channel to transmit on
-    std::vector<Ptr<LogicalLoraChannel>> logicalChannels;
-    logicalChannels =
-        m_channelHelper.GetEnabledChannelList(); // Use a separate list to do the shuffle
-    // logicalChannels = Shuffle (logicalChannels);
+    // The channel helper keeps its sub-bands sorted by availability
+    Time waitingTime = m_channelHelper.GetEarliestWaitingTime();
 
-    Time waitingTime = Time::Max();
-
-    // Try every channel
-    std::vector<Ptr<LogicalLoraChannel>>::iterator it;
-    for (it = logicalChannels.begin(); it != logicalChannels.end(); ++it)
-    {
-        // Pointer to the current channel
-        Ptr<LogicalLoraChannel> logicalChannel = *it;
-        double frequency = logicalChannel->GetFrequency();
-
-        waitingTime = std::min(waitingTime, m_channelHelper.GetWaitingTime(logicalChannel));
-
-        NS_LOG_DEBUG("Waiting time before the next transmission in channel with frequency "
-                     << frequency << " is = " << waitingTime.GetSeconds() << ".");
-    }
+    NS_LOG_DEBUG("Waiting time before the next transmission is = " << waitingTime.GetSeconds()
+                                                                   << ".");
 
     waitingTime = GetNextClassTransmissionDelay(waitingTime);
 
     return waitingTime;
 }
 
-Ptr<LogicalLoraChannel>
-EndDeviceLorawanMac::GetChannelForTx()
+void
+EndDeviceLorawanMac::ReleasePostponedTransmission()
 {
-    NS_LOG_FUNCTION_NOARGS();
-
-    // Pick a random channel to transmit on
-    std::vector<Ptr<LogicalLoraChannel>> logicalChannels;
-    logicalChannels =
-        m_channelHelper.GetEnabledChannelList(); // Use a separate list to do the shuffle
-    logicalChannels = Shuffle(logicalChannels);
+    NS_LOG_FUNCTION(this);
 
-    // Try every channel
-    std::vector<Ptr<LogicalLoraChannel>>::iterator it;
-    for (it = logicalChannels.begin(); it != logicalChannels.end(); ++it)
+    Time now = Simulator::Now();
+    if (now < m_postponedUntil)
     {
-        // Pointer to the current channel
-        Ptr<LogicalLoraChannel> logicalChannel = *it;
-        double frequency = logicalChannel->GetFrequency();
-
-        NS_LOG_DEBUG("Frequency of the current channel: " << frequency);
-
-        // Verify that we can send the packet
-        Time waitingTime = m_channelHelper.GetWaitingTime(logicalChannel);
-
-        NS_LOG_DEBUG("Waiting time for current channel = " << waitingTime.GetSeconds());
-
-        // Send immediately if we can
-        if (waitingTime == Seconds(0))
-        {
-            return *it;
-        }
-        else
-        {
-            NS_LOG_DEBUG("Packet cannot be immediately transmitted on "
-                         << "the current channel because of duty cycle limitations.");
-        }
+        m_nextTx = Simulator::Schedule(m_postponedUntil - now,
+                                       &EndDeviceLorawanMac::ReleasePostponedTransmission,
+                                       this);
+        return;
     }
-    return nullptr; // In this case, no suitable channel was found
+
+    Ptr<Packet> packet = m_postponedPacket;
+    m_postponedPacket = nullptr;
+    DoSend(packet);
 }
 
-std::vector<Ptr<LogicalLoraChannel>>
-EndDeviceLorawanMac::Shuffle(std::vector<Ptr<LogicalLoraChannel>> vector)
+Ptr<LogicalLoraChannel>
+EndDeviceLorawanMac::GetChannelForTx()
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    int size = vector.size();
-
-    for (int i = 0; i < size; ++i)
+    // Pick a random channel to transmit on, among the available ones
+    Ptr<LogicalLoraChannel> channel = m_channelHelper.PickChannel(m_dataRate, m_uniformRV);
+    if (!channel)
     {
-        uint16_t random = std::floor(m_uniformRV->GetValue(0, size));
-        Ptr<LogicalLoraChannel> temp = vector.at(random);
-        vector.at(random) = vector.at(i);
-        vector.at(i) = temp;
+        NS_LOG_DEBUG("Packet cannot be immediately transmitted on "
+                     << "any channel because of duty cycle limitations.");
     }
-
-    return vector;
+    return channel; // nullptr if no suitable channel was found
 }
 
 /////////////////////////
@@ -609,6 +607,19 @@ EndDeviceLorawanMac::resetRetransmissionParameters()
 
     // Cancel next retransmissions, if any
     Simulator::Cancel(m_nextTx);
+    m_postponedPacket = nullptr;
+}
+
+uint32_t
+EndDeviceLorawanMac::GetNDeferredTransmissions() const
+{
+    return m_nDeferred;
+}
+
+Time
+EndDeviceLorawanMac::GetTimeBlockedByDutyCycle() const
+{
+    return m_timeBlocked;
 }
 
 void
@@ -683,10 +694,12 @@ EndDeviceLorawanMac::OnLinkCheckAns(uint8_t margin, uint8_t gwCnt)
 void
 EndDeviceLorawanMac::OnLinkAdrReq(uint8_t dataRate,
                                   uint8_t txPower,
-                                  std::list<int> enabledChannels,
+                                  uint8_t chMaskCntl,
+                                  uint16_t chMask,
                                   int repetitions)
 {
-    NS_LOG_FUNCTION(this << unsigned(dataRate) << unsigned(txPower) << repetitions);
+    NS_LOG_FUNCTION(this << unsigned(dataRate) << unsigned(txPower) << unsigned(chMaskCntl)
+                         << chMask << repetitions);
 
     // Three bools for three requirements before setting things up
     bool channelMaskOk = true;
@@ -697,16 +710,8 @@ EndDeviceLorawanMac::OnLinkAdrReq(uint8_t dataRate,
     /////////////////////////
     // Check whether all specified channels exist on this device
     auto channelList = m_channelHelper.GetChannelList();
-    int channelListSize = channelList.size();
-
-    for (auto it = enabledChannels.begin(); it != enabledChannels.end(); it++)
-    {
-        if ((*it) > channelListSize)
-        {
-            channelMaskOk = false;
-            break;
-        }
-    }
+    LogicalLoraChannelHelper::ChannelMask channelMask;
+    channelMaskOk = m_channelHelper.ComputeChannelMask(chMaskCntl, chMask, channelMask);
 
     // Check the dataRate
     /////////////////////
@@ -729,12 +734,16 @@ EndDeviceLorawanMac::OnLinkAdrReq(uint8_t dataRate,
     if (dataRateOk && channelMaskOk) // If false, skip the check
     {
         bool foundAvailableChannel = false;
-        for (auto it = enabledChannels.begin(); it != enabledChannels.end(); it++)
+        for (uint32_t i = 0; i < channelList.size(); i++)
         {
-            NS_LOG_DEBUG("MinDR: " << unsigned(channelList.at(*it)->GetMinimumDataRate()));
-            NS_LOG_DEBUG("MaxDR: " << unsigned(channelList.at(*it)->GetMaximumDataRate()));
-            if (channelList.at(*it)->GetMinimumDataRate() <= dataRate &&
-                channelList.at(*it)->GetMaximumDataRate() >= dataRate)
+            if (!channelMask.test(i))
+            {
+                continue;
+            }
+            NS_LOG_DEBUG("MinDR: " << unsigned(channelList.at(i)->GetMinimumDataRate()));
+            NS_LOG_DEBUG("MaxDR: " << unsigned(channelList.at(i)->GetMaximumDataRate()));
+            if (channelList.at(i)->GetMinimumDataRate() <= dataRate &&
+                channelList.at(i)->GetMaximumDataRate() >= dataRate)
             {
                 foundAvailableChannel = true;
                 break;
@@ -764,21 +773,9 @@ EndDeviceLorawanMac::OnLinkAdrReq(uint8_t dataRate,
     //////////////////////////////////////////////////
     if (channelMaskOk && dataRateOk && txPowerOk)
     {
-        // Cycle over all channels in the list
-        for (uint32_t i = 0; i < m_channelHelper.GetChannelList().size(); i++)
-        {
-            if (std::find(enabledChannels.begin(), enabledChannels.end(), i) !=
-                enabledChannels.end())
-            {
-                m_channelHelper.GetChannelList().at(i)->SetEnabledForUplink();
-                NS_LOG_DEBUG("Channel " << i << " enabled");
-            }
-            else
-            {
-                m_channelHelper.GetChannelList().at(i)->DisableForUplink();
-                NS_LOG_DEBUG("Channel " << i << " disabled");
-            }
-        }
+        // Enable the channels of the mask, and disable all the others
+        m_channelHelper.SetChannelMask(channelMask);
+        NS_LOG_DEBUG("Enabled channels: " << channelMask);
 
         // Set the data rate
         m_dataRate = dataRate;
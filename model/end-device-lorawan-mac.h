@@ -74,6 +74,11 @@ class EndDeviceLorawanMac : public LorawanMac
      * Postpone transmission to the specified time and delete previously scheduled transmissions if
      * present.
      *
+     * A single timer is kept per device: a newer packet replaces the postponed
+     * one, and the timer is only rescheduled if the newer packet can be sent
+     * earlier. Otherwise, the timer is re-armed for the remaining time when it
+     * expires.
+     *
      * \param nextTxDelay Delay at which the transmission will be performed.
      * \param packet The packet to delay the transmission of.
      */
@@ -113,6 +118,25 @@ class EndDeviceLorawanMac : public LorawanMac
      */
     virtual void resetRetransmissionParameters();
 
+    /**
+     * Get the number of transmissions postponed because of the duty cycle.
+     *
+     * Transmissions postponed for longer than the duty cycle requires, i.e.,
+     * until the end of the receive windows or of the ACK_TIMEOUT, are not
+     * counted, nor is their waiting time.
+     *
+     * \return The number of deferrals.
+     */
+    uint32_t GetNDeferredTransmissions() const;
+
+    /**
+     * Get the total time during which a transmission of this device was
+     * postponed because of the duty cycle.
+     *
+     * \return The time blocked by the duty cycle.
+     */
+    Time GetTimeBlockedByDutyCycle() const;
+
     /**
      * Enable data rate adaptation in the retransmitting procedure.
      *
@@ -243,12 +267,14 @@ class EndDeviceLorawanMac : public LorawanMac
      *
      * \param dataRate The data rate value of the command.
      * \param txPower The transmission power value of the command.
-     * \param enabledChannels A list of the enabled channels.
+     * \param chMaskCntl The ChMaskCntl value of the command.
+     * \param chMask The ChMask value of the command.
      * \param repetitions The number of repetitions prescribed by the command.
      */
     void OnLinkAdrReq(uint8_t dataRate,
                       uint8_t txPower,
-                      std::list<int> enabledChannels,
+                      uint8_t chMaskCntl,
+                      uint16_t chMask,
                       int repetitions);
 
     /**
@@ -378,9 +404,9 @@ class EndDeviceLorawanMac : public LorawanMac
     virtual Time GetNextClassTransmissionDelay(Time waitingTime);
 
     /**
-     * Find a suitable channel for transmission. The channel is chosen among the
-     * ones that are available in the end device, based on their duty
-     * cycle limitations.
+     * Find a suitable channel for transmission. The channel is chosen at random
+     * among the ones that are enabled in the end device and allow its data
+     * rate, based on their duty cycle limitations.
      *
      * \return A pointer to the channel.
      */
@@ -403,14 +429,20 @@ class EndDeviceLorawanMac : public LorawanMac
      */
     std::list<Ptr<MacCommand>> m_macCommandList;
 
+    /**
+     * Whether the last uplink frame may solicit a downlink from the network
+     * server, that is, whether it requested ADR or carried MAC commands.
+     */
+    bool m_uplinkSolicitsReply;
+
     /**
      * Structure containing the retransmission parameters for this device.
      */
     struct LoraRetxParameters m_retxParams;
 
     /**
-     * An uniform random variable, used by the Shuffle method to randomly reorder
-     * the channel list.
+     * An uniform random variable, used to randomly pick the transmission
+     * channel.
      */
     Ptr<UniformRandomVariable> m_uniformRV;
 
@@ -424,16 +456,6 @@ class EndDeviceLorawanMac : public LorawanMac
     TracedCallback<uint8_t, uint8_t,  bool, Time, Ptr<Packet>> m_requiredTxCallback;
 
   private:
-    /**
-     * Randomly shuffle a Ptr<LogicalLoraChannel> vector.
-     *
-     * Used to pick a random channel on which to send the packet.
-     *
-     * \param vector The vector of pointers to logical LoRa channels.
-     * \return The shuffled vector.
-     */
-    std::vector<Ptr<LogicalLoraChannel>> Shuffle(std::vector<Ptr<LogicalLoraChannel>> vector);
-
     /**
      * Find the base minimum waiting time before the next possible transmission.
      *
@@ -441,6 +463,11 @@ class EndDeviceLorawanMac : public LorawanMac
      */
     Time GetNextTransmissionDelay();
 
+    /**
+     * Send the postponed packet, or re-arm the timer if it cannot be sent yet.
+     */
+    void ReleasePostponedTransmission();
+
     /**
      * Whether this device's data rate should be controlled by the network server.
      */
@@ -463,6 +490,12 @@ class EndDeviceLorawanMac : public LorawanMac
      */
     EventId m_nextRetx;
 
+    Ptr<Packet> m_postponedPacket; //!< The packet waiting for the duty cycle
+    Time m_postponedUntil;         //!< The time the postponed packet can be sent
+    uint32_t m_nDeferred;          //!< The number of transmissions postponed
+    Time m_timeBlocked;            //!< The total time blocked by the duty cycle
+    Time m_blockedUntil;           //!< The end of the last blocked interval
+
     /**
      * The last known link margin.
      *
@@ -326,6 +326,23 @@ EndDeviceStatus::GetLastReceivedPacketInfo()
     }
 }
 
+uint32_t
+EndDeviceStatus::GetNReceivedPackets() const
+{
+    return m_receivedPacketList.size();
+}
+
+uint32_t
+EndDeviceStatus::GetNReceptions() const
+{
+    uint32_t nReceptions = 0;
+    for (const auto& [packet, info] : m_receivedPacketList)
+    {
+        nReceptions += info.gwList.size();
+    }
+    return nReceptions;
+}
+
 Ptr<const Packet>
 EndDeviceStatus::GetLastPacketReceivedFromDevice()
 {
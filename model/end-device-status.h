@@ -303,6 +303,21 @@ class EndDeviceStatus : public Object
      */
     EndDeviceStatus::ReceivedPacketInfo GetLastReceivedPacketInfo();
 
+    /**
+     * Get the number of packets in the received packet list.
+     *
+     * \return The number of packets.
+     */
+    uint32_t GetNReceivedPackets() const;
+
+    /**
+     * Get the number of receptions by gateways of the packets in the received
+     * packet list.
+     *
+     * \return The number of receptions.
+     */
+    uint32_t GetNReceptions() const;
+
     /**
      * Reset the next reply state.
      */
@@ -0,0 +1,400 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "fleet-traffic-scheduler.h"
+
+#include "lora-net-device.h"
+
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("FleetTrafficScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(FleetTrafficScheduler);
+
+TypeId
+FleetTrafficScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::FleetTrafficScheduler")
+            .SetParent<Object>()
+            .SetGroupName("lorawan")
+            .AddConstructor<FleetTrafficScheduler>()
+            .AddAttribute("Distribution",
+                          "The distribution of the inter-arrival times. Must be set before "
+                          "devices are added.",
+                          EnumValue(FleetTrafficScheduler::PERIODIC),
+                          MakeEnumAccessor<Distribution>(&FleetTrafficScheduler::m_distribution),
+                          MakeEnumChecker(FleetTrafficScheduler::PERIODIC,
+                                          "Periodic",
+                                          FleetTrafficScheduler::EXPONENTIAL,
+                                          "Exponential",
+                                          FleetTrafficScheduler::PARETO,
+                                          "Pareto"))
+            .AddAttribute("MeanInterval",
+                          "The mean interval between two packets of a device (the period, "
+                          "for periodic traffic). Must be set before devices are added.",
+                          TimeValue(Seconds(600)),
+                          MakeTimeAccessor(&FleetTrafficScheduler::m_meanInterval),
+                          MakeTimeChecker())
+            .AddAttribute("ParetoShape",
+                          "The shape of the Pareto distribution. Must be set before devices "
+                          "are added.",
+                          DoubleValue(2.5),
+                          MakeDoubleAccessor(&FleetTrafficScheduler::m_paretoShape),
+                          MakeDoubleChecker<double>(1.0 + 1e-9))
+            .AddAttribute("PacketSize",
+                          "The size of the packets, in bytes",
+                          UintegerValue(10),
+                          MakeUintegerAccessor(&FleetTrafficScheduler::m_packetSize),
+                          MakeUintegerChecker<uint8_t>())
+            .AddAttribute("NBuckets",
+                          "The number of buckets of the calendar queue",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&FleetTrafficScheduler::m_nBuckets),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BucketWidth",
+                          "The width of the buckets of the calendar queue",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&FleetTrafficScheduler::m_bucketWidth),
+                          MakeTimeChecker(TimeStep(1)));
+    return tid;
+}
+
+FleetTrafficScheduler::FleetTrafficScheduler()
+    : m_nBatches(0),
+      m_nSentPackets(0)
+{
+    NS_LOG_FUNCTION(this);
+
+    m_initialDelay = CreateObject<UniformRandomVariable>();
+}
+
+FleetTrafficScheduler::~FleetTrafficScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+FleetTrafficScheduler::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    Simulator::Cancel(m_nextBatch);
+    Simulator::Cancel(m_startEvent);
+    Simulator::Cancel(m_stopEvent);
+    m_queue.Clear();
+    m_macs.clear();
+    m_intervalRvs.clear();
+
+    Object::DoDispose();
+}
+
+void
+FleetTrafficScheduler::AddDevices(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this);
+
+    m_macs.reserve(m_macs.size() + nodes.GetN());
+    m_intervalRvs.reserve(m_intervalRvs.size() + nodes.GetN());
+    for (auto node = nodes.Begin(); node != nodes.End(); node++)
+    {
+        AddDevice(*node);
+    }
+}
+
+void
+FleetTrafficScheduler::AddDevice(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(this << node);
+
+    // Assumes there's only one device, like the sender applications
+    Ptr<LoraNetDevice> loraNetDevice = node->GetDevice(0)->GetObject<LoraNetDevice>();
+    NS_ASSERT(loraNetDevice);
+    m_macs.push_back(loraNetDevice->GetMac());
+
+    Ptr<RandomVariableStream> intervalRv;
+    switch (m_distribution)
+    {
+    case PERIODIC:
+        break;
+    case EXPONENTIAL: {
+        Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable>();
+        exponential->SetAttribute("Mean", DoubleValue(m_meanInterval.GetSeconds()));
+        intervalRv = exponential;
+        break;
+    }
+    case PARETO: {
+        // Scale such that the mean is m_meanInterval
+        Ptr<ParetoRandomVariable> pareto = CreateObject<ParetoRandomVariable>();
+        pareto->SetAttribute("Scale",
+                             DoubleValue(m_meanInterval.GetSeconds() * (m_paretoShape - 1) /
+                                         m_paretoShape));
+        pareto->SetAttribute("Shape", DoubleValue(m_paretoShape));
+        intervalRv = pareto;
+        break;
+    }
+    }
+    m_intervalRvs.push_back(intervalRv);
+}
+
+uint32_t
+FleetTrafficScheduler::GetNDevices() const
+{
+    return m_macs.size();
+}
+
+void
+FleetTrafficScheduler::Start(Time start)
+{
+    NS_LOG_FUNCTION(this << start);
+
+    Simulator::Cancel(m_startEvent);
+    m_startEvent = Simulator::Schedule(start, &FleetTrafficScheduler::DoStart, this);
+}
+
+void
+FleetTrafficScheduler::Stop(Time stop)
+{
+    NS_LOG_FUNCTION(this << stop);
+
+    Simulator::Cancel(m_stopEvent);
+    m_stopEvent = Simulator::Schedule(stop, &FleetTrafficScheduler::DoStop, this);
+}
+
+int64_t
+FleetTrafficScheduler::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+
+    int64_t currentStream = stream;
+    m_initialDelay->SetStream(currentStream++);
+    for (auto& rv : m_intervalRvs)
+    {
+        if (rv)
+        {
+            rv->SetStream(currentStream);
+        }
+        currentStream++;
+    }
+    return currentStream - stream;
+}
+
+uint64_t
+FleetTrafficScheduler::GetNBatches() const
+{
+    return m_nBatches;
+}
+
+uint64_t
+FleetTrafficScheduler::GetNSentPackets() const
+{
+    return m_nSentPackets;
+}
+
+void
+FleetTrafficScheduler::DoStart()
+{
+    NS_LOG_FUNCTION(this);
+
+    Simulator::Cancel(m_nextBatch);
+    m_queue.Clear();
+    m_queue.Initialize(m_nBuckets, m_bucketWidth.GetTimeStep());
+
+    for (uint32_t device = 0; device < m_macs.size(); device++)
+    {
+        Time initialDelay = Seconds(m_initialDelay->GetValue(0, m_meanInterval.GetSeconds()));
+        m_queue.Insert((Simulator::Now() + initialDelay).GetTimeStep(), device);
+    }
+
+    NS_LOG_DEBUG("Started the traffic of " << m_macs.size() << " devices");
+    ScheduleNextBatch();
+}
+
+void
+FleetTrafficScheduler::DoStop()
+{
+    NS_LOG_FUNCTION(this);
+
+    Simulator::Cancel(m_nextBatch);
+    m_queue.Clear();
+}
+
+void
+FleetTrafficScheduler::SendBatch()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_queue.PopBatch(m_batch);
+    m_nBatches++;
+
+    for (uint32_t device : m_batch)
+    {
+        Ptr<Packet> packet = Create<Packet>(m_packetSize);
+        m_macs[device]->Send(packet);
+        m_nSentPackets++;
+
+        Time next = Simulator::Now() + GetNextInterval(device);
+        m_queue.Insert(next.GetTimeStep(), device);
+    }
+    NS_LOG_DEBUG("Sent a batch of " << m_batch.size() << " packets");
+
+    ScheduleNextBatch();
+}
+
+void
+FleetTrafficScheduler::ScheduleNextBatch()
+{
+    if (m_queue.IsEmpty())
+    {
+        return;
+    }
+
+    Time next = TimeStep(m_queue.PeekMin());
+    m_nextBatch =
+        Simulator::Schedule(next - Simulator::Now(), &FleetTrafficScheduler::SendBatch, this);
+}
+
+Time
+FleetTrafficScheduler::GetNextInterval(uint32_t device)
+{
+    if (m_distribution == PERIODIC)
+    {
+        return m_meanInterval;
+    }
+    return Seconds(m_intervalRvs[device]->GetValue());
+}
+
+//////////////////////////////
+// Calendar queue functions //
+//////////////////////////////
+
+void
+FleetTrafficScheduler::CalendarQueue::Initialize(uint32_t nBuckets, int64_t bucketWidth)
+{
+    NS_ASSERT(nBuckets > 0 && bucketWidth > 0);
+
+    std::vector<Entry> entries;
+    entries.reserve(m_size);
+    for (const auto& bucket : m_buckets)
+    {
+        entries.insert(entries.end(), bucket.begin(), bucket.end());
+    }
+
+    // Keep scanning from the window holding the current one, since all the
+    // entries, and the next ones to be inserted, are after its start
+    m_buckets.assign(nBuckets, std::vector<Entry>());
+    m_bucketWidth = bucketWidth;
+    m_current = (m_windowStart / m_bucketWidth) % nBuckets;
+    m_windowStart = m_windowStart / m_bucketWidth * m_bucketWidth;
+    for (const auto& entry : entries)
+    {
+        m_buckets[(entry.ts / m_bucketWidth) % nBuckets].push_back(entry);
+    }
+}
+
+void
+FleetTrafficScheduler::CalendarQueue::Insert(int64_t ts, uint32_t device)
+{
+    NS_ASSERT(ts >= m_windowStart);
+
+    m_buckets[(ts / m_bucketWidth) % m_buckets.size()].push_back({ts, device});
+    m_size++;
+}
+
+int64_t
+FleetTrafficScheduler::CalendarQueue::PeekMin()
+{
+    NS_ASSERT(m_size > 0);
+
+    // Scan one year of buckets, from the current one
+    uint32_t nBuckets = m_buckets.size();
+    for (uint32_t n = 0; n < nBuckets; n++)
+    {
+        int64_t windowEnd = m_windowStart + m_bucketWidth;
+        int64_t min = windowEnd;
+        for (const auto& entry : m_buckets[m_current])
+        {
+            min = std::min(min, entry.ts);
+        }
+        if (min < windowEnd)
+        {
+            return min;
+        }
+        m_current = (m_current + 1) % nBuckets;
+        m_windowStart = windowEnd;
+    }
+
+    // All entries are more than one year ahead: jump to the earliest one
+    int64_t min = std::numeric_limits<int64_t>::max();
+    for (const auto& bucket : m_buckets)
+    {
+        for (const auto& entry : bucket)
+        {
+            min = std::min(min, entry.ts);
+        }
+    }
+    m_current = (min / m_bucketWidth) % nBuckets;
+    m_windowStart = min / m_bucketWidth * m_bucketWidth;
+    return min;
+}
+
+int64_t
+FleetTrafficScheduler::CalendarQueue::PopBatch(std::vector<uint32_t>& devices)
+{
+    int64_t min = PeekMin();
+
+    devices.clear();
+    std::vector<Entry>& bucket = m_buckets[m_current];
+    for (size_t i = 0; i < bucket.size();)
+    {
+        if (bucket[i].ts == min)
+        {
+            devices.push_back(bucket[i].device);
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+    m_size -= devices.size();
+
+    // Removal does not preserve the order of the bucket
+    std::sort(devices.begin(), devices.end());
+    return min;
+}
+
+bool
+FleetTrafficScheduler::CalendarQueue::IsEmpty() const
+{
+    return m_size == 0;
+}
+
+void
+FleetTrafficScheduler::CalendarQueue::Clear()
+{
+    for (auto& bucket : m_buckets)
+    {
+        bucket.clear();
+    }
+    m_size = 0;
+    m_current = 0;
+    m_windowStart = 0;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,268 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef FLEET_TRAFFIC_SCHEDULER_H
+#define FLEET_TRAFFIC_SCHEDULER_H
+
+#include "lorawan-mac.h"
+
+#include "ns3/event-id.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Generate the uplink traffic of a whole fleet of end devices.
+ *
+ * Installing a PeriodicSender or a RandomSender on each device keeps one
+ * pending event per device in the simulator. This scheduler replaces them for
+ * large fleets: it keeps the next send time of every device in a calendar
+ * queue, and has a single pending simulator event, at the earliest send time.
+ * When the event fires, all the devices due at that time (the batch) send a
+ * packet through their MAC layer, and their next send time is put back in the
+ * queue.
+ *
+ * Inter-arrival times are periodic, exponential or Pareto distributed. Each
+ * device draws its inter-arrival times from its own random variable stream,
+ * like a RandomSender does, while the initial delays of all the devices are
+ * drawn from a single stream, in the order the devices were added, like the
+ * PeriodicSenderHelper does. Periodic traffic thus has the same send times as
+ * PeriodicSender applications installed on the same devices when the initial
+ * delays are drawn from the same stream, and exponential traffic has the same
+ * inter-arrival times as RandomSender applications using the same streams,
+ * but not the same initial delays, which the RandomSenderHelper draws from an
+ * exponential distribution. Devices due at the very same time send in the
+ * order they were added.
+ */
+class FleetTrafficScheduler : public Object
+{
+  public:
+    /**
+     * The distribution of the inter-arrival times.
+     */
+    enum Distribution
+    {
+        PERIODIC,
+        EXPONENTIAL,
+        PARETO
+    };
+
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    FleetTrafficScheduler();           //!< Default constructor
+    ~FleetTrafficScheduler() override; //!< Destructor
+
+    /**
+     * Add the end devices of a container to the fleet.
+     *
+     * \param nodes The end device nodes, each with a LoraNetDevice as its
+     * first device.
+     */
+    void AddDevices(NodeContainer nodes);
+
+    /**
+     * Add an end device to the fleet.
+     *
+     * \param node The end device node, with a LoraNetDevice as its first
+     * device.
+     */
+    void AddDevice(Ptr<Node> node);
+
+    /**
+     * Get the number of devices in the fleet.
+     *
+     * \return The number of devices.
+     */
+    uint32_t GetNDevices() const;
+
+    /**
+     * Start generating traffic.
+     *
+     * The first packet of each device is sent after a random initial delay,
+     * uniformly distributed between zero and the mean interval.
+     *
+     * \param start The delay after which the traffic starts.
+     */
+    void Start(Time start);
+
+    /**
+     * Stop generating traffic.
+     *
+     * \param stop The delay after which the traffic stops.
+     */
+    void Stop(Time stop);
+
+    /**
+     * Assign fixed random variable stream numbers to the random variables used
+     * by this scheduler: one for the initial delays, then one per device, in
+     * the order the devices were added. Devices must be added beforehand.
+     *
+     * \param stream The first stream index to use.
+     * \return The number of stream indices assigned.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * Get the number of simulator events fired to send packets, i.e., the
+     * number of batches.
+     *
+     * \return The number of batches.
+     */
+    uint64_t GetNBatches() const;
+
+    /**
+     * Get the number of packets sent by the fleet.
+     *
+     * \return The number of packets.
+     */
+    uint64_t GetNSentPackets() const;
+
+    /**
+     * A calendar queue of (send time, device) entries.
+     *
+     * Entries are hashed by send time into a circular array of buckets of
+     * fixed width. The earliest entry is found by scanning the buckets from
+     * the current one, only looking at the entries that fall in the current
+     * "year" of each bucket.
+     *
+     * It is only used by the scheduler, and is public so that it can be
+     * tested on its own.
+     */
+    class CalendarQueue
+    {
+      public:
+        /**
+         * Set up the buckets, moving the entries already in the queue, if any,
+         * to the new buckets.
+         *
+         * \param nBuckets The number of buckets.
+         * \param bucketWidth The width of a bucket, in time steps.
+         */
+        void Initialize(uint32_t nBuckets, int64_t bucketWidth);
+
+        /**
+         * Insert an entry.
+         *
+         * \param ts The send time, in time steps.
+         * \param device The index of the device.
+         */
+        void Insert(int64_t ts, uint32_t device);
+
+        /**
+         * Get the earliest send time.
+         *
+         * \return The earliest send time, in time steps. The queue must not be
+         * empty.
+         */
+        int64_t PeekMin();
+
+        /**
+         * Remove all the entries with the earliest send time.
+         *
+         * \param devices Filled with the devices of the removed entries, in
+         * increasing order.
+         * \return The send time of the removed entries, in time steps.
+         */
+        int64_t PopBatch(std::vector<uint32_t>& devices);
+
+        /**
+         * Check whether the queue is empty.
+         *
+         * \return True if no entry is left.
+         */
+        bool IsEmpty() const;
+
+        /**
+         * Remove all entries.
+         */
+        void Clear();
+
+      private:
+        /**
+         * An entry of the queue.
+         */
+        struct Entry
+        {
+            int64_t ts;      //!< The send time, in time steps
+            uint32_t device; //!< The index of the device
+        };
+
+        std::vector<std::vector<Entry>> m_buckets; //!< The buckets
+        int64_t m_bucketWidth = 1;                 //!< The width of a bucket, in time steps
+        uint32_t m_current = 0;                    //!< The bucket being scanned
+        int64_t m_windowStart = 0;                 //!< The start of the window of m_current
+        uint64_t m_size = 0;                       //!< The number of entries
+    };
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * Schedule the first packet of every device.
+     */
+    void DoStart();
+
+    /**
+     * Stop the traffic.
+     */
+    void DoStop();
+
+    /**
+     * Send a packet for each device of the earliest batch, and schedule the
+     * next batch.
+     */
+    void SendBatch();
+
+    /**
+     * Schedule the event of the earliest batch, if any.
+     */
+    void ScheduleNextBatch();
+
+    /**
+     * Draw the next inter-arrival time of a device.
+     *
+     * \param device The index of the device.
+     * \return The inter-arrival time.
+     */
+    Time GetNextInterval(uint32_t device);
+
+    Distribution m_distribution; //!< The distribution of the inter-arrival times
+    Time m_meanInterval;         //!< The mean interval between two packets of a device
+    double m_paretoShape;        //!< The shape of the Pareto distribution
+    uint8_t m_packetSize;        //!< The size of the packets, in bytes
+    uint32_t m_nBuckets;         //!< The number of buckets of the calendar queue
+    Time m_bucketWidth;          //!< The width of the buckets of the calendar queue
+
+    std::vector<Ptr<LorawanMac>> m_macs;                  //!< The MAC layer of each device
+    std::vector<Ptr<RandomVariableStream>> m_intervalRvs; //!< The interval stream of each device
+    Ptr<UniformRandomVariable> m_initialDelay;            //!< The initial delay of the devices
+
+    CalendarQueue m_queue;         //!< The next send time of each device
+    std::vector<uint32_t> m_batch; //!< The devices of the batch being sent
+    EventId m_nextBatch;           //!< The event of the next batch
+    EventId m_startEvent;          //!< The event starting the traffic
+    EventId m_stopEvent;           //!< The event stopping the traffic
+    uint64_t m_nBatches;           //!< The number of batches sent
+    uint64_t m_nSentPackets;       //!< The number of packets sent
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* FLEET_TRAFFIC_SCHEDULER_H */
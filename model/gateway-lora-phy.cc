@@ -111,7 +111,22 @@ GatewayLoraPhy::GetTypeId()
             .AddTraceSource("OccupiedReceptionPaths",
                             "Number of currently occupied reception paths",
                             MakeTraceSourceAccessor(&GatewayLoraPhy::m_occupiedReceptionPaths),
-                            "ns3::TracedValueCallback::Int");
+                            "ns3::TracedValueCallback::Int")
+            .AddTraceSource("SignalArrival",
+                            "Trace source indicating a signal reached the gateway, "
+                            "with its power, spreading factor, duration and frequency",
+                            MakeTraceSourceAccessor(&GatewayLoraPhy::m_signalArrival),
+                            "ns3::lorawan::GatewayLoraPhy::SignalTracedCallback")
+            .AddTraceSource("SignalTransmission",
+                            "Trace source indicating the gateway started a transmission, "
+                            "with its power, spreading factor, duration and frequency",
+                            MakeTraceSourceAccessor(&GatewayLoraPhy::m_signalTransmission),
+                            "ns3::lorawan::GatewayLoraPhy::SignalTracedCallback")
+            .AddTraceSource("HypothesisOutcome",
+                            "Trace source indicating the outcome of a signal under a "
+                            "reception hypothesis",
+                            MakeTraceSourceAccessor(&GatewayLoraPhy::m_hypothesisOutcome),
+                            "ns3::lorawan::GatewayLoraPhy::HypothesisOutcomeTracedCallback");
     return tid;
 }
 
@@ -146,6 +161,16 @@ GatewayLoraPhy::ResetReceptionPaths()
     m_receptionPaths.clear();
 }
 
+void
+GatewayLoraPhy::SetHypotheses(const std::vector<LoraInterferenceHelper::Hypothesis>& hypotheses)
+{
+    NS_LOG_FUNCTION(this << hypotheses.size());
+    NS_ASSERT_MSG(m_hypothesisReceptions.empty(), "Hypotheses changed during a reception");
+
+    m_interference.SetHypotheses(hypotheses);
+    m_hypothesisOccupiedPaths.assign(hypotheses.size(), 0);
+}
+
 void
 GatewayLoraPhy::TxFinished(Ptr<const Packet> packet)
 {
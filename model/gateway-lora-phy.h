@@ -19,6 +19,8 @@
 #include "ns3/traced-value.h"
 
 #include <list>
+#include <map>
+#include <vector>
 
 namespace ns3
 {
@@ -51,6 +53,49 @@ class GatewayLoraPhy : public LoraPhy
     GatewayLoraPhy();           //!< Default constructor
     ~GatewayLoraPhy() override; //!< Destructor
 
+    /**
+     * The outcomes of a signal reaching the gateway under a reception
+     * hypothesis.
+     */
+    enum HypothesisOutcome : uint8_t
+    {
+        HYPOTHESIS_RECEIVED,          //!< The signal would be received
+        HYPOTHESIS_INTERFERED,        //!< The signal would be destroyed by interference
+        HYPOTHESIS_NO_MORE_RECEIVERS, //!< No reception path would be free
+        HYPOTHESIS_UNDER_SENSITIVITY, //!< The signal would be below the sensitivity
+        HYPOTHESIS_LOST_BECAUSE_TX,   //!< The gateway would be transmitting
+    };
+
+    /**
+     * TracedCallback signature for the signals reaching the gateway and those
+     * it transmits.
+     *
+     * \param packet The packet carried by the signal.
+     * \param powerDbm The received or transmitted power [dBm].
+     * \param sf The spreading factor of the signal.
+     * \param duration The on-air duration of the signal.
+     * \param frequencyMHz The frequency of the signal [MHz].
+     */
+    typedef void (*SignalTracedCallback)(Ptr<const Packet> packet,
+                                         double powerDbm,
+                                         uint8_t sf,
+                                         Time duration,
+                                         double frequencyMHz);
+
+    /**
+     * TracedCallback signature for the outcome of a signal reaching the
+     * gateway under a reception hypothesis.
+     *
+     * \param packet The packet carried by the signal.
+     * \param systemId The node id of the gateway, or 0.
+     * \param hypothesis The index of the hypothesis.
+     * \param outcome The outcome of the signal under the hypothesis.
+     */
+    typedef void (*HypothesisOutcomeTracedCallback)(Ptr<const Packet> packet,
+                                                    uint32_t systemId,
+                                                    uint32_t hypothesis,
+                                                    HypothesisOutcome outcome);
+
     void StartReceive(Ptr<Packet> packet,
                       double rxPowerDbm,
                       uint8_t sf,
@@ -93,6 +138,17 @@ class GatewayLoraPhy : public LoraPhy
      */
     void AddFrequency(double frequencyMHz);
 
+    /**
+     * Set the reception hypotheses the gateway evaluates every signal under,
+     * besides its own parameters, which keep deciding the packets delivered to
+     * the MAC. Each hypothesis has reception paths of its own, and its
+     * outcomes are fired by the HypothesisOutcome trace source. This must be
+     * called while no reception is in progress.
+     *
+     * \param hypotheses The hypotheses, none by default.
+     */
+    void SetHypotheses(const std::vector<LoraInterferenceHelper::Hypothesis>& hypotheses);
+
     static const double sensitivity[6]; //!< A vector containing the sensitivities required to
                                         //!< correctly decode different spreading factors.
 
@@ -200,6 +256,34 @@ class GatewayLoraPhy : public LoraPhy
      */
     TracedCallback<Ptr<const Packet>, uint32_t> m_noReceptionBecauseTransmitting;
 
+    /**
+     * Trace source fired when a signal reaches the gateway, before any check.
+     */
+    TracedCallback<Ptr<const Packet>, double, uint8_t, Time, double> m_signalArrival;
+
+    /**
+     * Trace source fired when the gateway starts a transmission.
+     */
+    TracedCallback<Ptr<const Packet>, double, uint8_t, Time, double> m_signalTransmission;
+
+    /**
+     * Trace source fired with the outcome of a signal under each hypothesis.
+     */
+    TracedCallback<Ptr<const Packet>, uint32_t, uint32_t, HypothesisOutcome> m_hypothesisOutcome;
+
+    /**
+     * A signal that hypothetical reception paths are locked on.
+     */
+    struct HypothesisReception
+    {
+        std::vector<bool> locked; //!< Whether a path of each hypothesis is locked on the signal
+        EventId endReceive;       //!< The end of the reception, if no actual path is locked on it
+    };
+
+    /// The signals hypothetical reception paths are locked on
+    std::map<Ptr<LoraInterferenceHelper::Event>, HypothesisReception> m_hypothesisReceptions;
+    std::vector<uint32_t> m_hypothesisOccupiedPaths; //!< The occupied paths of each hypothesis
+
     bool m_isTransmitting; //!< Flag indicating whether a transmission is going on
 
     std::list<double> m_frequencies; //!< List of frequencies the GatewayLoraPhy is listening to.
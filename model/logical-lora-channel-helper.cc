@@ -29,7 +29,9 @@ LogicalLoraChannelHelper::GetTypeId()
 }
 
 LogicalLoraChannelHelper::LogicalLoraChannelHelper()
-    : m_nextAggregatedTransmissionTime(Seconds(0)),
+    : m_channelVersions(0),
+      m_candidatesDataRate(-1),
+      m_nextAggregatedTransmissionTime(Seconds(0)),
       m_aggregatedDutyCycle(1)
 {
     NS_LOG_FUNCTION(this);
@@ -58,20 +60,14 @@ LogicalLoraChannelHelper::GetEnabledChannelList()
 {
     NS_LOG_FUNCTION(this);
 
-    // Make a copy of the channel vector
-    std::vector<Ptr<LogicalLoraChannel>> vector;
-    vector.reserve(m_channelList.size());
-    std::copy(m_channelList.begin(),
-              m_channelList.end(),
-              std::back_inserter(vector)); // Working on a copy
-
+    SyncChannelMask();
     std::vector<Ptr<LogicalLoraChannel>> channels;
-    std::vector<Ptr<LogicalLoraChannel>>::iterator it;
-    for (it = vector.begin(); it != vector.end(); it++)
+    channels.reserve(m_channelMask.count());
+    for (uint32_t i = 0; i < m_channelList.size(); i++)
     {
-        if ((*it)->IsEnabledForUplink())
+        if (m_channelMask.test(i))
         {
-            channels.push_back(*it);
+            channels.push_back(m_channelList[i]);
         }
     }
 
@@ -113,6 +109,7 @@ LogicalLoraChannelHelper::AddChannel(double frequency)
 
     // Add it to the list
     m_channelList.push_back(channel);
+    UpdateChannelMask();
 
     NS_LOG_DEBUG("Added a channel. Current number of channels in list is " << m_channelList.size());
 }
@@ -124,6 +121,7 @@ LogicalLoraChannelHelper::AddChannel(Ptr<LogicalLoraChannel> logicalChannel)
 
     // Add it to the list
     m_channelList.push_back(logicalChannel);
+    UpdateChannelMask();
 }
 
 void
@@ -133,6 +131,7 @@ LogicalLoraChannelHelper::SetChannel(uint8_t chIndex, Ptr<LogicalLoraChannel> lo
     NS_LOG_FUNCTION(this << chIndex << logicalChannel);
 
     m_channelList.at(chIndex) = logicalChannel;
+    UpdateChannelMask();
 }
 
 void
@@ -145,7 +144,7 @@ LogicalLoraChannelHelper::AddSubBand(double firstFrequency,
 
     Ptr<SubBand> subBand = Create<SubBand>(firstFrequency, lastFrequency, dutyCycle, maxTxPowerDbm);
 
-    m_subBandList.push_back(subBand);
+    AddSubBand(subBand);
 }
 
 void
@@ -154,6 +153,8 @@ LogicalLoraChannelHelper::AddSubBand(Ptr<SubBand> subBand)
     NS_LOG_FUNCTION(this << subBand);
 
     m_subBandList.push_back(subBand);
+    m_nextTransmissionTimes.push_back({subBand->GetNextTransmissionTime().GetTimeStep(), subBand});
+    UpdateNextTransmissionTime(subBand);
 }
 
 void
@@ -167,6 +168,9 @@ LogicalLoraChannelHelper::RemoveChannel(Ptr<LogicalLoraChannel> logicalChannel)
         if (currentChannel == logicalChannel)
         {
             m_channelList.erase(it);
+
+            // The indices of the following channels changed
+            UpdateChannelMask();
             return;
         }
     }
@@ -203,6 +207,62 @@ LogicalLoraChannelHelper::GetWaitingTime(Ptr<LogicalLoraChannel> channel)
     return subBandWaitingTime;
 }
 
+Time
+LogicalLoraChannelHelper::GetEarliestWaitingTime()
+{
+    NS_LOG_FUNCTION(this);
+
+    SyncChannelMask();
+
+    // SubBands are sorted by next transmission time: the first one with an
+    // enabled channel gives the waiting time
+    for (const auto& entry : m_nextTransmissionTimes)
+    {
+        if (HasEnabledChannel(entry.subBand))
+        {
+            Time waitingTime = TimeStep(entry.ts) - Simulator::Now();
+            return Max(waitingTime, Seconds(0));
+        }
+    }
+    return Time::Max();
+}
+
+void
+LogicalLoraChannelHelper::UpdateNextTransmissionTime(Ptr<SubBand> subBand)
+{
+    auto it = m_nextTransmissionTimes.begin();
+    while (it->subBand != subBand)
+    {
+        it++;
+    }
+    it->ts = subBand->GetNextTransmissionTime().GetTimeStep();
+
+    // Move the entry to its place, towards either end
+    while (it != m_nextTransmissionTimes.begin() && (it - 1)->ts > it->ts)
+    {
+        std::iter_swap(it, it - 1);
+        it--;
+    }
+    while (it + 1 != m_nextTransmissionTimes.end() && (it + 1)->ts < it->ts)
+    {
+        std::iter_swap(it, it + 1);
+        it++;
+    }
+}
+
+bool
+LogicalLoraChannelHelper::HasEnabledChannel(Ptr<SubBand> subBand) const
+{
+    for (uint32_t i = 0; i < m_channelList.size(); i++)
+    {
+        if (m_channelMask.test(i) && subBand->BelongsToSubBand(m_channelList[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void
 LogicalLoraChannelHelper::AddEvent(Time duration, Ptr<LogicalLoraChannel> channel)
 {
@@ -215,6 +275,7 @@ LogicalLoraChannelHelper::AddEvent(Time duration, Ptr<LogicalLoraChannel> channe
 
     // Computation of necessary waiting time on this sub-band
     subBand->SetNextTransmissionTime(Simulator::Now() + Seconds(timeOnAir / dutyCycle - timeOnAir));
+    UpdateNextTransmissionTime(subBand);
 
     // Computation of necessary aggregate waiting time
     m_nextAggregatedTransmissionTime =
@@ -255,6 +316,172 @@ LogicalLoraChannelHelper::DisableChannel(int index)
     NS_LOG_FUNCTION(this << index);
 
     m_channelList.at(index)->DisableForUplink();
+    UpdateChannelMask();
+}
+
+void
+LogicalLoraChannelHelper::EnableChannel(int index)
+{
+    NS_LOG_FUNCTION(this << index);
+
+    m_channelList.at(index)->SetEnabledForUplink();
+    UpdateChannelMask();
+}
+
+LogicalLoraChannelHelper::ChannelMask
+LogicalLoraChannelHelper::GetChannelMask() const
+{
+    SyncChannelMask();
+    return m_channelMask;
+}
+
+void
+LogicalLoraChannelHelper::SetChannelMask(const ChannelMask& mask)
+{
+    NS_LOG_FUNCTION(this << mask);
+
+    NS_ASSERT_MSG((mask >> m_channelList.size()).none(), "The mask contains unknown channels");
+
+    for (uint32_t i = 0; i < m_channelList.size(); i++)
+    {
+        if (mask.test(i))
+        {
+            m_channelList[i]->SetEnabledForUplink();
+        }
+        else
+        {
+            m_channelList[i]->DisableForUplink();
+        }
+    }
+    UpdateChannelMask();
+}
+
+bool
+LogicalLoraChannelHelper::ComputeChannelMask(uint8_t chMaskCntl,
+                                             uint16_t chMask,
+                                             ChannelMask& mask) const
+{
+    NS_LOG_FUNCTION(this << unsigned(chMaskCntl) << chMask);
+
+    SyncChannelMask();
+    mask = m_channelMask;
+
+    uint32_t first;
+    if (chMaskCntl <= 5)
+    {
+        first = 16 * chMaskCntl;
+    }
+    else
+    {
+        // Switch all the channels below 64 on (6) or off (7)
+        first = 64;
+        for (uint32_t i = 0; i < std::min<uint32_t>(first, m_channelList.size()); i++)
+        {
+            mask.set(i, chMaskCntl == 6);
+        }
+    }
+
+    for (uint32_t bit = 0; bit < 16; bit++)
+    {
+        bool enabled = chMask & (1 << bit);
+        if (first + bit >= m_channelList.size())
+        {
+            if (enabled)
+            {
+                NS_LOG_DEBUG("Channel " << first + bit << " does not exist");
+                return false;
+            }
+            continue;
+        }
+        mask.set(first + bit, enabled);
+    }
+    return true;
+}
+
+Ptr<LogicalLoraChannel>
+LogicalLoraChannelHelper::PickChannel(uint8_t dataRate, Ptr<UniformRandomVariable> rv)
+{
+    NS_LOG_FUNCTION(this << unsigned(dataRate));
+
+    SyncChannelMask();
+    if (m_candidatesDataRate != dataRate)
+    {
+        m_candidates.clear();
+        for (uint32_t i = 0; i < m_channelList.size(); i++)
+        {
+            if (m_channelMask.test(i) && m_channelList[i]->GetMinimumDataRate() <= dataRate &&
+                m_channelList[i]->GetMaximumDataRate() >= dataRate)
+            {
+                m_candidates.push_back(i);
+            }
+        }
+        m_candidatesDataRate = dataRate;
+    }
+
+    uint32_t nCandidates = m_candidates.size();
+    if (nCandidates == 0)
+    {
+        return nullptr;
+    }
+
+    uint32_t index = m_candidates[rv->GetInteger(0, nCandidates - 1)];
+    Ptr<LogicalLoraChannel> channel = m_channelList[index];
+    if (GetWaitingTime(channel).IsZero())
+    {
+        return channel;
+    }
+
+    // Fall back on a uniform pick among the channels whose SubBand is available
+    std::vector<uint8_t> available;
+    for (auto index : m_candidates)
+    {
+        if (GetWaitingTime(m_channelList[index]).IsZero())
+        {
+            available.push_back(index);
+        }
+    }
+    if (available.empty())
+    {
+        NS_LOG_DEBUG("No channel is available because of the duty cycle");
+        return nullptr;
+    }
+    return m_channelList[available[rv->GetInteger(0, available.size() - 1)]];
+}
+
+void
+LogicalLoraChannelHelper::UpdateChannelMask() const
+{
+    NS_ASSERT_MSG(m_channelList.size() <= MAX_CHANNELS, "Too many channels");
+
+    m_channelMask.reset();
+    for (uint32_t i = 0; i < m_channelList.size(); i++)
+    {
+        m_channelMask.set(i, m_channelList[i]->IsEnabledForUplink());
+    }
+    m_channelVersions = GetChannelVersions();
+    m_candidatesDataRate = -1;
+}
+
+void
+LogicalLoraChannelHelper::SyncChannelMask() const
+{
+    // Only the changes to the channels of this helper rebuild the mask, the
+    // channels of the other devices don't matter
+    if (m_channelVersions != GetChannelVersions())
+    {
+        UpdateChannelMask();
+    }
+}
+
+uint64_t
+LogicalLoraChannelHelper::GetChannelVersions() const
+{
+    uint64_t versions = 0;
+    for (const auto& channel : m_channelList)
+    {
+        versions += channel->GetVersion();
+    }
+    return versions;
 }
 } // namespace lorawan
 } // namespace ns3
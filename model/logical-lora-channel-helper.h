@@ -15,7 +15,10 @@
 #include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
 
+#include <algorithm>
+#include <bitset>
 #include <iterator>
 #include <list>
 #include <vector>
@@ -35,10 +38,26 @@ namespace lorawan
  * This class also takes into account duty cycle limitations, by updating a list
  * of SubBand objects and providing methods to query whether transmission on a
  * set channel is admissible or not.
+ *
+ * The channels enabled for uplink are kept as a bitmask indexed like the
+ * channel list, so that the large channel plans of the US915 and AU915
+ * regions (64 + 8 channels) can be masked with ChMask / ChMaskCntl and
+ * searched in constant time. The enabled state of a channel must be changed
+ * through this helper, which keeps the LogicalLoraChannel objects in sync.
  */
 class LogicalLoraChannelHelper : public Object
 {
   public:
+    /**
+     * The maximum number of channels of a helper.
+     */
+    static constexpr uint32_t MAX_CHANNELS = 96;
+
+    /**
+     * The set of channels enabled for uplink, one bit per channel index.
+     */
+    typedef std::bitset<MAX_CHANNELS> ChannelMask;
+
     /**
      *  Register this type.
      *  \return The object TypeId.
@@ -70,6 +89,17 @@ class LogicalLoraChannelHelper : public Object
      */
     Time GetWaitingTime(Ptr<LogicalLoraChannel> channel);
 
+    /**
+     * Get the time it is necessary to wait for before transmitting on any of
+     * the channels enabled for uplink transmission, i.e., the waiting time of
+     * the earliest available SubBand that contains an enabled channel.
+     *
+     * \remark This function does not take into account aggregate waiting time.
+     *
+     * \return The waiting time, or Time::Max () if no channel is enabled.
+     */
+    Time GetEarliestWaitingTime();
+
     /**
      * Register the transmission of a packet.
      *
@@ -175,12 +205,113 @@ class LogicalLoraChannelHelper : public Object
      */
     void DisableChannel(int index);
 
+    /**
+     * Enable the channel at a specified index.
+     *
+     * \param index The index of the channel to enable.
+     */
+    void EnableChannel(int index);
+
+    /**
+     * Get the channels currently enabled for uplink.
+     *
+     * \return The channel mask.
+     */
+    ChannelMask GetChannelMask() const;
+
+    /**
+     * Enable exactly the channels of a mask for uplink.
+     *
+     * \param mask The channel mask. It must only contain existing channels.
+     */
+    void SetChannelMask(const ChannelMask& mask);
+
+    /**
+     * Compute the channel mask resulting from the ChMaskCntl and ChMask fields
+     * of a LinkAdrReq command, applied to the current channel mask.
+     *
+     * A ChMaskCntl value from 0 to 5 applies ChMask to the block of 16 channels
+     * starting at index 16 * ChMaskCntl. Values 6 and 7 respectively enable and
+     * disable all the channels below index 64, and apply ChMask to the
+     * channels from index 64 on, like the 500 kHz channels of the US915 plan.
+     *
+     * \param chMaskCntl The ChMaskCntl field.
+     * \param chMask The ChMask field.
+     * \param mask The resulting channel mask.
+     * \return False if the fields refer to channels that do not exist.
+     */
+    bool ComputeChannelMask(uint8_t chMaskCntl, uint16_t chMask, ChannelMask& mask) const;
+
+    /**
+     * Pick a random channel enabled for uplink that allows a data rate and
+     * whose SubBand is available now.
+     *
+     * The channels enabled for a data rate are cached, so that the pick takes
+     * a single random draw whenever the picked channel is available, as is
+     * always the case in the regions without duty cycle.
+     *
+     * \param dataRate The data rate of the transmission.
+     * \param rv The random variable to draw from.
+     * \return The channel, or nullptr if no channel is available.
+     */
+    Ptr<LogicalLoraChannel> PickChannel(uint8_t dataRate, Ptr<UniformRandomVariable> rv);
+
   private:
+    /**
+     * The next transmission time of a SubBand.
+     */
+    struct SubBandTime
+    {
+        int64_t ts;           //!< The next transmission time, in time steps
+        Ptr<SubBand> subBand; //!< The SubBand
+    };
+
+    /**
+     * Keep the entry of a SubBand in m_nextTransmissionTimes up to date with
+     * its next transmission time, and sorted.
+     *
+     * \param subBand The SubBand.
+     */
+    void UpdateNextTransmissionTime(Ptr<SubBand> subBand);
+
+    /**
+     * Rebuild the channel mask from the enabled state of the channels.
+     */
+    void UpdateChannelMask() const;
+
+    /**
+     * Rebuild the channel mask if a channel changed since the last update,
+     * including through the channels returned by GetChannelList.
+     */
+    void SyncChannelMask() const;
+
+    /**
+     * Get the sum of the versions of the channels, which changes whenever
+     * one of them does, since the versions only grow.
+     *
+     * \return The sum of the versions.
+     */
+    uint64_t GetChannelVersions() const;
+
+    /**
+     * Check whether a SubBand contains a channel enabled for uplink.
+     *
+     * \param subBand The SubBand.
+     * \return True if one of the channels of the SubBand is enabled.
+     */
+    bool HasEnabledChannel(Ptr<SubBand> subBand) const;
+
     /**
      * A list of the SubBands that are currently registered within this helper.
      */
     std::list<Ptr<SubBand>> m_subBandList;
 
+    /**
+     * The next transmission time of each SubBand, sorted from the earliest.
+     * There are only a few SubBands, so the order is kept by insertion.
+     */
+    std::vector<SubBandTime> m_nextTransmissionTimes;
+
     /**
      * A vector of the LogicalLoraChannels that are currently registered within
      * this helper. This vector represents the node's channel mask. The first N
@@ -188,6 +319,13 @@ class LogicalLoraChannelHelper : public Object
      */
     std::vector<Ptr<LogicalLoraChannel>> m_channelList;
 
+    mutable ChannelMask m_channelMask; //!< The channels enabled for uplink
+    /// The GetChannelVersions of the last update of the mask
+    mutable uint64_t m_channelVersions;
+
+    std::vector<uint8_t> m_candidates; //!< The enabled channels allowing m_candidatesDataRate
+    mutable int m_candidatesDataRate;  //!< The data rate of m_candidates, -1 if out of date
+
     Time m_nextAggregatedTransmissionTime; //!< The next time at which
     //! transmission will be possible
     //! according to the aggregated
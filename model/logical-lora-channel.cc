@@ -31,7 +31,8 @@ LogicalLoraChannel::LogicalLoraChannel()
     : m_frequency(0),
       m_minDataRate(0),
       m_maxDataRate(5),
-      m_enabledForUplink(true)
+      m_enabledForUplink(true),
+      m_version(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -43,7 +44,10 @@ LogicalLoraChannel::~LogicalLoraChannel()
 
 LogicalLoraChannel::LogicalLoraChannel(double frequency)
     : m_frequency(frequency),
-      m_enabledForUplink(true)
+      m_minDataRate(0),
+      m_maxDataRate(5),
+      m_enabledForUplink(true),
+      m_version(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -52,7 +56,8 @@ LogicalLoraChannel::LogicalLoraChannel(double frequency, uint8_t minDataRate, ui
     : m_frequency(frequency),
       m_minDataRate(minDataRate),
       m_maxDataRate(maxDataRate),
-      m_enabledForUplink(true)
+      m_enabledForUplink(true),
+      m_version(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -67,12 +72,14 @@ void
 LogicalLoraChannel::SetMinimumDataRate(uint8_t minDataRate)
 {
     m_minDataRate = minDataRate;
+    m_version++;
 }
 
 void
 LogicalLoraChannel::SetMaximumDataRate(uint8_t maxDataRate)
 {
     m_maxDataRate = maxDataRate;
+    m_version++;
 }
 
 uint8_t
@@ -91,12 +98,14 @@ void
 LogicalLoraChannel::SetEnabledForUplink()
 {
     m_enabledForUplink = true;
+    m_version++;
 }
 
 void
 LogicalLoraChannel::DisableForUplink()
 {
     m_enabledForUplink = false;
+    m_version++;
 }
 
 bool
@@ -105,6 +114,12 @@ LogicalLoraChannel::IsEnabledForUplink() const
     return m_enabledForUplink;
 }
 
+uint32_t
+LogicalLoraChannel::GetVersion() const
+{
+    return m_version;
+}
+
 bool
 operator==(const Ptr<LogicalLoraChannel>& first, const Ptr<LogicalLoraChannel>& second)
 {
@@ -113,11 +113,20 @@ class LogicalLoraChannel : public Object
      */
     bool IsEnabledForUplink() const;
 
+    /**
+     * Get the number of changes to the data rates or to the uplink state of
+     * this channel so far, for the users of the channel to detect them.
+     *
+     * \return The number of changes.
+     */
+    uint32_t GetVersion() const;
+
   private:
     double m_frequency;      //!< The central frequency of this channel, in MHz.
     uint8_t m_minDataRate;   //!< The minimum data rate that is allowed on this channel.
     uint8_t m_maxDataRate;   //!< The maximum data rate that is allowed on this channel.
     bool m_enabledForUplink; //!< Whether this channel can be used for uplink or not.
+    uint32_t m_version;      //!< The changes to this channel so far
 };
 
 /**
@@ -10,6 +10,7 @@
 
 #include "end-device-lora-phy.h"
 #include "gateway-lora-phy.h"
+#include "lora-profiler.h"
 
 #include "ns3/log.h"
 #include "ns3/object-factory.h"
@@ -107,16 +108,71 @@ LoraChannel::Send(Ptr<LoraPhy> sender,
                   double frequencyMHz) const
 {
     NS_LOG_FUNCTION(this << sender << packet << txPowerDbm << txParams << duration << frequencyMHz);
+    LORAWAN_PROFILE_SCOPE("LoraChannel::Send");
 
     // Get the mobility model of the sender
     Ptr<MobilityModel> senderMobility = sender->GetMobility()->GetObject<MobilityModel>();
 
     NS_ASSERT(senderMobility); // Make sure it's available
 
-    NS_LOG_INFO("Starting cycle over all " << m_phyList.size() << " PHYs");
     NS_LOG_INFO("Sender mobility: " << senderMobility->GetPosition());
 
+    uint32_t deliveries = Deliver(sender,
+                                  senderMobility,
+                                  packet,
+                                  txPowerDbm,
+                                  txParams.sf,
+                                  duration,
+                                  frequencyMHz,
+                                  Time(0));
+
+    // Fire the trace source for sent packet, once per receiving PHY
+    for (uint32_t k = 0; k < deliveries; k++)
+    {
+        m_packetSent(packet);
+    }
+}
+
+void
+LoraChannel::SendFrom(Ptr<MobilityModel> senderMobility,
+                      Ptr<Packet> packet,
+                      double txPowerDbm,
+                      LoraTxParameters txParams,
+                      Time duration,
+                      double frequencyMHz) const
+{
+    NS_LOG_FUNCTION(this << senderMobility << packet << txPowerDbm << txParams << duration
+                         << frequencyMHz);
+    LORAWAN_PROFILE_SCOPE("LoraChannel::SendFrom");
+
+    uint32_t deliveries = Deliver(nullptr,
+                                  senderMobility,
+                                  packet,
+                                  txPowerDbm,
+                                  txParams.sf,
+                                  duration,
+                                  frequencyMHz,
+                                  Time(0));
+    for (uint32_t k = 0; k < deliveries; k++)
+    {
+        m_packetSent(packet);
+    }
+}
+
+uint32_t
+LoraChannel::Deliver(Ptr<LoraPhy> sender,
+                     Ptr<MobilityModel> senderMobility,
+                     Ptr<Packet> packet,
+                     double txPowerDbm,
+                     uint8_t sf,
+                     Time duration,
+                     double frequencyMHz,
+                     Time elapsed) const
+{
+    NS_LOG_INFO("Starting cycle over all " << m_phyList.size() << " PHYs");
+
     // Cycle over all registered PHYs
+    uint32_t deliveries = 0;
     uint32_t j = 0;
     std::vector<Ptr<LoraPhy>>::const_iterator i;
     for (i = m_phyList.begin(); i != m_phyList.end(); i++, j++)
@@ -129,8 +185,10 @@ LoraChannel::Send(Ptr<LoraPhy> sender,
 
             NS_LOG_INFO("Receiver mobility: " << receiverMobility->GetPosition());
 
-            // Compute delay using the delay model
+            // Compute delay using the delay model, from the start of the
+            // transmission
             Time delay = m_delay->GetDelay(senderMobility, receiverMobility);
+            delay = delay > elapsed ? delay - elapsed : Time(0);
 
             // Compute received power using the loss model
             double rxPowerDbm = GetRxPower(txPowerDbm, senderMobility, receiverMobility);
@@ -157,7 +215,7 @@ LoraChannel::Send(Ptr<LoraPhy> sender,
             // Create the parameters object based on the calculations above
             LoraChannelParameters parameters;
             parameters.rxPowerDbm = rxPowerDbm;
-            parameters.sf = txParams.sf;
+            parameters.sf = sf;
             parameters.duration = duration;
             parameters.frequencyMHz = frequencyMHz;
 
@@ -170,11 +228,11 @@ LoraChannel::Send(Ptr<LoraPhy> sender,
                                            j,
                                            packet,
                                            parameters);
-
-            // Fire the trace source for sent packet
-            m_packetSent(packet);
+            LORAWAN_PROFILE_COUNT("LoraChannel::Send deliveries", 1);
+            deliveries++;
         }
     }
+    return deliveries;
 }
 
 void
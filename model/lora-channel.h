@@ -132,12 +132,32 @@ class LoraChannel : public Channel
      * When this method is called, the channel schedules an internal Receive call
      * that performs the actual call to the PHY's StartReceive function.
      */
-    void Send(Ptr<LoraPhy> sender,
-              Ptr<Packet> packet,
-              double txPowerDbm,
-              LoraTxParameters txParams,
-              Time duration,
-              double frequencyMHz) const;
+    virtual void Send(Ptr<LoraPhy> sender,
+                      Ptr<Packet> packet,
+                      double txPowerDbm,
+                      LoraTxParameters txParams,
+                      Time duration,
+                      double frequencyMHz) const;
+
+    /**
+     * Send a packet in the channel on behalf of a transmitter without a PHY,
+     * such as a virtual end device. Every connected PHY is notified as with
+     * Send.
+     *
+     * \param senderMobility The mobility model giving the position of the
+     * transmitter.
+     * \param packet The PHY layer packet that is being sent over the channel.
+     * \param txPowerDbm The power of the transmission.
+     * \param txParams The set of parameters that are used by the transmitter.
+     * \param duration The on-air duration of this packet.
+     * \param frequencyMHz The frequency this transmission will happen at.
+     */
+    void SendFrom(Ptr<MobilityModel> senderMobility,
+                  Ptr<Packet> packet,
+                  double txPowerDbm,
+                  LoraTxParameters txParams,
+                  Time duration,
+                  double frequencyMHz) const;
 
     /**
      * Compute the received power when transmitting from a point to another one.
@@ -155,6 +175,32 @@ class LoraChannel : public Channel
                       Ptr<MobilityModel> senderMobility,
                       Ptr<MobilityModel> receiverMobility) const;
 
+  protected:
+    /**
+     * Schedule the reception of a transmission at every connected PHY but the
+     * sender.
+     *
+     * \param sender The phy that is sending the packet, or nullptr if it is
+     * not connected to this channel.
+     * \param senderMobility The mobility model of the sender.
+     * \param packet The PHY layer packet that is being sent over the channel.
+     * \param txPowerDbm The power of the transmission.
+     * \param sf The spreading factor of the transmission.
+     * \param duration The on-air duration of the packet.
+     * \param frequencyMHz The frequency of the transmission.
+     * \param elapsed The time since the start of the transmission, which is
+     * subtracted from the propagation delay of each PHY.
+     * \return The number of PHYs the reception was scheduled at.
+     */
+    uint32_t Deliver(Ptr<LoraPhy> sender,
+                     Ptr<MobilityModel> senderMobility,
+                     Ptr<Packet> packet,
+                     double txPowerDbm,
+                     uint8_t sf,
+                     Time duration,
+                     double frequencyMHz,
+                     Time elapsed) const;
+
   private:
     /**
      * Private method that is scheduled by LoraChannel's Send method to happen
@@ -0,0 +1,286 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-distributed-channel.h"
+
+#include "ns3/abort.h"
+#include "ns3/distributed-simulator-impl.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraDistributedChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(LoraRemoteTransmissionTag);
+
+TypeId
+LoraRemoteTransmissionTag::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::LoraRemoteTransmissionTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("lorawan")
+                            .AddConstructor<LoraRemoteTransmissionTag>();
+    return tid;
+}
+
+TypeId
+LoraRemoteTransmissionTag::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+LoraRemoteTransmissionTag::LoraRemoteTransmissionTag()
+    : txPowerDbm(0),
+      sf(0),
+      frequencyMHz(0)
+{
+}
+
+LoraRemoteTransmissionTag::~LoraRemoteTransmissionTag()
+{
+}
+
+uint32_t
+LoraRemoteTransmissionTag::GetSerializedSize() const
+{
+    // The position, power and frequency are doubles, the spreading factor a
+    // byte, the duration and the start numbers of time steps
+    return 5 * sizeof(double) + 1 + 2 * sizeof(int64_t);
+}
+
+void
+LoraRemoteTransmissionTag::Serialize(TagBuffer i) const
+{
+    i.WriteDouble(position.x);
+    i.WriteDouble(position.y);
+    i.WriteDouble(position.z);
+    i.WriteDouble(txPowerDbm);
+    i.WriteU8(sf);
+    i.WriteU64(duration.GetTimeStep());
+    i.WriteDouble(frequencyMHz);
+    i.WriteU64(start.GetTimeStep());
+}
+
+void
+LoraRemoteTransmissionTag::Deserialize(TagBuffer i)
+{
+    position.x = i.ReadDouble();
+    position.y = i.ReadDouble();
+    position.z = i.ReadDouble();
+    txPowerDbm = i.ReadDouble();
+    sf = i.ReadU8();
+    duration = TimeStep(i.ReadU64());
+    frequencyMHz = i.ReadDouble();
+    start = TimeStep(i.ReadU64());
+}
+
+void
+LoraRemoteTransmissionTag::Print(std::ostream& os) const
+{
+    os << position << " " << txPowerDbm << " " << unsigned(sf) << " " << duration << " "
+       << frequencyMHz << " " << start;
+}
+
+NS_OBJECT_ENSURE_REGISTERED(LoraDistributedChannel);
+
+TypeId
+LoraDistributedChannel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LoraDistributedChannel")
+            .SetParent<LoraChannel>()
+            .SetGroupName("lorawan")
+            .AddConstructor<LoraDistributedChannel>()
+            .AddAttribute("MinEventSeparation",
+                          "The time between the start of a transmission and its reception on "
+                          "other ranks, bounding the lookahead of the distributed simulator",
+                          TimeValue(MicroSeconds(10)),
+                          MakeTimeAccessor(&LoraDistributedChannel::m_minEventSeparation),
+                          MakeTimeChecker(NanoSeconds(1)))
+            .AddAttribute("MaxRange",
+                          "The distance [m] beyond which transmissions are not received, used "
+                          "to send them only to the partitions they reach. 0 sends them to "
+                          "all partitions",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&LoraDistributedChannel::m_maxRange),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+LoraDistributedChannel::LoraDistributedChannel()
+    : m_lookAhead(0),
+      m_remoteSender(CreateObject<ConstantPositionMobilityModel>())
+{
+}
+
+LoraDistributedChannel::~LoraDistributedChannel()
+{
+}
+
+LoraDistributedChannel::LoraDistributedChannel(Ptr<PropagationLossModel> loss,
+                                               Ptr<PropagationDelayModel> delay)
+    : LoraChannel(loss, delay),
+      m_lookAhead(0),
+      m_remoteSender(CreateObject<ConstantPositionMobilityModel>())
+{
+}
+
+void
+LoraDistributedChannel::DoDispose()
+{
+    m_partitions.clear();
+    m_remoteSender = nullptr;
+    LoraChannel::DoDispose();
+}
+
+void
+LoraDistributedChannel::AddPartition(uint32_t systemId, Box region, Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(this << systemId << node);
+    NS_ASSERT_MSG(node->GetNDevices() > 0, "The node of a partition needs a device");
+    NS_ASSERT(node->GetSystemId() == systemId);
+
+    if (!MpiInterface::IsEnabled())
+    {
+        // A sequential simulation has no other partitions
+        return;
+    }
+    NS_ABORT_MSG_IF(systemId >= MpiInterface::GetSize(),
+                    "No rank " << systemId << " among the " << MpiInterface::GetSize());
+    // The lookahead is only computed when the simulation starts
+    NS_ABORT_MSG_UNLESS(Simulator::Now().IsZero(),
+                        "The partitions must be registered before the simulation starts");
+    if (systemId != MpiInterface::GetSystemId())
+    {
+        for (const auto& partition : m_partitions)
+        {
+            NS_ABORT_MSG_IF(partition.systemId == systemId,
+                            "The partition of rank " << systemId << " is already registered");
+        }
+        m_partitions.push_back({systemId, region, node->GetId(), 0});
+        return;
+    }
+
+    // This is the partition of this rank: receive the transmissions of the
+    // others, and bound the lookahead with the time they take to arrive
+    NS_ABORT_MSG_IF(m_lookAhead.IsStrictlyPositive(),
+                    "The partition of rank " << systemId << " is already registered");
+    NS_ABORT_MSG_IF(node->GetDevice(0)->GetObject<MpiReceiver>(),
+                    "The device of node " << node->GetId()
+                                          << " already receives from other ranks");
+    Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver>();
+    receiver->SetReceiveCallback(MakeCallback(&LoraDistributedChannel::ReceiveRemote, this));
+    node->GetDevice(0)->AggregateObject(receiver);
+
+    Ptr<DistributedSimulatorImpl> simulator =
+        DynamicCast<DistributedSimulatorImpl>(Simulator::GetImplementation());
+    NS_ABORT_MSG_UNLESS(simulator,
+                        "The LoraDistributedChannel needs the ns3::DistributedSimulatorImpl");
+    simulator->BoundLookAhead(m_minEventSeparation);
+    m_lookAhead = m_minEventSeparation;
+}
+
+Time
+LoraDistributedChannel::GetMinEventSeparation() const
+{
+    return m_minEventSeparation;
+}
+
+void
+LoraDistributedChannel::Send(Ptr<LoraPhy> sender,
+                             Ptr<Packet> packet,
+                             double txPowerDbm,
+                             LoraTxParameters txParams,
+                             Time duration,
+                             double frequencyMHz) const
+{
+    NS_LOG_FUNCTION(this << sender << packet << txPowerDbm << txParams << duration << frequencyMHz);
+
+    // The PHY layers of this partition
+    LoraChannel::Send(sender, packet, txPowerDbm, txParams, duration, frequencyMHz);
+
+    if (m_partitions.empty())
+    {
+        return;
+    }
+    // A remote transmission received earlier than the lookahead would be in
+    // the past of the receiving rank
+    NS_ABORT_MSG_IF(m_lookAhead.IsZero(), "The partition of this rank is not registered");
+    NS_ABORT_MSG_IF(m_minEventSeparation != m_lookAhead,
+                    "The MinEventSeparation changed after the lookahead was bounded");
+
+    // The partitions of the other ranks within reach
+    LoraRemoteTransmissionTag tag;
+    tag.position = sender->GetMobility()->GetObject<MobilityModel>()->GetPosition();
+    tag.txPowerDbm = txPowerDbm;
+    tag.sf = txParams.sf;
+    tag.duration = duration;
+    tag.frequencyMHz = frequencyMHz;
+    tag.start = Simulator::Now();
+    for (const auto& partition : m_partitions)
+    {
+        if (m_maxRange > 0 && GetDistance(tag.position, partition.region) > m_maxRange)
+        {
+            continue;
+        }
+        NS_LOG_DEBUG("Sending the transmission to rank " << partition.systemId);
+        Ptr<Packet> copy = packet->Copy();
+        copy->AddPacketTag(tag);
+        MpiInterface::SendPacket(copy,
+                                 tag.start + m_lookAhead,
+                                 partition.nodeId,
+                                 partition.ifIndex);
+    }
+}
+
+void
+LoraDistributedChannel::ReceiveRemote(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+
+    // The packets come from another process, so they are checked in all
+    // builds
+    LoraRemoteTransmissionTag tag;
+    NS_ABORT_MSG_UNLESS(packet->RemovePacketTag(tag),
+                        "A remote transmission without its parameters");
+    NS_ABORT_MSG_UNLESS(tag.duration.IsStrictlyPositive(),
+                        "A remote transmission of duration " << tag.duration);
+    // The delays of the receptions count from the start of the transmission
+    Time elapsed = Simulator::Now() - tag.start;
+    NS_ABORT_MSG_IF(elapsed.IsNegative(),
+                    "A remote transmission received before its start at " << tag.start);
+
+    m_remoteSender->SetPosition(tag.position);
+    Deliver(nullptr,
+            m_remoteSender,
+            packet,
+            tag.txPowerDbm,
+            tag.sf,
+            tag.duration,
+            tag.frequencyMHz,
+            elapsed);
+}
+
+double
+LoraDistributedChannel::GetDistance(const Vector& position, const Box& region)
+{
+    // The distance from the closest point of the region
+    double dx = position.x - std::clamp(position.x, region.xMin, region.xMax);
+    double dy = position.y - std::clamp(position.y, region.yMin, region.yMax);
+    double dz = position.z - std::clamp(position.z, region.zMin, region.zMax);
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace lorawan
+} // namespace ns3
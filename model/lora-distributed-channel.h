@@ -0,0 +1,182 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_DISTRIBUTED_CHANNEL_H
+#define LORA_DISTRIBUTED_CHANNEL_H
+
+#include "lora-channel.h"
+
+#include "ns3/box.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/node.h"
+#include "ns3/tag.h"
+#include "ns3/vector.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Packet tag carrying the parameters of a transmission to the partitions of
+ * other MPI ranks, which the receiving LoraDistributedChannel needs to
+ * compute the power and the delay at its own PHY layers.
+ */
+class LoraRemoteTransmissionTag : public Tag
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+
+    LoraRemoteTransmissionTag();           //!< Default constructor
+    ~LoraRemoteTransmissionTag() override; //!< Destructor
+
+    void Serialize(TagBuffer i) const override;
+    void Deserialize(TagBuffer i) override;
+    uint32_t GetSerializedSize() const override;
+    void Print(std::ostream& os) const override;
+
+    Vector position;     //!< The position of the sender
+    double txPowerDbm;   //!< The power of the transmission
+    uint8_t sf;          //!< The spreading factor of the transmission
+    Time duration;       //!< The duration of the transmission
+    double frequencyMHz; //!< The frequency of the transmission [MHz]
+    Time start;          //!< The start of the transmission
+};
+
+/**
+ * \ingroup lorawan
+ *
+ * A LoraChannel for distributed simulations, where the nodes are partitioned
+ * spatially across MPI ranks.
+ *
+ * Each rank has its own channel, with the PHY layers of its own nodes, which
+ * receive the transmissions of each other as with a LoraChannel. The region
+ * of each rank is registered with AddPartition, together with a node of the
+ * rank that receives the transmissions of the other ranks. A transmission is
+ * sent to another rank only if the region of that rank is within MaxRange of
+ * the sender, i.e., if the coverage footprint of the transmission crosses the
+ * boundary of the partition. There the channel delivers it to its own PHY
+ * layers, computing their power and delay from the position of the sender.
+ *
+ * The remote transmissions are received MinEventSeparation after their
+ * start, which bounds the lookahead of the distributed simulator: the larger
+ * the separation, the fewer the synchronizations among ranks. The lookahead is
+ * bounded when the partition of the rank is registered, so the partitions are
+ * registered before the simulation starts, and the separation is not changed
+ * afterwards. Receptions that would start earlier than the separation, at the
+ * PHY layers closer to the sender than the distance travelled in the
+ * separation, start the separation after the start of the transmission
+ * instead. With a deterministic loss
+ * model the outcomes are otherwise those of a LoraChannel; random loss models
+ * draw their values in a different order, so the outcomes are only
+ * statistically the same. Loss models that need other objects aggregated to
+ * the mobility of the sender, like the BuildingPenetrationLoss, are not
+ * supported across partitions.
+ *
+ * Without MPI, or with a single rank, the channel is a LoraChannel.
+ */
+class LoraDistributedChannel : public LoraChannel
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    LoraDistributedChannel();           //!< Default constructor
+    ~LoraDistributedChannel() override; //!< Destructor
+
+    /**
+     * Construct a LoraDistributedChannel with a loss and delay model.
+     *
+     * \param loss The loss model to associate to this channel.
+     * \param delay The delay model to associate to this channel.
+     */
+    LoraDistributedChannel(Ptr<PropagationLossModel> loss, Ptr<PropagationDelayModel> delay);
+
+    /**
+     * Register the partition of an MPI rank. The same partitions must be
+     * registered on all ranks.
+     *
+     * \param systemId The rank.
+     * \param region The region of the nodes of the rank.
+     * \param node A node of the rank, receiving the transmissions of the
+     * other ranks with its first device.
+     */
+    void AddPartition(uint32_t systemId, Box region, Ptr<Node> node);
+
+    void Send(Ptr<LoraPhy> sender,
+              Ptr<Packet> packet,
+              double txPowerDbm,
+              LoraTxParameters txParams,
+              Time duration,
+              double frequencyMHz) const override;
+
+    /**
+     * Get the minimum separation between the start of a transmission and its
+     * reception on another rank, which bounds the lookahead of the distributed
+     * simulator.
+     *
+     * \return The separation.
+     */
+    Time GetMinEventSeparation() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * The partition of an MPI rank.
+     */
+    struct Partition
+    {
+        uint32_t systemId; //!< The rank
+        Box region;        //!< The region of its nodes
+        uint32_t nodeId;   //!< The node receiving its remote transmissions
+        uint32_t ifIndex;  //!< The device receiving its remote transmissions
+    };
+
+    /**
+     * Compute the distance between a position and a region.
+     *
+     * \param position The position.
+     * \param region The region.
+     * \return The distance [m], 0 if the position is in the region.
+     */
+    static double GetDistance(const Vector& position, const Box& region);
+
+    /**
+     * Deliver a transmission received from another rank to the PHY layers of
+     * this partition.
+     *
+     * \param packet The packet, with a LoraRemoteTransmissionTag.
+     */
+    void ReceiveRemote(Ptr<Packet> packet);
+
+    std::vector<Partition> m_partitions; //!< The partitions of the other ranks
+    Time m_minEventSeparation;           //!< The separation of remote receptions
+    double m_maxRange;                   //!< The range of the transmissions [m]
+
+    /// The separation the lookahead was bounded with, 0 until the partition
+    /// of this rank is registered
+    Time m_lookAhead;
+
+    /// The mobility of the senders of remote transmissions
+    Ptr<ConstantPositionMobilityModel> m_remoteSender;
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_DISTRIBUTED_CHANNEL_H */
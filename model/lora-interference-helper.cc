@@ -8,6 +8,8 @@
 
 #include "lora-interference-helper.h"
 
+#include "lora-profiler.h"
+
 #include "ns3/enum.h"
 #include "ns3/log.h"
 
@@ -32,7 +34,26 @@ LoraInterferenceHelper::Event::Event(Time duration,
 									 uint16_t nodeId,
                                      Ptr<Packet> packet,
                                      double frequencyMHz)
-    : m_startTime(Simulator::Now()),
+    : Event(Simulator::Now(),
+            duration,
+            rxPowerdBm,
+            spreadingFactor,
+            irType,
+            nodeId,
+            packet,
+            frequencyMHz)
+{
+}
+
+LoraInterferenceHelper::Event::Event(Time startTime,
+                                     Time duration,
+                                     double rxPowerdBm,
+                                     uint8_t spreadingFactor,
+                                     uint8_t irType,
+                                     uint16_t nodeId,
+                                     Ptr<Packet> packet,
+                                     double frequencyMHz)
+    : m_startTime(startTime),
       m_endTime(m_startTime + duration),
       m_sf(spreadingFactor),
 	  m_irType(irType),
@@ -172,6 +193,24 @@ LoraInterferenceHelper::SetCollisionMatrix(
     }
 }
 
+LoraInterferenceHelper::Hypothesis::Hypothesis()
+    : collisionSnir(LoraInterferenceHelper::collisionMatrix == LoraInterferenceHelper::ALOHA
+                        ? LoraInterferenceHelper::collisionSnirAloha
+                        : LoraInterferenceHelper::collisionSnirGoursaud),
+      incrementalRedundancy(NOREDUNDANCY),
+      nReceptionPaths(8)
+{
+}
+
+void
+LoraInterferenceHelper::Hypothesis::SetCaptureThreshold(double thresholdDb)
+{
+    for (uint8_t sf = 0; sf < 6; sf++)
+    {
+        collisionSnir[sf][sf] = thresholdDb;
+    }
+}
+
 TypeId
 LoraInterferenceHelper::GetTypeId()
 {
@@ -206,16 +245,37 @@ LoraInterferenceHelper::Add(Time duration,
                             Ptr<Packet> packet,
                             double frequencyMHz)
 {
-    NS_LOG_FUNCTION(this << duration.GetSeconds() << rxPower << unsigned(spreadingFactor) << packet
-                         << frequencyMHz);
+    return Add(Simulator::Now(),
+               duration,
+               rxPower,
+               spreadingFactor,
+               irType,
+               nodeId,
+               packet,
+               frequencyMHz);
+}
+
+Ptr<LoraInterferenceHelper::Event>
+LoraInterferenceHelper::Add(Time startTime,
+                            Time duration,
+                            double rxPower,
+                            uint8_t spreadingFactor,
+                            uint8_t irType,
+                            uint16_t nodeId,
+                            Ptr<Packet> packet,
+                            double frequencyMHz)
+{
+    NS_LOG_FUNCTION(this << startTime.GetSeconds() << duration.GetSeconds() << rxPower
+                         << unsigned(spreadingFactor) << packet << frequencyMHz);
 
     // Create an event based on the parameters
     Ptr<LoraInterferenceHelper::Event> event =
-        Create<LoraInterferenceHelper::Event>(duration,
+        Create<LoraInterferenceHelper::Event>(startTime,
+                                              duration,
                                               rxPower,
                                               spreadingFactor,
-									 		  irType,
-									 		  nodeId,
+                                              irType,
+                                              nodeId,
                                               packet,
                                               frequencyMHz);
 
@@ -225,21 +285,59 @@ LoraInterferenceHelper::Add(Time duration,
     // Clean the event list
     if (m_events.size() > 100)
     {
-        CleanOldEvents();
+        CleanOldEvents(startTime);
     }
 
     return event;
 }
 
+void
+LoraInterferenceHelper::SetCollisionSnir(const std::vector<std::vector<double>>& collisionSnir)
+{
+    NS_ASSERT(collisionSnir.size() == 6);
+    m_collisionSnir = collisionSnir;
+}
+
+void
+LoraInterferenceHelper::SetIncrementalRedundancy(IncrementalRedundancy incrementalRedundancy)
+{
+    m_incrementalRed = incrementalRedundancy;
+}
+
+void
+LoraInterferenceHelper::SetHypotheses(const std::vector<Hypothesis>& hypotheses)
+{
+    NS_LOG_FUNCTION(this << hypotheses.size());
+
+    for (const auto& hypothesis : hypotheses)
+    {
+        NS_ASSERT(hypothesis.collisionSnir.size() == 6);
+    }
+    m_hypotheses = hypotheses;
+    m_hypothesisChaseCombiningSnir.assign(hypotheses.size(), ChaseCombiningSnir());
+}
+
+const std::vector<LoraInterferenceHelper::Hypothesis>&
+LoraInterferenceHelper::GetHypotheses() const
+{
+    return m_hypotheses;
+}
+
 void
 LoraInterferenceHelper::CleanOldEvents()
 {
-    NS_LOG_FUNCTION(this);
+    CleanOldEvents(Simulator::Now());
+}
+
+void
+LoraInterferenceHelper::CleanOldEvents(Time now)
+{
+    NS_LOG_FUNCTION(this << now);
 
     // Cycle the events, and clean up if an event is old.
     for (auto it = m_events.begin(); it != m_events.end();)
     {
-        if ((*it)->GetEndTime() + oldEventThreshold < Simulator::Now())
+        if ((*it)->GetEndTime() + oldEventThreshold < now)
         {
             it = m_events.erase(it);
         }
@@ -256,6 +354,32 @@ LoraInterferenceHelper::GetInterferers()
     return m_events;
 }
 
+uint32_t
+LoraInterferenceHelper::GetNEvents() const
+{
+    return m_events.size();
+}
+
+uint32_t
+LoraInterferenceHelper::GetNChaseCombiningDevices() const
+{
+    return m_chaseCombiningSnir.size();
+}
+
+uint64_t
+LoraInterferenceHelper::GetNChaseCombiningValues() const
+{
+    uint64_t nValues = 0;
+    for (const auto& [nodeId, snirPerSf] : m_chaseCombiningSnir)
+    {
+        for (const auto& values : snirPerSf)
+        {
+            nValues += values.size();
+        }
+    }
+    return nValues;
+}
+
 void
 LoraInterferenceHelper::PrintEvents(std::ostream& stream)
 {
@@ -274,45 +398,77 @@ uint8_t
 LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Event> event)
 {
     NS_LOG_FUNCTION(this << event);
+    LORAWAN_PROFILE_SCOPE("LoraInterferenceHelper::IsDestroyedByInterference");
+
+    return IsDestroyed(event,
+                       GetCumulativeInterferenceEnergy(event),
+                       m_collisionSnir,
+                       event->GetIrType(),
+                       m_chaseCombiningSnir);
+}
+
+uint8_t
+LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Event> event,
+                                                  bool primary,
+                                                  const std::vector<bool>& hypotheses,
+                                                  std::vector<uint8_t>& destroyedBy)
+{
+    NS_LOG_FUNCTION(this << event << primary);
+    LORAWAN_PROFILE_SCOPE("LoraInterferenceHelper::IsDestroyedByInterference");
+    NS_ASSERT(hypotheses.size() == m_hypotheses.size());
 
+    // The interference is the same under all hypotheses, only the way it is
+    // judged differs
+    std::vector<double> cumulativeInterferenceEnergy = GetCumulativeInterferenceEnergy(event);
+
+    destroyedBy.assign(m_hypotheses.size(), 0);
+    for (uint32_t h = 0; h < m_hypotheses.size(); h++)
+    {
+        if (hypotheses[h])
+        {
+            NS_LOG_DEBUG("Evaluating hypothesis " << h);
+            destroyedBy[h] = IsDestroyed(event,
+                                         cumulativeInterferenceEnergy,
+                                         m_hypotheses[h].collisionSnir,
+                                         m_hypotheses[h].incrementalRedundancy,
+                                         m_hypothesisChaseCombiningSnir[h]);
+        }
+    }
+
+    if (!primary)
+    {
+        return uint8_t(0);
+    }
+    return IsDestroyed(event,
+                       cumulativeInterferenceEnergy,
+                       m_collisionSnir,
+                       event->GetIrType(),
+                       m_chaseCombiningSnir);
+}
+
+std::vector<double>
+LoraInterferenceHelper::GetCumulativeInterferenceEnergy(Ptr<LoraInterferenceHelper::Event> event)
+{
     NS_LOG_INFO("Current number of events in LoraInterferenceHelper: " << m_events.size());
 
     // We want to see the interference affecting this event: cycle through events
     // that overlap with this one and see whether it survives the interference or
     // not.
-
-    // Gather information about the event
-    double rxPowerDbm = event->GetRxPowerdBm();
-    uint8_t sf = event->GetSpreadingFactor();
-	uint16_t nodeId = event->GetNodeId();
     double frequency = event->GetFrequency();
 
-    // Handy information about the time frame when the packet was received
-    Time now = Simulator::Now();
-    Time duration = event->GetDuration();
-    Time packetStartTime = now - duration;
-  	Time packetEndTime = now;
-
-    // Get the list of interfering events
-    std::list<Ptr<LoraInterferenceHelper::Event>>::iterator it;
-
     // Energy for interferers of various SFs
     std::vector<double> cumulativeInterferenceEnergy(6, 0);
 
     // Cycle over the events
-    for (it = m_events.begin(); it != m_events.end();)
+    for (const auto& interferer : m_events)
     {
-        // Pointer to the current interferer
-        Ptr<LoraInterferenceHelper::Event> interferer = *it;
-
         // Only consider the current event if the channel is the same: we
         // assume there's no interchannel interference. Also skip the current
         // event if it's the same that we want to analyze.
         if (!(interferer->GetFrequency() == frequency) || interferer == event)
         {
             NS_LOG_DEBUG("Different channel or same event");
-            it++;
-            continue; // Continues from the first line inside the for cycle
+            continue;
         }
 
         NS_LOG_DEBUG("Interferer on same channel");
@@ -320,13 +476,12 @@ LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Ev
         // Gather information about this interferer
         uint8_t interfererSf = interferer->GetSpreadingFactor();
         double interfererPower = interferer->GetRxPowerdBm();
-        Time interfererStartTime = interferer->GetStartTime();
-        Time interfererEndTime = interferer->GetEndTime();
 
         NS_LOG_INFO("Found an interferer: sf = " << unsigned(interfererSf)
                                                  << ", power = " << interfererPower
-                                                 << ", start time = " << interfererStartTime
-                                                 << ", end time = " << interfererEndTime);
+                                                 << ", start time = "
+                                                 << interferer->GetStartTime()
+                                                 << ", end time = " << interferer->GetEndTime());
 
         // Compute the fraction of time the two events are overlapping
         Time overlap = GetOverlapTime(event, interferer);
@@ -342,9 +497,24 @@ LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Ev
         cumulativeInterferenceEnergy.at(unsigned(interfererSf) - 7) += interferenceEnergy;
         NS_LOG_DEBUG("Interferer power in W: " << interfererPowerW);
         NS_LOG_DEBUG("Interference energy: " << interferenceEnergy);
-        it++;
     }
 
+    return cumulativeInterferenceEnergy;
+}
+
+uint8_t
+LoraInterferenceHelper::IsDestroyed(Ptr<LoraInterferenceHelper::Event> event,
+                                    const std::vector<double>& cumulativeInterferenceEnergy,
+                                    const std::vector<std::vector<double>>& collisionSnir,
+                                    uint8_t irType,
+                                    ChaseCombiningSnir& chaseCombiningSnir)
+{
+    // Gather information about the event
+    double rxPowerDbm = event->GetRxPowerdBm();
+    uint8_t sf = event->GetSpreadingFactor();
+    uint16_t nodeId = event->GetNodeId();
+    Time duration = event->GetDuration();
+
     // For each spreading factor, check if there was destructive interference
     for (auto currentSf = uint8_t(7); currentSf <= uint8_t(12); currentSf++)
     {
@@ -359,61 +529,41 @@ LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Ev
         NS_LOG_DEBUG("Signal energy: " << signalEnergy);
 
         // Check whether the packet survives the interference of this spreading factor
-        double snirIsolation = m_collisionSnir[unsigned(sf) - 7][unsigned(currentSf) - 7];
+        double snirIsolation = collisionSnir[unsigned(sf) - 7][unsigned(currentSf) - 7];
         NS_LOG_DEBUG("The needed isolation to survive is " << snirIsolation << " dB");
 
-	  	double snir;
-	  	if(event->GetIrType()){
-			snir = signalEnergy / cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7);
-	  		//double snir_p =	10 * log10 (signalEnergy / cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-   		
-			NS_LOG_DEBUG ("The current SNIR_CC is " << snir << " W");
-      	}else{
-	  		snir = 10 * log10 (signalEnergy / cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-	  		NS_LOG_DEBUG ("The current SNIR_NC is " << snir << " dB");
-      	}
-	  
-
-		//	if (nodeId == 44)
-		//		std::cout << "node: " << nodeId << " SNIR: " << snir << " sign sf: " << unsigned(sf) << " current sf: " << unsigned(currentSf) << std::endl;
-	
-	 	uint8_t id = 0; 
-     	// add incremental redundancy case 
-	  	switch ( event->GetIrType() ) {
-			  case CHASECOMBINING:
-				if(m_chaseCombiningSnir.count(nodeId)>0){
-					if(m_chaseCombiningSnir[nodeId][currentSf - 7].size()>0){
-						m_chaseCombiningSnir[nodeId][currentSf - 7].at(0)+=snir;
-						m_chaseCombiningSnir[nodeId][currentSf - 7].at(1)++;
-						//if (nodeId == 44)
-						//	std::cout << "The SNIRp CH is " << m_chaseCombiningSnir[unsigned(nodeId)][unsigned(currentSf) - 7].at(0) << std::endl;
-					}else{
-						m_chaseCombiningSnir[nodeId][currentSf - 7].resize(2);
-						m_chaseCombiningSnir[nodeId][currentSf - 7].at(0)=snir;
-						m_chaseCombiningSnir[nodeId][currentSf - 7].at(1)=1;
-						//if (nodeId == 44)
-						//	std::cout << "I The SNIRp CH is "<< m_chaseCombiningSnir[unsigned(nodeId)][unsigned(currentSf) - 7].at(0) << std::endl;
-					}
-				}else{
-					m_chaseCombiningSnir[nodeId].resize(6);
-					m_chaseCombiningSnir[nodeId][currentSf - 7].resize(2);
-					m_chaseCombiningSnir[nodeId][currentSf - 7].at(0)=snir;
-					m_chaseCombiningSnir[nodeId][currentSf - 7].at(1)=1;
-					//if (nodeId == 44)
-					//	std::cout << "I The SNIRp CH is " << m_chaseCombiningSnir[unsigned(nodeId)][unsigned(currentSf) - 7].at(0) << std::endl;
-				}
-				snir = m_chaseCombiningSnir[nodeId][currentSf - 7].at(0);
-				id = m_chaseCombiningSnir[nodeId][currentSf - 7].at(1);
-				snir=10*log10(snir);
-				//if (nodeId == 44)
-				//	std::cout << "id: " << unsigned(id) << " The SNIR CH is " << snir << " dB, The SNIR is " << snir_p << " dB" << std::endl;
-  
- 				NS_LOG_DEBUG( "id: " << (unsigned)id << " The acumulated SNIR_CC is " << snir << " dB");
-		  	  break;
-			  default:
-			  break;
-	  	}	/* -----  end switch  ----- */
+        double snir;
+        if (irType)
+        {
+            snir = signalEnergy / cumulativeInterferenceEnergy.at(unsigned(currentSf) - 7);
+            NS_LOG_DEBUG("The current SNIR_CC is " << snir << " W");
+        }
+        else
+        {
+            snir = 10 * log10(signalEnergy /
+                              cumulativeInterferenceEnergy.at(unsigned(currentSf) - 7));
+            NS_LOG_DEBUG("The current SNIR_NC is " << snir << " dB");
+        }
 
+        // add incremental redundancy case
+        if (irType == CHASECOMBINING)
+        {
+            std::vector<std::vector<double>>& nodeSnir = chaseCombiningSnir[nodeId];
+            nodeSnir.resize(6);
+            std::vector<double>& sfSnir = nodeSnir[currentSf - 7];
+            if (!sfSnir.empty())
+            {
+                sfSnir.at(0) += snir;
+                sfSnir.at(1)++;
+            }
+            else
+            {
+                sfSnir = {snir, 1};
+            }
+            snir = 10 * log10(sfSnir.at(0));
+            NS_LOG_DEBUG("id: " << unsigned(uint8_t(sfSnir.at(1)))
+                                << " The acumulated SNIR_CC is " << snir << " dB");
+        }
 
         if (snir >= snirIsolation)
         {
@@ -427,11 +577,8 @@ LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Ev
             return currentSf;
         }
     }
-    
-
 
-
-	// If we get to here, it means that the packet survived all interference
+    // If we get to here, it means that the packet survived all interference
     NS_LOG_DEBUG("Packet survived all interference");
 
     // Since the packet was not destroyed, we return 0.
@@ -461,8 +608,28 @@ LoraInterferenceHelper::ClearIndexUmap (uint16_t idx)
   	}
 }
 
+void
+LoraInterferenceHelper::ClearIndexUmap(uint16_t idx, uint32_t hypothesis)
+{
+    NS_LOG_FUNCTION(this << idx << hypothesis);
+
+    auto it = m_hypothesisChaseCombiningSnir.at(hypothesis).find(idx);
+    if (it == m_hypothesisChaseCombiningSnir[hypothesis].end())
+    {
+        return;
+    }
+    for (auto& sfSnir : it->second)
+    {
+        if (!sfSnir.empty())
+        {
+            sfSnir.at(0) = 0;
+            sfSnir.at(1) = 0;
+        }
+    }
+}
+
 uint8_t 
-LoraInterferenceHelper::GetIncrementalRedundancy (void){
+LoraInterferenceHelper::GetIncrementalRedundancy (void) const{
 	NS_LOG_FUNCTION_NOARGS();
 
 	return(m_incrementalRed);
@@ -19,6 +19,8 @@
 #include "ns3/traced-callback.h"
 
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -63,6 +65,28 @@ class LoraInterferenceHelper
               Ptr<Packet> packet,
               double frequencyMHz);
 
+        /**
+         * Construct a new interference signal Event object starting at a
+         * given time, rather than now.
+         *
+         * \param startTime The time the signal begins.
+         * \param duration The duration in time.
+         * \param rxPowerdBm The power of the signal.
+         * \param spreadingFactor The modulation spreading factor.
+         * \param irType The incremental redundancy type.
+         * \param nodeId The node id of the transmitter.
+         * \param packet The packet transmitted.
+         * \param frequencyMHz The carrier frequency of the signal.
+         */
+        Event(Time startTime,
+              Time duration,
+              double rxPowerdBm,
+              uint8_t spreadingFactor,
+              uint8_t irType,
+              uint16_t nodeId,
+              Ptr<Packet> packet,
+              double frequencyMHz);
+
         ~Event(); //!< Destructor
 
         /**
@@ -161,6 +185,29 @@ class LoraInterferenceHelper
 		BUNDLEPARITY,
   	};
 
+    /**
+     * A set of PHY parameters under which receptions are evaluated alongside
+     * those of the helper, which keep deciding the receptions.
+     */
+    struct Hypothesis
+    {
+        Hypothesis(); //!< The parameters of the default gateways
+
+        /**
+         * Set the isolation [dB] a signal needs from the interference of its
+         * own spreading factor, the diagonal of the collision matrix.
+         *
+         * \param thresholdDb The capture threshold [dB].
+         */
+        void SetCaptureThreshold(double thresholdDb);
+
+        /// The isolation [dB] each spreading factor needs from each other
+        std::vector<std::vector<double>> collisionSnir;
+        /// The incremental redundancy of the receptions
+        IncrementalRedundancy incrementalRedundancy;
+        uint32_t nReceptionPaths; //!< The number of reception paths of the gateway
+    };
+
     /**
      *  Register this type.
      *  \return The object TypeId.
@@ -189,6 +236,64 @@ class LoraInterferenceHelper
                                            Ptr<Packet> packet,
                                            double frequencyMHz);
 
+    /**
+     * Add an event starting at a given time, rather than now, to the
+     * InterferenceHelper. Events must be added in the order of their start.
+     * This does not depend on the simulator, so that receptions can be
+     * evaluated outside of a simulation.
+     *
+     * \param startTime The time the transmission begins.
+     * \param duration The duration of the packet.
+     * \param rxPower The received power in dBm.
+     * \param spreadingFactor The spreading factor used by the transmission.
+     * \param irType The incremental redundancy type.
+     * \param nodeId The node id of the transmitter.
+     * \param packet The packet carried by this transmission.
+     * \param frequencyMHz The frequency this event was sent at.
+     *
+     * \return The newly created event.
+     */
+    Ptr<LoraInterferenceHelper::Event> Add(Time startTime,
+                                           Time duration,
+                                           double rxPower,
+                                           uint8_t spreadingFactor,
+                                           uint8_t irType,
+                                           uint16_t nodeId,
+                                           Ptr<Packet> packet,
+                                           double frequencyMHz);
+
+    /**
+     * Set the matrix of the isolation [dB] a signal needs from the
+     * interference of each spreading factor to survive, by spreading factor of
+     * the signal, in place of the collision matrix. The diagonal holds the
+     * capture thresholds.
+     *
+     * \param collisionSnir The matrix, 6 by 6.
+     */
+    void SetCollisionSnir(const std::vector<std::vector<double>>& collisionSnir);
+
+    /**
+     * Set the incremental redundancy of the receptions.
+     *
+     * \param incrementalRedundancy The type of incremental redundancy.
+     */
+    void SetIncrementalRedundancy(IncrementalRedundancy incrementalRedundancy);
+
+    /**
+     * Set the hypotheses to evaluate the receptions under, besides the
+     * parameters of the helper, discarding their chase combining state.
+     *
+     * \param hypotheses The hypotheses, none by default.
+     */
+    void SetHypotheses(const std::vector<Hypothesis>& hypotheses);
+
+    /**
+     * Get the hypotheses the receptions are evaluated under.
+     *
+     * \return The hypotheses.
+     */
+    const std::vector<Hypothesis>& GetHypotheses() const;
+
     /**
      * Get a list of the interferers currently registered at this InterferenceHelper.
      *
@@ -196,6 +301,28 @@ class LoraInterferenceHelper
      */
     std::list<Ptr<LoraInterferenceHelper::Event>> GetInterferers();
 
+    /**
+     * Get the number of events currently registered at this InterferenceHelper.
+     *
+     * \return The number of events.
+     */
+    uint32_t GetNEvents() const;
+
+    /**
+     * Get the number of devices with chase combining state.
+     *
+     * \return The number of devices.
+     */
+    uint32_t GetNChaseCombiningDevices() const;
+
+    /**
+     * Get the number of SNIR values kept for chase combining, over all the
+     * devices.
+     *
+     * \return The number of values.
+     */
+    uint64_t GetNChaseCombiningValues() const;
+
     /**
      * Print the events that are saved in this helper in a human readable format.
      *
@@ -214,6 +341,24 @@ class LoraInterferenceHelper
      */
     uint8_t IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Event> event);
 
+    /**
+     * Determine whether the event was destroyed by interference under the
+     * parameters of the helper and under a subset of the hypotheses, computing
+     * the interference energy of each spreading factor once for all of them.
+     *
+     * \param event The event for which to check the outcome.
+     * \param primary Whether to evaluate the parameters of the helper.
+     * \param hypotheses Whether to evaluate each hypothesis.
+     * \param destroyedBy The sf of the packets that caused the loss under each
+     * evaluated hypothesis, or 0 if there was no loss, filled.
+     * \return The sf of the packets that caused the loss under the parameters
+     * of the helper, or 0 if there was no loss or they were not evaluated.
+     */
+    uint8_t IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Event> event,
+                                      bool primary,
+                                      const std::vector<bool>& hypotheses,
+                                      std::vector<uint8_t>& destroyedBy);
+
     /**
      * Compute the time duration in which two given events are overlapping.
      *
@@ -238,19 +383,58 @@ class LoraInterferenceHelper
   	/**
    	*  in this LoraInterferenceHelper.
    	*/
-  	uint8_t GetIncrementalRedundancy (void);
+  	uint8_t GetIncrementalRedundancy (void) const;
 
   	/**
    	* Delete index in unordered map in the LoraInterferenceHelper.
    	*/
   	void  ClearIndexUmap(uint16_t idx);
 
+    /**
+     * Delete the chase combining state of a device under a hypothesis.
+     *
+     * \param idx The node id of the device.
+     * \param hypothesis The index of the hypothesis.
+     */
+    void ClearIndexUmap(uint16_t idx, uint32_t hypothesis);
+
     static CollisionMatrix collisionMatrix; //!< Collision matrix type set by the constructor
 
     static std::vector<std::vector<double>> collisionSnirAloha;    //!< ALOHA collision matrix
     static std::vector<std::vector<double>> collisionSnirGoursaud; //!< GOURSAUD collision matrix
 
   private:
+    /// The SNIR values kept for chase combining, by node id and spreading factor
+    typedef std::unordered_map<uint16_t, std::vector<std::vector<double>>> ChaseCombiningSnir;
+
+    /**
+     * Compute the interference energy [J] each spreading factor causes to an
+     * event on its frequency.
+     *
+     * \param event The event.
+     * \return The energy, by spreading factor.
+     */
+    std::vector<double> GetCumulativeInterferenceEnergy(Ptr<LoraInterferenceHelper::Event> event);
+
+    /**
+     * Determine whether an event was destroyed by a given interference under a
+     * set of parameters.
+     *
+     * \param event The event.
+     * \param cumulativeInterferenceEnergy The interference energy [J], by
+     * spreading factor.
+     * \param collisionSnir The collision matrix.
+     * \param irType The incremental redundancy type.
+     * \param chaseCombiningSnir The chase combining state, updated.
+     * \return The sf of the packets that caused the loss, or 0 if there was no
+     * loss.
+     */
+    uint8_t IsDestroyed(Ptr<LoraInterferenceHelper::Event> event,
+                        const std::vector<double>& cumulativeInterferenceEnergy,
+                        const std::vector<std::vector<double>>& collisionSnir,
+                        uint8_t irType,
+                        ChaseCombiningSnir& chaseCombiningSnir);
+
     /**
      * Set the collision matrix.
      *
@@ -260,13 +444,24 @@ class LoraInterferenceHelper
      */
     void SetCollisionMatrix(enum CollisionMatrix collisionMatrix);
 
+    /**
+     * Delete the events older than a time.
+     *
+     * \param now The current time.
+     */
+    void CleanOldEvents(Time now);
+
     std::vector<std::vector<double>> m_collisionSnir; //!< The matrix containing information about
                                                       //!< how packets survive interference
  
-  	std::unordered_map<uint16_t, std::vector<std::vector<double>>> m_chaseCombiningSnir;
+  	ChaseCombiningSnir m_chaseCombiningSnir;
  
   	uint8_t m_incrementalRed;
 
+    std::vector<Hypothesis> m_hypotheses; //!< The hypotheses evaluated besides
+    std::vector<ChaseCombiningSnir>
+        m_hypothesisChaseCombiningSnir; //!< The chase combining state of each hypothesis
+
     std::list<Ptr<LoraInterferenceHelper::Event>>
         m_events; //!< List of the events this LoraInterferenceHelper is keeping track of
     static Time oldEventThreshold; //!< The threshold after which an event is considered old and
@@ -0,0 +1,120 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-packet-pool.h"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraPacketPool");
+
+NS_OBJECT_ENSURE_REGISTERED(LoraPacketPool);
+
+TypeId
+LoraPacketPool::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LoraPacketPool")
+            .SetParent<Object>()
+            .SetGroupName("lorawan")
+            .AddConstructor<LoraPacketPool>()
+            .AddAttribute("Capacity",
+                          "The maximum number of packets kept for recycling",
+                          UintegerValue(256),
+                          MakeUintegerAccessor(&LoraPacketPool::m_capacity),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+LoraPacketPool::LoraPacketPool()
+    : m_next(0),
+      m_nCreated(0),
+      m_nRecycled(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LoraPacketPool::~LoraPacketPool()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+LoraPacketPool::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_packets.clear();
+
+    Object::DoDispose();
+}
+
+Ptr<Packet>
+LoraPacketPool::Acquire(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+
+    // Packets are released roughly in the order they were handed out, so the
+    // oldest ones are the likeliest to be free: checking only a few of them
+    // keeps a pool whose packets are all held elsewhere cheap
+    uint32_t nPackets = m_packets.size();
+    uint32_t nChecks = std::min(nPackets, MAX_CHECKS);
+    for (uint32_t n = 0; n < nChecks; n++)
+    {
+        uint32_t index = (m_next + n) % nPackets;
+        Ptr<Packet>& packet = m_packets[index];
+        if (packet->GetReferenceCount() == 1)
+        {
+            // Reset in place: the Packet object is kept, its previous buffer,
+            // headers and tags are released, and it gets a new uid. The new
+            // buffer comes from the free list the previous one went to
+            *packet = Packet(size);
+            m_next = (index + 1) % nPackets;
+            m_nRecycled++;
+            return packet;
+        }
+    }
+
+    Ptr<Packet> packet = Create<Packet>(size);
+    m_nCreated++;
+    if (nPackets < m_capacity)
+    {
+        // The newest packet goes just before the oldest one
+        m_packets.insert(m_packets.begin() + m_next, packet);
+        m_next = (m_next + 1) % m_packets.size();
+    }
+    else
+    {
+        NS_LOG_DEBUG("No free packet in a full pool");
+    }
+    return packet;
+}
+
+uint32_t
+LoraPacketPool::GetSize() const
+{
+    return m_packets.size();
+}
+
+uint64_t
+LoraPacketPool::GetNCreated() const
+{
+    return m_nCreated;
+}
+
+uint64_t
+LoraPacketPool::GetNRecycled() const
+{
+    return m_nRecycled;
+}
+
+} // namespace lorawan
+} // namespace ns3
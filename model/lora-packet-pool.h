@@ -0,0 +1,105 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_PACKET_POOL_H
+#define LORA_PACKET_POOL_H
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * A pool of packets recycled by the sender applications.
+ *
+ * Creating a new packet for each uplink allocates a Packet object. The pool
+ * keeps the packets it handed out, and a packet is recycled once the pool
+ * holds the only reference to it, i.e., once the MAC and PHY layers are done
+ * with it. A recycled packet is reset to a fresh packet of the requested size:
+ * it gets a new uid, and no header or tag of its previous use is left. The
+ * reset releases the previous buffer to the Buffer free list and takes the new
+ * one from it, and packet tags and metadata are only allocated when used, so
+ * that a recycled uplink does not allocate memory on the application side.
+ * Buffers leave room for the headers added to the packets destroyed before
+ * them, so the LoRaWAN headers are added in place from the second use of the
+ * pool on.
+ *
+ * Packets are released roughly in the order they were handed out, so only the
+ * few oldest packets are checked for recycling. Packets that are still
+ * referenced elsewhere (e.g., by the LoraPacketTracker, which keeps every
+ * packet until the end of the simulation) are never recycled: when no packet
+ * is free and the pool is full, a new packet is created and not kept by the
+ * pool.
+ *
+ * A pool is meant to be shared by several applications: it only keeps as many
+ * packets as are in use at the same time, up to its capacity. The sender
+ * helpers share one pool between the applications they install, and the
+ * applications installed without a pool share the pool of their node.
+ */
+class LoraPacketPool : public Object
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    LoraPacketPool();           //!< Default constructor
+    ~LoraPacketPool() override; //!< Destructor
+
+    /**
+     * Get a packet with a payload of the given size, recycling a packet of the
+     * pool if possible.
+     *
+     * \param size The size of the payload, in bytes.
+     * \return The packet.
+     */
+    Ptr<Packet> Acquire(uint32_t size);
+
+    /**
+     * Get the number of packets currently kept by the pool.
+     *
+     * \return The number of packets.
+     */
+    uint32_t GetSize() const;
+
+    /**
+     * Get the number of packets the pool had to create.
+     *
+     * \return The number of packets created.
+     */
+    uint64_t GetNCreated() const;
+
+    /**
+     * Get the number of packets the pool recycled.
+     *
+     * \return The number of packets recycled.
+     */
+    uint64_t GetNRecycled() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    static constexpr uint32_t MAX_CHECKS = 8; //!< The packets checked for recycling
+
+    uint32_t m_capacity;                //!< The maximum number of packets kept
+    std::vector<Ptr<Packet>> m_packets; //!< The packets kept by the pool
+    uint32_t m_next;                    //!< The oldest packet handed out
+    uint64_t m_nCreated;                //!< The number of packets created
+    uint64_t m_nRecycled;               //!< The number of packets recycled
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_PACKET_POOL_H */
@@ -120,6 +120,20 @@ LoraPhy::SetMobility(Ptr<MobilityModel> mobility)
     m_mobility = mobility;
 }
 
+const LoraInterferenceHelper&
+LoraPhy::GetInterferenceHelper() const
+{
+    return m_interference;
+}
+
+void
+LoraPhy::AddInterference(Time duration, double rxPowerDbm, uint8_t sf, double frequencyMHz)
+{
+    NS_LOG_FUNCTION(this << duration << rxPowerDbm << unsigned(sf) << frequencyMHz);
+
+    m_interference.Add(duration, rxPowerDbm, sf, 0, 0, nullptr, frequencyMHz);
+}
+
 void
 LoraPhy::SetChannel(Ptr<LoraChannel> channel)
 {
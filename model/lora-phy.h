@@ -204,6 +204,24 @@ class LoraPhy : public Object
      */
     void SetMobility(Ptr<MobilityModel> mobility);
 
+    /**
+     * Get the LoraInterferenceHelper of this PHY.
+     *
+     * \return The LoraInterferenceHelper.
+     */
+    const LoraInterferenceHelper& GetInterferenceHelper() const;
+
+    /**
+     * Add a signal to the interference seen by this PHY, without a packet to
+     * receive, e.g., from a statistical model of far devices.
+     *
+     * \param duration The duration of the signal.
+     * \param rxPowerDbm The power of the signal at this PHY.
+     * \param sf The spreading factor of the signal.
+     * \param frequencyMHz The frequency of the signal.
+     */
+    void AddInterference(Time duration, double rxPowerDbm, uint8_t sf, double frequencyMHz);
+
     /**
      * Set the LoraChannel instance PHY transmits on.
      *
@@ -0,0 +1,130 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "lora-profiler.h"
+
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iostream>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LoraProfiler");
+
+/**
+ * \ingroup lorawan
+ *
+ * File the profile is appended to at Simulator::Destroy, in builds with the
+ * LORAWAN_PROFILE option.
+ */
+static GlobalValue g_lorawanProfileFile("LorawanProfileFile",
+                                        "File the lorawan profile is appended to at "
+                                        "Simulator::Destroy, empty for std::clog",
+                                        StringValue(""),
+                                        MakeStringChecker());
+
+void
+LoraProfiler::Site::Record(uint64_t ns)
+{
+    calls++;
+    totalNs += ns;
+    minNs = std::min(minNs, ns);
+    maxNs = std::max(maxNs, ns);
+    histogram[std::min<uint32_t>(std::bit_width(ns), N_BUCKETS - 1)]++;
+}
+
+LoraProfiler::Site*
+LoraProfiler::GetSite(const std::string& name, bool timer)
+{
+    auto it = GetSites().try_emplace(name).first;
+    it->second.timer = timer;
+    return &it->second;
+}
+
+void
+LoraProfiler::Dump(std::ostream& os)
+{
+    for (const auto& [name, site] : GetSites())
+    {
+        if (site.calls == 0)
+        {
+            continue;
+        }
+        if (!site.timer)
+        {
+            os << name << " count " << site.calls << std::endl;
+            continue;
+        }
+        os << name << " calls " << site.calls << " total_ms " << site.totalNs / 1e6 << " mean_ns "
+           << site.totalNs / site.calls << " min_ns " << site.minNs << " max_ns " << site.maxNs
+           << " histogram";
+        for (uint32_t k = 0; k < N_BUCKETS; k++)
+        {
+            if (site.histogram[k] > 0)
+            {
+                // The upper bound of the bucket, and its calls
+                os << " <" << (uint64_t(1) << k) << ":" << site.histogram[k];
+            }
+        }
+        os << std::endl;
+    }
+}
+
+void
+LoraProfiler::Reset()
+{
+    for (auto& [name, site] : GetSites())
+    {
+        bool timer = site.timer;
+        site = Site();
+        site.timer = timer;
+    }
+}
+
+void
+LoraProfiler::ScheduleDump()
+{
+    m_dumpScheduled = true;
+    Simulator::ScheduleDestroy(&LoraProfiler::DumpAtDestroy);
+}
+
+void
+LoraProfiler::DumpAtDestroy()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    StringValue file;
+    g_lorawanProfileFile.GetValue(file);
+    if (file.Get().empty())
+    {
+        Dump(std::clog);
+    }
+    else
+    {
+        std::ofstream os(file.Get(), std::ios::out | std::ios::app);
+        Dump(os);
+    }
+    Reset();
+    m_dumpScheduled = false;
+}
+
+std::map<std::string, LoraProfiler::Site>&
+LoraProfiler::GetSites()
+{
+    // Constructed on first use, since the sites are created by static locals
+    static std::map<std::string, Site> sites;
+    return sites;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,196 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LORA_PROFILER_H
+#define LORA_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+#ifdef LORAWAN_PROFILE
+/**
+ * \ingroup lorawan
+ *
+ * Time the rest of the enclosing scope, adding it to the profile site of the
+ * given name. At most one per scope.
+ *
+ * \param name The name of the site.
+ */
+#define LORAWAN_PROFILE_SCOPE(name)                                                                \
+    static ns3::lorawan::LoraProfiler::Site* lorawanProfileSite =                                  \
+        ns3::lorawan::LoraProfiler::GetSite(name, true);                                           \
+    ns3::lorawan::LoraProfileScope lorawanProfileScope(lorawanProfileSite)
+
+/**
+ * \ingroup lorawan
+ *
+ * Add to the profile counter of the given name.
+ *
+ * \param name The name of the counter.
+ * \param n The amount to add.
+ */
+#define LORAWAN_PROFILE_COUNT(name, n)                                                             \
+    do                                                                                             \
+    {                                                                                              \
+        static ns3::lorawan::LoraProfiler::Site* lorawanProfileCounter =                           \
+            ns3::lorawan::LoraProfiler::GetSite(name, false);                                      \
+        ns3::lorawan::LoraProfiler::EnsureDump();                                                  \
+        lorawanProfileCounter->calls += (n);                                                       \
+    } while (false)
+#else
+#define LORAWAN_PROFILE_SCOPE(name)
+#define LORAWAN_PROFILE_COUNT(name, n)
+#endif
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Aggregate the timings of the hot paths of the module, when it is built with
+ * the LORAWAN_PROFILE option.
+ *
+ * The LORAWAN_PROFILE_SCOPE and LORAWAN_PROFILE_COUNT macros place scoped
+ * timers and counters on the entry points of the module. Each call of a timer
+ * adds its steady_clock duration to a histogram of its site, with buckets
+ * that double in width. Without the option the macros expand to nothing, so
+ * they cost nothing.
+ *
+ * The sites are dumped at Simulator::Destroy, to the file set in the
+ * LorawanProfileFile global value (appending to it) or to std::clog, and
+ * then reset, so each simulation of a process gets its own profile. The
+ * profiler is not thread safe, like the simulator it instruments.
+ */
+class LoraProfiler
+{
+  public:
+    /// The number of buckets of the histograms: bucket k holds the durations
+    /// in [2^(k-1), 2^k) ns, and the last one the longer ones
+    static constexpr uint32_t N_BUCKETS = 40;
+
+    /**
+     * A timer or counter of the profile.
+     */
+    struct Site
+    {
+        bool timer = true;                           //!< Whether it times its calls
+        uint64_t calls = 0;                          //!< The calls, or the count of a counter
+        uint64_t totalNs = 0;                        //!< The total duration of the calls [ns]
+        uint64_t minNs = UINT64_MAX;                 //!< The shortest call [ns]
+        uint64_t maxNs = 0;                          //!< The longest call [ns]
+        std::array<uint64_t, N_BUCKETS> histogram{}; //!< The calls per duration bucket
+
+        /**
+         * Add a call.
+         *
+         * \param ns The duration of the call [ns].
+         */
+        void Record(uint64_t ns);
+    };
+
+    /**
+     * Get the site of a name, creating it the first time. The site stays valid
+     * for the lifetime of the process.
+     *
+     * \param name The name of the site.
+     * \param timer Whether the site is a timer, or a counter.
+     * \return The site.
+     */
+    static Site* GetSite(const std::string& name, bool timer);
+
+    /**
+     * Make sure the profile is dumped at the next Simulator::Destroy.
+     */
+    static void EnsureDump()
+    {
+        if (!m_dumpScheduled)
+        {
+            ScheduleDump();
+        }
+    }
+
+    /**
+     * Print the sites with some calls, one line each: the name, the calls,
+     * the total, mean, minimum and maximum durations, and the non-empty
+     * buckets of the histogram. Counters only print their count.
+     *
+     * \param os The output stream.
+     */
+    static void Dump(std::ostream& os);
+
+    /**
+     * Clear the calls of all the sites.
+     */
+    static void Reset();
+
+  private:
+    /**
+     * Schedule the dump of the profile at Simulator::Destroy.
+     */
+    static void ScheduleDump();
+
+    /**
+     * Dump the profile to its output, and reset it.
+     */
+    static void DumpAtDestroy();
+
+    /**
+     * Get the sites, by name.
+     *
+     * \return The sites.
+     */
+    static std::map<std::string, Site>& GetSites();
+
+    static inline bool m_dumpScheduled = false; //!< Whether the dump is scheduled
+};
+
+/**
+ * \ingroup lorawan
+ *
+ * Time its scope, adding the duration to a site of the LoraProfiler when it
+ * is destroyed.
+ */
+class LoraProfileScope
+{
+  public:
+    /**
+     * Constructor, starting the timer.
+     *
+     * \param site The site to add the duration to.
+     */
+    LoraProfileScope(LoraProfiler::Site* site)
+        : m_site(site)
+    {
+        LoraProfiler::EnsureDump();
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * Destructor, adding the duration of the scope to the site.
+     */
+    ~LoraProfileScope()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_site->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    LoraProfileScope(const LoraProfileScope&) = delete;            //!< Not copyable
+    LoraProfileScope& operator=(const LoraProfileScope&) = delete; //!< Not copyable
+
+  private:
+    LoraProfiler::Site* m_site;                    //!< The site of the timer
+    std::chrono::steady_clock::time_point m_start; //!< The start of the scope
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_PROFILER_H */
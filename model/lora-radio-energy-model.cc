@@ -8,11 +8,15 @@
 
 #include "lora-radio-energy-model.h"
 
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/energy-source.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 namespace lorawan
@@ -59,6 +63,23 @@ LoraRadioEnergyModel::GetTypeId()
                           PointerValue(),
                           MakePointerAccessor(&LoraRadioEnergyModel::m_txCurrentModel),
                           MakePointerChecker<LoraTxCurrentModel>())
+            .AddAttribute("LazyAccounting",
+                          "Whether state changes only update residence counters, and the "
+                          "energy source is updated on demand or when the energy could deplete",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraRadioEnergyModel::m_lazyAccounting),
+                          MakeBooleanChecker())
+            .AddAttribute("UpdateInterval",
+                          "The interval between updates of the energy source with lazy "
+                          "accounting, or zero to only update it on demand and at depletion",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&LoraRadioEnergyModel::m_updateInterval),
+                          MakeTimeChecker())
+            .AddAttribute("DepletionResolution",
+                          "The minimum delay between two depletion checks with lazy accounting",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&LoraRadioEnergyModel::m_depletionResolution),
+                          MakeTimeChecker())
             .AddTraceSource(
                 "TotalEnergyConsumption",
                 "Total energy consumption of the radio device.",
@@ -74,6 +95,11 @@ LoraRadioEnergyModel::LoraRadioEnergyModel()
     m_lastUpdateTime = Seconds(0.0);
     m_nPendingChangeState = 0;
     m_isSupersededChangeState = false;
+    m_lazyAccounting = false;
+    m_chargeC = 0;
+    m_boundCurrentA = 0;
+    m_windowChargeC = 0;
+    m_windowStart = Seconds(0);
     m_energyDepletionCallback.Nullify();
     m_source = nullptr;
     // set callback for EndDeviceLoraPhy listener
@@ -96,12 +122,24 @@ LoraRadioEnergyModel::SetEnergySource(Ptr<EnergySource> source)
     NS_LOG_FUNCTION(this << source);
     NS_ASSERT(source);
     m_source = source;
+
+    if (m_lazyAccounting)
+    {
+        m_updateEvent = Simulator::ScheduleNow(&LoraRadioEnergyModel::ScheduleNextUpdate, this);
+    }
 }
 
 double
 LoraRadioEnergyModel::GetTotalEnergyConsumption() const
 {
     NS_LOG_FUNCTION(this);
+
+    if (m_lazyAccounting && m_source)
+    {
+        double pendingC = GetStateCurrentA(m_currentState) *
+                          (Simulator::Now() - m_lastUpdateTime).GetSeconds();
+        return (m_chargeC + pendingC) * m_source->GetSupplyVoltage();
+    }
     return m_totalEnergyConsumption;
 }
 
@@ -203,6 +241,13 @@ LoraRadioEnergyModel::SetTxCurrentFromModel(double txPowerDbm)
     {
         m_txCurrentA = m_txCurrentModel->CalcTxCurrent(txPowerDbm);
     }
+
+    // A larger current than predicted may deplete the energy earlier
+    if (m_lazyAccounting && m_updateEvent.IsPending() && m_txCurrentA > m_boundCurrentA)
+    {
+        Simulator::Cancel(m_updateEvent);
+        m_updateEvent = Simulator::ScheduleNow(&LoraRadioEnergyModel::ScheduleNextUpdate, this);
+    }
 }
 
 void
@@ -210,8 +255,16 @@ LoraRadioEnergyModel::ChangeState(int newState)
 {
     NS_LOG_FUNCTION(this << newState);
 
+    if (m_lazyAccounting)
+    {
+        Accrue();
+        SetLoraRadioState((EndDeviceLoraPhy::State)newState);
+        return;
+    }
+
     Time duration = Simulator::Now() - m_lastUpdateTime;
     NS_ASSERT(duration.GetNanoSeconds() >= 0); // check if duration is valid
+    m_stateDuration[m_currentState] += duration;
 
     // energy to decrease = current * voltage * time
     double energyToDecrease = 0.0;
@@ -296,6 +349,12 @@ LoraRadioEnergyModel::HandleEnergyRecharged()
     {
         m_energyRechargedCallback();
     }
+
+    // Depletion checks stopped when the energy was depleted
+    if (m_lazyAccounting && !m_updateEvent.IsPending())
+    {
+        m_updateEvent = Simulator::ScheduleNow(&LoraRadioEnergyModel::ScheduleNextUpdate, this);
+    }
 }
 
 LoraRadioEnergyModelPhyListener*
@@ -305,6 +364,39 @@ LoraRadioEnergyModel::GetPhyListener()
     return m_listener;
 }
 
+Time
+LoraRadioEnergyModel::GetStateDuration(EndDeviceLoraPhy::State state) const
+{
+    NS_LOG_FUNCTION(this << state);
+
+    Time duration = m_stateDuration[state];
+    if (state == m_currentState)
+    {
+        duration += Simulator::Now() - m_lastUpdateTime;
+    }
+    return duration;
+}
+
+void
+LoraRadioEnergyModel::UpdateEnergyConsumption()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_lazyAccounting)
+    {
+        return;
+    }
+
+    Accrue();
+
+    // The source queries the average current since its previous update
+    m_source->UpdateEnergySource();
+    m_totalEnergyConsumption = m_chargeC * m_source->GetSupplyVoltage();
+
+    NS_LOG_DEBUG("LoraRadioEnergyModel:Total energy consumption is " << m_totalEnergyConsumption
+                                                                     << "J");
+}
+
 /*
  * Private functions start here.
  */
@@ -313,6 +405,7 @@ void
 LoraRadioEnergyModel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    Simulator::Cancel(m_updateEvent);
     m_source = nullptr;
     m_energyDepletionCallback.Nullify();
 }
@@ -321,7 +414,33 @@ double
 LoraRadioEnergyModel::DoGetCurrentA() const
 {
     NS_LOG_FUNCTION(this);
-    switch (m_currentState)
+
+    if (m_lazyAccounting)
+    {
+        // Average current since the previous update of the energy source,
+        // which is updating now: the next window starts
+        Time now = Simulator::Now();
+        double pendingC =
+            GetStateCurrentA(m_currentState) * (now - m_lastUpdateTime).GetSeconds();
+        double duration = (now - m_windowStart).GetSeconds();
+        double currentA = GetStateCurrentA(m_currentState);
+        if (duration > 0)
+        {
+            currentA = (m_windowChargeC + pendingC) / duration;
+        }
+        // The pending charge will be accrued again at the next state change
+        m_windowChargeC = -pendingC;
+        m_windowStart = now;
+        return currentA;
+    }
+
+    return GetStateCurrentA(m_currentState);
+}
+
+double
+LoraRadioEnergyModel::GetStateCurrentA(EndDeviceLoraPhy::State state) const
+{
+    switch (state)
     {
     case EndDeviceLoraPhy::STANDBY:
         return m_idleCurrentA;
@@ -332,7 +451,56 @@ LoraRadioEnergyModel::DoGetCurrentA() const
     case EndDeviceLoraPhy::SLEEP:
         return m_sleepCurrentA;
     default:
-        NS_FATAL_ERROR("LoraRadioEnergyModel:Undefined radio state:" << m_currentState);
+        NS_FATAL_ERROR("LoraRadioEnergyModel:Undefined radio state:" << state);
+    }
+}
+
+void
+LoraRadioEnergyModel::Accrue()
+{
+    Time now = Simulator::Now();
+    Time duration = now - m_lastUpdateTime;
+    NS_ASSERT(!duration.IsStrictlyNegative());
+
+    double chargeC = GetStateCurrentA(m_currentState) * duration.GetSeconds();
+    m_stateDuration[m_currentState] += duration;
+    m_chargeC += chargeC;
+    m_windowChargeC += chargeC;
+    m_lastUpdateTime = now;
+}
+
+void
+LoraRadioEnergyModel::ScheduleNextUpdate()
+{
+    NS_LOG_FUNCTION(this);
+
+    UpdateEnergyConsumption();
+
+    // The energy cannot deplete before the energy left above the low battery
+    // threshold is drawn at the largest current of the radio
+    DoubleValue threshold(0);
+    m_source->GetAttributeFailSafe("BasicEnergyLowBatteryThreshold", threshold);
+    double availableJ =
+        m_source->GetRemainingEnergy() - threshold.Get() * m_source->GetInitialEnergy();
+    m_boundCurrentA = std::max({m_txCurrentA, m_rxCurrentA, m_idleCurrentA, m_sleepCurrentA});
+    double boundPowerW = m_boundCurrentA * m_source->GetSupplyVoltage();
+
+    Time delay = Time::Max();
+    if (availableJ > 0 && boundPowerW > 0 && availableJ / boundPowerW < Time::Max().GetSeconds())
+    {
+        delay = Max(Seconds(availableJ / boundPowerW), m_depletionResolution);
+        NS_LOG_DEBUG("Energy cannot deplete before " << (Simulator::Now() + delay).As(Time::S));
+    }
+    if (m_updateInterval.IsStrictlyPositive())
+    {
+        delay = Min(delay, m_updateInterval);
+    }
+
+    // Depletion or recharge handlers may have scheduled an update already
+    Simulator::Cancel(m_updateEvent);
+    if (delay != Time::Max())
+    {
+        m_updateEvent = Simulator::Schedule(delay, &LoraRadioEnergyModel::ScheduleNextUpdate, this);
     }
 }
 
@@ -14,8 +14,12 @@
 #include "lora-tx-current-model.h"
 
 #include "ns3/device-energy-model.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
 #include "ns3/traced-value.h"
 
+#include <array>
+
 namespace ns3
 {
 namespace lorawan
@@ -118,6 +122,17 @@ class LoraRadioEnergyModelPhyListener : public EndDeviceLoraPhyListener
  * Energy calculation: For each transaction, this model notifies EnergySource
  * object. The EnergySource object will query this model for the total current.
  * Then the EnergySource object uses the total current to calculate energy.
+ *
+ * Lazy accounting: with the LazyAccounting attribute, a transaction only adds
+ * the time spent in the previous state to per-state residence counters, and
+ * the charge drawn to a running total. The EnergySource is only updated on
+ * demand (UpdateEnergyConsumption, or a query of the source), every
+ * UpdateInterval if set, and when the energy could deplete: the earliest
+ * possible depletion time is predicted from the remaining energy and the
+ * largest current of the radio, and checked then. In this mode, the current
+ * returned to the EnergySource is the average current since its previous
+ * update, so that its own periodic updates stay exact; they can be made
+ * coarse with its update interval attribute.
  */
 class LoraRadioEnergyModel : public DeviceEnergyModel
 {
@@ -276,9 +291,43 @@ class LoraRadioEnergyModel : public DeviceEnergyModel
      */
     LoraRadioEnergyModelPhyListener* GetPhyListener();
 
+    /**
+     * Get the total time spent in a state.
+     *
+     * \param state The state.
+     * \return The residence time in the state, up to now.
+     */
+    Time GetStateDuration(EndDeviceLoraPhy::State state) const;
+
+    /**
+     * Bring the total energy consumption and the energy source up to date. This
+     * is only needed with lazy accounting.
+     */
+    void UpdateEnergyConsumption();
+
   private:
     void DoDispose() override;
 
+    /**
+     * Get the current drawn in a state.
+     *
+     * \param state The state.
+     * \return The current [A].
+     */
+    double GetStateCurrentA(EndDeviceLoraPhy::State state) const;
+
+    /**
+     * Add the time spent in the current state since the last update to the
+     * residence counters and the charge drawn.
+     */
+    void Accrue();
+
+    /**
+     * Update the energy source and schedule the next update, at the earliest
+     * possible depletion or after the update interval.
+     */
+    void ScheduleNextUpdate();
+
     /**
      * \return Current draw of device, at current state.
      *
@@ -322,6 +371,22 @@ class LoraRadioEnergyModel : public DeviceEnergyModel
 
     /// EndDeviceLoraPhy listener
     LoraRadioEnergyModelPhyListener* m_listener;
+
+    std::array<Time, 4> m_stateDuration; //!< Residence time in each state, by state value
+
+    bool m_lazyAccounting;      //!< Whether the energy source is updated lazily
+    Time m_updateInterval;      //!< The interval between lazy updates, zero for none
+    Time m_depletionResolution; //!< The minimum delay between depletion checks
+    double m_chargeC;           //!< The charge drawn so far [C], with lazy accounting
+    double m_boundCurrentA;     //!< The current bounding the next depletion check [A]
+    EventId m_updateEvent;      //!< The next lazy update
+
+    /**
+     * The charge drawn [C] since the window start. The energy source closes
+     * the window when it queries the current.
+     */
+    mutable double m_windowChargeC;
+    mutable Time m_windowStart; //!< The time of the last update of the energy source
 };
 
 } // namespace lorawan
@@ -10,8 +10,15 @@
 
 #include "lora-utils.h"
 
+#include "ns3/abort.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
 
 namespace ns3
 {
@@ -174,5 +181,125 @@ ConstantLoraTxCurrentModel::CalcTxCurrent(double txPowerDbm) const
     return m_txCurrent;
 }
 
+NS_OBJECT_ENSURE_REGISTERED(TableLoraTxCurrentModel);
+
+TypeId
+TableLoraTxCurrentModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TableLoraTxCurrentModel")
+            .SetParent<LoraTxCurrentModel>()
+            .SetGroupName("Lora")
+            .AddConstructor<TableLoraTxCurrentModel>()
+            .AddAttribute("TableFile",
+                          "The file of the measured (tx power [dBm], current [A]) table. "
+                          "If empty, the SX1276 datasheet values are used.",
+                          StringValue(""),
+                          MakeStringAccessor(&TableLoraTxCurrentModel::LoadTable),
+                          MakeStringChecker());
+    return tid;
+}
+
+TableLoraTxCurrentModel::TableLoraTxCurrentModel()
+{
+    NS_LOG_FUNCTION(this);
+    SetTable({{7, 0.020}, {13, 0.029}, {17, 0.087}, {20, 0.120}});
+}
+
+TableLoraTxCurrentModel::~TableLoraTxCurrentModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+TableLoraTxCurrentModel::SetTable(std::vector<std::pair<double, double>> table)
+{
+    NS_LOG_FUNCTION(this << table.size());
+    NS_ABORT_MSG_IF(table.empty(), "The TX current table is empty");
+
+    std::sort(table.begin(), table.end());
+    m_table = std::move(table);
+    for (int p = MIN_TX_POWER_DBM; p <= MAX_TX_POWER_DBM; p++)
+    {
+        m_precomputed[p - MIN_TX_POWER_DBM] = Interpolate(p);
+    }
+}
+
+void
+TableLoraTxCurrentModel::LoadTable(std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    if (filename.empty())
+    {
+        return;
+    }
+    std::ifstream file(filename);
+    NS_ABORT_MSG_IF(!file.is_open(), "Cannot open TX current table " << filename);
+
+    std::vector<std::pair<double, double>> table;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first) || first[0] == '#')
+        {
+            continue;
+        }
+        // The power must be a number up to the separator, not a number prefix
+        std::istringstream power(first);
+        double txPowerDbm;
+        double current;
+        NS_ABORT_MSG_IF(!(power >> txPowerDbm) || !power.eof() || !(fields >> current),
+                        "Malformed line in " << filename << ": " << line);
+        table.emplace_back(txPowerDbm, current);
+    }
+    SetTable(std::move(table));
+}
+
+const std::vector<std::pair<double, double>>&
+TableLoraTxCurrentModel::GetTable() const
+{
+    return m_table;
+}
+
+double
+TableLoraTxCurrentModel::CalcTxCurrent(double txPowerDbm) const
+{
+    NS_LOG_FUNCTION(this << txPowerDbm);
+
+    // Devices are configured with integer powers, looked up without
+    // interpolating
+    double rounded = std::round(txPowerDbm);
+    if (rounded == txPowerDbm && rounded >= MIN_TX_POWER_DBM && rounded <= MAX_TX_POWER_DBM)
+    {
+        return m_precomputed[int(rounded) - MIN_TX_POWER_DBM];
+    }
+    return Interpolate(txPowerDbm);
+}
+
+double
+TableLoraTxCurrentModel::Interpolate(double txPowerDbm) const
+{
+    if (txPowerDbm <= m_table.front().first)
+    {
+        return m_table.front().second;
+    }
+    if (txPowerDbm >= m_table.back().first)
+    {
+        return m_table.back().second;
+    }
+    auto upper = std::upper_bound(m_table.begin(),
+                                  m_table.end(),
+                                  txPowerDbm,
+                                  [](double p, const std::pair<double, double>& point) {
+                                      return p < point.first;
+                                  });
+    auto lower = upper - 1;
+    double ratio = (txPowerDbm - lower->first) / (upper->first - lower->first);
+    return lower->second + ratio * (upper->second - lower->second);
+}
+
 } // namespace lorawan
 } // namespace ns3
@@ -12,6 +12,11 @@
 
 #include "ns3/object.h"
 
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -150,6 +155,83 @@ class ConstantLoraTxCurrentModel : public LoraTxCurrentModel
     double m_txCurrent; //!< The transmission current [Ampere]
 };
 
+/**
+ * \ingroup lorawan
+ *
+ * A model of the transmission current for a LoRa device interpolated from a
+ * table of measurements, e.g., of a power amplifier whose consumption is not
+ * linear in the transmission power.
+ *
+ * The current is linearly interpolated between the measured powers, and
+ * clamped to the first and last measurements outside of them. The current at
+ * each integer power between MIN_TX_POWER_DBM and MAX_TX_POWER_DBM, i.e., at
+ * every power an end device can be configured with, is precomputed when the
+ * table is set, so that CalcTxCurrent is a lookup for these powers.
+ *
+ * The model holds no per-device state: a single instance can be shared by
+ * the energy models of all the devices (see
+ * LoraRadioEnergyModelHelper::SetTxCurrentModel). The default table holds the
+ * SX1276 datasheet values: 20 mA at 7 dBm and 29 mA at 13 dBm on the RFO pin,
+ * 87 mA at 17 dBm and 120 mA at 20 dBm on the PA_BOOST pin.
+ */
+class TableLoraTxCurrentModel : public LoraTxCurrentModel
+{
+  public:
+    static constexpr int MIN_TX_POWER_DBM = 0;  //!< The lowest precomputed power [dBm]
+    static constexpr int MAX_TX_POWER_DBM = 30; //!< The highest precomputed power [dBm]
+
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    TableLoraTxCurrentModel();           //!< Default constructor
+    ~TableLoraTxCurrentModel() override; //!< Destructor
+
+    /**
+     * Set the table of measurements.
+     *
+     * \param table The (transmission power [dBm], current [Ampere]) pairs, in
+     * any order.
+     */
+    void SetTable(std::vector<std::pair<double, double>> table);
+
+    /**
+     * Load the table of measurements from a text file, with one transmission
+     * power [dBm] and current [Ampere] per line, separated by white space.
+     * Empty lines and lines starting with '#' are ignored. An empty filename
+     * keeps the current table.
+     *
+     * \param filename The path of the file.
+     */
+    void LoadTable(std::string filename);
+
+    /**
+     * Get the table of measurements.
+     *
+     * \return The (transmission power [dBm], current [Ampere]) pairs, sorted
+     * by power.
+     */
+    const std::vector<std::pair<double, double>>& GetTable() const;
+
+    double CalcTxCurrent(double txPowerDbm) const override;
+
+  private:
+    /**
+     * Interpolate the table of measurements.
+     *
+     * \param txPowerDbm The nominal tx power in dBm.
+     * \return The transmit current (in Ampere).
+     */
+    double Interpolate(double txPowerDbm) const;
+
+    std::vector<std::pair<double, double>> m_table; //!< The measurements, sorted by power
+
+    /// The current at each integer power from MIN_TX_POWER_DBM [Ampere]
+    std::array<double, MAX_TX_POWER_DBM - MIN_TX_POWER_DBM + 1> m_precomputed;
+};
+
 } // namespace lorawan
 
 } // namespace ns3
@@ -57,7 +57,7 @@ class LorawanMac : public Object
      *
      * \param phy The phy layer.
      */
-    void SetPhy(Ptr<LoraPhy> phy);
+    virtual void SetPhy(Ptr<LoraPhy> phy);
 
     /**
      * Get the underlying PHY layer.
@@ -159,7 +159,7 @@ class LorawanMac : public Object
      * \param sfForDataRate A vector that contains at position i the spreading factor that
      * should correspond to data rate i.
      */
-    void SetSfForDataRate(std::vector<uint8_t> sfForDataRate);
+    virtual void SetSfForDataRate(std::vector<uint8_t> sfForDataRate);
 
     /**
      * Set the vector to use to check up correspondence between bandwidth and
@@ -168,7 +168,7 @@ class LorawanMac : public Object
      * \param bandwidthForDataRate A vector that contains at position i the
      * bandwidth that should correspond to data rate i in this MAC's region.
      */
-    void SetBandwidthForDataRate(std::vector<double> bandwidthForDataRate);
+    virtual void SetBandwidthForDataRate(std::vector<double> bandwidthForDataRate);
 
     /**
      * Set the maximum App layer payload for a set data rate.
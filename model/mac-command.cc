@@ -356,6 +356,22 @@ LinkAdrReq::GetEnabledChannelsList()
     return channelIndices;
 }
 
+uint16_t
+LinkAdrReq::GetChannelMask()
+{
+    NS_LOG_FUNCTION(this);
+
+    return m_channelMask;
+}
+
+uint8_t
+LinkAdrReq::GetChannelMaskControl()
+{
+    NS_LOG_FUNCTION(this);
+
+    return m_chMaskCntl;
+}
+
 int
 LinkAdrReq::GetRepetitions()
 {
@@ -259,6 +259,21 @@ class LinkAdrReq : public MacCommand
      */
     std::list<int> GetEnabledChannelsList();
 
+    /**
+     * Get the 16-bit channel mask prescribed by this MAC command.
+     *
+     * \return The ChMask field.
+     */
+    uint16_t GetChannelMask();
+
+    /**
+     * Get the channel mask control prescribed by this MAC command, i.e., the
+     * block of channels the channel mask refers to.
+     *
+     * \return The ChMaskCntl field.
+     */
+    uint8_t GetChannelMaskControl();
+
     /**
      * Get the number of repetitions prescribed by this MAC command.
      *
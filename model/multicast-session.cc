@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#include "multicast-session.h"
+
+#include "end-device-status.h"
+#include "gateway-status.h"
+#include "lora-frame-header.h"
+#include "lora-phy.h"
+#include "lora-tag.h"
+#include "lorawan-mac-header.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <set>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("MulticastSession");
+
+NS_OBJECT_ENSURE_REGISTERED(MulticastSession);
+
+TypeId
+MulticastSession::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MulticastSession")
+            .SetParent<Object>()
+            .SetGroupName("lorawan")
+            .AddConstructor<MulticastSession>()
+            .AddAttribute("DataRate",
+                          "The data rate of the multicast downlinks",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MulticastSession::m_dataRate),
+                          MakeUintegerChecker<uint8_t>(0, 7))
+            .AddAttribute("Frequency",
+                          "The frequency of the multicast downlinks, in MHz",
+                          DoubleValue(869.525),
+                          MakeDoubleAccessor(&MulticastSession::m_frequency),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("NFragments",
+                          "The number of fragments to deliver",
+                          UintegerValue(10),
+                          MakeUintegerAccessor(&MulticastSession::m_nFragments),
+                          MakeUintegerChecker<uint32_t>(1, 65535))
+            .AddAttribute("FragmentSize",
+                          "The application payload of each fragment, in bytes",
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&MulticastSession::m_fragmentSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Repetitions",
+                          "The maximum number of times the sequence of fragments is sent",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&MulticastSession::m_repetitions),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("GuardInterval",
+                          "The spacing between the transmissions of different gateways",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&MulticastSession::m_guardInterval),
+                          MakeTimeChecker())
+            .AddTraceSource("Completed",
+                            "Trace source that is fired when every member received every "
+                            "fragment",
+                            MakeTraceSourceAccessor(&MulticastSession::m_completed),
+                            "ns3::lorawan::MulticastSession::CompletedTracedCallback");
+    return tid;
+}
+
+MulticastSession::MulticastSession()
+    : m_nCompletedMembers(0),
+      m_completionTime(Time::Max())
+{
+    NS_LOG_FUNCTION(this);
+}
+
+MulticastSession::~MulticastSession()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MulticastSession::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto& event : m_nextFragment)
+    {
+        Simulator::Cancel(event);
+    }
+    m_members.clear();
+    m_status = nullptr;
+
+    Object::DoDispose();
+}
+
+void
+MulticastSession::SetGroupAddress(LoraDeviceAddress groupAddress)
+{
+    m_groupAddress = groupAddress;
+}
+
+LoraDeviceAddress
+MulticastSession::GetGroupAddress() const
+{
+    return m_groupAddress;
+}
+
+void
+MulticastSession::AddMember(Ptr<ClassCEndDeviceLorawanMac> mac)
+{
+    NS_LOG_FUNCTION(this << mac);
+
+    mac->AddMulticastAddress(m_groupAddress);
+    mac->TraceConnectWithoutContext(
+        "ReceivedMulticast",
+        MakeCallback(&MulticastSession::FragmentReceived, this).Bind(uint32_t(m_members.size())));
+
+    m_members.push_back(mac);
+}
+
+uint32_t
+MulticastSession::GetNMembers() const
+{
+    return m_members.size();
+}
+
+void
+MulticastSession::Start(Ptr<NetworkStatus> status)
+{
+    NS_LOG_FUNCTION(this << status);
+
+    m_status = status;
+    m_startTime = Simulator::Now();
+    m_completionTime = Time::Max();
+    m_nCompletedMembers = 0;
+    m_receivedFragments.assign(m_members.size(), std::vector<bool>(m_nFragments, false));
+    m_missingFragments.assign(m_members.size(), m_nFragments);
+
+    // Use the gateways that can hear the members
+    std::set<Address> gateways;
+    for (const auto& mac : m_members)
+    {
+        Ptr<EndDeviceStatus> edStatus = m_status->GetEndDeviceStatus(mac->GetDeviceAddress());
+        if (edStatus)
+        {
+            for (const auto& gw : edStatus->GetLastReceivedPacketInfo().gwList)
+            {
+                gateways.insert(gw.first);
+            }
+        }
+    }
+    if (gateways.empty())
+    {
+        NS_LOG_DEBUG("No gateway heard the members: using all gateways.");
+        for (const auto& gw : m_status->m_gatewayStatuses)
+        {
+            gateways.insert(gw.first);
+        }
+    }
+    m_gateways.assign(gateways.begin(), gateways.end());
+    NS_ABORT_MSG_IF(m_gateways.empty(), "No gateway can deliver the multicast session.");
+
+    // Stagger the gateway timelines by the airtime of a fragment
+    Ptr<GatewayLorawanMac> firstGwMac =
+        m_status->m_gatewayStatuses.at(m_gateways.front())->GetGatewayMac();
+    Time offset = GetFragmentAirtime(firstGwMac, CreateFragment(0)) + m_guardInterval;
+
+    m_nextFragment.assign(m_gateways.size(), EventId());
+    for (uint32_t i = 0; i < m_gateways.size(); i++)
+    {
+        m_airtime[m_gateways[i]] = Seconds(0);
+        m_nextFragment[i] =
+            Simulator::Schedule(offset * i, &MulticastSession::SendFragment, this, i, 0);
+    }
+
+    NS_LOG_INFO("Starting multicast session " << m_groupAddress << " with " << m_members.size()
+                                              << " members and " << m_gateways.size()
+                                              << " gateways.");
+}
+
+bool
+MulticastSession::IsComplete() const
+{
+    return !m_members.empty() && m_nCompletedMembers == m_members.size();
+}
+
+Time
+MulticastSession::GetCompletionTime() const
+{
+    return m_completionTime;
+}
+
+uint32_t
+MulticastSession::GetNCompletedMembers() const
+{
+    return m_nCompletedMembers;
+}
+
+const std::map<Address, Time>&
+MulticastSession::GetAirtimePerGateway() const
+{
+    return m_airtime;
+}
+
+Ptr<Packet>
+MulticastSession::CreateFragment(uint16_t fragment) const
+{
+    Ptr<Packet> packet = Create<Packet>(m_fragmentSize);
+
+    // The frame counter carries the fragment index
+    LoraFrameHeader fHdr;
+    fHdr.SetAsDownlink();
+    fHdr.SetAddress(m_groupAddress);
+    fHdr.SetFCnt(fragment);
+    packet->AddHeader(fHdr);
+
+    LorawanMacHeader mHdr;
+    mHdr.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+    packet->AddHeader(mHdr);
+
+    LoraTag tag;
+    tag.SetDataRate(m_dataRate);
+    tag.SetFrequency(m_frequency);
+    packet->AddPacketTag(tag);
+
+    return packet;
+}
+
+Time
+MulticastSession::GetFragmentAirtime(Ptr<GatewayLorawanMac> gwMac, Ptr<Packet> packet) const
+{
+    // Same parameters the gateway will use
+    LoraTxParameters params;
+    params.sf = gwMac->GetSfFromDataRate(m_dataRate);
+    params.headerDisabled = false;
+    params.codingRate = 1;
+    params.bandwidthHz = gwMac->GetBandwidthFromDataRate(m_dataRate);
+    params.nPreamble = 8;
+    params.crcEnabled = true;
+    params.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(params) > MilliSeconds(16);
+
+    return LoraPhy::GetOnAirTime(packet, params);
+}
+
+void
+MulticastSession::SendFragment(uint32_t gwIndex, uint32_t sequence)
+{
+    NS_LOG_FUNCTION(this << gwIndex << sequence);
+
+    if (IsComplete() || sequence >= m_nFragments * m_repetitions)
+    {
+        return;
+    }
+
+    Address gwAddress = m_gateways.at(gwIndex);
+    Ptr<GatewayStatus> gwStatus = m_status->m_gatewayStatuses.at(gwAddress);
+    Ptr<GatewayLorawanMac> gwMac = gwStatus->GetGatewayMac();
+
+    // Wait for the gateway to be allowed to transmit on the session frequency
+    Time waitingTime = gwMac->GetWaitingTime(m_frequency);
+    if (gwMac->IsTransmitting())
+    {
+        waitingTime = std::max(waitingTime, m_guardInterval);
+    }
+    if (waitingTime > Seconds(0))
+    {
+        NS_LOG_DEBUG("Gateway " << gwAddress << " busy for " << waitingTime.As(Time::S));
+        m_nextFragment[gwIndex] = Simulator::Schedule(waitingTime,
+                                                      &MulticastSession::SendFragment,
+                                                      this,
+                                                      gwIndex,
+                                                      sequence);
+        return;
+    }
+
+    Ptr<Packet> packet = CreateFragment(sequence % m_nFragments);
+    Time airtime = GetFragmentAirtime(gwMac, packet);
+    m_airtime[gwAddress] += airtime;
+
+    NS_LOG_DEBUG("Sending fragment " << sequence % m_nFragments << " through gateway "
+                                     << gwAddress);
+
+    // Book the gateway, so that the network server does not use it for unicast
+    // replies at the same time
+    gwStatus->SetNextTransmissionTime(Simulator::Now());
+    m_status->SendThroughGateway(packet, gwAddress);
+
+    // The duty cycle of this transmission is registered when the packet reaches
+    // the gateway: it will be respected at the next attempt
+    m_nextFragment[gwIndex] = Simulator::Schedule(airtime + m_guardInterval,
+                                                  &MulticastSession::SendFragment,
+                                                  this,
+                                                  gwIndex,
+                                                  sequence + 1);
+}
+
+void
+MulticastSession::FragmentReceived(uint32_t memberIndex,
+                                   Ptr<const Packet> packet,
+                                   LoraDeviceAddress groupAddress,
+                                   uint16_t fCnt)
+{
+    NS_LOG_FUNCTION(this << memberIndex << packet << groupAddress << fCnt);
+
+    if (groupAddress != m_groupAddress || fCnt >= m_nFragments ||
+        memberIndex >= m_receivedFragments.size() || m_receivedFragments[memberIndex][fCnt])
+    {
+        return;
+    }
+
+    m_receivedFragments[memberIndex][fCnt] = true;
+    if (--m_missingFragments[memberIndex] > 0)
+    {
+        return;
+    }
+
+    m_nCompletedMembers++;
+    if (IsComplete())
+    {
+        m_completionTime = Simulator::Now() - m_startTime;
+        NS_LOG_INFO("Multicast session " << m_groupAddress << " completed in "
+                                         << m_completionTime.As(Time::S));
+        for (auto& event : m_nextFragment)
+        {
+            Simulator::Cancel(event);
+        }
+        m_completed(m_completionTime);
+    }
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef MULTICAST_SESSION_H
+#define MULTICAST_SESSION_H
+
+#include "class-c-end-device-lorawan-mac.h"
+#include "gateway-lorawan-mac.h"
+#include "lora-device-address.h"
+#include "network-status.h"
+
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/traced-callback.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * A multicast downlink session run by the network server, for instance a
+ * firmware update campaign.
+ *
+ * The session delivers a sequence of fragments to all the Class C devices of a
+ * multicast group. Each fragment is sent once per gateway, so that a single
+ * gateway transmission reaches every listening member in its coverage. Each
+ * gateway follows its own transmission timeline, staggered with respect to the
+ * others to limit self-interference, and bound by its duty cycle on the
+ * session frequency. The sequence is repeated until every member has received
+ * every fragment, or until the configured number of repetitions is reached.
+ *
+ * The session keeps track of which fragments each member received, and reports
+ * the campaign completion time and the airtime spent by each gateway.
+ */
+class MulticastSession : public Object
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    MulticastSession();           //!< Default constructor
+    ~MulticastSession() override; //!< Destructor
+
+    /**
+     * Set the multicast address of the group.
+     *
+     * \param groupAddress The address of the group.
+     */
+    void SetGroupAddress(LoraDeviceAddress groupAddress);
+
+    /**
+     * Get the multicast address of the group.
+     *
+     * \return The address of the group.
+     */
+    LoraDeviceAddress GetGroupAddress() const;
+
+    /**
+     * Add a device to the multicast group.
+     *
+     * The device is subscribed to the group address. Members must be added
+     * after the group address is set and before the session starts.
+     *
+     * \param mac The MAC layer of the device.
+     */
+    void AddMember(Ptr<ClassCEndDeviceLorawanMac> mac);
+
+    /**
+     * Get the number of devices in the multicast group.
+     *
+     * \return The number of members.
+     */
+    uint32_t GetNMembers() const;
+
+    /**
+     * Start the campaign.
+     *
+     * Gateways that received uplinks from at least one member are used to
+     * deliver the fragments. If none did, all gateways are used.
+     *
+     * \param status The status of the network.
+     */
+    void Start(Ptr<NetworkStatus> status);
+
+    /**
+     * Check whether every member received every fragment.
+     *
+     * \return True if the campaign is complete.
+     */
+    bool IsComplete() const;
+
+    /**
+     * Get the time it took to deliver every fragment to every member.
+     *
+     * \return The completion time, or Time::Max () if the campaign is not
+     * complete.
+     */
+    Time GetCompletionTime() const;
+
+    /**
+     * Get the number of members that received every fragment.
+     *
+     * \return The number of members.
+     */
+    uint32_t GetNCompletedMembers() const;
+
+    /**
+     * Get the airtime spent by each gateway to deliver the fragments.
+     *
+     * \return A map from gateway address to total airtime.
+     */
+    const std::map<Address, Time>& GetAirtimePerGateway() const;
+
+    /**
+     * TracedCallback signature for the completion of a campaign.
+     *
+     * \param completionTime The time it took to complete the campaign.
+     */
+    typedef void (*CompletedTracedCallback)(Time completionTime);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * Create the packet carrying a fragment, tagged with the session data rate
+     * and frequency.
+     *
+     * \param fragment The index of the fragment.
+     * \return The packet.
+     */
+    Ptr<Packet> CreateFragment(uint16_t fragment) const;
+
+    /**
+     * Compute the airtime of a fragment sent by a gateway.
+     *
+     * \param gwMac The MAC layer of the gateway.
+     * \param packet The fragment.
+     * \return The airtime of the fragment.
+     */
+    Time GetFragmentAirtime(Ptr<GatewayLorawanMac> gwMac, Ptr<Packet> packet) const;
+
+    /**
+     * Send the next fragment through a gateway, or wait for the gateway to be
+     * allowed to transmit.
+     *
+     * \param gwIndex The index of the gateway in m_gateways.
+     * \param sequence The position of the transmission in the (repeated)
+     * sequence of fragments.
+     */
+    void SendFragment(uint32_t gwIndex, uint32_t sequence);
+
+    /**
+     * Record the reception of a fragment at a member.
+     *
+     * \param memberIndex The index of the member.
+     * \param packet The received packet.
+     * \param groupAddress The multicast address of the packet.
+     * \param fCnt The frame counter of the packet, i.e., the fragment index.
+     */
+    void FragmentReceived(uint32_t memberIndex,
+                          Ptr<const Packet> packet,
+                          LoraDeviceAddress groupAddress,
+                          uint16_t fCnt);
+
+    LoraDeviceAddress m_groupAddress; //!< The multicast address of the group
+    uint8_t m_dataRate;               //!< The data rate of the fragments
+    double m_frequency;               //!< The frequency of the fragments, in MHz
+    uint32_t m_nFragments;            //!< The number of fragments to deliver
+    uint32_t m_fragmentSize;          //!< The application payload of each fragment, in bytes
+    uint32_t m_repetitions;           //!< The maximum number of times the sequence is sent
+    Time m_guardInterval;             //!< Spacing between transmissions of different gateways
+
+    std::vector<Ptr<ClassCEndDeviceLorawanMac>> m_members; //!< The MAC layer of the members
+
+    /**
+     * For each member, the fragments it received.
+     */
+    std::vector<std::vector<bool>> m_receivedFragments;
+
+    std::vector<uint32_t> m_missingFragments; //!< For each member, the fragments still missing
+    uint32_t m_nCompletedMembers;             //!< The members that received every fragment
+
+    Ptr<NetworkStatus> m_status;         //!< The status of the network
+    std::vector<Address> m_gateways;     //!< The gateways delivering the fragments
+    std::vector<EventId> m_nextFragment; //!< For each gateway, its next transmission
+    std::map<Address, Time> m_airtime;   //!< The airtime spent by each gateway
+
+    Time m_startTime;      //!< The time the campaign started
+    Time m_completionTime; //!< The time it took to complete the campaign
+
+    TracedCallback<Time> m_completed; //!< Trace source fired when the campaign completes
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* MULTICAST_SESSION_H */
@@ -8,6 +8,8 @@
 
 #include "network-controller-components.h"
 
+#include "lora-profiler.h"
+
 namespace ns3
 {
 namespace lorawan
@@ -60,6 +62,7 @@ ConfirmedMessagesComponent::OnReceivedPacket(Ptr<const Packet> packet,
                                              Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this->GetTypeId() << packet << networkStatus);
+    LORAWAN_PROFILE_SCOPE("ConfirmedMessagesComponent::OnReceivedPacket");
 
     // Check whether the received packet requires an acknowledgment.
     LorawanMacHeader mHdr;
@@ -98,6 +101,7 @@ ConfirmedMessagesComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status,
                                                Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this << status << networkStatus);
+    LORAWAN_PROFILE_SCOPE("ConfirmedMessagesComponent::BeforeSendingReply");
     // Nothing to do in this case
 }
 
@@ -106,6 +110,7 @@ ConfirmedMessagesComponent::OnFailedReply(Ptr<EndDeviceStatus> status,
                                           Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this << networkStatus);
+    LORAWAN_PROFILE_SCOPE("ConfirmedMessagesComponent::OnFailedReply");
 
     // Empty the Ack bit.
     status->m_reply.frameHeader.SetAck(false);
@@ -138,6 +143,7 @@ LinkCheckComponent::OnReceivedPacket(Ptr<const Packet> packet,
                                      Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this->GetTypeId() << packet << networkStatus);
+    LORAWAN_PROFILE_SCOPE("LinkCheckComponent::OnReceivedPacket");
 
     // We will only act just before reply, when all Gateways will have received
     // the packet.
@@ -148,6 +154,7 @@ LinkCheckComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status,
                                        Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this << status << networkStatus);
+    LORAWAN_PROFILE_SCOPE("LinkCheckComponent::BeforeSendingReply");
 
     Ptr<Packet> myPacket = status->GetLastPacketReceivedFromDevice()->Copy();
     LorawanMacHeader mHdr;
@@ -183,6 +190,7 @@ void
 LinkCheckComponent::OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus)
 {
     NS_LOG_FUNCTION(this->GetTypeId() << networkStatus);
+    LORAWAN_PROFILE_SCOPE("LinkCheckComponent::OnFailedReply");
 }
 } // namespace lorawan
 } // namespace ns3
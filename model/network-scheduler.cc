@@ -1,5 +1,9 @@
 #include "network-scheduler.h"
 
+#include "class-b-end-device-lorawan-mac.h"
+#include "gateway-status.h"
+#include "lora-tag.h"
+
 namespace ns3
 {
 namespace lorawan
@@ -20,17 +24,30 @@ NetworkScheduler::GetTypeId()
                             "Trace source that is fired when a receive window opportunity happens.",
                             MakeTraceSourceAccessor(&NetworkScheduler::m_receiveWindowOpened),
                             "ns3::Packet::TracedCallback")
+            .AddTraceSource("ClassBDownlinkLatency",
+                            "Trace source that is fired when a Class B downlink is delivered",
+                            MakeTraceSourceAccessor(&NetworkScheduler::m_classBDownlinkLatency),
+                            "ns3::lorawan::NetworkScheduler::ClassBDownlinkLatencyTracedCallback")
+            .AddAttribute("MaxClassBAttempts",
+                          "The maximum number of ping slots used to deliver a Class B downlink",
+                          UintegerValue(3),
+                          MakeUintegerAccessor(&NetworkScheduler::m_maxClassBAttempts),
+                          MakeUintegerChecker<uint8_t>(1))
             .SetGroupName("lorawan");
     return tid;
 }
 
 NetworkScheduler::NetworkScheduler()
+    : m_maxClassBAttempts(3),
+      m_nFailedClassBDownlinks(0)
 {
 }
 
 NetworkScheduler::NetworkScheduler(Ptr<NetworkStatus> status, Ptr<NetworkController> controller)
     : m_status(status),
-      m_controller(controller)
+      m_controller(controller),
+      m_maxClassBAttempts(3),
+      m_nFailedClassBDownlinks(0)
 {
 }
 
@@ -130,5 +147,212 @@ NetworkScheduler::OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, in
         }
     }
 }
+
+void
+NetworkScheduler::EnableClassB()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    if (!m_beaconTimeline)
+    {
+        m_beaconTimeline = CreateObject<ClassBBeaconTimeline>();
+        m_beaconTimeline->SetNetworkStatus(m_status);
+        m_beaconTimeline->Start();
+    }
+}
+
+Ptr<ClassBBeaconTimeline>
+NetworkScheduler::GetBeaconTimeline() const
+{
+    return m_beaconTimeline;
+}
+
+void
+NetworkScheduler::ScheduleClassBDownlink(LoraDeviceAddress deviceAddress, Ptr<Packet> payload)
+{
+    NS_LOG_FUNCTION(this << deviceAddress << payload);
+
+    NS_ABORT_MSG_IF(!m_beaconTimeline, "Class B is not enabled.");
+
+    Ptr<EndDeviceStatus> edStatus = m_status->GetEndDeviceStatus(deviceAddress);
+    NS_ABORT_MSG_IF(!edStatus, "Unknown device " << deviceAddress);
+    Ptr<ClassBEndDeviceLorawanMac> mac = DynamicCast<ClassBEndDeviceLorawanMac>(edStatus->GetMac());
+    NS_ABORT_MSG_IF(!mac, "Device " << deviceAddress << " is not a Class B device.");
+
+    // Measure the latency at the device
+    if (m_classBListened.insert(deviceAddress).second)
+    {
+        mac->TraceConnectWithoutContext(
+            "ReceivedPacket",
+            MakeCallback(&NetworkScheduler::ClassBDownlinkReceived, this).Bind(deviceAddress));
+    }
+
+    // A pending downlink may already be waiting for a ping slot
+    bool waitingSlot = false;
+    auto it = m_classBDownlinks.find(deviceAddress);
+    if (it != m_classBDownlinks.end())
+    {
+        NS_LOG_WARN("Replacing the pending Class B downlink of device " << deviceAddress);
+        waitingSlot = it->second.waitingSlot;
+    }
+    m_classBDownlinks[deviceAddress] = {payload, Simulator::Now(), 0, 0, waitingSlot};
+
+    if (!waitingSlot)
+    {
+        ScheduleNextPingSlot(deviceAddress);
+    }
+}
+
+const std::vector<Time>&
+NetworkScheduler::GetClassBDownlinkLatencies() const
+{
+    return m_classBLatencies;
+}
+
+uint32_t
+NetworkScheduler::GetNFailedClassBDownlinks() const
+{
+    return m_nFailedClassBDownlinks;
+}
+
+void
+NetworkScheduler::ScheduleNextPingSlot(LoraDeviceAddress deviceAddress)
+{
+    NS_LOG_FUNCTION(this << deviceAddress);
+
+    Ptr<EndDeviceStatus> edStatus = m_status->GetEndDeviceStatus(deviceAddress);
+    Ptr<ClassBEndDeviceLorawanMac> mac = DynamicCast<ClassBEndDeviceLorawanMac>(edStatus->GetMac());
+    m_classBDownlinks.at(deviceAddress).waitingSlot = true;
+
+    // Skip the ping slot that is starting now, if any
+    Time slotStart = m_beaconTimeline->GetNextPingSlot(deviceAddress,
+                                                       mac->GetPingSlotPeriodicity(),
+                                                       Simulator::Now() + MilliSeconds(1));
+    NS_LOG_DEBUG("Next ping slot of device " << deviceAddress << " at " << slotStart.As(Time::S));
+
+    m_beaconTimeline->ScheduleAtPingSlot(
+        slotStart,
+        MakeCallback(&NetworkScheduler::OnPingSlot, this).Bind(deviceAddress));
+}
+
+void
+NetworkScheduler::OnPingSlot(LoraDeviceAddress deviceAddress)
+{
+    NS_LOG_FUNCTION(this << deviceAddress);
+
+    auto it = m_classBDownlinks.find(deviceAddress);
+    if (it == m_classBDownlinks.end())
+    {
+        // Already delivered
+        return;
+    }
+    ClassBDownlink& downlink = it->second;
+    downlink.waitingSlot = false;
+
+    // The device runs the same ping slot function: open the slot it would
+    // open anyway
+    Ptr<EndDeviceStatus> edStatus = m_status->GetEndDeviceStatus(deviceAddress);
+    Ptr<ClassBEndDeviceLorawanMac> mac = DynamicCast<ClassBEndDeviceLorawanMac>(edStatus->GetMac());
+    mac->OpenPingSlot();
+
+    // Pick the best gateway that can transmit on the ping slot frequency
+    double frequency = mac->GetPingSlotFrequency();
+    std::map<double, Address> gwAddresses = edStatus->GetPowerGatewayMap();
+    Address gwAddress;
+    for (auto gw = gwAddresses.rbegin(); gw != gwAddresses.rend(); gw++)
+    {
+        if (m_status->m_gatewayStatuses.at(gw->second)->IsAvailableForTransmission(frequency))
+        {
+            gwAddress = gw->second;
+            break;
+        }
+    }
+
+    downlink.attempts++;
+    if (gwAddress == Address())
+    {
+        NS_LOG_DEBUG("No suitable gateway found for the ping slot.");
+    }
+    else
+    {
+        Ptr<Packet> packet = downlink.payload->Copy();
+
+        LoraFrameHeader fHdr;
+        fHdr.SetAsDownlink();
+        fHdr.SetAddress(deviceAddress);
+        packet->AddHeader(fHdr);
+
+        LorawanMacHeader mHdr;
+        mHdr.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+        packet->AddHeader(mHdr);
+
+        LoraTag tag;
+        tag.SetDataRate(mac->GetPingSlotDataRate());
+        tag.SetFrequency(frequency);
+        packet->AddPacketTag(tag);
+
+        downlink.uid = packet->GetUid();
+
+        NS_LOG_DEBUG("Sending Class B downlink to " << deviceAddress << " through gateway "
+                                                    << gwAddress);
+        m_status->m_gatewayStatuses.at(gwAddress)->SetNextTransmissionTime(Simulator::Now());
+        m_status->SendThroughGateway(packet, gwAddress);
+    }
+
+    if (downlink.attempts < m_maxClassBAttempts)
+    {
+        // Nothing happens if the downlink is received in this slot
+        ScheduleNextPingSlot(deviceAddress);
+    }
+    else
+    {
+        // Give up once the last transmission is surely over
+        Simulator::Schedule(Seconds(3),
+                            &NetworkScheduler::GiveUpClassBDownlink,
+                            this,
+                            deviceAddress,
+                            downlink.uid);
+    }
+}
+
+void
+NetworkScheduler::GiveUpClassBDownlink(LoraDeviceAddress deviceAddress, uint64_t uid)
+{
+    NS_LOG_FUNCTION(this << deviceAddress << uid);
+
+    // The downlink may have been delivered or replaced in the meantime
+    auto it = m_classBDownlinks.find(deviceAddress);
+    if (it == m_classBDownlinks.end() || it->second.uid != uid || it->second.waitingSlot ||
+        it->second.attempts < m_maxClassBAttempts)
+    {
+        return;
+    }
+
+    NS_LOG_DEBUG("Giving up on the Class B downlink to " << deviceAddress);
+    m_classBDownlinks.erase(it);
+    m_nFailedClassBDownlinks++;
+}
+
+void
+NetworkScheduler::ClassBDownlinkReceived(LoraDeviceAddress deviceAddress, Ptr<const Packet> packet)
+{
+    NS_LOG_FUNCTION(this << deviceAddress << packet);
+
+    auto it = m_classBDownlinks.find(deviceAddress);
+    if (it == m_classBDownlinks.end() || it->second.uid != packet->GetUid())
+    {
+        return;
+    }
+
+    Time latency = Simulator::Now() - it->second.requestTime;
+    NS_LOG_INFO("Class B downlink to " << deviceAddress << " delivered in "
+                                       << latency.As(Time::S) << " after "
+                                       << unsigned(it->second.attempts) << " ping slot(s)");
+
+    m_classBDownlinks.erase(it);
+    m_classBLatencies.push_back(latency);
+    m_classBDownlinkLatency(deviceAddress, latency);
+}
+
 } // namespace lorawan
 } // namespace ns3
@@ -9,6 +9,7 @@
 #ifndef NETWORK_SCHEDULER_H
 #define NETWORK_SCHEDULER_H
 
+#include "class-b-beacon-timeline.h"
 #include "lora-device-address.h"
 #include "lora-frame-header.h"
 #include "lorawan-mac-header.h"
@@ -19,6 +20,10 @@
 #include "ns3/object.h"
 #include "ns3/packet.h"
 
+#include <map>
+#include <set>
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -74,12 +79,114 @@ class NetworkScheduler : public Object
      */
     void OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, int window);
 
+    /**
+     * Start the Class B beacon timeline of the network, if it was not started
+     * already.
+     */
+    void EnableClassB();
+
+    /**
+     * Get the Class B beacon timeline of the network.
+     *
+     * \return A pointer to the timeline, or nullptr if Class B is not enabled.
+     */
+    Ptr<ClassBBeaconTimeline> GetBeaconTimeline() const;
+
+    /**
+     * Schedule a downlink to a Class B device in its next ping slot.
+     *
+     * If the device does not receive the downlink, it is sent again in the
+     * following ping slots, up to MaxClassBAttempts times. A new downlink to a
+     * device replaces the one still pending, if any.
+     *
+     * \param deviceAddress The address of the device.
+     * \param payload The application payload of the downlink.
+     */
+    void ScheduleClassBDownlink(LoraDeviceAddress deviceAddress, Ptr<Packet> payload);
+
+    /**
+     * Get the latency of each Class B downlink delivered so far, from the
+     * request to the reception at the device.
+     *
+     * \return The latencies, in order of delivery.
+     */
+    const std::vector<Time>& GetClassBDownlinkLatencies() const;
+
+    /**
+     * Get the number of Class B downlinks that could not be delivered.
+     *
+     * \return The number of failed downlinks.
+     */
+    uint32_t GetNFailedClassBDownlinks() const;
+
+    /**
+     * TracedCallback signature for the delivery of a Class B downlink.
+     *
+     * \param deviceAddress The address of the device.
+     * \param latency The time from the request to the reception at the device.
+     */
+    typedef void (*ClassBDownlinkLatencyTracedCallback)(LoraDeviceAddress deviceAddress,
+                                                        Time latency);
+
   private:
+    /**
+     * A Class B downlink waiting for delivery.
+     */
+    struct ClassBDownlink
+    {
+        Ptr<Packet> payload; //!< The application payload
+        Time requestTime;    //!< The time the downlink was requested
+        uint8_t attempts;    //!< The number of ping slots used so far
+        uint64_t uid;        //!< The uid of the last transmitted packet
+        bool waitingSlot;    //!< Whether the downlink is registered in a ping slot
+    };
+
+    /**
+     * Register the delivery of the pending downlink of a device in its next
+     * ping slot.
+     *
+     * \param deviceAddress The address of the device.
+     */
+    void ScheduleNextPingSlot(LoraDeviceAddress deviceAddress);
+
+    /**
+     * Open the ping slot of a device and send its pending downlink, if any.
+     *
+     * \param deviceAddress The address of the device.
+     */
+    void OnPingSlot(LoraDeviceAddress deviceAddress);
+
+    /**
+     * Drop the pending downlink of a device, if all its attempts were used.
+     *
+     * \param deviceAddress The address of the device.
+     * \param uid The uid of the last transmitted packet.
+     */
+    void GiveUpClassBDownlink(LoraDeviceAddress deviceAddress, uint64_t uid);
+
+    /**
+     * Record the reception of a packet at a Class B device.
+     *
+     * \param deviceAddress The address of the device.
+     * \param packet The received packet.
+     */
+    void ClassBDownlinkReceived(LoraDeviceAddress deviceAddress, Ptr<const Packet> packet);
+
     TracedCallback<Ptr<const Packet>>
         m_receiveWindowOpened;           //!< Trace callback source for reception windows openings.
                                          //!< \todo Never called. Place calls in the right places.
     Ptr<NetworkStatus> m_status;         //!< A pointer to the NetworkStatus object.
     Ptr<NetworkController> m_controller; //!< A pointer to the NetworkController object.
+
+    Ptr<ClassBBeaconTimeline> m_beaconTimeline; //!< The Class B beacon timeline, if enabled.
+    uint8_t m_maxClassBAttempts; //!< The maximum number of ping slots used by a downlink.
+    std::map<LoraDeviceAddress, ClassBDownlink> m_classBDownlinks; //!< Pending downlinks.
+    std::set<LoraDeviceAddress> m_classBListened; //!< Devices whose receptions are traced.
+    std::vector<Time> m_classBLatencies;          //!< Latencies of the delivered downlinks.
+    uint32_t m_nFailedClassBDownlinks;            //!< Number of failed downlinks.
+
+    TracedCallback<LoraDeviceAddress, Time>
+        m_classBDownlinkLatency; //!< Trace source fired when a Class B downlink is delivered.
 };
 
 } // namespace lorawan
@@ -10,8 +10,10 @@
 #include "network-server.h"
 
 #include "class-a-end-device-lorawan-mac.h"
+#include "class-b-end-device-lorawan-mac.h"
 #include "lora-device-address.h"
 #include "lora-frame-header.h"
+#include "lora-profiler.h"
 #include "lorawan-mac-header.h"
 #include "mac-command.h"
 #include "network-status.h"
@@ -20,6 +22,7 @@
 #include "ns3/node-container.h"
 #include "ns3/packet.h"
 #include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
 
 namespace ns3
 {
@@ -138,6 +141,12 @@ NetworkServer::AddNode(Ptr<Node> node)
 
     // Update the NetworkStatus about the existence of this node
     m_status->AddNode(edLorawanMac);
+
+    // Class B devices need the beacons of the gateways
+    if (DynamicCast<ClassBEndDeviceLorawanMac>(edLorawanMac))
+    {
+        m_scheduler->EnableClassB();
+    }
 }
 
 bool
@@ -147,6 +156,7 @@ NetworkServer::Receive(Ptr<NetDevice> device,
                        const Address& address)
 {
     NS_LOG_FUNCTION(this << packet << protocol << address);
+    LORAWAN_PROFILE_SCOPE("NetworkServer::Receive");
 
     // Create a copy of the packet
     Ptr<Packet> myPacket = packet->Copy();
@@ -154,6 +164,16 @@ NetworkServer::Receive(Ptr<NetDevice> device,
     // Fire the trace source
     m_receivedPacket(packet);
 
+    // Drop the packets of unknown devices, such as virtual end devices,
+    // like a network server drops the frames of addresses it has no session
+    // for
+    Ptr<EndDeviceStatus> edStatus = m_status->GetEndDeviceStatus(packet);
+    if (!edStatus)
+    {
+        NS_LOG_INFO("Dropping the packet of an unknown device");
+        return true;
+    }
+
     // Inform the scheduler of the newly arrived packet
     m_scheduler->OnReceivedPacket(packet);
 
@@ -163,6 +183,13 @@ NetworkServer::Receive(Ptr<NetDevice> device,
     // Inform the controller of the newly arrived packet
     m_controller->OnNewPacket(packet);
 
+    // If a reply is already known to be needed, make sure the device listens
+    // for it (devices may skip their receive windows otherwise)
+    if (edStatus->NeedsReply())
+    {
+        edStatus->GetMac()->MaterializeReceiveWindows();
+    }
+
     return true;
 }
 
@@ -174,11 +201,26 @@ NetworkServer::AddComponent(Ptr<NetworkControllerComponent> component)
     m_controller->Install(component);
 }
 
+void
+NetworkServer::AddMulticastSession(Ptr<MulticastSession> session, Time start)
+{
+    NS_LOG_FUNCTION(this << session << start);
+
+    m_multicastSessions.push_back(session);
+    Simulator::Schedule(start, &MulticastSession::Start, session, m_status);
+}
+
 Ptr<NetworkStatus>
 NetworkServer::GetNetworkStatus()
 {
     return m_status;
 }
 
+Ptr<NetworkScheduler>
+NetworkServer::GetNetworkScheduler()
+{
+    return m_scheduler;
+}
+
 } // namespace lorawan
 } // namespace ns3
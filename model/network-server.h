@@ -13,6 +13,7 @@
 #include "class-a-end-device-lorawan-mac.h"
 #include "gateway-status.h"
 #include "lora-device-address.h"
+#include "multicast-session.h"
 #include "network-controller.h"
 #include "network-scheduler.h"
 #include "network-status.h"
@@ -99,6 +100,14 @@ class NetworkServer : public Application
      */
     void AddComponent(Ptr<NetworkControllerComponent> component);
 
+    /**
+     * Add a multicast session to be run by this NetworkServer application.
+     *
+     * \param session A pointer to the MulticastSession object.
+     * \param start The delay after which the session starts.
+     */
+    void AddMulticastSession(Ptr<MulticastSession> session, Time start);
+
     /**
      * Receive a packet from a gateway.
      *
@@ -118,11 +127,20 @@ class NetworkServer : public Application
      */
     Ptr<NetworkStatus> GetNetworkStatus();
 
+    /**
+     * Get the NetworkScheduler object of this NetworkServer application.
+     *
+     * \return A pointer to the NetworkScheduler object.
+     */
+    Ptr<NetworkScheduler> GetNetworkScheduler();
+
   protected:
     Ptr<NetworkStatus> m_status;         //!< Ptr to the NetworkStatus object.
     Ptr<NetworkController> m_controller; //!< Ptr to the NetworkController object.
     Ptr<NetworkScheduler> m_scheduler;   //!< Ptr to the NetworkScheduler object.
 
+    std::vector<Ptr<MulticastSession>> m_multicastSessions; //!< The multicast sessions.
+
     TracedCallback<Ptr<const Packet>> m_receivedPacket; //!< The `ReceivedPacket` trace source.
 };
 
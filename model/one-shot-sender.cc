@@ -31,7 +31,13 @@ OneShotSender::GetTypeId()
     static TypeId tid = TypeId("ns3::OneShotSender")
                             .SetParent<Application>()
                             .AddConstructor<OneShotSender>()
-                            .SetGroupName("lorawan");
+                            .SetGroupName("lorawan")
+                            .AddAttribute("PacketPool",
+                                          "The pool of the packet of this app, usually shared "
+                                          "between apps. If not set, a new packet is created.",
+                                          PointerValue(),
+                                          MakePointerAccessor(&OneShotSender::m_packetPool),
+                                          MakePointerChecker<LoraPacketPool>());
     return tid;
 }
 
@@ -64,8 +70,8 @@ OneShotSender::SendPacket()
 {
     NS_LOG_FUNCTION(this);
 
-    // Create and send a new packet
-    Ptr<Packet> packet = Create<Packet>(10);
+    // A single packet is not worth a pool of its own: only use a shared one
+    Ptr<Packet> packet = m_packetPool ? m_packetPool->Acquire(10) : Create<Packet>(10);
     m_mac->Send(packet);
 }
 
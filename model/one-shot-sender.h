@@ -9,6 +9,7 @@
 #ifndef ONE_SHOT_SENDER_H
 #define ONE_SHOT_SENDER_H
 
+#include "lora-packet-pool.h"
 #include "lorawan-mac.h"
 
 #include "ns3/application.h"
@@ -67,9 +68,10 @@ class OneShotSender : public Application
     void StopApplication() override;
 
   private:
-    Time m_sendTime;       //!< The time at which to send the packet.
-    EventId m_sendEvent;   //!< The sending event.
-    Ptr<LorawanMac> m_mac; //!< The MAC layer of this node.
+    Time m_sendTime;                  //!< The time at which to send the packet.
+    EventId m_sendEvent;              //!< The sending event.
+    Ptr<LorawanMac> m_mac;            //!< The MAC layer of this node.
+    Ptr<LoraPacketPool> m_packetPool; //!< The pool of the packet, if any.
 };
 
 } // namespace lorawan
@@ -36,7 +36,13 @@ PeriodicSender::GetTypeId()
                                           TimeValue(Seconds(0)),
                                           MakeTimeAccessor(&PeriodicSender::GetInterval,
                                                            &PeriodicSender::SetInterval),
-                                          MakeTimeChecker());
+                                          MakeTimeChecker())
+                            .AddAttribute("PacketPool",
+                                          "The pool recycling the packets of this app. If not "
+                                          "set, the app uses the pool of its node.",
+                                          PointerValue(),
+                                          MakePointerAccessor(&PeriodicSender::m_packetPool),
+                                          MakePointerChecker<LoraPacketPool>());
     // .AddAttribute ("PacketSizeRandomVariable", "The random variable that determines the shape of
     // the packet size, in bytes",
     //                StringValue ("ns3::UniformRandomVariable[Min=0,Max=10]"),
@@ -98,16 +104,16 @@ PeriodicSender::SendPacket()
 {
     NS_LOG_FUNCTION(this);
 
-    // Create and send a new packet
+    // Get a packet from the pool and send it
     Ptr<Packet> packet;
     if (m_pktSizeRV)
     {
         int randomsize = m_pktSizeRV->GetInteger();
-        packet = Create<Packet>(m_basePktSize + randomsize);
+        packet = m_packetPool->Acquire(m_basePktSize + randomsize);
     }
     else
     {
-        packet = Create<Packet>(m_basePktSize);
+        packet = m_packetPool->Acquire(m_basePktSize);
     }
     m_mac->Send(packet);
 
@@ -132,6 +138,17 @@ PeriodicSender::StartApplication()
         NS_ASSERT(m_mac);
     }
 
+    // Without a pool of its own, the app shares the pool of its node
+    if (!m_packetPool)
+    {
+        m_packetPool = m_node->GetObject<LoraPacketPool>();
+    }
+    if (!m_packetPool)
+    {
+        m_packetPool = CreateObject<LoraPacketPool>();
+        m_node->AggregateObject(m_packetPool);
+    }
+
     // Schedule the next SendPacket event
     Simulator::Cancel(m_sendEvent);
     NS_LOG_DEBUG("Starting up application with a first event with a " << m_initialDelay.GetSeconds()
@@ -9,6 +9,7 @@
 #ifndef PERIODIC_SENDER_H
 #define PERIODIC_SENDER_H
 
+#include "lora-packet-pool.h"
 #include "lorawan-mac.h"
 
 #include "ns3/application.h"
@@ -100,7 +101,8 @@ class PeriodicSender : public Application
     Ptr<LorawanMac> m_mac; //!< The MAC layer of this node.
     uint8_t m_basePktSize; //!< The packet size.
     Ptr<RandomVariableStream>
-        m_pktSizeRV; //!< The random variable that adds bytes to the packet size.
+        m_pktSizeRV;                  //!< The random variable that adds bytes to the packet size.
+    Ptr<LoraPacketPool> m_packetPool; //!< The pool recycling the packets of this app.
 };
 
 } // namespace lorawan
@@ -41,7 +41,12 @@ TypeId RandomSender::GetTypeId (void){
     	.AddAttribute ("PacketSize", "The size of the packets this application sends, in bytes",
         	           StringValue ("ns3::ParetoRandomVariable[Bound=200,Shape=2.5]"),
             	       MakePointerAccessor (&RandomSender::m_pktSize),
-                	   MakePointerChecker <RandomVariableStream>());
+                	   MakePointerChecker <RandomVariableStream>())
+    	.AddAttribute ("PacketPool", "The pool recycling the packets of this app. "
+        	           "If not set, the app uses the pool of its node.",
+            	       PointerValue (),
+            	       MakePointerAccessor (&RandomSender::m_packetPool),
+                	   MakePointerChecker <LoraPacketPool>());
   	return(tid);
 }
 
@@ -79,17 +84,23 @@ void RandomSender::SetPacketSize (uint8_t size){
   m_basePktSize = size;
 }
 
+int64_t RandomSender::AssignStreams (int64_t stream){
+  NS_LOG_FUNCTION (this << stream);
+  m_nextDelay->SetStream (stream);
+  return 1;
+}
+
 void RandomSender::SendPacket (void){
   	NS_LOG_FUNCTION (this);
 
 	Time nxtDelay;
-  	// Create and send a new packet
+  	// Get a packet from the pool and send it
   	int size = m_pktSize->GetInteger ();
   	Ptr<Packet> packet;
   	if (m_randomPktSize){
-      	packet = Create<Packet>(m_basePktSize+size);
+      	packet = m_packetPool->Acquire (m_basePktSize+size);
     }else{
-      	packet = Create<Packet>(m_basePktSize);
+      	packet = m_packetPool->Acquire (m_basePktSize);
     }
 
 	m_mac->Send (packet);
@@ -117,6 +128,15 @@ void RandomSender::StartApplication (void){
       	NS_ASSERT (m_mac);
     }
 
+  	// Without a pool of its own, the app shares the pool of its node
+  	if (!m_packetPool){
+      	m_packetPool = m_node->GetObject<LoraPacketPool> ();
+    }
+  	if (!m_packetPool){
+      	m_packetPool = CreateObject<LoraPacketPool> ();
+      	m_node->AggregateObject (m_packetPool);
+    }
+
 	// Schedule the next SendPacket event
   	Simulator::Cancel (m_sendEvent);
   	NS_LOG_DEBUG ("Starting up application with a first event with a " <<
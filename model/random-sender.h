@@ -18,6 +18,7 @@
 #ifndef RANDOM_SENDER_H
 #define RANDOM_SENDER_H
 
+#include "lora-packet-pool.h"
 #include "lorawan-mac.h"
 
 #include "ns3/application.h"
@@ -56,6 +57,15 @@ public:
    	*/
   	void SetPacketSize (uint8_t size);
 
+  	/**
+   	* Assign a fixed random variable stream number to the random variable
+   	* of the delays between the packets of this application
+   	*
+   	* \param stream The stream index to use
+   	* \return The number of stream indices assigned
+   	*/
+  	int64_t AssignStreams (int64_t stream);
+
   	/**
    	* Send a packet using the LoraNetDevice's Send method
    	*/
@@ -106,6 +116,11 @@ private:
    	* The packet size.
    	*/
   	uint8_t m_basePktSize;
+
+  	/**
+   	* The pool recycling the packets of this application
+   	*/
+  	Ptr<LoraPacketPool> m_packetPool;
 };
 
 } //namespace ns3
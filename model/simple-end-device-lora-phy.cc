@@ -8,6 +8,7 @@
 
 #include "simple-end-device-lora-phy.h"
 
+#include "lora-profiler.h"
 #include "lora-tag.h"
 
 #include "ns3/log.h"
@@ -103,6 +104,7 @@ SimpleEndDeviceLoraPhy::StartReceive(Ptr<Packet> packet,
                                      double frequencyMHz)
 {
     NS_LOG_FUNCTION(this << packet << rxPowerDbm << unsigned(sf) << duration << frequencyMHz);
+    LORAWAN_PROFILE_SCOPE("SimpleEndDeviceLoraPhy::StartReceive");
 
     // Notify the LoraInterferenceHelper of the impinging signal, and remember
     // the event it creates. This will be used then to correctly handle the end
@@ -235,6 +237,7 @@ void
 SimpleEndDeviceLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper::Event> event)
 {
     NS_LOG_FUNCTION(this << packet << event);
+    LORAWAN_PROFILE_SCOPE("SimpleEndDeviceLoraPhy::EndReceive");
 
     // Automatically switch to Standby in either case
     SwitchToStandby();
@@ -8,11 +8,14 @@
 
 #include "simple-gateway-lora-phy.h"
 
+#include "lora-profiler.h"
 #include "lora-tag.h"
 
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 namespace lorawan
@@ -89,6 +92,23 @@ SimpleGatewayLoraPhy::Send(Ptr<Packet> packet,
         }
     }
 
+    // Interrupt all hypothetical receptions
+    for (auto& [event, reception] : m_hypothesisReceptions)
+    {
+        Simulator::Cancel(reception.endReceive);
+        for (uint32_t h = 0; h < reception.locked.size(); h++)
+        {
+            if (reception.locked[h])
+            {
+                FireHypothesisOutcome(event->GetPacket(), h, HYPOTHESIS_LOST_BECAUSE_TX);
+            }
+        }
+    }
+    m_hypothesisReceptions.clear();
+    std::fill(m_hypothesisOccupiedPaths.begin(), m_hypothesisOccupiedPaths.end(), 0);
+
+    m_signalTransmission(packet, txPowerDbm, txParams.sf, duration, frequencyMHz);
+
     // Send the packet in the channel
     m_channel->Send(this, packet, txPowerDbm, txParams, duration, frequencyMHz);
 
@@ -115,6 +135,7 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
                                    double frequencyMHz)
 {
     NS_LOG_FUNCTION(this << packet << rxPowerDbm << duration << frequencyMHz);
+    LORAWAN_PROFILE_SCOPE("SimpleGatewayLoraPhy::StartReceive");
 
 
   	LoraTag tag;
@@ -125,8 +146,9 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
 
   	NS_LOG_DEBUG("receiving id: " << (unsigned)nodeId <<  " rx: " << (unsigned)rtxLeft << " sf: " << (unsigned)sf);
 
-    // Fire the trace source
+    // Fire the trace sources
     m_phyRxBeginTrace(packet);
+    m_signalArrival(packet, rxPowerDbm, sf, duration, frequencyMHz);
 
     if (m_isTransmitting)
     {
@@ -152,6 +174,11 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
             m_noReceptionBecauseTransmitting(packet, 0);
         }
 
+        for (uint32_t h = 0; h < m_hypothesisOccupiedPaths.size(); h++)
+        {
+            FireHypothesisOutcome(packet, h, HYPOTHESIS_LOST_BECAUSE_TX);
+        }
+
         return;
     }
 
@@ -194,6 +221,7 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
                 {
                     m_underSensitivity(packet, 0);
                 }
+                StartHypothesisReceive(event, true);
 
                 // Since the packet is below sensitivity, it makes no sense to
                 // search for another ReceivePath
@@ -212,6 +240,7 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
                     Simulator::Schedule(duration, &LoraPhy::EndReceive, this, packet, event);
 
                 currentPath->SetEndReceive(endReceiveEventId);
+                StartHypothesisReceive(event, false);
 
                 // Make sure we don't go on searching for other ReceivePaths
                 return;
@@ -238,12 +267,14 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
     {
         m_noMoreDemodulators(packet, 0);
     }
+    StartHypothesisReceive(event, true);
 }
 
 void
 SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper::Event> event)
 {
     NS_LOG_FUNCTION(this << packet << *event);
+    LORAWAN_PROFILE_SCOPE("SimpleGatewayLoraPhy::EndReceive");
 	
   	LoraTag tag;
   	packet->RemovePacketTag (tag);
@@ -258,7 +289,7 @@ SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper:
     // destructive interference. If the packet is correctly received, this
     // method returns a 0.
     uint8_t packetDestroyed = 0;
-    packetDestroyed = m_interference.IsDestroyedByInterference(event);
+    packetDestroyed = EvaluateReception(event, true);
 
     // Check whether the packet was destroyed
     if (packetDestroyed != uint8_t(0))
@@ -344,5 +375,122 @@ SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper:
     }
 }
 
+void
+SimpleGatewayLoraPhy::StartHypothesisReceive(Ptr<LoraInterferenceHelper::Event> event,
+                                             bool scheduleEnd)
+{
+    const std::vector<LoraInterferenceHelper::Hypothesis>& hypotheses =
+        m_interference.GetHypotheses();
+    if (hypotheses.empty())
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << event << scheduleEnd);
+
+    double sensitivity = SimpleGatewayLoraPhy::sensitivity[event->GetSpreadingFactor() - 7];
+    HypothesisReception reception;
+    reception.locked.assign(hypotheses.size(), false);
+    bool isLocked = false;
+    for (uint32_t h = 0; h < hypotheses.size(); h++)
+    {
+        if (m_hypothesisOccupiedPaths[h] >= hypotheses[h].nReceptionPaths)
+        {
+            FireHypothesisOutcome(event->GetPacket(), h, HYPOTHESIS_NO_MORE_RECEIVERS);
+        }
+        else if (event->GetRxPowerdBm() < sensitivity)
+        {
+            FireHypothesisOutcome(event->GetPacket(), h, HYPOTHESIS_UNDER_SENSITIVITY);
+        }
+        else
+        {
+            reception.locked[h] = true;
+            m_hypothesisOccupiedPaths[h]++;
+            isLocked = true;
+        }
+    }
+
+    if (!isLocked)
+    {
+        return;
+    }
+    if (scheduleEnd)
+    {
+        reception.endReceive = Simulator::Schedule(event->GetDuration(),
+                                                   &SimpleGatewayLoraPhy::EndHypothesisReceive,
+                                                   this,
+                                                   event);
+    }
+    m_hypothesisReceptions.emplace(event, reception);
+}
+
+void
+SimpleGatewayLoraPhy::EndHypothesisReceive(Ptr<LoraInterferenceHelper::Event> event)
+{
+    NS_LOG_FUNCTION(this << event);
+
+    EvaluateReception(event, false);
+}
+
+uint8_t
+SimpleGatewayLoraPhy::EvaluateReception(Ptr<LoraInterferenceHelper::Event> event, bool primary)
+{
+    auto it = m_hypothesisReceptions.find(event);
+    if (it == m_hypothesisReceptions.end())
+    {
+        return primary ? m_interference.IsDestroyedByInterference(event) : uint8_t(0);
+    }
+
+    // A single computation of the interference serves the gateway and the
+    // hypotheses
+    const std::vector<bool>& locked = it->second.locked;
+    std::vector<uint8_t> destroyedBy;
+    uint8_t packetDestroyed =
+        m_interference.IsDestroyedByInterference(event, primary, locked, destroyedBy);
+    for (uint32_t h = 0; h < locked.size(); h++)
+    {
+        if (locked[h])
+        {
+            m_hypothesisOccupiedPaths[h]--;
+            FireHypothesisOutcome(event->GetPacket(),
+                                  h,
+                                  destroyedBy[h] != 0 ? HYPOTHESIS_INTERFERED
+                                                      : HYPOTHESIS_RECEIVED);
+        }
+    }
+    m_hypothesisReceptions.erase(it);
+
+    return packetDestroyed;
+}
+
+void
+SimpleGatewayLoraPhy::FireHypothesisOutcome(Ptr<const Packet> packet,
+                                            uint32_t hypothesis,
+                                            HypothesisOutcome outcome)
+{
+    NS_LOG_DEBUG("Outcome " << unsigned(outcome) << " under hypothesis " << hypothesis);
+
+    // As the gateway does, forget the chase combining state of a device once
+    // its packet is received or its last transmission is lost
+    if (m_interference.GetHypotheses()[hypothesis].incrementalRedundancy !=
+        LoraInterferenceHelper::NOREDUNDANCY)
+    {
+        LoraTag tag;
+        packet->PeekPacketTag(tag);
+        if (outcome == HYPOTHESIS_RECEIVED || tag.GetNumTx() == 0)
+        {
+            m_interference.ClearIndexUmap(tag.GetNodeId(), hypothesis);
+        }
+    }
+
+    if (m_device)
+    {
+        m_hypothesisOutcome(packet, m_device->GetNode()->GetId(), hypothesis, outcome);
+    }
+    else
+    {
+        m_hypothesisOutcome(packet, 0, hypothesis, outcome);
+    }
+}
+
 } // namespace lorawan
 } // namespace ns3
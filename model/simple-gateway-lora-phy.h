@@ -58,6 +58,47 @@ class SimpleGatewayLoraPhy : public GatewayLoraPhy
               double txPowerDbm) override;
 
   private:
+    /**
+     * Lock the free hypothetical reception paths on a signal reaching the
+     * gateway while it is not transmitting, and fire the outcomes of the
+     * hypotheses with no free path or too high a sensitivity.
+     *
+     * \param event The event of the signal.
+     * \param scheduleEnd Whether to schedule the end of the hypothetical
+     * receptions, because no actual path is locked on the signal.
+     */
+    void StartHypothesisReceive(Ptr<LoraInterferenceHelper::Event> event, bool scheduleEnd);
+
+    /**
+     * End the hypothetical receptions of a signal no actual path is locked on.
+     *
+     * \param event The event of the signal.
+     */
+    void EndHypothesisReceive(Ptr<LoraInterferenceHelper::Event> event);
+
+    /**
+     * Determine whether a signal was destroyed by interference, under the
+     * parameters of the gateway and under the hypotheses locked on it, firing
+     * the outcomes of the latter and freeing their paths.
+     *
+     * \param event The event of the signal.
+     * \param primary Whether an actual path is locked on the signal.
+     * \return The sf of the packets that caused the loss under the parameters
+     * of the gateway, or 0 if there was no loss or primary is false.
+     */
+    uint8_t EvaluateReception(Ptr<LoraInterferenceHelper::Event> event, bool primary);
+
+    /**
+     * Fire the outcome of a signal under a hypothesis, and clear the chase
+     * combining state of its device under the hypothesis once done with it.
+     *
+     * \param packet The packet carried by the signal.
+     * \param hypothesis The index of the hypothesis.
+     * \param outcome The outcome.
+     */
+    void FireHypothesisOutcome(Ptr<const Packet> packet,
+                               uint32_t hypothesis,
+                               HypothesisOutcome outcome);
 };
 
 } // namespace lorawan
@@ -0,0 +1,365 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "trace-replay-sender.h"
+
+#include "lora-net-device.h"
+
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include <cctype>
+#include <cstdlib>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("TraceReplaySender");
+
+NS_OBJECT_ENSURE_REGISTERED(TraceReplaySender);
+
+/// The size of a record of a binary trace, in bytes
+static const size_t BINARY_RECORD_SIZE = 15;
+
+TypeId
+TraceReplaySender::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TraceReplaySender")
+            .SetParent<Object>()
+            .SetGroupName("lorawan")
+            .AddConstructor<TraceReplaySender>()
+            .AddAttribute("TraceFile",
+                          "The path of the trace file",
+                          StringValue(""),
+                          MakeStringAccessor(&TraceReplaySender::m_traceFile),
+                          MakeStringChecker())
+            .AddAttribute("Format",
+                          "The format of the trace file",
+                          EnumValue(TraceReplaySender::CSV),
+                          MakeEnumAccessor<Format>(&TraceReplaySender::m_format),
+                          MakeEnumChecker(TraceReplaySender::CSV,
+                                          "Csv",
+                                          TraceReplaySender::BINARY,
+                                          "Binary"))
+            .AddAttribute("WindowSize",
+                          "The number of upcoming records kept in memory",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&TraceReplaySender::m_windowSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BufferSize",
+                          "The size of the read buffer of the trace file, in bytes",
+                          UintegerValue(1 << 20),
+                          MakeUintegerAccessor(&TraceReplaySender::m_bufferSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("RebaseTimestamps",
+                          "Whether to send the first record at the start of the replay. "
+                          "Otherwise, timestamps are relative to the start of the replay.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&TraceReplaySender::m_rebaseTimestamps),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TraceReplaySender::TraceReplaySender()
+    : m_endOfFile(true),
+      m_firstRecord(true),
+      m_timeBase(0),
+      m_nSentPackets(0),
+      m_nMalformedRecords(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TraceReplaySender::~TraceReplaySender()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+TraceReplaySender::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    Simulator::Cancel(m_nextRecord);
+    Simulator::Cancel(m_startEvent);
+    Simulator::Cancel(m_stopEvent);
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    m_window.clear();
+    m_macs.clear();
+
+    Object::DoDispose();
+}
+
+void
+TraceReplaySender::AddDevices(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto node = nodes.Begin(); node != nodes.End(); node++)
+    {
+        // Assumes there's only one device, like the sender applications
+        Ptr<LoraNetDevice> loraNetDevice = (*node)->GetDevice(0)->GetObject<LoraNetDevice>();
+        NS_ASSERT(loraNetDevice);
+        Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(loraNetDevice->GetMac());
+        NS_ASSERT(mac);
+        m_macs.push_back(mac);
+    }
+}
+
+void
+TraceReplaySender::Start(Time start)
+{
+    NS_LOG_FUNCTION(this << start);
+
+    Simulator::Cancel(m_startEvent);
+    m_startEvent = Simulator::Schedule(start, &TraceReplaySender::DoStart, this);
+}
+
+void
+TraceReplaySender::Stop(Time stop)
+{
+    NS_LOG_FUNCTION(this << stop);
+
+    Simulator::Cancel(m_stopEvent);
+    m_stopEvent = Simulator::Schedule(stop, &TraceReplaySender::DoStop, this);
+}
+
+uint64_t
+TraceReplaySender::GetNSentPackets() const
+{
+    return m_nSentPackets;
+}
+
+uint64_t
+TraceReplaySender::GetNMalformedRecords() const
+{
+    return m_nMalformedRecords;
+}
+
+void
+TraceReplaySender::DoStart()
+{
+    NS_LOG_FUNCTION(this);
+
+    NS_ABORT_MSG_IF(m_macs.empty(), "No device to replay the trace on.");
+
+    DoStop();
+
+    // The buffer must be installed before the file is opened
+    m_buffer.resize(m_bufferSize);
+    m_file.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+    std::ios_base::openmode mode = std::ios_base::in;
+    if (m_format == BINARY)
+    {
+        mode |= std::ios_base::binary;
+    }
+    m_file.open(m_traceFile, mode);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Cannot open trace file " << m_traceFile);
+
+    m_endOfFile = false;
+    m_firstRecord = true;
+    m_startTime = Simulator::Now();
+
+    Refill();
+    ScheduleNextRecord();
+}
+
+void
+TraceReplaySender::DoStop()
+{
+    NS_LOG_FUNCTION(this);
+
+    Simulator::Cancel(m_nextRecord);
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    m_window.clear();
+    m_endOfFile = true;
+}
+
+bool
+TraceReplaySender::ReadRecord(Record& record)
+{
+    uint32_t deviceId = 0;
+    double timestamp = 0;
+    unsigned long size = 0;
+    bool confirmed = false;
+
+    if (m_format == BINARY)
+    {
+        unsigned char bytes[BINARY_RECORD_SIZE];
+        if (!m_file.read(reinterpret_cast<char*>(bytes), BINARY_RECORD_SIZE))
+        {
+            if (m_file.gcount() > 0)
+            {
+                NS_LOG_WARN("Truncated record at the end of " << m_traceFile);
+                m_nMalformedRecords++;
+            }
+            return false;
+        }
+
+        uint64_t timestampUs = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            deviceId |= uint32_t(bytes[i]) << (8 * i);
+        }
+        for (int i = 0; i < 8; i++)
+        {
+            timestampUs |= uint64_t(bytes[4 + i]) << (8 * i);
+        }
+        size = bytes[12] | (bytes[13] << 8);
+        confirmed = bytes[14] != 0;
+        timestamp = timestampUs / 1e6;
+    }
+    else
+    {
+        std::string line;
+        while (true)
+        {
+            if (!std::getline(m_file, line))
+            {
+                return false;
+            }
+            if (line.empty() || line[0] == '#' || line[0] == '\r')
+            {
+                continue;
+            }
+
+            const char* cursor = line.c_str();
+            char* end;
+            deviceId = std::strtoul(cursor, &end, 10);
+            bool valid = (end != cursor && *end == ',');
+            if (valid)
+            {
+                cursor = end + 1;
+                timestamp = std::strtod(cursor, &end);
+                valid = (end != cursor && *end == ',');
+            }
+            if (valid)
+            {
+                cursor = end + 1;
+                size = std::strtoul(cursor, &end, 10);
+                valid = (end != cursor && *end == ',');
+            }
+            if (valid)
+            {
+                cursor = end + 1;
+                confirmed = std::strtoul(cursor, &end, 10) != 0;
+                valid = (end != cursor);
+                // Nothing but blanks after the last field, e.g., the carriage
+                // return of CRLF line endings: no trailing garbage or columns
+                while (std::isspace(static_cast<unsigned char>(*end)))
+                {
+                    end++;
+                }
+                valid = valid && *end == '\0';
+            }
+
+            if (valid && size <= UINT16_MAX)
+            {
+                break;
+            }
+
+            // The first line may be a header
+            if (m_firstRecord && !std::isdigit(static_cast<unsigned char>(line[0])))
+            {
+                NS_LOG_DEBUG("Skipping header: " << line);
+                continue;
+            }
+            NS_LOG_WARN("Skipping malformed record: " << line);
+            m_nMalformedRecords++;
+        }
+    }
+
+    if (m_firstRecord)
+    {
+        m_timeBase = m_rebaseTimestamps ? timestamp : 0;
+        m_firstRecord = false;
+    }
+
+    record.ts = (m_startTime + Seconds(timestamp - m_timeBase)).GetTimeStep();
+    record.device = deviceId % m_macs.size();
+    record.size = static_cast<uint16_t>(size);
+    record.confirmed = confirmed;
+    return true;
+}
+
+void
+TraceReplaySender::Refill()
+{
+    NS_LOG_FUNCTION(this);
+
+    Record record;
+    while (!m_endOfFile && m_window.size() < m_windowSize)
+    {
+        if (ReadRecord(record))
+        {
+            m_window.push_back(record);
+        }
+        else
+        {
+            NS_LOG_DEBUG("Reached the end of " << m_traceFile);
+            m_endOfFile = true;
+            m_file.close();
+        }
+    }
+}
+
+void
+TraceReplaySender::SendDueRecords()
+{
+    NS_LOG_FUNCTION(this);
+
+    int64_t now = Simulator::Now().GetTimeStep();
+    while (!m_window.empty() && m_window.front().ts <= now)
+    {
+        const Record& record = m_window.front();
+        Ptr<EndDeviceLorawanMac> mac = m_macs[record.device];
+        mac->SetMType(record.confirmed ? LorawanMacHeader::CONFIRMED_DATA_UP
+                                       : LorawanMacHeader::UNCONFIRMED_DATA_UP);
+        mac->Send(Create<Packet>(record.size));
+        m_nSentPackets++;
+        m_window.pop_front();
+
+        // Read ahead only once half of the window was consumed
+        if (m_window.size() < m_windowSize / 2)
+        {
+            Refill();
+        }
+    }
+
+    ScheduleNextRecord();
+}
+
+void
+TraceReplaySender::ScheduleNextRecord()
+{
+    if (m_window.empty())
+    {
+        return;
+    }
+
+    Time next = TimeStep(m_window.front().ts);
+    if (next < Simulator::Now())
+    {
+        NS_LOG_WARN("Record out of order in " << m_traceFile << ": sending it now.");
+        next = Simulator::Now();
+    }
+    m_nextRecord =
+        Simulator::Schedule(next - Simulator::Now(), &TraceReplaySender::SendDueRecords, this);
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,182 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef TRACE_REPLAY_SENDER_H
+#define TRACE_REPLAY_SENDER_H
+
+#include "end-device-lorawan-mac.h"
+
+#include "ns3/event-id.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Replay a log of uplinks against a simulated topology.
+ *
+ * Each record of the trace holds a device id, a timestamp, a payload size and
+ * a confirmed flag. The uplink is sent through EndDeviceLorawanMac::Send of the
+ * simulated device with index (device id modulo the number of devices), with
+ * the message type set according to the confirmed flag.
+ *
+ * Two formats are supported:
+ *
+ * - CSV: one "deviceId,timestamp,size,confirmed" record per line, with the
+ *   timestamp in seconds (possibly fractional) and confirmed being 0 or 1.
+ *   Empty lines, lines starting with '#' and a header line are ignored;
+ *   records with other characters than blanks after the last field are
+ *   skipped as malformed.
+ * - Binary: packed little endian records of 15 bytes: a uint32 device id, a
+ *   uint64 timestamp in microseconds, a uint16 size and a uint8 confirmed flag.
+ *
+ * Records must be sorted by timestamp. The file is read through a buffer of
+ * fixed size, and only a window of upcoming records is kept in memory, so
+ * traces of any length can be replayed with bounded memory. A single simulator
+ * event is pending at any time, at the timestamp of the next record.
+ */
+class TraceReplaySender : public Object
+{
+  public:
+    /**
+     * The format of the trace file.
+     */
+    enum Format
+    {
+        CSV,
+        BINARY
+    };
+
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    TraceReplaySender();           //!< Default constructor
+    ~TraceReplaySender() override; //!< Destructor
+
+    /**
+     * Add the end devices the trace is replayed on.
+     *
+     * \param nodes The end device nodes, each with a LoraNetDevice as its
+     * first device.
+     */
+    void AddDevices(NodeContainer nodes);
+
+    /**
+     * Start replaying the trace.
+     *
+     * \param start The delay after which the replay starts.
+     */
+    void Start(Time start);
+
+    /**
+     * Stop replaying the trace.
+     *
+     * \param stop The delay after which the replay stops.
+     */
+    void Stop(Time stop);
+
+    /**
+     * Get the number of uplinks sent so far.
+     *
+     * \return The number of uplinks.
+     */
+    uint64_t GetNSentPackets() const;
+
+    /**
+     * Get the number of records of the trace that could not be parsed.
+     *
+     * \return The number of malformed records.
+     */
+    uint64_t GetNMalformedRecords() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * A record of the trace.
+     */
+    struct Record
+    {
+        int64_t ts;      //!< The simulation time of the uplink, in time steps
+        uint32_t device; //!< The index of the device
+        uint16_t size;   //!< The payload size, in bytes
+        bool confirmed;  //!< Whether the uplink is confirmed
+    };
+
+    /**
+     * Open the trace file and schedule the first record.
+     */
+    void DoStart();
+
+    /**
+     * Stop the replay and close the trace file.
+     */
+    void DoStop();
+
+    /**
+     * Read the next record of the trace file.
+     *
+     * \param record The record to fill.
+     * \return False at the end of the file.
+     */
+    bool ReadRecord(Record& record);
+
+    /**
+     * Read records until the window is full or the file ends.
+     */
+    void Refill();
+
+    /**
+     * Send the uplinks of all the records due now, and schedule the next one.
+     */
+    void SendDueRecords();
+
+    /**
+     * Schedule the event of the next record in the window, if any.
+     */
+    void ScheduleNextRecord();
+
+    std::string m_traceFile; //!< The path of the trace file
+    Format m_format;         //!< The format of the trace file
+    uint32_t m_windowSize;   //!< The number of upcoming records kept in memory
+    uint32_t m_bufferSize;   //!< The size of the read buffer, in bytes
+    bool m_rebaseTimestamps; //!< Whether the first record is sent at the start of the replay
+
+    std::vector<Ptr<EndDeviceLorawanMac>> m_macs; //!< The MAC layer of each device
+
+    std::ifstream m_file;        //!< The trace file
+    std::vector<char> m_buffer;  //!< The read buffer of the file
+    std::deque<Record> m_window; //!< The upcoming records
+    bool m_endOfFile;            //!< Whether the whole file was read
+    bool m_firstRecord;          //!< Whether the next record read is the first one
+    double m_timeBase;           //!< The trace timestamp mapped to the start, in seconds
+    Time m_startTime;            //!< The time the replay started
+
+    EventId m_nextRecord; //!< The event of the next record
+    EventId m_startEvent; //!< The event starting the replay
+    EventId m_stopEvent;  //!< The event stopping the replay
+
+    uint64_t m_nSentPackets;      //!< The number of uplinks sent
+    uint64_t m_nMalformedRecords; //!< The number of records that could not be parsed
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* TRACE_REPLAY_SENDER_H */
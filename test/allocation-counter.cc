@@ -0,0 +1,142 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "allocation-counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+std::atomic<uint64_t> g_allocations{0}; //!< The allocations of the process
+std::atomic<uint64_t> g_bytes{0};       //!< The bytes allocated by the process
+
+/**
+ * Count an allocation and perform it.
+ *
+ * \param size The size of the allocation.
+ * \return The allocated memory, or nullptr on failure.
+ */
+void*
+CountedAlloc(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+} // namespace
+
+/////////////////////////////////////////////
+// Replacements of operator new and delete //
+/////////////////////////////////////////////
+
+void*
+operator new(std::size_t size)
+{
+    void* ptr = CountedAlloc(size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void*
+operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void*
+operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace ns3
+{
+namespace lorawan
+{
+
+AllocationCounter::AllocationCounter()
+{
+    Start();
+}
+
+void
+AllocationCounter::Start()
+{
+    m_running = true;
+    m_allocations = 0;
+    m_bytes = 0;
+    m_startAllocations = g_allocations.load(std::memory_order_relaxed);
+    m_startBytes = g_bytes.load(std::memory_order_relaxed);
+}
+
+void
+AllocationCounter::Stop()
+{
+    if (m_running)
+    {
+        m_allocations = GetAllocations();
+        m_bytes = GetBytes();
+        m_running = false;
+    }
+}
+
+uint64_t
+AllocationCounter::GetAllocations() const
+{
+    if (!m_running)
+    {
+        return m_allocations;
+    }
+    return g_allocations.load(std::memory_order_relaxed) - m_startAllocations;
+}
+
+uint64_t
+AllocationCounter::GetBytes() const
+{
+    if (!m_running)
+    {
+        return m_bytes;
+    }
+    return g_bytes.load(std::memory_order_relaxed) - m_startBytes;
+}
+
+} // namespace lorawan
+} // namespace ns3
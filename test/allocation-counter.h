@@ -0,0 +1,73 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * \ingroup lorawan
+ *
+ * Count the heap allocations made through the global operator new while it is
+ * running.
+ *
+ * The counts come from replacements of the global operator new and delete,
+ * defined in allocation-counter.cc: that file replaces them for the whole
+ * process, so it is only linked in the dedicated lorawan-allocation-test
+ * binary, and never in the library or the test-runner. Allocations made
+ * directly through malloc (e.g., by the packet tag lists) are not counted.
+ *
+ * A counter starts when it is constructed, so that it counts the allocations
+ * of its scope, and can be restarted and stopped to count those of a part of
+ * a simulation. The counts are global, so they include the allocations of all
+ * the threads.
+ */
+class AllocationCounter
+{
+  public:
+    AllocationCounter(); //!< Default constructor, starting the counter
+
+    /**
+     * Reset the counts and start counting.
+     */
+    void Start();
+
+    /**
+     * Stop counting, keeping the counts so far.
+     */
+    void Stop();
+
+    /**
+     * Get the number of allocations counted.
+     *
+     * \return The number of allocations since the counter was started, up to
+     * now or to when it was stopped.
+     */
+    uint64_t GetAllocations() const;
+
+    /**
+     * Get the number of bytes allocated.
+     *
+     * \return The bytes requested by the allocations counted.
+     */
+    uint64_t GetBytes() const;
+
+  private:
+    bool m_running;              //!< Whether the counter is running
+    uint64_t m_startAllocations; //!< The global allocations when the counter started
+    uint64_t m_startBytes;       //!< The global bytes when the counter started
+    uint64_t m_allocations;      //!< The allocations counted when the counter stopped
+    uint64_t m_bytes;            //!< The bytes counted when the counter stopped
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* ALLOCATION_COUNTER_H */
@@ -12,9 +12,12 @@ cpp_examples = [
     ("complete-network-example --realisticChannel", "True", "True"),
     ("adr-example", "True", "True"),
     ("lorawan-energy-model-example", "True", "True"),
+    ("lorawan-lifetime-projection-example --nDevices=20", "True", "True"),
     ("aloha-throughput", "True", "True"),
     ("parallel-reception-example", "True", "True"),
     ("frame-counter-update", "True", "True"),
+    ("multicast-campaign-example --nDevices=20", "True", "True"),
+    ("class-b-downlink-example --nDevices=20", "True", "True"),
 ]
 
 # A list of Python examples to run in order to ensure that they remain
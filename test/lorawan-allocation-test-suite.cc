@@ -0,0 +1,655 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This file includes testing of the heap allocations made by an uplink in
+ * each layer:
+ * - PHY send
+ * - LoraChannel fan-out
+ * - Gateway receive
+ * - NetworkServer processing
+ * and of the steady-state sends of the sender applications.
+ *
+ * It is built in the dedicated lorawan-allocation-test binary, together with
+ * the replacement of operator new of allocation-counter.cc.
+ */
+
+// Include headers of classes to test
+#include "allocation-counter.h"
+#include "utilities.h"
+
+#include "ns3/core-module.h"
+#include "ns3/log.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/network-server.h"
+#include "ns3/one-shot-sender-helper.h"
+#include "ns3/one-shot-sender.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/periodic-sender.h"
+#include "ns3/random-sender-helper.h"
+#include "ns3/random-sender.h"
+#include "ns3/system-path.h"
+
+// An essential include is test.h
+#include "ns3/test.h"
+
+#include <fstream>
+#include <functional>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanAllocationTestSuite");
+
+// The allocations of an uplink in steady state are measured per layer, and
+// recorded in test/golden with the --update-data option of the test-runner.
+// The ceiling of a layer is its recorded count plus this headroom, which
+// absorbs the small differences between ns-3 versions and build profiles:
+// record the counts again when a layer gets cheaper.
+static const uint64_t ALLOCATION_HEADROOM = 4; //!< Allocations over the recorded count
+
+/**
+ * Get the PHY layer of a node.
+ *
+ * \param node The node, with a LoraNetDevice as its first device.
+ * \return The PHY layer.
+ */
+static Ptr<LoraPhy>
+GetPhyFromNode(Ptr<Node> node)
+{
+    return node->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * A test case checking the allocations of a layer against the count recorded
+ * for it
+ */
+class AllocationTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param name The description of the test case.
+     */
+    AllocationTestCase(std::string name);
+
+  protected:
+    /**
+     * Check the allocations of a layer against its ceiling, i.e., its recorded
+     * count plus the headroom.
+     *
+     * \param layer The name of the layer, and of its file of recorded counts.
+     * \param allocations The allocations measured for the layer.
+     */
+    void CheckAllocations(std::string layer, uint64_t allocations);
+};
+
+AllocationTestCase::AllocationTestCase(std::string name)
+    : TestCase(name)
+{
+    SetDataDir(std::string(NS_TEST_SOURCEDIR) + "/golden");
+}
+
+void
+AllocationTestCase::CheckAllocations(std::string layer, uint64_t allocations)
+{
+    // Write the count where the test-runner keeps its temporary files, or
+    // over the recorded count with --update-data
+    std::string filename = "lorawan-allocation-" + layer + ".txt";
+    std::string outputFilename = CreateTempDirFilename(filename);
+    SystemPath::MakeDirectories(SystemPath::Dirname(outputFilename));
+    std::ofstream output(outputFilename);
+    output << allocations << std::endl;
+    output.close();
+
+    std::string recordedFilename = CreateDataDirFilename(filename);
+    std::ifstream recorded(recordedFilename);
+    uint64_t recordedAllocations = 0;
+    NS_TEST_ASSERT_MSG_EQ(bool(recorded >> recordedAllocations),
+                          true,
+                          "No recorded allocations in " << recordedFilename
+                                                        << ", record them with --update-data");
+    if (allocations < recordedAllocations)
+    {
+        NS_LOG_INFO("The " << layer << " got cheaper than its " << recordedAllocations
+                           << " recorded allocations, record them with --update-data");
+    }
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(allocations,
+                                recordedAllocations + ALLOCATION_HEADROOM,
+                                "The " << layer << " exceeded its allocation ceiling");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It checks the allocations of the transmission of a packet by an end device
+ * PHY, on a channel without receivers
+ */
+class PhySendAllocationTest : public AllocationTestCase
+{
+  public:
+    PhySendAllocationTest();           //!< Default constructor
+    ~PhySendAllocationTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+PhySendAllocationTest::PhySendAllocationTest()
+    : AllocationTestCase("Check the allocations of an end device PHY send")
+{
+}
+
+// Reminder that the test case should clean up after itself
+PhySendAllocationTest::~PhySendAllocationTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+PhySendAllocationTest::DoRun()
+{
+    NS_LOG_DEBUG("PhySendAllocationTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(1, mobility, channel);
+    Ptr<LoraPhy> phy = GetPhyFromNode(endDevices.Get(0));
+
+    // The first send warms up, the count of the second one is kept
+    LoraTxParameters txParams;
+    AllocationCounter counter;
+    for (int i = 0; i < 2; i++)
+    {
+        Ptr<Packet> packet = Create<Packet>(20);
+        Simulator::Schedule(Seconds(10 * i), [&counter, phy, packet, txParams]() {
+            counter.Start();
+            phy->Send(packet, txParams, 868.1, 14);
+            counter.Stop();
+        });
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_LOG_INFO("PHY send: " << counter.GetAllocations() << " allocations, "
+                             << counter.GetBytes() << " bytes");
+    CheckAllocations("phy-send", counter.GetAllocations());
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It checks the allocations per receiver of the delivery of a packet by the
+ * LoraChannel to the PHY layers connected to it
+ */
+class ChannelFanOutAllocationTest : public AllocationTestCase
+{
+  public:
+    ChannelFanOutAllocationTest();           //!< Default constructor
+    ~ChannelFanOutAllocationTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+ChannelFanOutAllocationTest::ChannelFanOutAllocationTest()
+    : AllocationTestCase("Check the allocations per receiver of the channel fan-out")
+{
+}
+
+// Reminder that the test case should clean up after itself
+ChannelFanOutAllocationTest::~ChannelFanOutAllocationTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+ChannelFanOutAllocationTest::DoRun()
+{
+    NS_LOG_DEBUG("ChannelFanOutAllocationTest");
+
+    const uint32_t nReceivers = 16;
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(nReceivers + 1, mobility, channel);
+    Ptr<LoraPhy> sender = GetPhyFromNode(endDevices.Get(0));
+
+    // The first send warms up, the count of the second one is kept
+    LoraTxParameters txParams;
+    AllocationCounter counter;
+    for (int i = 0; i < 2; i++)
+    {
+        Ptr<Packet> packet = Create<Packet>(20);
+        Time duration = LoraPhy::GetOnAirTime(packet, txParams);
+        Simulator::Schedule(Seconds(10 * i),
+                            [&counter, channel, sender, packet, txParams, duration]() {
+                                counter.Start();
+                                channel->Send(sender, packet, 14, txParams, duration, 868.1);
+                                counter.Stop();
+                            });
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_LOG_INFO("Channel fan-out to " << nReceivers << " receivers: " << counter.GetAllocations()
+                                      << " allocations, " << counter.GetBytes() << " bytes");
+    CheckAllocations("channel-fan-out", counter.GetAllocations());
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It checks the allocations of the reception of an uplink by a gateway, from
+ * the start of the reception at its PHY layer to the delivery by its MAC layer
+ * to the net device
+ */
+class GatewayReceiveAllocationTest : public AllocationTestCase
+{
+  public:
+    GatewayReceiveAllocationTest();           //!< Default constructor
+    ~GatewayReceiveAllocationTest() override; //!< Destructor
+
+    /**
+     * Keep a copy of an uplink received by the gateway.
+     *
+     * \param packet The received packet.
+     * \param index The index of the receiver.
+     */
+    void ReceivedPacket(Ptr<const Packet> packet, uint32_t index);
+
+    /**
+     * Stand for the forwarder, receiving the packets from the gateway net
+     * device.
+     *
+     * \copydoc ns3::NetDevice::ReceiveCallback
+     */
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& address);
+
+  private:
+    void DoRun() override;
+
+    Ptr<Packet> m_uplink; //!< A copy of the uplink received by the gateway
+};
+
+// Add some help text to this case to describe what it is intended to test
+GatewayReceiveAllocationTest::GatewayReceiveAllocationTest()
+    : AllocationTestCase("Check the allocations of a gateway receive")
+{
+}
+
+// Reminder that the test case should clean up after itself
+GatewayReceiveAllocationTest::~GatewayReceiveAllocationTest()
+{
+}
+
+void
+GatewayReceiveAllocationTest::ReceivedPacket(Ptr<const Packet> packet, uint32_t index)
+{
+    m_uplink = packet->Copy();
+}
+
+bool
+GatewayReceiveAllocationTest::Receive(Ptr<NetDevice> device,
+                                      Ptr<const Packet> packet,
+                                      uint16_t protocol,
+                                      const Address& address)
+{
+    return true;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+GatewayReceiveAllocationTest::DoRun()
+{
+    NS_LOG_DEBUG("GatewayReceiveAllocationTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(1, mobility, channel);
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+    LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    // Without a forwarder, the packets end in this test
+    gateways.Get(0)->GetDevice(0)->SetReceiveCallback(
+        MakeCallback(&GatewayReceiveAllocationTest::Receive, this));
+    Ptr<LoraPhy> gatewayPhy = GetPhyFromNode(gateways.Get(0));
+    gatewayPhy->TraceConnectWithoutContext(
+        "ReceivedPacket",
+        MakeCallback(&GatewayReceiveAllocationTest::ReceivedPacket, this));
+
+    // Get an uplink with the headers of the MAC layer of a device
+    endDevices.Get(0)->GetDevice(0)->Send(Create<Packet>(20), Address(), 0);
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_NE(m_uplink, nullptr, "The gateway did not receive the uplink");
+    gatewayPhy->TraceDisconnectWithoutContext(
+        "ReceivedPacket",
+        MakeCallback(&GatewayReceiveAllocationTest::ReceivedPacket, this));
+
+    // Receive it again: the first reception warms up, the count of the second
+    // one is kept, up to the end of the simulation
+    LoraTxParameters txParams;
+    Time duration = LoraPhy::GetOnAirTime(m_uplink, txParams);
+    AllocationCounter counter;
+    for (int i = 0; i < 2; i++)
+    {
+        Ptr<Packet> packet = m_uplink->Copy();
+        Simulator::Schedule(Seconds(10 * i), [&counter, gatewayPhy, packet, duration]() {
+            counter.Start();
+            gatewayPhy->StartReceive(packet, -100, 7, duration, 868.1);
+        });
+    }
+    Simulator::Run();
+    counter.Stop();
+    Simulator::Destroy();
+
+    NS_LOG_INFO("Gateway receive: " << counter.GetAllocations() << " allocations, "
+                                    << counter.GetBytes() << " bytes");
+    CheckAllocations("gateway-receive", counter.GetAllocations());
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It checks the allocations of the processing of an unconfirmed uplink by the
+ * network server, from its reception to the end of the receive windows of the
+ * device
+ */
+class NetworkServerAllocationTest : public AllocationTestCase
+{
+  public:
+    NetworkServerAllocationTest();           //!< Default constructor
+    ~NetworkServerAllocationTest() override; //!< Destructor
+
+    /**
+     * Start counting the allocations at the reception of an uplink.
+     *
+     * \param packet The received packet.
+     */
+    void ReceivedPacket(Ptr<const Packet> packet);
+
+  private:
+    void DoRun() override;
+
+    AllocationCounter m_counter; //!< The counter of the allocations
+};
+
+// Add some help text to this case to describe what it is intended to test
+NetworkServerAllocationTest::NetworkServerAllocationTest()
+    : AllocationTestCase("Check the allocations of the network server processing")
+{
+}
+
+// Reminder that the test case should clean up after itself
+NetworkServerAllocationTest::~NetworkServerAllocationTest()
+{
+}
+
+void
+NetworkServerAllocationTest::ReceivedPacket(Ptr<const Packet> packet)
+{
+    m_counter.Start();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+NetworkServerAllocationTest::DoRun()
+{
+    NS_LOG_DEBUG("NetworkServerAllocationTest");
+
+    NetworkComponents components = InitializeNetwork(1, 1);
+    Ptr<Node> endDevice = components.endDevices.Get(0);
+    components.nsNode->GetApplication(0)->TraceConnectWithoutContext(
+        "ReceivedPacket",
+        MakeCallback(&NetworkServerAllocationTest::ReceivedPacket, this));
+
+    // The first uplink warms up, the count of the second one is kept, from
+    // its reception by the network server to the end of the simulation
+    for (int i = 0; i < 2; i++)
+    {
+        Simulator::Schedule(Seconds(10 * i), [endDevice]() {
+            endDevice->GetDevice(0)->Send(Create<Packet>(20), Address(), 0);
+        });
+    }
+    m_counter.Stop(); // Only count from the first reception
+    Simulator::Run();
+    m_counter.Stop();
+    Simulator::Destroy();
+
+    NS_LOG_INFO("Network server processing: " << m_counter.GetAllocations() << " allocations, "
+                                              << m_counter.GetBytes() << " bytes");
+    NS_TEST_EXPECT_MSG_GT(m_counter.GetAllocations(),
+                          0,
+                          "The network server did not receive the uplinks");
+    CheckAllocations("network-server-processing", m_counter.GetAllocations());
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * A MAC layer using the packets of the sender applications like the MAC layer
+ * of an end device: it adds the LoRaWAN headers, and keeps the last packet, as
+ * for its retransmissions, until the next one is sent
+ */
+class HoldingLorawanMac : public LorawanMac
+{
+  public:
+    void Send(Ptr<Packet> packet) override;
+    void Receive(Ptr<const Packet> packet) override;
+    void FailedReception(Ptr<const Packet> packet) override;
+    void TxFinished(Ptr<const Packet> packet) override;
+
+  private:
+    Ptr<Packet> m_lastPacket; //!< The last packet sent
+};
+
+void
+HoldingLorawanMac::Send(Ptr<Packet> packet)
+{
+    LoraFrameHeader frameHdr;
+    frameHdr.SetAsUplink();
+    packet->AddHeader(frameHdr);
+    packet->AddHeader(LorawanMacHeader());
+    m_lastPacket = packet;
+}
+
+void
+HoldingLorawanMac::Receive(Ptr<const Packet> packet)
+{
+}
+
+void
+HoldingLorawanMac::FailedReception(Ptr<const Packet> packet)
+{
+}
+
+void
+HoldingLorawanMac::TxFinished(Ptr<const Packet> packet)
+{
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It checks that the steady-state sends of the PeriodicSender, RandomSender
+ * and OneShotSender applications, with the packet pool of their helper, don't
+ * allocate: the only allocations of a send are those of the scheduling of the
+ * next one
+ */
+class SenderAllocationTest : public TestCase
+{
+  public:
+    SenderAllocationTest();           //!< Default constructor
+    ~SenderAllocationTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Create a node whose LoraNetDevice has a HoldingLorawanMac.
+     *
+     * \return The node.
+     */
+    static Ptr<Node> CreateSenderNode();
+
+    /**
+     * Count the allocations of some steady-state sends of an application.
+     *
+     * \param send The send of the application.
+     * \return The allocations of the sends.
+     */
+    static uint64_t CountSendAllocations(std::function<void()> send);
+
+    static const int N_SENDS = 100; //!< The sends counted
+};
+
+// Add some help text to this case to describe what it is intended to test
+SenderAllocationTest::SenderAllocationTest()
+    : TestCase("Check that the steady-state sends of the sender applications don't allocate")
+{
+}
+
+// Reminder that the test case should clean up after itself
+SenderAllocationTest::~SenderAllocationTest()
+{
+}
+
+Ptr<Node>
+SenderAllocationTest::CreateSenderNode()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<LoraNetDevice> device = CreateObject<LoraNetDevice>();
+    Ptr<LorawanMac> mac = CreateObject<HoldingLorawanMac>();
+    mac->SetDevice(device);
+    device->SetMac(mac);
+    node->AddDevice(device);
+    return node;
+}
+
+uint64_t
+SenderAllocationTest::CountSendAllocations(std::function<void()> send)
+{
+    // The first sends warm up the pool, the Buffer free list and the headroom
+    // of the buffers for the headers
+    for (int i = 0; i < 10; i++)
+    {
+        send();
+    }
+    AllocationCounter counter;
+    for (int i = 0; i < N_SENDS; i++)
+    {
+        send();
+    }
+    counter.Stop();
+    return counter.GetAllocations();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+SenderAllocationTest::DoRun()
+{
+    NS_LOG_DEBUG("SenderAllocationTest");
+
+    // The sends are called directly, without running the simulation, so the
+    // events the periodic and random senders schedule for their next send
+    // pile up: their allocations are measured on their own
+    PeriodicSenderHelper periodicHelper;
+    periodicHelper.SetPeriod(Seconds(600));
+    Ptr<PeriodicSender> periodic =
+        DynamicCast<PeriodicSender>(periodicHelper.Install(CreateSenderNode()).Get(0));
+    periodic->StartApplication();
+    uint64_t periodicAllocations = CountSendAllocations([periodic]() { periodic->SendPacket(); });
+    uint64_t periodicScheduleAllocations = CountSendAllocations([periodic]() {
+        Simulator::Schedule(Seconds(600), &PeriodicSender::SendPacket, periodic);
+    });
+    NS_LOG_INFO("PeriodicSender: " << periodicAllocations << " allocations in " << N_SENDS
+                                   << " sends, " << periodicScheduleAllocations
+                                   << " to schedule them");
+    NS_TEST_EXPECT_MSG_EQ(periodicAllocations,
+                          periodicScheduleAllocations,
+                          "The sends of a PeriodicSender allocate");
+
+    RandomSenderHelper randomHelper;
+    Ptr<RandomSender> random =
+        DynamicCast<RandomSender>(randomHelper.Install(CreateSenderNode()).Get(0));
+    random->StartApplication();
+    uint64_t randomAllocations = CountSendAllocations([random]() { random->SendPacket(); });
+    uint64_t randomScheduleAllocations = CountSendAllocations([random]() {
+        Simulator::Schedule(Seconds(10), &RandomSender::SendPacket, random);
+    });
+    NS_LOG_INFO("RandomSender: " << randomAllocations << " allocations in " << N_SENDS
+                                 << " sends, " << randomScheduleAllocations
+                                 << " to schedule them");
+    NS_TEST_EXPECT_MSG_EQ(randomAllocations,
+                          randomScheduleAllocations,
+                          "The sends of a RandomSender allocate");
+
+    // One-shot senders don't schedule anything when sending
+    OneShotSenderHelper oneShotHelper;
+    Ptr<OneShotSender> oneShot =
+        DynamicCast<OneShotSender>(oneShotHelper.Install(CreateSenderNode()).Get(0));
+    oneShot->StartApplication();
+    uint64_t oneShotAllocations = CountSendAllocations([oneShot]() { oneShot->SendPacket(); });
+    NS_LOG_INFO("OneShotSender: " << oneShotAllocations << " allocations in " << N_SENDS
+                                  << " sends");
+    NS_TEST_EXPECT_MSG_EQ(oneShotAllocations, 0, "The sends of a OneShotSender allocate");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * The TestSuite class names the TestSuite, identifies what type of TestSuite, and enables the
+ * TestCases to be run. Typically, only the constructor for this class must be defined
+ */
+class LorawanAllocationTestSuite : public TestSuite
+{
+  public:
+    LorawanAllocationTestSuite(); //!< Default constructor
+};
+
+LorawanAllocationTestSuite::LorawanAllocationTestSuite()
+    : TestSuite("lorawan-allocation", Type::UNIT)
+{
+    LogComponentEnable("LorawanAllocationTestSuite", LOG_LEVEL_INFO);
+
+    // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+    AddTestCase(new SenderAllocationTest, Duration::QUICK);
+#ifdef LORAWAN_ALLOCATION_GOLDENS
+    // The ceilings of the layers are only checked once their counts are
+    // recorded in test/golden, see LORAWAN_RECORD_GOLDENS
+    AddTestCase(new PhySendAllocationTest, Duration::QUICK);
+    AddTestCase(new ChannelFanOutAllocationTest, Duration::QUICK);
+    AddTestCase(new GatewayReceiveAllocationTest, Duration::QUICK);
+    AddTestCase(new NetworkServerAllocationTest, Duration::QUICK);
+#endif
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static LorawanAllocationTestSuite lorawanAllocationTestSuite;
+
+int
+main(int argc, char* argv[])
+{
+    return TestRunner::Run(argc, argv);
+}
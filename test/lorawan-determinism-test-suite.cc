@@ -0,0 +1,406 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This file includes regression testing of the outcomes of reference
+ * scenarios with fixed seeds, against golden records kept in test/golden.
+ *
+ * Each record is a line with the time [time steps], the sender node, the
+ * frame counter, the receiver node and the outcome of a packet: R(eceived),
+ * I(nterfered), S(under sensitivity), D(no more demodulators) or T(gateway
+ * transmitting) at the gateways, A for a downlink received by a device, and
+ * the number of transmissions and the success of the retransmission
+ * procedure of the devices. The golden files are regenerated by running the
+ * suite with the --update-data option of the test-runner. The suite is only
+ * built once test/golden holds its records, or with LORAWAN_RECORD_GOLDENS.
+ */
+
+// Include headers of classes to test
+#include "utilities.h"
+
+#include "ns3/core-module.h"
+#include "ns3/correlated-shadowing-propagation-loss-model.h"
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/log.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-tag.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/system-path.h"
+
+// An essential include is test.h
+#include "ns3/test.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanDeterminismTestSuite");
+
+/**
+ * \ingroup lorawan
+ *
+ * The configuration of a reference scenario
+ */
+struct DeterminismScenario
+{
+    std::string name;   //!< The name of the scenario, and of its golden file
+    uint32_t nDevices;  //!< The number of end devices
+    uint32_t nGateways; //!< The number of gateways
+    double radius;      //!< The radius of the area of the nodes [m]
+    Time period;        //!< The period of the uplinks
+    Time duration;      //!< The simulated time
+    bool adr;           //!< Whether ADR is enabled
+    bool confirmed;     //!< Whether the uplinks are confirmed
+    bool shadowing;     //!< Whether the channel has correlated shadowing
+};
+
+/**
+ * \ingroup lorawan
+ *
+ * It runs a reference scenario twice with fixed seeds, checks that the
+ * per-packet outcomes are the same in both runs, and compares them with the
+ * golden records of the scenario
+ */
+class DeterminismTest : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param scenario The scenario.
+     */
+    DeterminismTest(DeterminismScenario scenario);
+    ~DeterminismTest() override; //!< Destructor
+
+    /**
+     * Record the outcome of an uplink at a gateway.
+     *
+     * \param outcome The letter of the outcome.
+     * \param packet The packet.
+     * \param gatewayId The node id of the gateway.
+     */
+    void GatewayOutcome(char outcome, Ptr<const Packet> packet, uint32_t gatewayId);
+
+    /**
+     * Record a downlink received by a device.
+     *
+     * \param packet The packet.
+     * \param nodeId The node id of the device.
+     */
+    void DownlinkReceived(Ptr<const Packet> packet, uint32_t nodeId);
+
+    /**
+     * Record the end of the retransmission procedure of a device.
+     *
+     * \param nodeId The node id of the device.
+     * \param transmissions The number of transmissions.
+     * \param sf The spreading factor of the last transmission.
+     * \param success Whether the procedure was successful.
+     * \param firstAttempt The time of the first transmission.
+     * \param packet The packet.
+     */
+    void TransmissionsDone(uint32_t nodeId,
+                           uint8_t transmissions,
+                           uint8_t sf,
+                           bool success,
+                           Time firstAttempt,
+                           Ptr<Packet> packet);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Run the scenario from a clean state.
+     *
+     * \return The records of the outcomes, in order.
+     */
+    std::vector<std::string> RunScenario();
+
+    /**
+     * Compute the 64 bit FNV-1a hash of some records.
+     *
+     * \param records The records.
+     * \return The digest.
+     */
+    static uint64_t Digest(const std::vector<std::string>& records);
+
+    DeterminismScenario m_scenario;    //!< The scenario
+    std::vector<std::string> m_records; //!< The records of the current run
+};
+
+// Add some help text to this case to describe what it is intended to test
+DeterminismTest::DeterminismTest(DeterminismScenario scenario)
+    : TestCase("Check the outcomes of the " + scenario.name + " scenario against the goldens"),
+      m_scenario(scenario)
+{
+    SetDataDir(std::string(NS_TEST_SOURCEDIR) + "/golden");
+}
+
+// Reminder that the test case should clean up after itself
+DeterminismTest::~DeterminismTest()
+{
+}
+
+void
+DeterminismTest::GatewayOutcome(char outcome, Ptr<const Packet> packet, uint32_t gatewayId)
+{
+    Ptr<Packet> copy = packet->Copy();
+    LoraTag tag;
+    copy->PeekPacketTag(tag);
+    LorawanMacHeader mHdr;
+    LoraFrameHeader fHdr;
+    fHdr.SetAsUplink();
+    copy->RemoveHeader(mHdr);
+    copy->RemoveHeader(fHdr);
+
+    std::ostringstream record;
+    record << Simulator::Now().GetTimeStep() << " " << tag.GetNodeId() << " " << fHdr.GetFCnt()
+           << " " << gatewayId << " " << outcome;
+    m_records.push_back(record.str());
+}
+
+void
+DeterminismTest::DownlinkReceived(Ptr<const Packet> packet, uint32_t nodeId)
+{
+    Ptr<Packet> copy = packet->Copy();
+    LorawanMacHeader mHdr;
+    LoraFrameHeader fHdr;
+    fHdr.SetAsDownlink();
+    copy->RemoveHeader(mHdr);
+    copy->RemoveHeader(fHdr);
+
+    std::ostringstream record;
+    record << Simulator::Now().GetTimeStep() << " - " << fHdr.GetFCnt() << " " << nodeId << " A";
+    m_records.push_back(record.str());
+}
+
+void
+DeterminismTest::TransmissionsDone(uint32_t nodeId,
+                                   uint8_t transmissions,
+                                   uint8_t sf,
+                                   bool success,
+                                   Time firstAttempt,
+                                   Ptr<Packet> packet)
+{
+    std::ostringstream record;
+    record << Simulator::Now().GetTimeStep() << " " << nodeId << " " << unsigned(transmissions)
+           << " " << unsigned(sf) << " " << (success ? "ok" : "fail");
+    m_records.push_back(record.str());
+}
+
+std::vector<std::string>
+DeterminismTest::RunScenario()
+{
+    // Start from the same seed and the same automatic stream numbers, so that
+    // both runs of the process draw the same random values
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+    RngSeedManager::ResetNextStreamIndex();
+    m_records.clear();
+
+    // Channel
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    if (m_scenario.shadowing)
+    {
+        loss->SetNext(CreateObject<CorrelatedShadowingPropagationLossModel>());
+    }
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    // Nodes
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                  "rho",
+                                  DoubleValue(m_scenario.radius),
+                                  "X",
+                                  DoubleValue(0.0),
+                                  "Y",
+                                  DoubleValue(0.0));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(m_scenario.nDevices, mobility, channel);
+    NodeContainer gateways = CreateGateways(m_scenario.nGateways, mobility, channel);
+    LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    for (auto node = endDevices.Begin(); node != endDevices.End(); node++)
+    {
+        Ptr<EndDeviceLorawanMac> mac = GetMacLayerFromNode<EndDeviceLorawanMac>(*node);
+        if (m_scenario.confirmed)
+        {
+            mac->SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
+            mac->SetMaxNumberOfTransmissions(8);
+        }
+        if (m_scenario.adr)
+        {
+            mac->SetAttribute("DRControl", BooleanValue(true));
+        }
+        mac->TraceConnectWithoutContext(
+            "RequiredTransmissions",
+            MakeCallback(&DeterminismTest::TransmissionsDone, this).Bind((*node)->GetId()));
+        (*node)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy()->TraceConnectWithoutContext(
+            "ReceivedPacket",
+            MakeCallback(&DeterminismTest::DownlinkReceived, this));
+    }
+
+    const std::pair<std::string, char> outcomes[] = {
+        {"ReceivedPacket", 'R'},
+        {"LostPacketBecauseInterference", 'I'},
+        {"LostPacketBecauseUnderSensitivity", 'S'},
+        {"LostPacketBecauseNoMoreReceivers", 'D'},
+        {"NoReceptionBecauseTransmitting", 'T'}};
+    for (auto node = gateways.Begin(); node != gateways.End(); node++)
+    {
+        Ptr<LoraPhy> phy = (*node)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+        for (const auto& [traceSource, outcome] : outcomes)
+        {
+            phy->TraceConnectWithoutContext(
+                traceSource,
+                MakeCallback(&DeterminismTest::GatewayOutcome, this).Bind(outcome));
+        }
+    }
+
+    // Network server
+    Ptr<Node> nsNode = CreateObject<Node>();
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+    P2PGwRegistration_t gwRegistration;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+    {
+        auto container = p2p.Install(nsNode, *gw);
+        auto serverP2PNetDev = DynamicCast<PointToPointNetDevice>(container.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, *gw);
+    }
+    NetworkServerHelper networkServerHelper;
+    networkServerHelper.SetGatewaysP2P(gwRegistration);
+    networkServerHelper.SetEndDevices(endDevices);
+    networkServerHelper.EnableAdr(m_scenario.adr);
+    networkServerHelper.Install(nsNode);
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(gateways);
+
+    // Traffic
+    PeriodicSenderHelper appHelper;
+    appHelper.SetPeriod(m_scenario.period);
+    ApplicationContainer apps = appHelper.Install(endDevices);
+    apps.Start(Seconds(0));
+    apps.Stop(m_scenario.duration);
+
+    Simulator::Stop(m_scenario.duration + Seconds(100));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    return m_records;
+}
+
+uint64_t
+DeterminismTest::Digest(const std::vector<std::string>& records)
+{
+    uint64_t digest = 14695981039346656037ULL;
+    for (const auto& record : records)
+    {
+        for (char c : record + "\n")
+        {
+            digest ^= static_cast<unsigned char>(c);
+            digest *= 1099511628211ULL;
+        }
+    }
+    return digest;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+DeterminismTest::DoRun()
+{
+    NS_LOG_DEBUG("DeterminismTest " << m_scenario.name);
+
+    std::vector<std::string> records = RunScenario();
+    NS_TEST_ASSERT_MSG_GT(records.size(), 0, "The scenario produced no outcomes");
+    uint64_t digest = Digest(records);
+    NS_TEST_EXPECT_MSG_EQ(Digest(RunScenario()),
+                          digest,
+                          "Two runs of the scenario in the same process differ");
+
+    std::ostringstream digestLine;
+    digestLine << "digest " << std::hex << std::setw(16) << std::setfill('0') << digest
+               << std::dec << " records " << records.size();
+    NS_LOG_INFO(m_scenario.name << ": " << digestLine.str());
+
+    // Write the records where the test-runner keeps its temporary files, or
+    // over the golden file with --update-data
+    std::string filename = "lorawan-determinism-" + m_scenario.name + ".txt";
+    std::string outputFilename = CreateTempDirFilename(filename);
+    SystemPath::MakeDirectories(SystemPath::Dirname(outputFilename));
+    std::ofstream output(outputFilename);
+    for (const auto& record : records)
+    {
+        output << record << std::endl;
+    }
+    output << digestLine.str() << std::endl;
+    output.close();
+
+    // With --update-data, the golden file is the one just written
+    std::string goldenFilename = CreateDataDirFilename(filename);
+    std::ifstream golden(goldenFilename);
+    NS_TEST_ASSERT_MSG_EQ(golden.is_open(),
+                          true,
+                          "No golden records in " << goldenFilename
+                                                  << ", record them with --update-data");
+
+    // Report the first record that differs, rather than only the digest
+    std::string goldenRecord;
+    uint32_t i = 0;
+    while (std::getline(golden, goldenRecord) && i < records.size())
+    {
+        NS_TEST_ASSERT_MSG_EQ(records[i],
+                              goldenRecord,
+                              "Record " << i << " differs from the golden records");
+        i++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(i, records.size(), "There are fewer golden records than outcomes");
+    NS_TEST_EXPECT_MSG_EQ(goldenRecord, digestLine.str(), "The digests differ");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * The TestSuite class names the TestSuite, identifies what type of TestSuite, and enables the
+ * TestCases to be run. Typically, only the constructor for this class must be defined
+ */
+class LorawanDeterminismTestSuite : public TestSuite
+{
+  public:
+    LorawanDeterminismTestSuite(); //!< Default constructor
+};
+
+LorawanDeterminismTestSuite::LorawanDeterminismTestSuite()
+    : TestSuite("lorawan-determinism", Type::SYSTEM)
+{
+    LogComponentEnable("LorawanDeterminismTestSuite", LOG_LEVEL_INFO);
+
+    const Time hour = Hours(1);
+    const DeterminismScenario scenarios[] = {
+        // name, devices, gateways, radius, period, duration, ADR, confirmed, shadowing
+        {"single-gateway", 100, 1, 3000, Seconds(300), hour, false, false, false},
+        {"multi-gateway", 100, 4, 5000, Seconds(300), hour, false, false, false},
+        {"adr", 50, 2, 3000, Seconds(60), hour, true, false, false},
+        {"confirmed", 100, 1, 3000, Seconds(120), hour, false, true, false},
+        {"realistic-channel", 100, 2, 5000, Seconds(300), hour, false, false, true}};
+
+    // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+    for (const auto& scenario : scenarios)
+    {
+        AddTestCase(new DeterminismTest(scenario), Duration::QUICK);
+    }
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static LorawanDeterminismTestSuite lorawanDeterminismTestSuite;
@@ -0,0 +1,254 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This file includes testing of the LoraDistributedChannel across the MPI
+ * ranks of a distributed simulation.
+ *
+ * It is built in the dedicated lorawan-distributed-test binary, which enables
+ * MPI and the distributed simulator, and runs on two ranks, e.g.:
+ * mpiexec -n 2 lorawan-distributed-test --suite=lorawan-distributed
+ */
+
+// Include headers of classes to test
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/core-module.h"
+#include "ns3/log.h"
+#include "ns3/lora-distributed-helper.h"
+#include "ns3/lora-phy.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+
+// An essential include is test.h
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanDistributedTestSuite");
+
+/**
+ * \ingroup lorawan
+ *
+ * A PHY layer recording the receptions the channel starts, with their
+ * parameters.
+ */
+class RecordingLoraPhy : public LoraPhy
+{
+  public:
+    /**
+     * A reception started by the channel.
+     */
+    struct Reception
+    {
+        Time start;          //!< The time the reception started
+        double rxPowerDbm;   //!< The power of the reception
+        uint8_t sf;          //!< The spreading factor of the transmission
+        Time duration;       //!< The duration of the transmission
+        double frequencyMHz; //!< The frequency of the transmission [MHz]
+        uint32_t size;       //!< The size of the packet
+        bool tagged;         //!< Whether the packet still has the remote parameters
+    };
+
+    void StartReceive(Ptr<Packet> packet,
+                      double rxPowerDbm,
+                      uint8_t sf,
+                      Time duration,
+                      double frequencyMHz) override
+    {
+        LoraRemoteTransmissionTag tag;
+        m_receptions.push_back({Simulator::Now(),
+                                rxPowerDbm,
+                                sf,
+                                duration,
+                                frequencyMHz,
+                                packet->GetSize(),
+                                packet->PeekPacketTag(tag)});
+    }
+
+    void EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper::Event> event) override
+    {
+    }
+
+    void Send(Ptr<Packet> packet,
+              LoraTxParameters txParams,
+              double frequencyMHz,
+              double txPowerDbm) override
+    {
+    }
+
+    bool IsTransmitting() override
+    {
+        return false;
+    }
+
+    bool IsOnFrequency(double frequency) override
+    {
+        return true;
+    }
+
+    std::vector<Reception> m_receptions; //!< The receptions, in order
+
+  private:
+    void TxFinished(Ptr<const Packet> packet) override
+    {
+    }
+};
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that a transmission reaches the PHY layers of the other rank with
+ * the delay of the channel, bounded by the MinEventSeparation, and with its
+ * transmission parameters
+ */
+class RemoteTransmissionTest : public TestCase
+{
+  public:
+    RemoteTransmissionTest();           //!< Default constructor
+    ~RemoteTransmissionTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+RemoteTransmissionTest::RemoteTransmissionTest()
+    : TestCase("Verify the delay and the parameters of a transmission across ranks")
+{
+}
+
+// Reminder that the test case should clean up after itself
+RemoteTransmissionTest::~RemoteTransmissionTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+RemoteTransmissionTest::DoRun()
+{
+    NS_LOG_DEBUG("RemoteTransmissionTest");
+
+    NS_TEST_ASSERT_MSG_EQ(MpiInterface::GetSize(), 2, "The test runs on two ranks");
+    uint32_t systemId = MpiInterface::GetSystemId();
+
+    // Rank 0 holds x < 0, rank 1 x >= 0
+    LoraDistributedHelper distributedHelper;
+    distributedHelper.SetPartitioning(-1000, 1000);
+    distributedHelper.SetChannelAttribute("MinEventSeparation", TimeValue(MicroSeconds(1)));
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraDistributedChannel> channel = distributedHelper.CreateChannel(loss, delay);
+
+    // The sender and a receiver on rank 0; on rank 1 a receiver closer to
+    // the sender than the distance travelled in the separation (300 m), and
+    // one farther
+    Ptr<ConstantPositionMobilityModel> senderMobility =
+        CreateObject<ConstantPositionMobilityModel>();
+    senderMobility->SetPosition(Vector(-100, 0, 0));
+    const std::vector<Vector> positions =
+        systemId == 0 ? std::vector<Vector>{Vector(-300, 0, 0)}
+                      : std::vector<Vector>{Vector(100, 0, 0), Vector(1000, 0, 0)};
+    std::vector<Ptr<RecordingLoraPhy>> receivers;
+    std::vector<Ptr<MobilityModel>> mobilities;
+    for (const Vector& position : positions)
+    {
+        Ptr<ConstantPositionMobilityModel> mobility =
+            CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(position);
+        Ptr<RecordingLoraPhy> phy = CreateObject<RecordingLoraPhy>();
+        phy->SetMobility(mobility);
+        channel->Add(phy);
+        receivers.push_back(phy);
+        mobilities.push_back(mobility);
+    }
+
+    LoraTxParameters txParams;
+    txParams.sf = 9;
+    const double txPowerDbm = 14;
+    const double frequencyMHz = 868.3;
+    const Time start = Seconds(1);
+    Ptr<Packet> packet = Create<Packet>(20);
+    Time duration = LoraPhy::GetOnAirTime(packet, txParams);
+    if (systemId == 0)
+    {
+        Ptr<RecordingLoraPhy> sender = CreateObject<RecordingLoraPhy>();
+        sender->SetMobility(senderMobility);
+        channel->Add(sender);
+        Simulator::Schedule(start, [=]() {
+            channel->Send(sender, packet, txPowerDbm, txParams, duration, frequencyMHz);
+        });
+    }
+
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+
+    for (uint32_t i = 0; i < receivers.size(); i++)
+    {
+        const auto& receptions = receivers[i]->m_receptions;
+        NS_TEST_ASSERT_MSG_EQ(receptions.size(), 1, "Wrong number of receptions");
+        const RecordingLoraPhy::Reception& reception = receptions[0];
+
+        // The receptions of the other rank start the separation after the
+        // start of the transmission at the earliest
+        Time expectedDelay = delay->GetDelay(senderMobility, mobilities[i]);
+        if (systemId == 1)
+        {
+            expectedDelay = Max(expectedDelay, MicroSeconds(1));
+        }
+        NS_TEST_EXPECT_MSG_EQ(reception.start, start + expectedDelay, "Wrong reception time");
+        NS_TEST_EXPECT_MSG_EQ_TOL(reception.rxPowerDbm,
+                                  loss->CalcRxPower(txPowerDbm, senderMobility, mobilities[i]),
+                                  1e-9,
+                                  "Wrong reception power");
+        NS_TEST_EXPECT_MSG_EQ(unsigned(reception.sf), 9, "Wrong spreading factor");
+        NS_TEST_EXPECT_MSG_EQ(reception.duration, duration, "Wrong duration");
+        NS_TEST_EXPECT_MSG_EQ_TOL(reception.frequencyMHz,
+                                  frequencyMHz,
+                                  1e-9,
+                                  "Wrong frequency");
+        NS_TEST_EXPECT_MSG_EQ(reception.size, 20, "Wrong packet size");
+        NS_TEST_EXPECT_MSG_EQ(reception.tagged, false, "The remote parameters were not removed");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * The TestSuite class names the TestSuite, identifies what type of TestSuite, and enables the
+ * TestCases to be run. Typically, only the constructor for this class must be defined
+ */
+class LorawanDistributedTestSuite : public TestSuite
+{
+  public:
+    LorawanDistributedTestSuite(); //!< Default constructor
+};
+
+LorawanDistributedTestSuite::LorawanDistributedTestSuite()
+    : TestSuite("lorawan-distributed", Type::UNIT)
+{
+    // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+    AddTestCase(new RemoteTransmissionTest, Duration::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static LorawanDistributedTestSuite lorawanDistributedTestSuite;
+
+int
+main(int argc, char* argv[])
+{
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    MpiInterface::Enable(&argc, &argv);
+    int result = TestRunner::Run(argc, argv);
+    MpiInterface::Disable();
+    return result;
+}
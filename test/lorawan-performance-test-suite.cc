@@ -0,0 +1,301 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * This file includes performance testing of a standard network, scaled in
+ * number of devices and of gateways.
+ *
+ * The allocations per component are not counted here, since the test-runner
+ * cannot replace operator new: they are checked per uplink and per layer by
+ * the lorawan-allocation suite, in its own binary.
+ */
+
+// Include headers of classes to test
+#include "utilities.h"
+
+#include "ns3/core-module.h"
+#include "ns3/end-device-lorawan-mac.h"
+#include "ns3/log.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/system-wall-clock-ms.h"
+
+// An essential include is test.h
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanPerformanceTestSuite");
+
+/**
+ * \ingroup lorawan
+ *
+ * Scale of the budgets of the performance tests, set through the
+ * NS_GLOBAL_VALUE environment variable. Zero disables the budget checks.
+ */
+static GlobalValue g_lorawanPerfBudgetScale("LorawanPerfBudgetScale",
+                                            "Scale of the budgets of the lorawan performance "
+                                            "tests, zero to only report the measurements",
+                                            DoubleValue(1),
+                                            MakeDoubleChecker<double>(0));
+
+/**
+ * \ingroup lorawan
+ *
+ * File the measurements of the performance tests are appended to, one JSON
+ * object per line, set through the NS_GLOBAL_VALUE environment variable.
+ */
+static GlobalValue g_lorawanPerfResults("LorawanPerfResults",
+                                        "File the lorawan performance measurements are appended "
+                                        "to, empty for none",
+                                        StringValue(""),
+                                        MakeStringChecker());
+
+/**
+ * \ingroup lorawan
+ *
+ * It runs a network of end devices sending periodic uplinks to a network
+ * server through some gateways for a fixed simulated time, and checks the wall
+ * clock time and the peak resident memory of the simulation against budgets.
+ *
+ * The memory of a case is the growth of the resident memory of the process
+ * during the case: the peak resident memory is reset when the case starts, so
+ * that the cases run before do not count.
+ */
+class NetworkScaleTest : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param nDevices The number of end devices.
+     * \param nGateways The number of gateways.
+     * \param confirmed Whether the uplinks are confirmed.
+     * \param wallBudget The budget of wall clock time [s].
+     * \param memoryBudget The budget of the growth of the peak resident
+     * memory [MiB].
+     */
+    NetworkScaleTest(uint32_t nDevices,
+                     uint32_t nGateways,
+                     bool confirmed,
+                     double wallBudget,
+                     double memoryBudget);
+    ~NetworkScaleTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Get a field of the memory status of the process.
+     *
+     * \param field The field, e.g., VmRSS for the resident memory or VmHWM for
+     * its peak.
+     * \return The value of the field [MiB], or zero if not available.
+     */
+    static double GetMemory(std::string field);
+
+    /**
+     * Reset the peak resident memory of the process to its current resident
+     * memory.
+     *
+     * \return Whether the peak could be reset.
+     */
+    static bool ResetPeakMemory();
+
+    uint32_t m_nDevices;   //!< The number of end devices
+    uint32_t m_nGateways;  //!< The number of gateways
+    bool m_confirmed;      //!< Whether the uplinks are confirmed
+    double m_wallBudget;   //!< The budget of wall clock time [s]
+    double m_memoryBudget; //!< The budget of the growth of peak resident memory [MiB]
+};
+
+NetworkScaleTest::NetworkScaleTest(uint32_t nDevices,
+                                   uint32_t nGateways,
+                                   bool confirmed,
+                                   double wallBudget,
+                                   double memoryBudget)
+    : TestCase("Run " + std::to_string(nDevices) + " devices and " + std::to_string(nGateways) +
+               " gateways with " + (confirmed ? "confirmed" : "unconfirmed") + " traffic"),
+      m_nDevices(nDevices),
+      m_nGateways(nGateways),
+      m_confirmed(confirmed),
+      m_wallBudget(wallBudget),
+      m_memoryBudget(memoryBudget)
+{
+}
+
+// Reminder that the test case should clean up after itself
+NetworkScaleTest::~NetworkScaleTest()
+{
+}
+
+double
+NetworkScaleTest::GetMemory(std::string field)
+{
+    // Lines like "VmRSS:    123456 kB"
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, field.size() + 1, field + ":") == 0)
+        {
+            return std::stod(line.substr(field.size() + 1)) / 1024.0;
+        }
+    }
+    return 0;
+}
+
+bool
+NetworkScaleTest::ResetPeakMemory()
+{
+    // Available since Linux 4.0
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+NetworkScaleTest::DoRun()
+{
+    NS_LOG_DEBUG("NetworkScaleTest " << m_nDevices << " " << m_nGateways << " " << m_confirmed);
+
+    const Time period = Seconds(600);
+    const Time simulationTime = Seconds(1800);
+
+    // ru_maxrss only grows over the life of the process, so the memory of
+    // the case is measured from its own baseline
+    double baseMemory = GetMemory("VmRSS");
+    bool peakReset = ResetPeakMemory();
+
+    SystemWallClockMs clock;
+    clock.Start();
+
+    NetworkComponents components = InitializeNetwork(m_nDevices, m_nGateways);
+    if (m_confirmed)
+    {
+        for (auto node = components.endDevices.Begin(); node != components.endDevices.End();
+             node++)
+        {
+            GetMacLayerFromNode<EndDeviceLorawanMac>(*node)->SetMType(
+                LorawanMacHeader::CONFIRMED_DATA_UP);
+        }
+    }
+    PeriodicSenderHelper appHelper;
+    appHelper.SetPeriod(period);
+    ApplicationContainer apps = appHelper.Install(components.endDevices);
+    apps.Start(Seconds(0));
+    apps.Stop(simulationTime);
+
+    // Packets are created with increasing uids: the uid of a packet created
+    // before and after the run tells how many the simulation created
+    uint64_t firstUid = Create<Packet>()->GetUid();
+    int64_t setupMs = clock.End();
+
+    clock.Start();
+    Simulator::Stop(simulationTime);
+    Simulator::Run();
+    int64_t runMs = clock.End();
+    uint64_t nEvents = Simulator::GetEventCount();
+    uint64_t nPackets = Create<Packet>()->GetUid() - firstUid - 1;
+    // Without the reset, fall back to the resident memory at the end of the
+    // run, which misses the transient peaks
+    double endMemory = GetMemory("VmRSS");
+    double peakMemory = peakReset ? std::max(GetMemory("VmHWM"), endMemory) : endMemory;
+    double caseMemory = std::max(0.0, peakMemory - baseMemory);
+    Simulator::Destroy();
+
+    double wallS = (setupMs + runMs) / 1000.0;
+    double eventsPerS = runMs > 0 ? nEvents / (runMs / 1000.0) : 0;
+
+    std::ostringstream result;
+    result << "{\"devices\": " << m_nDevices << ", \"gateways\": " << m_nGateways
+           << ", \"confirmed\": " << (m_confirmed ? "true" : "false")
+           << ", \"setup_s\": " << setupMs / 1000.0 << ", \"run_s\": " << runMs / 1000.0
+           << ", \"events\": " << nEvents << ", \"events_per_s\": " << eventsPerS
+           << ", \"packets\": " << nPackets << ", \"peak_rss_growth_mib\": " << caseMemory
+           << ", \"peak_rss_exact\": " << (peakReset ? "true" : "false") << "}";
+    NS_LOG_INFO(result.str());
+
+    StringValue resultsFile;
+    g_lorawanPerfResults.GetValue(resultsFile);
+    if (!resultsFile.Get().empty())
+    {
+        std::ofstream file(resultsFile.Get(), std::ios::out | std::ios::app);
+        file << result.str() << std::endl;
+    }
+
+    DoubleValue scale;
+    g_lorawanPerfBudgetScale.GetValue(scale);
+    if (scale.Get() > 0)
+    {
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(wallS,
+                                    m_wallBudget * scale.Get(),
+                                    "The simulation exceeded its wall clock budget");
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(caseMemory,
+                                    m_memoryBudget * scale.Get(),
+                                    "The simulation exceeded its memory budget");
+    }
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * The TestSuite class names the TestSuite, identifies what type of TestSuite, and enables the
+ * TestCases to be run. Typically, only the constructor for this class must be defined
+ */
+class LorawanPerformanceTestSuite : public TestSuite
+{
+  public:
+    LorawanPerformanceTestSuite(); //!< Default constructor
+};
+
+LorawanPerformanceTestSuite::LorawanPerformanceTestSuite()
+    : TestSuite("lorawan-performance", Type::PERFORMANCE)
+{
+    LogComponentEnable("LorawanPerformanceTestSuite", LOG_LEVEL_INFO);
+
+    // The wall clock budgets [s] grow with the number of devices, and double
+    // with each step in the number of gateways; the memory budgets [MiB] are
+    // the growth of the peak resident memory during each case
+    struct Scale
+    {
+        uint32_t nDevices;   //!< The number of end devices
+        double wallBudget;   //!< The wall clock budget with one gateway [s]
+        double memoryBudget; //!< The memory budget [MiB]
+        Duration duration;   //!< The duration of the test cases
+    };
+
+    const Scale scales[] = {{1000, 30, 512, Duration::QUICK},
+                            {10000, 300, 2048, Duration::EXTENSIVE},
+                            {100000, 3600, 16384, Duration::TAKES_FOREVER}};
+    const uint32_t gateways[] = {1, 16, 128};
+
+    // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+    for (const auto& scale : scales)
+    {
+        for (uint32_t g = 0; g < 3; g++)
+        {
+            for (bool confirmed : {false, true})
+            {
+                AddTestCase(new NetworkScaleTest(scale.nDevices,
+                                                 gateways[g],
+                                                 confirmed,
+                                                 scale.wallBudget * (1 << g),
+                                                 scale.memoryBudget),
+                            scale.duration);
+            }
+        }
+    }
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static LorawanPerformanceTestSuite lorawanPerformanceTestSuite;
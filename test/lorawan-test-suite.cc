@@ -7,17 +7,54 @@
  */
 
 // Include headers of classes to test
+#include "utilities.h"
+
+#include "ns3/alarm-traffic-helper.h"
+#include "ns3/basic-energy-source-helper.h"
+#include "ns3/boolean.h"
+#include "ns3/class-b-beacon-timeline.h"
+#include "ns3/class-b-end-device-lorawan-mac.h"
+#include "ns3/class-c-end-device-lorawan-mac.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/fleet-traffic-scheduler.h"
 #include "ns3/log.h"
+#include "ns3/lora-far-field-helper.h"
+#include "ns3/lora-fleet-energy-tracker.h"
 #include "ns3/lora-helper.h"
+#include "ns3/lora-lifetime-projector.h"
+#include "ns3/lora-packet-pool.h"
+#include "ns3/lora-phy-recorder.h"
+#include "ns3/lora-phy-replay.h"
+#include "ns3/lora-radio-energy-model-helper.h"
+#include "ns3/lora-tag.h"
+#include "ns3/lora-tx-current-model.h"
+#include "ns3/lora-virtual-fleet.h"
 #include "ns3/mobility-helper.h"
+#include "ns3/network-server.h"
+#include "ns3/node-list.h"
 #include "ns3/one-shot-sender-helper.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/random-sender-helper.h"
+#include "ns3/random-sender.h"
+#include "ns3/rng-seed-manager.h"
 #include "ns3/simple-end-device-lora-phy.h"
 #include "ns3/simple-gateway-lora-phy.h"
+#include "ns3/string.h"
+#include "ns3/trace-replay-sender.h"
+#include "ns3/uinteger.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
 using namespace ns3;
 using namespace lorawan;
 
@@ -980,6 +1017,54 @@ LogicalLoraChannelTest::DoRun()
     NS_TEST_EXPECT_MSG_EQ(channelHelper->GetWaitingTime(channel5),
                           Time(0),
                           "Waiting time affects other subbands");
+
+    // The earliest waiting time only considers SubBands with enabled channels
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->GetEarliestWaitingTime(),
+                          Time(0),
+                          "Earliest waiting time ignores the free SubBand");
+    channel4->DisableForUplink();
+    channel5->DisableForUplink();
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->GetEarliestWaitingTime(),
+                          expectedTimeOff,
+                          "Earliest waiting time considers disabled channels");
+
+    // Channel mask tests
+    /////////////////////
+
+    // The mask only applies to existing channels
+    LogicalLoraChannelHelper::ChannelMask mask;
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->ComputeChannelMask(0, 0b100011, mask),
+                          false,
+                          "Channel mask of a non-existing channel accepted");
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->ComputeChannelMask(0, 0b00011, mask),
+                          true,
+                          "Channel mask of existing channels rejected");
+    channelHelper->SetChannelMask(mask);
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->GetEnabledChannelList().size(),
+                          2,
+                          "Channel mask not applied");
+    NS_TEST_EXPECT_MSG_EQ(channel3->IsEnabledForUplink(), false, "Channel mask not applied");
+
+    // Only available channels are picked
+    Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+    NS_TEST_EXPECT_MSG_EQ(bool(channelHelper->PickChannel(0, rv)),
+                          false,
+                          "Picked a channel blocked by the duty cycle");
+    channelHelper->EnableChannel(4);
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->PickChannel(0, rv), channel5, "Wrong channel picked");
+    NS_TEST_EXPECT_MSG_EQ(bool(channelHelper->PickChannel(6, rv)),
+                          false,
+                          "Picked a channel that does not allow the data rate");
+
+    // Channels toggled directly are seen by the helper
+    channel5->DisableForUplink();
+    channel4->SetEnabledForUplink();
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->GetChannelMask().test(3),
+                          true,
+                          "Channel enabled directly missing from the mask");
+    NS_TEST_EXPECT_MSG_EQ(channelHelper->PickChannel(0, rv),
+                          channel4,
+                          "Channel toggled directly not considered");
 }
 
 /**
@@ -1567,6 +1652,2569 @@ PhyConnectivityTest::DoRun()
                           "State didn't switch to STANDBY as expected");
 }
 
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the LoraPacketPool recycles the packets released by the MAC layer, and that the
+ * steady-state send path does not create packets. That it does not allocate is checked by the
+ * lorawan-allocation suite, which counts the allocations
+ */
+class PacketPoolTest : public TestCase
+{
+  public:
+    PacketPoolTest();           //!< Default constructor
+    ~PacketPoolTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+PacketPoolTest::PacketPoolTest()
+    : TestCase("Verify that LoraPacketPool recycles packets")
+{
+}
+
+// Reminder that the test case should clean up after itself
+PacketPoolTest::~PacketPoolTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+PacketPoolTest::DoRun()
+{
+    NS_LOG_DEBUG("PacketPoolTest");
+
+    Ptr<LoraPacketPool> pool = CreateObject<LoraPacketPool>();
+    pool->SetAttribute("Capacity", UintegerValue(2));
+
+    // Use a packet like the MAC and PHY layers do, then release it
+    Ptr<Packet> packet = pool->Acquire(10);
+    Packet* first = PeekPointer(packet);
+    uint64_t firstUid = packet->GetUid();
+    LoraFrameHeader frameHdr;
+    frameHdr.SetAsUplink();
+    packet->AddHeader(frameHdr);
+    packet->AddHeader(LorawanMacHeader());
+    packet->AddPacketTag(LoraTag(7));
+    packet = nullptr;
+
+    // The same packet is reset and handed out again
+    packet = pool->Acquire(12);
+    LoraTag tag;
+    NS_TEST_EXPECT_MSG_EQ(PeekPointer(packet), first, "The packet was not recycled");
+    NS_TEST_EXPECT_MSG_EQ(packet->GetSize(), 12, "Wrong size of a recycled packet");
+    NS_TEST_EXPECT_MSG_EQ(packet->PeekPacketTag(tag), false, "A tag survived recycling");
+    NS_TEST_EXPECT_MSG_NE(packet->GetUid(), firstUid, "A recycled packet kept its uid");
+    NS_TEST_EXPECT_MSG_EQ(pool->GetNCreated(), 1, "Unexpected number of created packets");
+
+    // Packets still referenced elsewhere are not recycled, and a full pool
+    // does not keep the packets it has to create
+    Ptr<Packet> second = pool->Acquire(10);
+    Ptr<Packet> third = pool->Acquire(10);
+    NS_TEST_EXPECT_MSG_NE(PeekPointer(second), first, "A used packet was recycled");
+    NS_TEST_EXPECT_MSG_EQ(pool->GetSize(), 2, "The pool exceeded its capacity");
+    NS_TEST_EXPECT_MSG_EQ(pool->GetNCreated(), 3, "Unexpected number of created packets");
+    packet = nullptr;
+    second = nullptr;
+    third = nullptr;
+
+    // In steady state, sending does not create any packet
+    for (int i = 0; i < 100; i++)
+    {
+        Ptr<Packet> p = pool->Acquire(10);
+        p->AddHeader(LorawanMacHeader());
+        Ptr<Packet> copy = p->Copy(); // Like the confirmed path of the MAC
+    }
+    NS_TEST_EXPECT_MSG_EQ(pool->GetNCreated(), 3, "Packets were created in steady state");
+    NS_TEST_EXPECT_MSG_EQ(pool->GetNRecycled(), 101, "Unexpected number of recycled packets");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the TableLoraTxCurrentModel interpolates its table, and that the precomputed
+ * integer powers match the interpolation
+ */
+class TxCurrentModelTest : public TestCase
+{
+  public:
+    TxCurrentModelTest();           //!< Default constructor
+    ~TxCurrentModelTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+TxCurrentModelTest::TxCurrentModelTest()
+    : TestCase("Verify that TableLoraTxCurrentModel interpolates its table")
+{
+}
+
+// Reminder that the test case should clean up after itself
+TxCurrentModelTest::~TxCurrentModelTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+TxCurrentModelTest::DoRun()
+{
+    NS_LOG_DEBUG("TxCurrentModelTest");
+
+    Ptr<TableLoraTxCurrentModel> model = CreateObject<TableLoraTxCurrentModel>();
+    model->SetTable({{14, 0.044}, {2, 0.020}, {10, 0.030}});
+
+    // Measured powers
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(2), 0.020, 1e-12, "Wrong current at 2 dBm");
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(14), 0.044, 1e-12, "Wrong current at 14 dBm");
+
+    // Precomputed and interpolated powers
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(6), 0.025, 1e-12, "Wrong current at 6 dBm");
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(12), 0.037, 1e-12, "Wrong current at 12 dBm");
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(12.5),
+                              0.03875,
+                              1e-12,
+                              "Wrong current at 12.5 dBm");
+
+    // Clamped outside of the table
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(0), 0.020, 1e-12, "Wrong current at 0 dBm");
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(27), 0.044, 1e-12, "Wrong current at 27 dBm");
+    NS_TEST_EXPECT_MSG_EQ_TOL(model->CalcTxCurrent(-3.5),
+                              0.020,
+                              1e-12,
+                              "Wrong current at -3.5 dBm");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the LoraFarFieldHelper splits the devices at its distance from the gateways, and
+ * adds the signals of the far devices to the gateways at the rate of their uplinks
+ */
+class FarFieldTest : public TestCase
+{
+  public:
+    FarFieldTest();           //!< Default constructor
+    ~FarFieldTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+FarFieldTest::FarFieldTest()
+    : TestCase("Verify that the LoraFarFieldHelper models the interference of far devices")
+{
+}
+
+// Reminder that the test case should clean up after itself
+FarFieldTest::~FarFieldTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+FarFieldTest::DoRun()
+{
+    NS_LOG_DEBUG("FarFieldTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> gatewayAllocator = CreateObject<ListPositionAllocator>();
+    gatewayAllocator->Add(Vector(0, 0, 15));
+    mobility.SetPositionAllocator(gatewayAllocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+
+    // Two devices in the near field, and two in the far field, both at SF12
+    Ptr<ListPositionAllocator> deviceAllocator = CreateObject<ListPositionAllocator>();
+    deviceAllocator->Add(Vector(1000, 0, 0));
+    deviceAllocator->Add(Vector(0, 2000, 0));
+    deviceAllocator->Add(Vector(6000, 0, 0));
+    deviceAllocator->Add(Vector(0, -8000, 0));
+
+    LoraFarFieldHelper farField;
+    farField.SetDistance(5000);
+    farField.SetPeriod(Seconds(10));
+    farField.AssignStreams(0);
+    Ptr<ListPositionAllocator> nearField = farField.Split(deviceAllocator, 4, gateways);
+    NS_TEST_EXPECT_MSG_EQ(nearField->GetSize(), 2, "Wrong number of near devices");
+    NS_TEST_EXPECT_MSG_EQ(farField.GetNFarDevices(), 2, "Wrong number of far devices");
+    NS_TEST_EXPECT_MSG_EQ(nearField->GetNext(), Vector(1000, 0, 0), "Wrong near device");
+
+    farField.Install(gateways, channel);
+
+    // A process for SF12 on each of the three default channels
+    std::ostringstream processes;
+    farField.PrintProcesses(processes);
+    std::istringstream lines(processes.str());
+    std::string line;
+    uint32_t nProcesses = 0;
+    while (std::getline(lines, line))
+    {
+        nProcesses++;
+    }
+    NS_TEST_EXPECT_MSG_EQ(nProcesses, 3, "Wrong number of interference processes");
+
+    // Two devices with a period of 10 s send about 200 uplinks in 1000 s
+    Simulator::Stop(Seconds(1000));
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ_TOL(double(farField.GetNSignals()),
+                              200,
+                              60,
+                              "Wrong number of far field signals");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests the uplinks of a LoraVirtualFleet, and the promotion of its devices
+ * to full end devices
+ */
+class VirtualFleetTest : public TestCase
+{
+  public:
+    VirtualFleetTest();           //!< Default constructor
+    ~VirtualFleetTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for tracesource ReceivedPacket of the gateway.
+     *
+     * \param packet The packet received.
+     * \param node The receiver node id if any, 0 otherwise.
+     */
+    void ReceivedPacket(Ptr<const Packet> packet, uint32_t node);
+
+    uint32_t m_receivedPacketCalls; //!< Counter for ReceivedPacket calls
+    std::set<uint16_t> m_tagNodeIds; //!< The node ids of the LoraTags received
+};
+
+// Add some help text to this case to describe what it is intended to test
+VirtualFleetTest::VirtualFleetTest()
+    : TestCase("Verify that the LoraVirtualFleet sends the uplinks of its devices"),
+      m_receivedPacketCalls(0)
+{
+}
+
+// Reminder that the test case should clean up after itself
+VirtualFleetTest::~VirtualFleetTest()
+{
+}
+
+void
+VirtualFleetTest::ReceivedPacket(Ptr<const Packet> packet, uint32_t node)
+{
+    m_receivedPacketCalls++;
+    LoraTag tag;
+    packet->PeekPacketTag(tag);
+    m_tagNodeIds.insert(tag.GetNodeId());
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+VirtualFleetTest::DoRun()
+{
+    NS_LOG_DEBUG("VirtualFleetTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> gatewayAllocator = CreateObject<ListPositionAllocator>();
+    gatewayAllocator->Add(Vector(0, 0, 15));
+    mobility.SetPositionAllocator(gatewayAllocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+
+    // A device close to the gateway and one at the edge of the coverage
+    Ptr<ListPositionAllocator> deviceAllocator = CreateObject<ListPositionAllocator>();
+    deviceAllocator->Add(Vector(100, 0, 0));
+    deviceAllocator->Add(Vector(0, 6000, 0));
+    deviceAllocator->Add(Vector(200, 0, 0));
+    deviceAllocator->Add(Vector(0, 300, 0));
+
+    LoraVirtualFleet fleet;
+    fleet.SetPeriod(Seconds(200));
+    fleet.AssignStreams(0);
+    NS_TEST_EXPECT_MSG_EQ(fleet.AddDevices(4, deviceAllocator), 0, "Wrong first device");
+    fleet.SetSpreadingFactorsUp(gateways, channel);
+    NS_TEST_EXPECT_MSG_EQ(unsigned(fleet.GetDataRate(0)), 5, "Wrong data rate of a close device");
+    NS_TEST_EXPECT_MSG_LT(unsigned(fleet.GetDataRate(1)), 5, "Wrong data rate of a far device");
+
+    // Promote the last device
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    LorawanMacHelper macHelper;
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    NodeContainer promoted = fleet.Instantiate({3}, LoraHelper(), phyHelper, macHelper);
+    NS_TEST_ASSERT_MSG_EQ(promoted.GetN(), 1, "Wrong number of promoted devices");
+    Ptr<EndDeviceLorawanMac> mac = promoted.Get(0)
+                                       ->GetDevice(0)
+                                       ->GetObject<LoraNetDevice>()
+                                       ->GetMac()
+                                       ->GetObject<EndDeviceLorawanMac>();
+    NS_TEST_EXPECT_MSG_EQ(mac->GetDeviceAddress(), fleet.GetAddress(3), "Wrong address");
+
+    gateways.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy()->TraceConnectWithoutContext(
+        "ReceivedPacket",
+        MakeCallback(&VirtualFleetTest::ReceivedPacket, this));
+
+    // The three virtual devices send an uplink per period, within their duty
+    // cycle even at SF12
+    uint32_t nNodes = NodeList::GetNNodes();
+    fleet.Install(channel, Seconds(0), Seconds(2000));
+    Simulator::Stop(Seconds(2100));
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(fleet.GetNSentPackets(), 30, "Wrong number of uplinks");
+    NS_TEST_EXPECT_MSG_EQ(fleet.GetNDutyCycleDrops(), 0, "Wrong number of blocked uplinks");
+    NS_TEST_EXPECT_MSG_EQ(fleet.GetFCnt(0), 10, "Wrong frame counter");
+    NS_TEST_EXPECT_MSG_EQ(fleet.GetFCnt(3), 0, "The promoted device sent virtual uplinks");
+    NS_TEST_EXPECT_MSG_GT(m_receivedPacketCalls, 0, "The gateway received no virtual uplink");
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(m_receivedPacketCalls, 30, "The gateway received too many uplinks");
+    // The virtual devices don't take the node ids of the gateway and of the
+    // promoted device
+    for (uint16_t nodeId : m_tagNodeIds)
+    {
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(nodeId, nNodes, "A virtual device took a node id");
+        NS_TEST_EXPECT_MSG_LT(nodeId, nNodes + 3, "A virtual device has an unexpected node id");
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that a LoraPhyReplay of the signals recorded by a LoraPhyRecorder
+ * reproduces the outcomes of the simulation, and evaluates other parameters
+ */
+class PhyReplayTest : public TestCase
+{
+  public:
+    PhyReplayTest();           //!< Default constructor
+    ~PhyReplayTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for the trace sources of the outcomes of the gateway.
+     *
+     * \param outcome The outcome of the trace source.
+     * \param packet The packet.
+     * \param node The receiver node id if any, 0 otherwise.
+     */
+    void Outcome(LoraPhyReplay::Outcome outcome, Ptr<const Packet> packet, uint32_t node);
+
+    uint64_t m_outcomes[LoraPhyReplay::N_OUTCOMES]; //!< The outcomes of the simulation
+};
+
+// Add some help text to this case to describe what it is intended to test
+PhyReplayTest::PhyReplayTest()
+    : TestCase("Verify that the LoraPhyReplay reproduces the receptions of the gateways"),
+      m_outcomes{}
+{
+}
+
+// Reminder that the test case should clean up after itself
+PhyReplayTest::~PhyReplayTest()
+{
+}
+
+void
+PhyReplayTest::Outcome(LoraPhyReplay::Outcome outcome, Ptr<const Packet> packet, uint32_t node)
+{
+    m_outcomes[outcome]++;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+PhyReplayTest::DoRun()
+{
+    NS_LOG_DEBUG("PhyReplayTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> gatewayAllocator = CreateObject<ListPositionAllocator>();
+    gatewayAllocator->Add(Vector(0, 0, 15));
+    mobility.SetPositionAllocator(gatewayAllocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+
+    // Devices sending at the same time, some colliding, and two out of range
+    Ptr<ListPositionAllocator> deviceAllocator = CreateObject<ListPositionAllocator>();
+    for (double distance : {100, 300, 500, 700, 900, 1100, 1300, 1500, 20000, 25000})
+    {
+        deviceAllocator->Add(Vector(distance, 0, 0));
+    }
+    mobility.SetPositionAllocator(deviceAllocator);
+    NodeContainer endDevices = CreateEndDevices(10, mobility, channel);
+    LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    OneShotSenderHelper oneShotHelper;
+    oneShotHelper.SetSendTime(Seconds(1));
+    oneShotHelper.Install(endDevices);
+
+    Ptr<LoraPhy> gwPhy = gateways.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+    const std::pair<std::string, LoraPhyReplay::Outcome> traces[] = {
+        {"ReceivedPacket", LoraPhyReplay::RECEIVED},
+        {"LostPacketBecauseInterference", LoraPhyReplay::INTERFERED},
+        {"LostPacketBecauseUnderSensitivity", LoraPhyReplay::UNDER_SENSITIVITY},
+        {"LostPacketBecauseNoMoreReceivers", LoraPhyReplay::NO_MORE_RECEIVERS},
+        {"NoReceptionBecauseTransmitting", LoraPhyReplay::TRANSMITTING},
+    };
+    for (const auto& [name, outcome] : traces)
+    {
+        gwPhy->TraceConnectWithoutContext(
+            name,
+            MakeCallback(&PhyReplayTest::Outcome, this).Bind(outcome));
+    }
+
+    std::string filename = CreateTempDirFilename("lorawan-phy-records.bin");
+    LoraPhyRecorder recorder;
+    recorder.Open(filename);
+    recorder.Install(gateways);
+
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+    Simulator::Destroy();
+    recorder.Close();
+    NS_TEST_ASSERT_MSG_EQ(recorder.GetNRecords(), 10, "Wrong number of records");
+
+    // The parameters of the simulation give its outcomes
+    LoraPhyReplay replay;
+    replay.Load(filename);
+    NS_TEST_ASSERT_MSG_EQ(replay.GetNRecords(), 10, "Wrong number of records loaded");
+    replay.Run(LoraPhyReplay::Parameters());
+    for (uint8_t outcome = 0; outcome < LoraPhyReplay::N_OUTCOMES; outcome++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(replay.GetNOutcomes(LoraPhyReplay::Outcome(outcome)),
+                              m_outcomes[outcome],
+                              "Wrong number of outcomes " << unsigned(outcome));
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_outcomes[LoraPhyReplay::UNDER_SENSITIVITY],
+                          2,
+                          "The devices out of range were not under sensitivity");
+    uint64_t nReceived = replay.GetNOutcomes(LoraPhyReplay::RECEIVED);
+    NS_TEST_EXPECT_MSG_EQ(replay.GetNReceivedPackets(), nReceived, "Wrong received packets");
+
+    // A single reception path locks on the nearest signal, and all the others,
+    // reaching the gateway later, find no free path
+    LoraPhyReplay::Parameters singlePath;
+    singlePath.nReceptionPaths = 1;
+    replay.Run(singlePath);
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(replay.GetNOutcomes(LoraPhyReplay::RECEIVED),
+                                1,
+                                "Too many receptions with a single path");
+    NS_TEST_EXPECT_MSG_EQ(replay.GetNOutcomes(LoraPhyReplay::NO_MORE_RECEIVERS),
+                          9,
+                          "Wrong number of signals without a free path");
+
+    // ALOHA loses every overlapping reception that GOURSAUD may capture
+    LoraPhyReplay::Parameters aloha;
+    aloha.collisionSnir = LoraInterferenceHelper::collisionSnirAloha;
+    replay.SetNThreads(2);
+    replay.Run(aloha);
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(replay.GetNOutcomes(LoraPhyReplay::RECEIVED),
+                                nReceived,
+                                "ALOHA received more than GOURSAUD");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that a gateway evaluates the signals under a list of reception
+ * hypotheses in a single run, its own parameters still deciding the receptions
+ */
+class HypothesesTest : public TestCase
+{
+  public:
+    HypothesesTest();           //!< Default constructor
+    ~HypothesesTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for the trace sources of the outcomes of the gateway.
+     *
+     * \param outcome The outcome of the trace source.
+     * \param packet The packet.
+     * \param node The receiver node id if any, 0 otherwise.
+     */
+    void Outcome(GatewayLoraPhy::HypothesisOutcome outcome,
+                 Ptr<const Packet> packet,
+                 uint32_t node);
+
+    /**
+     * Callback for the HypothesisOutcome trace source of the gateway.
+     *
+     * \param packet The packet.
+     * \param node The receiver node id if any, 0 otherwise.
+     * \param hypothesis The index of the hypothesis.
+     * \param outcome The outcome under the hypothesis.
+     */
+    void HypothesisOutcome(Ptr<const Packet> packet,
+                           uint32_t node,
+                           uint32_t hypothesis,
+                           GatewayLoraPhy::HypothesisOutcome outcome);
+
+    std::vector<uint32_t> m_outcomes;                        //!< The outcomes of the gateway
+    std::vector<std::vector<uint32_t>> m_hypothesisOutcomes; //!< The outcomes of each hypothesis
+};
+
+// Add some help text to this case to describe what it is intended to test
+HypothesesTest::HypothesesTest()
+    : TestCase("Verify that a gateway evaluates the signals under several hypotheses")
+{
+}
+
+// Reminder that the test case should clean up after itself
+HypothesesTest::~HypothesesTest()
+{
+}
+
+void
+HypothesesTest::Outcome(GatewayLoraPhy::HypothesisOutcome outcome,
+                        Ptr<const Packet> packet,
+                        uint32_t node)
+{
+    m_outcomes[outcome]++;
+}
+
+void
+HypothesesTest::HypothesisOutcome(Ptr<const Packet> packet,
+                                  uint32_t node,
+                                  uint32_t hypothesis,
+                                  GatewayLoraPhy::HypothesisOutcome outcome)
+{
+    m_hypothesisOutcomes[hypothesis][outcome]++;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+HypothesesTest::DoRun()
+{
+    NS_LOG_DEBUG("HypothesesTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> gatewayAllocator = CreateObject<ListPositionAllocator>();
+    gatewayAllocator->Add(Vector(0, 0, 15));
+    mobility.SetPositionAllocator(gatewayAllocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+
+    // Devices sending at the same time, some colliding, and two out of range
+    Ptr<ListPositionAllocator> deviceAllocator = CreateObject<ListPositionAllocator>();
+    for (double distance : {100, 300, 500, 700, 900, 1100, 1300, 1500, 20000, 25000})
+    {
+        deviceAllocator->Add(Vector(distance, 0, 0));
+    }
+    mobility.SetPositionAllocator(deviceAllocator);
+    NodeContainer endDevices = CreateEndDevices(10, mobility, channel);
+    LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    OneShotSenderHelper oneShotHelper;
+    oneShotHelper.SetSendTime(Seconds(1));
+    oneShotHelper.Install(endDevices);
+
+    // The parameters of the gateway, ALOHA, and a single reception path
+    std::vector<LoraInterferenceHelper::Hypothesis> hypotheses(3);
+    hypotheses[1].collisionSnir = LoraInterferenceHelper::collisionSnirAloha;
+    hypotheses[2].nReceptionPaths = 1;
+
+    Ptr<GatewayLoraPhy> gwPhy = gateways.Get(0)
+                                    ->GetDevice(0)
+                                    ->GetObject<LoraNetDevice>()
+                                    ->GetPhy()
+                                    ->GetObject<GatewayLoraPhy>();
+    gwPhy->SetHypotheses(hypotheses);
+    m_outcomes.assign(5, 0);
+    m_hypothesisOutcomes.assign(hypotheses.size(), std::vector<uint32_t>(5, 0));
+
+    const std::pair<std::string, GatewayLoraPhy::HypothesisOutcome> traces[] = {
+        {"ReceivedPacket", GatewayLoraPhy::HYPOTHESIS_RECEIVED},
+        {"LostPacketBecauseInterference", GatewayLoraPhy::HYPOTHESIS_INTERFERED},
+        {"LostPacketBecauseNoMoreReceivers", GatewayLoraPhy::HYPOTHESIS_NO_MORE_RECEIVERS},
+        {"LostPacketBecauseUnderSensitivity", GatewayLoraPhy::HYPOTHESIS_UNDER_SENSITIVITY},
+        {"NoReceptionBecauseTransmitting", GatewayLoraPhy::HYPOTHESIS_LOST_BECAUSE_TX},
+    };
+    for (const auto& [name, outcome] : traces)
+    {
+        gwPhy->TraceConnectWithoutContext(
+            name,
+            MakeCallback(&HypothesesTest::Outcome, this).Bind(outcome));
+    }
+    gwPhy->TraceConnectWithoutContext("HypothesisOutcome",
+                                      MakeCallback(&HypothesesTest::HypothesisOutcome, this));
+
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    // Every hypothesis gives an outcome to every signal
+    for (uint32_t h = 0; h < hypotheses.size(); h++)
+    {
+        uint32_t nOutcomes = 0;
+        for (uint32_t outcome : m_hypothesisOutcomes[h])
+        {
+            nOutcomes += outcome;
+        }
+        NS_TEST_EXPECT_MSG_EQ(nOutcomes, 10, "Wrong number of outcomes of hypothesis " << h);
+    }
+
+    // The parameters of the gateway give its outcomes
+    for (uint32_t outcome = 0; outcome < m_outcomes.size(); outcome++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_hypothesisOutcomes[0][outcome],
+                              m_outcomes[outcome],
+                              "Wrong number of outcomes " << outcome);
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_outcomes[GatewayLoraPhy::HYPOTHESIS_UNDER_SENSITIVITY],
+                          2,
+                          "The devices out of range were not under sensitivity");
+
+    // ALOHA loses every overlapping reception that GOURSAUD may capture
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(m_hypothesisOutcomes[1][GatewayLoraPhy::HYPOTHESIS_RECEIVED],
+                                m_outcomes[GatewayLoraPhy::HYPOTHESIS_RECEIVED],
+                                "ALOHA received more than GOURSAUD");
+
+    // A single reception path locks on the nearest signal, and all the others,
+    // reaching the gateway later, find no free path
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(m_hypothesisOutcomes[2][GatewayLoraPhy::HYPOTHESIS_RECEIVED],
+                                1,
+                                "Too many receptions with a single path");
+    NS_TEST_EXPECT_MSG_EQ(m_hypothesisOutcomes[2][GatewayLoraPhy::HYPOTHESIS_NO_MORE_RECEIVERS],
+                          9,
+                          "Wrong number of signals without a free path");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the data rates assigned to the end devices are the ones of
+ * their region, so that their uplinks are sent
+ */
+class RegionDataRateTest : public TestCase
+{
+  public:
+    RegionDataRateTest();           //!< Default constructor
+    ~RegionDataRateTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for the StartSending trace source of the devices.
+     *
+     * \param packet The packet being sent.
+     * \param node The id of the sender node.
+     */
+    void StartSending(Ptr<const Packet> packet, uint32_t node);
+
+    uint32_t m_nSent; //!< The number of uplinks sent
+};
+
+// Add some help text to this case to describe what it is intended to test
+RegionDataRateTest::RegionDataRateTest()
+    : TestCase("Verify that the end devices are assigned the data rates of their region"),
+      m_nSent(0)
+{
+}
+
+// Reminder that the test case should clean up after itself
+RegionDataRateTest::~RegionDataRateTest()
+{
+}
+
+void
+RegionDataRateTest::StartSending(Ptr<const Packet> packet, uint32_t node)
+{
+    m_nSent++;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+RegionDataRateTest::DoRun()
+{
+    NS_LOG_DEBUG("RegionDataRateTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
+    allocator->Add(Vector(0, 0, 15));
+    mobility.SetPositionAllocator(allocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+
+    // A device next to the gateway and one at the edge of its range
+    allocator = CreateObject<ListPositionAllocator>();
+    allocator->Add(Vector(100, 0, 0));
+    allocator->Add(Vector(7000, 0, 0));
+    mobility.SetPositionAllocator(allocator);
+    NodeContainer endDevices;
+    endDevices.Create(2);
+    mobility.Install(endDevices);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    LorawanMacHelper macHelper;
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    macHelper.SetRegion(LorawanMacHelper::US);
+    macHelper.SetFrequencySubBand(1);
+    LoraHelper helper;
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    std::vector<uint16_t> sfQuantity =
+        LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    // SF7 is DR3 in the US region, and SF10, the largest 125 kHz spreading
+    // factor, is used in place of SF11 and SF12
+    Ptr<ClassAEndDeviceLorawanMac> nearMac = endDevices.Get(0)
+                                                 ->GetDevice(0)
+                                                 ->GetObject<LoraNetDevice>()
+                                                 ->GetMac()
+                                                 ->GetObject<ClassAEndDeviceLorawanMac>();
+    Ptr<ClassAEndDeviceLorawanMac> farMac = endDevices.Get(1)
+                                                ->GetDevice(0)
+                                                ->GetObject<LoraNetDevice>()
+                                                ->GetMac()
+                                                ->GetObject<ClassAEndDeviceLorawanMac>();
+    NS_TEST_EXPECT_MSG_EQ(unsigned(nearMac->GetDataRate()), 3, "Wrong data rate for SF7");
+    NS_TEST_EXPECT_MSG_EQ(unsigned(farMac->GetDataRate()), 0, "Wrong data rate for SF10");
+    NS_TEST_EXPECT_MSG_EQ(sfQuantity[0], 1, "Wrong number of devices using SF7");
+    NS_TEST_EXPECT_MSG_EQ(sfQuantity[3], 1, "Wrong number of devices using SF10");
+
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        Ptr<LoraPhy> phy = endDevices.Get(i)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+        phy->TraceConnectWithoutContext("StartSending",
+                                        MakeCallback(&RegionDataRateTest::StartSending, this));
+    }
+
+    OneShotSenderHelper oneShotHelper;
+    oneShotHelper.SetSendTime(Seconds(1));
+    oneShotHelper.Install(endDevices);
+
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_nSent, 2, "The uplinks of the devices were not sent");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the deferral counters of the end devices only account for the
+ * transmissions postponed by the duty cycle, and not by the ACK_TIMEOUT
+ */
+class DeferralCounterTest : public TestCase
+{
+  public:
+    DeferralCounterTest();           //!< Default constructor
+    ~DeferralCounterTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Send a confirmed packet from a device without gateways, so that all its
+     * transmissions are used.
+     *
+     * \param region The region of the device.
+     * \return The MAC layer of the device.
+     */
+    Ptr<ClassAEndDeviceLorawanMac> RunConfirmed(LorawanMacHelper::Regions region);
+
+    /**
+     * Callback for the StartSending trace source of the device.
+     *
+     * \param packet The packet being sent.
+     * \param node The id of the sender node.
+     */
+    void StartSending(Ptr<const Packet> packet, uint32_t node);
+
+    /**
+     * Callback for the EndDeviceState trace source of the device.
+     *
+     * \param oldState The previous state of the PHY.
+     * \param newState The new state of the PHY.
+     */
+    void StateChanged(EndDeviceLoraPhy::State oldState, EndDeviceLoraPhy::State newState);
+
+    std::vector<Time> m_sendTimes;  //!< The start times of the transmissions
+    std::vector<Time> m_sleepTimes; //!< The times the PHY went to sleep
+};
+
+// Add some help text to this case to describe what it is intended to test
+DeferralCounterTest::DeferralCounterTest()
+    : TestCase("Verify that only the transmissions blocked by the duty cycle are counted")
+{
+}
+
+// Reminder that the test case should clean up after itself
+DeferralCounterTest::~DeferralCounterTest()
+{
+}
+
+void
+DeferralCounterTest::StartSending(Ptr<const Packet> packet, uint32_t node)
+{
+    m_sendTimes.push_back(Simulator::Now());
+}
+
+void
+DeferralCounterTest::StateChanged(EndDeviceLoraPhy::State oldState,
+                                  EndDeviceLoraPhy::State newState)
+{
+    if (newState == EndDeviceLoraPhy::SLEEP)
+    {
+        m_sleepTimes.push_back(Simulator::Now());
+    }
+}
+
+Ptr<ClassAEndDeviceLorawanMac>
+DeferralCounterTest::RunConfirmed(LorawanMacHelper::Regions region)
+{
+    m_sendTimes.clear();
+    m_sleepTimes.clear();
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices;
+    endDevices.Create(1);
+    mobility.Install(endDevices);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    LorawanMacHelper macHelper;
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    macHelper.SetRegion(region);
+    LoraHelper helper;
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    Ptr<LoraNetDevice> device = endDevices.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>();
+    Ptr<ClassAEndDeviceLorawanMac> mac = device->GetMac()->GetObject<ClassAEndDeviceLorawanMac>();
+    mac->SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
+    mac->SetMaxNumberOfTransmissions(4);
+    mac->SetDataRate(0);
+    device->GetPhy()->TraceConnectWithoutContext(
+        "StartSending",
+        MakeCallback(&DeferralCounterTest::StartSending, this));
+    device->GetPhy()->TraceConnectWithoutContext(
+        "EndDeviceState",
+        MakeCallback(&DeferralCounterTest::StateChanged, this));
+
+    OneShotSenderHelper oneShotHelper;
+    oneShotHelper.SetSendTime(Seconds(1));
+    oneShotHelper.Install(endDevices);
+
+    Simulator::Stop(Seconds(1000));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    return mac;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+DeferralCounterTest::DoRun()
+{
+    NS_LOG_DEBUG("DeferralCounterTest");
+
+    // At SF12 in the EU region, the 1% duty cycle outlasts the ACK_TIMEOUT,
+    // and each retransmission is sent as soon as it allows it
+    Ptr<ClassAEndDeviceLorawanMac> mac = RunConfirmed(LorawanMacHelper::EU);
+    NS_TEST_ASSERT_MSG_EQ(m_sendTimes.size(), 4, "Wrong number of transmissions");
+    NS_TEST_EXPECT_MSG_EQ(mac->GetNDeferredTransmissions(),
+                          3,
+                          "The retransmissions were not blocked by the duty cycle");
+
+    // Each retransmission is postponed when the second receive window closes,
+    // and the PHY goes to sleep, after the previous transmission
+    Time expectedBlocked = Seconds(0);
+    for (std::size_t i = 1; i < m_sendTimes.size(); i++)
+    {
+        Time postponed = Seconds(0);
+        for (Time sleep : m_sleepTimes)
+        {
+            if (sleep > m_sendTimes[i - 1] && sleep <= m_sendTimes[i])
+            {
+                postponed = sleep;
+            }
+        }
+        NS_TEST_ASSERT_MSG_GT(postponed, m_sendTimes[i - 1], "No receive windows closed");
+        expectedBlocked += m_sendTimes[i] - postponed;
+    }
+    NS_TEST_EXPECT_MSG_EQ(mac->GetTimeBlockedByDutyCycle(),
+                          expectedBlocked,
+                          "Wrong time blocked by the duty cycle");
+
+    // The US region has no duty cycle: the retransmissions only wait for the
+    // ACK_TIMEOUT, and are not counted
+    mac = RunConfirmed(LorawanMacHelper::US);
+    NS_TEST_ASSERT_MSG_EQ(m_sendTimes.size(), 4, "Wrong number of transmissions");
+    NS_TEST_EXPECT_MSG_GT(m_sendTimes[1] - m_sendTimes[0],
+                          Seconds(3),
+                          "The retransmission did not wait for the ACK_TIMEOUT");
+    NS_TEST_EXPECT_MSG_EQ(mac->GetNDeferredTransmissions(),
+                          0,
+                          "The ACK_TIMEOUT was counted as a deferral");
+    NS_TEST_EXPECT_MSG_EQ(mac->GetTimeBlockedByDutyCycle(),
+                          Seconds(0),
+                          "The ACK_TIMEOUT was counted as blocked time");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests the ordering and the batching of the calendar queue of the
+ * FleetTrafficScheduler, across the wrap of its buckets and a resize
+ */
+class CalendarQueueTest : public TestCase
+{
+  public:
+    CalendarQueueTest();           //!< Default constructor
+    ~CalendarQueueTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+CalendarQueueTest::CalendarQueueTest()
+    : TestCase("Verify that the calendar queue pops the entries in batches of increasing time")
+{
+}
+
+// Reminder that the test case should clean up after itself
+CalendarQueueTest::~CalendarQueueTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+CalendarQueueTest::DoRun()
+{
+    NS_LOG_DEBUG("CalendarQueueTest");
+
+    // Four buckets of width 10, i.e., a year of 40 time steps
+    FleetTrafficScheduler::CalendarQueue queue;
+    queue.Initialize(4, 10);
+    NS_TEST_ASSERT_MSG_EQ(queue.IsEmpty(), true, "The new queue is not empty");
+    queue.Insert(5, 2);
+    queue.Insert(47, 1);
+    queue.Insert(13, 3);
+    queue.Insert(200, 4);
+    queue.Insert(5, 0);
+    queue.Insert(13, 5);
+
+    // Entries of the same time are popped together, in the order of the devices
+    std::vector<uint32_t> devices;
+    NS_TEST_EXPECT_MSG_EQ(queue.PeekMin(), 5, "Wrong earliest time");
+    NS_TEST_EXPECT_MSG_EQ(queue.PopBatch(devices), 5, "Wrong time of the first batch");
+    NS_TEST_EXPECT_MSG_EQ(devices.size(), 2, "Wrong size of the first batch");
+    NS_TEST_EXPECT_MSG_EQ(devices[0], 0, "Wrong order of the first batch");
+    NS_TEST_EXPECT_MSG_EQ(devices[1], 2, "Wrong order of the first batch");
+    NS_TEST_EXPECT_MSG_EQ(queue.PopBatch(devices), 13, "Wrong time of the second batch");
+    NS_TEST_EXPECT_MSG_EQ(devices.size(), 2, "Wrong size of the second batch");
+    NS_TEST_EXPECT_MSG_EQ(devices[0], 3, "Wrong order of the second batch");
+    NS_TEST_EXPECT_MSG_EQ(devices[1], 5, "Wrong order of the second batch");
+
+    // 45 wraps to the bucket of 5, and 47 and 200 share it: only the entries
+    // of the current year are considered
+    queue.Insert(45, 6);
+    NS_TEST_EXPECT_MSG_EQ(queue.PopBatch(devices), 45, "Wrong time after the wrap");
+    NS_TEST_EXPECT_MSG_EQ(devices.size(), 1, "Wrong size of the batch after the wrap");
+    NS_TEST_EXPECT_MSG_EQ(devices[0], 6, "Wrong device after the wrap");
+
+    // Resizing keeps the entries left, and the ones inserted next
+    queue.Initialize(8, 5);
+    queue.Insert(60, 7);
+    queue.Insert(47, 8);
+    NS_TEST_EXPECT_MSG_EQ(queue.PopBatch(devices), 47, "Wrong time after the resize");
+    NS_TEST_EXPECT_MSG_EQ(devices.size(), 2, "Wrong size of the batch after the resize");
+    NS_TEST_EXPECT_MSG_EQ(devices[0], 1, "Wrong order of the batch after the resize");
+    NS_TEST_EXPECT_MSG_EQ(devices[1], 8, "Wrong order of the batch after the resize");
+    NS_TEST_EXPECT_MSG_EQ(queue.PopBatch(devices), 60, "Wrong time of the inserted entry");
+    NS_TEST_EXPECT_MSG_EQ(devices[0], 7, "Wrong device of the inserted entry");
+
+    // 200 is more than a year ahead, so the scan jumps to it
+    NS_TEST_EXPECT_MSG_EQ(queue.PopBatch(devices), 200, "Wrong time of the last entry");
+    NS_TEST_EXPECT_MSG_EQ(devices[0], 4, "Wrong device of the last entry");
+    NS_TEST_EXPECT_MSG_EQ(queue.IsEmpty(), true, "The queue is not empty");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the FleetTrafficScheduler sends at the same times as one
+ * sender application per device, with the same random variable streams
+ */
+class FleetTrafficSchedulerTest : public TestCase
+{
+  public:
+    FleetTrafficSchedulerTest();           //!< Default constructor
+    ~FleetTrafficSchedulerTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Create the end devices, and connect to their StartSending trace sources.
+     *
+     * \return The end devices.
+     */
+    NodeContainer CreateDevices();
+
+    /**
+     * Run the simulation, and get the send times of each device.
+     *
+     * \param stop The duration of the simulation.
+     * \return The send times of each device, by index of the device.
+     */
+    std::vector<std::vector<Time>> Run(Time stop);
+
+    /**
+     * Callback for the StartSending trace source of the devices.
+     *
+     * \param packet The packet being sent.
+     * \param node The id of the sender node.
+     */
+    void StartSending(Ptr<const Packet> packet, uint32_t node);
+
+    uint32_t m_firstNodeId;                     //!< The node id of the first device
+    std::vector<std::vector<Time>> m_sendTimes; //!< The send times of each device
+};
+
+// Add some help text to this case to describe what it is intended to test
+FleetTrafficSchedulerTest::FleetTrafficSchedulerTest()
+    : TestCase("Verify that the FleetTrafficScheduler sends like the sender applications"),
+      m_firstNodeId(0)
+{
+}
+
+// Reminder that the test case should clean up after itself
+FleetTrafficSchedulerTest::~FleetTrafficSchedulerTest()
+{
+}
+
+void
+FleetTrafficSchedulerTest::StartSending(Ptr<const Packet> packet, uint32_t node)
+{
+    m_sendTimes[node - m_firstNodeId].push_back(Simulator::Now());
+}
+
+NodeContainer
+FleetTrafficSchedulerTest::CreateDevices()
+{
+    const uint32_t nDevices = 10;
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(nDevices, mobility, channel);
+
+    // Use the shortest time on air, so that the duty cycle does not postpone
+    // the packets
+    m_firstNodeId = endDevices.Get(0)->GetId();
+    m_sendTimes.assign(nDevices, std::vector<Time>());
+    for (uint32_t i = 0; i < nDevices; i++)
+    {
+        Ptr<LoraNetDevice> device = endDevices.Get(i)->GetDevice(0)->GetObject<LoraNetDevice>();
+        device->GetMac()->GetObject<EndDeviceLorawanMac>()->SetDataRate(5);
+        device->GetPhy()->TraceConnectWithoutContext(
+            "StartSending",
+            MakeCallback(&FleetTrafficSchedulerTest::StartSending, this));
+    }
+    return endDevices;
+}
+
+std::vector<std::vector<Time>>
+FleetTrafficSchedulerTest::Run(Time stop)
+{
+    Simulator::Stop(stop);
+    Simulator::Run();
+    Simulator::Destroy();
+    return m_sendTimes;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+FleetTrafficSchedulerTest::DoRun()
+{
+    NS_LOG_DEBUG("FleetTrafficSchedulerTest");
+
+    // Periodic traffic: the PeriodicSenderHelper and the scheduler are created
+    // first, so that their initial delays get the same automatic stream
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+    RngSeedManager::ResetNextStreamIndex();
+    PeriodicSenderHelper periodicHelper;
+    periodicHelper.SetPeriod(Seconds(600));
+    NodeContainer endDevices = CreateDevices();
+    periodicHelper.Install(endDevices).Start(Seconds(0));
+    std::vector<std::vector<Time>> applicationTimes = Run(Seconds(3000));
+
+    RngSeedManager::ResetNextStreamIndex();
+    Ptr<FleetTrafficScheduler> scheduler = CreateObject<FleetTrafficScheduler>();
+    scheduler->SetAttribute("MeanInterval", TimeValue(Seconds(600)));
+    endDevices = CreateDevices();
+    scheduler->AddDevices(endDevices);
+    scheduler->Start(Seconds(0));
+    std::vector<std::vector<Time>> fleetTimes = Run(Seconds(3000));
+
+    for (uint32_t i = 0; i < fleetTimes.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(fleetTimes[i].size(),
+                              applicationTimes[i].size(),
+                              "Wrong number of periodic packets of device " << i);
+        for (uint32_t j = 0; j < std::min(fleetTimes[i].size(), applicationTimes[i].size()); j++)
+        {
+            NS_TEST_EXPECT_MSG_EQ(fleetTimes[i][j],
+                                  applicationTimes[i][j],
+                                  "Wrong periodic send time " << j << " of device " << i);
+        }
+    }
+
+    // Exponential traffic: with the same streams, the inter-arrival times are
+    // those of the RandomSender applications, but not the initial delays
+    const int64_t stream = 100;
+    const int mean = 86400;
+    RandomSenderHelper randomHelper;
+    randomHelper.SetMean(mean);
+    endDevices = CreateDevices();
+    ApplicationContainer apps = randomHelper.Install(endDevices);
+    for (uint32_t i = 0; i < apps.GetN(); i++)
+    {
+        DynamicCast<RandomSender>(apps.Get(i))->AssignStreams(stream + 1 + i);
+    }
+    apps.Start(Seconds(0));
+    applicationTimes = Run(Days(30));
+
+    scheduler = CreateObject<FleetTrafficScheduler>();
+    scheduler->SetAttribute("Distribution", EnumValue(FleetTrafficScheduler::EXPONENTIAL));
+    scheduler->SetAttribute("MeanInterval", TimeValue(Seconds(mean)));
+    endDevices = CreateDevices();
+    scheduler->AddDevices(endDevices);
+    scheduler->AssignStreams(stream);
+    scheduler->Start(Seconds(0));
+    fleetTimes = Run(Days(30));
+
+    const uint32_t nIntervals = 3;
+    for (uint32_t i = 0; i < fleetTimes.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_GT(fleetTimes[i].size(), nIntervals, "Too few packets of the fleet");
+        NS_TEST_ASSERT_MSG_GT(applicationTimes[i].size(), nIntervals, "Too few packets");
+        for (uint32_t j = 1; j <= nIntervals; j++)
+        {
+            NS_TEST_EXPECT_MSG_EQ(fleetTimes[i][j] - fleetTimes[i][j - 1],
+                                  applicationTimes[i][j] - applicationTimes[i][j - 1],
+                                  "Wrong inter-arrival time " << j << " of device " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the LoraFleetEnergyTracker accounts for the energy of the
+ * devices like a LoraRadioEnergyModel with a BasicEnergySource
+ */
+class FleetEnergyTrackerTest : public TestCase
+{
+  public:
+    FleetEnergyTrackerTest();           //!< Default constructor
+    ~FleetEnergyTrackerTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for the depletion of the energy source of a device.
+     *
+     * \param index The index of the device.
+     */
+    void SourceDepleted(uint32_t index);
+
+    /**
+     * Callback for the depletion of a device detected by the tracker.
+     *
+     * \param nodeId The id of the node of the device.
+     */
+    void TrackerDepleted(uint32_t nodeId);
+
+    /**
+     * Compare the energy of the devices in the tracker and in their sources.
+     *
+     * \param tracker The tracker.
+     * \param endDevices The end devices.
+     * \param sources The energy sources of the devices.
+     */
+    void CompareEnergy(const LoraFleetEnergyTracker* tracker,
+                       NodeContainer endDevices,
+                       EnergySourceContainer sources);
+
+    std::map<uint32_t, Time> m_sourceDepletion;  //!< The depletion times of the sources
+    std::map<uint32_t, Time> m_trackerDepletion; //!< The depletion times of the tracker
+};
+
+// Add some help text to this case to describe what it is intended to test
+FleetEnergyTrackerTest::FleetEnergyTrackerTest()
+    : TestCase("Verify that the LoraFleetEnergyTracker matches the LoraRadioEnergyModel")
+{
+}
+
+// Reminder that the test case should clean up after itself
+FleetEnergyTrackerTest::~FleetEnergyTrackerTest()
+{
+}
+
+void
+FleetEnergyTrackerTest::SourceDepleted(uint32_t index)
+{
+    m_sourceDepletion[index] = Simulator::Now();
+}
+
+void
+FleetEnergyTrackerTest::TrackerDepleted(uint32_t nodeId)
+{
+    m_trackerDepletion[nodeId] = Simulator::Now();
+}
+
+void
+FleetEnergyTrackerTest::CompareEnergy(const LoraFleetEnergyTracker* tracker,
+                                      NodeContainer endDevices,
+                                      EnergySourceContainer sources)
+{
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        uint32_t nodeId = endDevices.Get(i)->GetId();
+        Ptr<EnergySource> source = sources.Get(i);
+        source->UpdateEnergySource();
+        NS_TEST_EXPECT_MSG_EQ_TOL(tracker->GetRemainingEnergy(nodeId),
+                                  source->GetRemainingEnergy(),
+                                  1e-9,
+                                  "Wrong remaining energy of device " << i << " at "
+                                                                      << Simulator::Now());
+        NS_TEST_EXPECT_MSG_EQ_TOL(tracker->GetTotalEnergyConsumption(nodeId),
+                                  source->GetInitialEnergy() - source->GetRemainingEnergy(),
+                                  1e-9,
+                                  "Wrong energy consumption of device " << i << " at "
+                                                                        << Simulator::Now());
+    }
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+FleetEnergyTrackerTest::DoRun()
+{
+    NS_LOG_DEBUG("FleetEnergyTrackerTest");
+
+    const double initialEnergyJ = 0.2;
+    const double sleepCurrentA = 0.001;
+    const Time sourceUpdateInterval = Seconds(1);
+    const Time trackerUpdateInterval = Seconds(1);
+
+    // Two devices sending a single uplink without gateways, at SF7 and SF12,
+    // then depleting their energy while they sleep
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(2, mobility, channel);
+    NetDeviceContainer netDevices;
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        netDevices.Add(endDevices.Get(i)->GetDevice(0));
+    }
+    GetMacLayerFromNode<EndDeviceLorawanMac>(endDevices.Get(0))->SetDataRate(5);
+    GetMacLayerFromNode<EndDeviceLorawanMac>(endDevices.Get(1))->SetDataRate(0);
+    OneShotSenderHelper oneShotHelper;
+    oneShotHelper.SetSendTime(Seconds(1));
+    oneShotHelper.Install(endDevices);
+
+    // Both the energy models and the tracker listen to the same PHY layers
+    Ptr<ConstantLoraTxCurrentModel> txCurrentModel = CreateObject<ConstantLoraTxCurrentModel>();
+    BasicEnergySourceHelper sourceHelper;
+    sourceHelper.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(initialEnergyJ));
+    sourceHelper.Set("BasicEnergySupplyVoltageV", DoubleValue(3.3));
+    sourceHelper.Set("BasicEnergyLowBatteryThreshold", DoubleValue(0));
+    sourceHelper.Set("PeriodicEnergyUpdateInterval", TimeValue(sourceUpdateInterval));
+    LoraRadioEnergyModelHelper radioEnergyHelper;
+    radioEnergyHelper.Set("SleepCurrentA", DoubleValue(sleepCurrentA));
+    radioEnergyHelper.SetTxCurrentModel(txCurrentModel);
+    EnergySourceContainer sources = sourceHelper.Install(endDevices);
+    DeviceEnergyModelContainer models = radioEnergyHelper.Install(netDevices, sources);
+    for (uint32_t i = 0; i < models.GetN(); i++)
+    {
+        DynamicCast<LoraRadioEnergyModel>(models.Get(i))
+            ->SetEnergyDepletionCallback(
+                MakeCallback(&FleetEnergyTrackerTest::SourceDepleted, this).Bind(i));
+    }
+
+    LoraFleetEnergyTracker tracker;
+    tracker.SetInitialEnergy(initialEnergyJ);
+    tracker.SetSupplyVoltage(3.3);
+    tracker.SetCurrents(0.0112, 0.0014, sleepCurrentA);
+    tracker.SetTxCurrentModel(txCurrentModel);
+    tracker.SetUpdateInterval(trackerUpdateInterval);
+    tracker.SetDepletionCallback(MakeCallback(&FleetEnergyTrackerTest::TrackerDepleted, this));
+    tracker.Install(endDevices);
+
+    // Before the uplinks, after them, and after the depletion of the devices
+    for (Time time : {Seconds(0.5), Seconds(10), Seconds(200)})
+    {
+        Simulator::Schedule(time,
+                            &FleetEnergyTrackerTest::CompareEnergy,
+                            this,
+                            &tracker,
+                            endDevices,
+                            sources);
+    }
+    Simulator::Stop(Seconds(300));
+    Simulator::Run();
+
+    // The tracker finds the exact depletion time, which the source detects
+    // at its next update, and the tracker itself at its next update
+    NS_TEST_EXPECT_MSG_EQ(tracker.GetNDepleted(), 2, "Wrong number of depleted devices");
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        uint32_t nodeId = endDevices.Get(i)->GetId();
+        Time depletion = tracker.GetDepletionTime(nodeId);
+        NS_TEST_ASSERT_MSG_EQ(m_sourceDepletion.count(i), 1, "The source did not deplete");
+        NS_TEST_ASSERT_MSG_EQ(m_trackerDepletion.count(nodeId), 1, "No depletion callback");
+        NS_TEST_EXPECT_MSG_GT(depletion, Seconds(10), "The device did not deplete in sleep");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(m_sourceDepletion[i], depletion, "Early source depletion");
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(m_sourceDepletion[i],
+                                    depletion + sourceUpdateInterval,
+                                    "Wrong depletion time of the source of device " << i);
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(m_trackerDepletion[nodeId], depletion, "Early callback");
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(m_trackerDepletion[nodeId],
+                                    depletion + trackerUpdateInterval,
+                                    "Late depletion callback of device " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ_TOL(tracker.GetFleetEnergyConsumption(),
+                              2 * initialEnergyJ,
+                              1e-9,
+                              "The devices did not consume all their energy");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the LoraRadioEnergyModel accounts for the same energy with
+ * and without LazyAccounting
+ */
+class LazyEnergyAccountingTest : public TestCase
+{
+  public:
+    LazyEnergyAccountingTest();           //!< Default constructor
+    ~LazyEnergyAccountingTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for the EndDeviceState trace source of the eager device,
+     * comparing the models once both devices changed their state.
+     *
+     * \param oldState The previous state of the PHY.
+     * \param newState The new state of the PHY.
+     */
+    void StateChanged(EndDeviceLoraPhy::State oldState, EndDeviceLoraPhy::State newState);
+
+    /**
+     * Compare the energy consumption and the state durations of the models.
+     *
+     * \param compareConsumption Whether to compare the energy consumption,
+     * which the eager model only updates at state changes.
+     */
+    void Compare(bool compareConsumption);
+
+    /**
+     * Callback for the depletion of the energy source of a device.
+     *
+     * \param index The index of the device: 0 for eager, 1 for lazy.
+     */
+    void Depleted(uint32_t index);
+
+    Ptr<LoraRadioEnergyModel> m_eager; //!< The model with eager accounting
+    Ptr<LoraRadioEnergyModel> m_lazy;  //!< The model with lazy accounting
+    Time m_depletion[2];               //!< The depletion times of the devices
+    uint32_t m_nComparisons;           //!< The number of comparisons at state changes
+};
+
+// Add some help text to this case to describe what it is intended to test
+LazyEnergyAccountingTest::LazyEnergyAccountingTest()
+    : TestCase("Verify that lazy energy accounting matches eager accounting"),
+      m_depletion{Time::Max(), Time::Max()},
+      m_nComparisons(0)
+{
+}
+
+// Reminder that the test case should clean up after itself
+LazyEnergyAccountingTest::~LazyEnergyAccountingTest()
+{
+}
+
+void
+LazyEnergyAccountingTest::StateChanged(EndDeviceLoraPhy::State oldState,
+                                       EndDeviceLoraPhy::State newState)
+{
+    // The trace source fires before the listeners are notified, and the lazy
+    // device changes its state in a later event at the same time
+    Simulator::ScheduleNow(&LazyEnergyAccountingTest::Compare, this, true);
+}
+
+void
+LazyEnergyAccountingTest::Compare(bool compareConsumption)
+{
+    if (compareConsumption)
+    {
+        m_nComparisons++;
+        NS_TEST_EXPECT_MSG_EQ_TOL(m_lazy->GetTotalEnergyConsumption(),
+                                  m_eager->GetTotalEnergyConsumption(),
+                                  1e-12,
+                                  "Wrong energy consumption at " << Simulator::Now());
+    }
+    for (auto state : {EndDeviceLoraPhy::SLEEP,
+                       EndDeviceLoraPhy::TX,
+                       EndDeviceLoraPhy::RX,
+                       EndDeviceLoraPhy::STANDBY})
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_lazy->GetStateDuration(state),
+                              m_eager->GetStateDuration(state),
+                              "Wrong duration of state " << state << " at " << Simulator::Now());
+    }
+}
+
+void
+LazyEnergyAccountingTest::Depleted(uint32_t index)
+{
+    if (m_depletion[index] == Time::Max())
+    {
+        m_depletion[index] = Simulator::Now();
+    }
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+LazyEnergyAccountingTest::DoRun()
+{
+    NS_LOG_DEBUG("LazyEnergyAccountingTest");
+
+    const double initialEnergyJ = 0.2;
+    const Time depletionResolution = Seconds(1);
+
+    // Two devices sending the same uplink at the same time, without gateways,
+    // then depleting their energy while they sleep
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(2, mobility, channel);
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        GetMacLayerFromNode<EndDeviceLorawanMac>(endDevices.Get(i))->SetDataRate(5);
+    }
+    OneShotSenderHelper oneShotHelper;
+    oneShotHelper.SetSendTime(Seconds(1));
+    oneShotHelper.Install(endDevices);
+
+    // The eager source is updated often, so that it detects the depletion
+    // almost at once, and the lazy one too rarely to detect it
+    BasicEnergySourceHelper sourceHelper;
+    sourceHelper.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(initialEnergyJ));
+    sourceHelper.Set("BasicEnergyLowBatteryThreshold", DoubleValue(0));
+    sourceHelper.Set("PeriodicEnergyUpdateInterval", TimeValue(MilliSeconds(10)));
+    EnergySourceContainer sources = sourceHelper.Install(endDevices.Get(0));
+    sourceHelper.Set("PeriodicEnergyUpdateInterval", TimeValue(Hours(1)));
+    sources.Add(sourceHelper.Install(endDevices.Get(1)));
+
+    LoraRadioEnergyModelHelper radioEnergyHelper;
+    radioEnergyHelper.Set("SleepCurrentA", DoubleValue(0.001));
+    m_eager = DynamicCast<LoraRadioEnergyModel>(
+        radioEnergyHelper.Install(endDevices.Get(0)->GetDevice(0), sources.Get(0)).Get(0));
+    radioEnergyHelper.Set("LazyAccounting", BooleanValue(true));
+    radioEnergyHelper.Set("DepletionResolution", TimeValue(depletionResolution));
+    m_lazy = DynamicCast<LoraRadioEnergyModel>(
+        radioEnergyHelper.Install(endDevices.Get(1)->GetDevice(0), sources.Get(1)).Get(0));
+    m_eager->SetEnergyDepletionCallback(
+        MakeCallback(&LazyEnergyAccountingTest::Depleted, this).Bind(0));
+    m_lazy->SetEnergyDepletionCallback(
+        MakeCallback(&LazyEnergyAccountingTest::Depleted, this).Bind(1));
+
+    Ptr<LoraPhy> phy = endDevices.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+    phy->TraceConnectWithoutContext(
+        "EndDeviceState",
+        MakeCallback(&LazyEnergyAccountingTest::StateChanged, this));
+    Simulator::Schedule(Seconds(30), &LazyEnergyAccountingTest::Compare, this, false);
+
+    Simulator::Stop(Seconds(300));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_GT(m_nComparisons, 0, "The devices did not change their state");
+    NS_TEST_ASSERT_MSG_NE(m_depletion[0], Time::Max(), "The eager device did not deplete");
+    NS_TEST_ASSERT_MSG_NE(m_depletion[1], Time::Max(), "The lazy device did not deplete");
+    NS_TEST_EXPECT_MSG_GT(m_depletion[0], Seconds(30), "The device did not deplete in sleep");
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(Abs(m_depletion[1] - m_depletion[0]),
+                                depletionResolution,
+                                "The lazy depletion is not within the resolution");
+
+    m_eager = nullptr;
+    m_lazy = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that Class C end devices keep listening with the second receive
+ * window parameters, and postpone the uplinks sent during a reception
+ */
+class ClassCEndDeviceTest : public TestCase
+{
+  public:
+    ClassCEndDeviceTest();           //!< Default constructor
+    ~ClassCEndDeviceTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for the EndDeviceState trace source of the device.
+     *
+     * \param oldState The previous state of the PHY.
+     * \param newState The new state of the PHY.
+     */
+    void StateChanged(EndDeviceLoraPhy::State oldState, EndDeviceLoraPhy::State newState);
+
+    /**
+     * Callback for the StartSending trace source of the device.
+     *
+     * \param packet The packet being sent.
+     * \param nodeId The id of the sending node.
+     */
+    void StartSending(Ptr<const Packet> packet, uint32_t nodeId);
+
+    /**
+     * Callback for the ReceivedMulticast trace source of the device.
+     *
+     * \param packet The received packet.
+     * \param groupAddress The multicast address the packet was sent to.
+     * \param fCnt The frame counter of the downlink.
+     */
+    void ReceivedMulticast(Ptr<const Packet> packet, LoraDeviceAddress groupAddress, uint16_t fCnt);
+
+    /**
+     * Check that the device is listening with the second receive window
+     * parameters.
+     */
+    void CheckListening();
+
+    /**
+     * Send an uplink while the PHY is receiving.
+     */
+    void SendDuringReception();
+
+    /**
+     * Check that the PHY is still receiving.
+     */
+    void CheckReceiving();
+
+    Ptr<ClassCEndDeviceLorawanMac> m_mac; //!< The MAC layer of the device
+    Ptr<EndDeviceLoraPhy> m_phy;          //!< The PHY layer of the device
+    uint32_t m_nSleeps;                   //!< The number of times the PHY went to sleep
+    std::vector<Time> m_sendTimes;        //!< The times the device started sending
+    std::vector<Time> m_receiveTimes;     //!< The times the device received a multicast downlink
+};
+
+// Add some help text to this case to describe what it is intended to test
+ClassCEndDeviceTest::ClassCEndDeviceTest()
+    : TestCase("Verify the continuous reception of Class C end devices"),
+      m_nSleeps(0)
+{
+}
+
+// Reminder that the test case should clean up after itself
+ClassCEndDeviceTest::~ClassCEndDeviceTest()
+{
+}
+
+void
+ClassCEndDeviceTest::StateChanged(EndDeviceLoraPhy::State oldState,
+                                  EndDeviceLoraPhy::State newState)
+{
+    if (newState == EndDeviceLoraPhy::SLEEP)
+    {
+        m_nSleeps++;
+    }
+}
+
+void
+ClassCEndDeviceTest::StartSending(Ptr<const Packet> packet, uint32_t nodeId)
+{
+    m_sendTimes.push_back(Simulator::Now());
+}
+
+void
+ClassCEndDeviceTest::ReceivedMulticast(Ptr<const Packet> packet,
+                                       LoraDeviceAddress groupAddress,
+                                       uint16_t fCnt)
+{
+    m_receiveTimes.push_back(Simulator::Now());
+}
+
+void
+ClassCEndDeviceTest::CheckListening()
+{
+    NS_TEST_EXPECT_MSG_EQ(m_phy->GetState(),
+                          EndDeviceLoraPhy::STANDBY,
+                          "The device is not listening at " << Simulator::Now());
+    NS_TEST_EXPECT_MSG_EQ(m_phy->IsOnFrequency(m_mac->GetSecondReceiveWindowFrequency()),
+                          true,
+                          "The device is not on the second receive window frequency");
+    NS_TEST_EXPECT_MSG_EQ(
+        unsigned(m_phy->GetSpreadingFactor()),
+        unsigned(m_mac->GetSfFromDataRate(m_mac->GetSecondReceiveWindowDataRate())),
+        "The device is not on the second receive window spreading factor");
+}
+
+void
+ClassCEndDeviceTest::SendDuringReception()
+{
+    NS_TEST_EXPECT_MSG_EQ(m_phy->GetState(), EndDeviceLoraPhy::RX, "The device is not receiving");
+    m_mac->Send(Create<Packet>(10));
+}
+
+void
+ClassCEndDeviceTest::CheckReceiving()
+{
+    NS_TEST_EXPECT_MSG_EQ(m_phy->GetState(),
+                          EndDeviceLoraPhy::RX,
+                          "The reception was interrupted at " << Simulator::Now());
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+ClassCEndDeviceTest::DoRun()
+{
+    NS_LOG_DEBUG("ClassCEndDeviceTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices;
+    endDevices.Create(1);
+    mobility.Install(endDevices);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    LorawanMacHelper macHelper;
+    macHelper.SetDeviceType(LorawanMacHelper::ED_C);
+    LoraHelper helper;
+    helper.Install(phyHelper, macHelper, endDevices);
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+
+    // Use the shortest time on air, so that the duty cycle does not postpone
+    // the second uplink
+    Ptr<LoraNetDevice> device = endDevices.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>();
+    m_mac = device->GetMac()->GetObject<ClassCEndDeviceLorawanMac>();
+    m_phy = device->GetPhy()->GetObject<EndDeviceLoraPhy>();
+    m_mac->SetDataRate(5);
+    LoraDeviceAddress groupAddress(uint8_t(54), uint32_t(0x1ffffff));
+    m_mac->AddMulticastAddress(groupAddress);
+    m_phy->TraceConnectWithoutContext("EndDeviceState",
+                                      MakeCallback(&ClassCEndDeviceTest::StateChanged, this));
+    m_phy->TraceConnectWithoutContext("StartSending",
+                                      MakeCallback(&ClassCEndDeviceTest::StartSending, this));
+    m_mac->TraceConnectWithoutContext("ReceivedMulticast",
+                                      MakeCallback(&ClassCEndDeviceTest::ReceivedMulticast, this));
+
+    // The device listens from the start, stands by after the uplink instead of
+    // sleeping, and goes back to the second window parameters after the first
+    // receive window
+    Simulator::Schedule(Seconds(0.5), &ClassCEndDeviceTest::CheckListening, this);
+    Simulator::Schedule(Seconds(1), [this]() { m_mac->Send(Create<Packet>(10)); });
+    Simulator::Schedule(Seconds(1.5), &ClassCEndDeviceTest::CheckListening, this);
+    Simulator::Schedule(Seconds(2.5), &ClassCEndDeviceTest::CheckListening, this);
+    Simulator::Schedule(Seconds(10), &ClassCEndDeviceTest::CheckListening, this);
+
+    // A multicast downlink in the second receive window parameters, during
+    // which the device tries to send an uplink
+    Ptr<Packet> downlink = Create<Packet>(10);
+    LoraFrameHeader fHdr;
+    fHdr.SetAsDownlink();
+    fHdr.SetAddress(groupAddress);
+    downlink->AddHeader(fHdr);
+    LorawanMacHeader mHdr;
+    mHdr.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+    downlink->AddHeader(mHdr);
+
+    LoraTxParameters txParams;
+    txParams.sf = m_mac->GetSfFromDataRate(m_mac->GetSecondReceiveWindowDataRate());
+    txParams.headerDisabled = false;
+    txParams.codingRate = 1;
+    txParams.bandwidthHz = 125000;
+    txParams.nPreamble = 8;
+    txParams.crcEnabled = true;
+    txParams.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(txParams) > MilliSeconds(16);
+
+    Ptr<LoraPhy> gwPhy = gateways.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+    Simulator::Schedule(Seconds(20),
+                        &LoraPhy::Send,
+                        gwPhy,
+                        downlink,
+                        txParams,
+                        m_mac->GetSecondReceiveWindowFrequency(),
+                        14.0);
+    Simulator::Schedule(Seconds(20.5), &ClassCEndDeviceTest::SendDuringReception, this);
+    Simulator::Schedule(Seconds(30), &ClassCEndDeviceTest::CheckListening, this);
+
+    // A multicast downlink that starts after an uplink and lasts over the
+    // opening of the first receive window (about 1.06 s after the uplink,
+    // while the downlink lasts more than 1 s): the window must not interrupt
+    // it, and the device keeps listening afterwards
+    Simulator::Schedule(Seconds(40), [this]() { m_mac->Send(Create<Packet>(10)); });
+    Simulator::Schedule(Seconds(40.5),
+                        &LoraPhy::Send,
+                        gwPhy,
+                        downlink->Copy(),
+                        txParams,
+                        m_mac->GetSecondReceiveWindowFrequency(),
+                        14.0);
+    Simulator::Schedule(Seconds(41.2), &ClassCEndDeviceTest::CheckReceiving, this);
+    Simulator::Schedule(Seconds(45), &ClassCEndDeviceTest::CheckListening, this);
+
+    Simulator::Stop(Seconds(50));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(m_nSleeps, 0, "The device went to sleep");
+    NS_TEST_ASSERT_MSG_EQ(m_receiveTimes.size(), 2, "The multicast downlinks were not received");
+    NS_TEST_ASSERT_MSG_EQ(m_sendTimes.size(), 3, "Wrong number of uplinks");
+    NS_TEST_EXPECT_MSG_EQ(m_sendTimes[0], Seconds(1), "Wrong time of the first uplink");
+    NS_TEST_EXPECT_MSG_GT(m_receiveTimes[0], Seconds(20.5), "The downlink ended too early");
+    NS_TEST_EXPECT_MSG_EQ(m_sendTimes[1],
+                          m_receiveTimes[0],
+                          "The uplink was not sent at the end of the reception");
+    NS_TEST_EXPECT_MSG_GT(m_receiveTimes[1],
+                          Seconds(41.2),
+                          "The downlink over the first receive window ended too early");
+
+    m_mac = nullptr;
+    m_phy = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests the ping slot arithmetic of the Class B beacon timeline, and the
+ * ping slot the network server picks for a Class B downlink
+ */
+class ClassBPingSlotTest : public TestCase
+{
+  public:
+    ClassBPingSlotTest();           //!< Default constructor
+    ~ClassBPingSlotTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check the ping slots of a device over the first two beacon periods.
+     *
+     * \param timeline The beacon timeline.
+     * \param address The address of the device.
+     * \param periodicity The ping slot periodicity of the device.
+     */
+    void CheckPingSlots(Ptr<ClassBBeaconTimeline> timeline,
+                        LoraDeviceAddress address,
+                        uint8_t periodicity);
+
+    /**
+     * Check that the timeline performs the actions registered for ping slots.
+     */
+    void CheckPingSlotActions();
+
+    /**
+     * Check that a Class B downlink is sent in the next ping slot of the
+     * device, which opens it.
+     */
+    void CheckNetworkServerSlot();
+
+    /**
+     * Record the time of an action registered for a ping slot.
+     *
+     * \param index The index of the action.
+     */
+    void PingSlotAction(uint32_t index);
+
+    /**
+     * Callback for the EndDeviceState trace source of the device.
+     *
+     * \param oldState The previous state of the PHY.
+     * \param newState The new state of the PHY.
+     */
+    void StateChanged(EndDeviceLoraPhy::State oldState, EndDeviceLoraPhy::State newState);
+
+    /**
+     * Callback for the ReceivedPacket trace source of the device.
+     *
+     * \param packet The received packet.
+     */
+    void ReceivedPacket(Ptr<const Packet> packet);
+
+    std::map<uint32_t, Time> m_actionTimes; //!< The times of the ping slot actions
+    std::vector<Time> m_standbyTimes;       //!< The times the PHY switched to standby
+    std::vector<Time> m_receiveTimes;       //!< The times the MAC received a downlink
+};
+
+// Add some help text to this case to describe what it is intended to test
+ClassBPingSlotTest::ClassBPingSlotTest()
+    : TestCase("Verify the Class B ping slot timeline")
+{
+}
+
+// Reminder that the test case should clean up after itself
+ClassBPingSlotTest::~ClassBPingSlotTest()
+{
+}
+
+void
+ClassBPingSlotTest::CheckPingSlots(Ptr<ClassBBeaconTimeline> timeline,
+                                   LoraDeviceAddress address,
+                                   uint8_t periodicity)
+{
+    // pingNb = 2^(7 - p) slots per beacon period, one every 2^(5 + p) slots
+    // of 30 ms, after the 2120 ms reserved for the beacon
+    const Time beaconPeriod = Seconds(128);
+    const Time reserved = MilliSeconds(2120);
+    const Time slotLength = MilliSeconds(30);
+    const uint32_t pingNb = 1 << (7 - periodicity);
+    const uint32_t pingPeriod = 1 << (5 + periodicity);
+    NS_TEST_ASSERT_MSG_EQ(pingNb * pingPeriod, 4096, "Wrong number of slots per beacon period");
+
+    for (uint32_t beacon = 0; beacon < 2; beacon++)
+    {
+        Time beaconStart = beaconPeriod * beacon;
+        uint32_t offset = ClassBBeaconTimeline::GetPingOffset(128 * beacon, address, pingPeriod);
+        NS_TEST_ASSERT_MSG_LT(offset, pingPeriod, "The offset is outside the ping period");
+
+        Time after = beaconStart;
+        for (uint32_t n = 0; n < pingNb; n++)
+        {
+            Time slot = timeline->GetNextPingSlot(address, periodicity, after);
+            NS_TEST_ASSERT_MSG_EQ(slot,
+                                  beaconStart + reserved + slotLength * (offset + n * pingPeriod),
+                                  "Wrong ping slot " << n << " with periodicity "
+                                                     << unsigned(periodicity));
+            NS_TEST_ASSERT_MSG_EQ(timeline->GetNextPingSlot(address, periodicity, slot),
+                                  slot,
+                                  "A ping slot starting at the given time was skipped");
+            after = slot + TimeStep(1);
+        }
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(after - TimeStep(1) + slotLength,
+                                    beaconStart + beaconPeriod,
+                                    "The last ping slot ends after the beacon period");
+    }
+}
+
+void
+ClassBPingSlotTest::PingSlotAction(uint32_t index)
+{
+    m_actionTimes[index] = Simulator::Now();
+}
+
+void
+ClassBPingSlotTest::CheckPingSlotActions()
+{
+    Ptr<ClassBBeaconTimeline> timeline = CreateObject<ClassBBeaconTimeline>();
+    LoraDeviceAddress address(uint8_t(1), uint32_t(42));
+    Time slot = timeline->GetNextPingSlot(address, 7, Seconds(0));
+    Time nextSlot = timeline->GetNextPingSlot(address, 7, slot + TimeStep(1));
+
+    m_actionTimes.clear();
+    timeline->ScheduleAtPingSlot(slot,
+                                 MakeCallback(&ClassBPingSlotTest::PingSlotAction, this).Bind(0));
+    timeline->ScheduleAtPingSlot(slot,
+                                 MakeCallback(&ClassBPingSlotTest::PingSlotAction, this).Bind(1));
+    timeline->ScheduleAtPingSlot(nextSlot,
+                                 MakeCallback(&ClassBPingSlotTest::PingSlotAction, this).Bind(2));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_actionTimes.size(), 3, "Wrong number of ping slot actions");
+    NS_TEST_EXPECT_MSG_EQ(m_actionTimes[0], slot, "Wrong time of the first action");
+    NS_TEST_EXPECT_MSG_EQ(m_actionTimes[1], slot, "Wrong time of the second action");
+    NS_TEST_EXPECT_MSG_EQ(m_actionTimes[2], nextSlot, "Wrong time of the third action");
+
+    timeline->Dispose();
+    Simulator::Destroy();
+}
+
+void
+ClassBPingSlotTest::StateChanged(EndDeviceLoraPhy::State oldState,
+                                 EndDeviceLoraPhy::State newState)
+{
+    if (newState == EndDeviceLoraPhy::STANDBY)
+    {
+        m_standbyTimes.push_back(Simulator::Now());
+    }
+}
+
+void
+ClassBPingSlotTest::ReceivedPacket(Ptr<const Packet> packet)
+{
+    m_receiveTimes.push_back(Simulator::Now());
+}
+
+void
+ClassBPingSlotTest::CheckNetworkServerSlot()
+{
+    m_standbyTimes.clear();
+    m_receiveTimes.clear();
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices;
+    endDevices.Create(1);
+    mobility.Install(endDevices);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    LorawanMacHelper macHelper;
+    macHelper.SetDeviceType(LorawanMacHelper::ED_B);
+    macHelper.SetAddressGenerator(CreateObject<LoraDeviceAddressGenerator>());
+    macHelper.Set("PingSlotPeriodicity", UintegerValue(4));
+    LoraHelper helper;
+    helper.Install(phyHelper, macHelper, endDevices);
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+    Ptr<Node> nsNode = CreateNetworkServer(endDevices, gateways);
+
+    Ptr<LoraNetDevice> device = endDevices.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>();
+    Ptr<ClassBEndDeviceLorawanMac> mac = device->GetMac()->GetObject<ClassBEndDeviceLorawanMac>();
+    device->GetPhy()->TraceConnectWithoutContext(
+        "EndDeviceState",
+        MakeCallback(&ClassBPingSlotTest::StateChanged, this));
+    mac->TraceConnectWithoutContext("ReceivedPacket",
+                                    MakeCallback(&ClassBPingSlotTest::ReceivedPacket, this));
+
+    // An uplink makes the gateway known to the network server, which then
+    // asks for a downlink once the receive windows are over
+    Simulator::Schedule(Seconds(1), [device]() { device->Send(Create<Packet>(10), Address(), 0); });
+    Ptr<NetworkScheduler> scheduler =
+        nsNode->GetApplication(0)->GetObject<NetworkServer>()->GetNetworkScheduler();
+    const Time requestTime = Seconds(10);
+    Simulator::Schedule(requestTime, [scheduler, mac]() {
+        scheduler->EnableClassB();
+        scheduler->ScheduleClassBDownlink(mac->GetDeviceAddress(), Create<Packet>(10));
+    });
+
+    Simulator::Stop(Seconds(100));
+    Simulator::Run();
+
+    // The slot following the request, skipping one starting right then
+    Time expectedSlot = scheduler->GetBeaconTimeline()->GetNextPingSlot(mac->GetDeviceAddress(),
+                                                                        4,
+                                                                        requestTime +
+                                                                            MilliSeconds(1));
+    NS_TEST_EXPECT_MSG_EQ(std::count(m_standbyTimes.begin(), m_standbyTimes.end(), expectedSlot),
+                          1,
+                          "The ping slot was not opened");
+    NS_TEST_ASSERT_MSG_EQ(m_receiveTimes.size(), 1, "The downlink was not received");
+    NS_TEST_EXPECT_MSG_GT(m_receiveTimes[0], expectedSlot, "Wrong reception time");
+    NS_TEST_EXPECT_MSG_LT(m_receiveTimes[0], expectedSlot + Seconds(1), "Wrong reception time");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetClassBDownlinkLatencies().size(),
+                          1,
+                          "The latency was not measured");
+    NS_TEST_EXPECT_MSG_EQ(scheduler->GetClassBDownlinkLatencies()[0],
+                          m_receiveTimes[0] - requestTime,
+                          "Wrong latency");
+    NS_TEST_EXPECT_MSG_EQ(scheduler->GetNFailedClassBDownlinks(), 0, "The downlink failed");
+
+    Simulator::Destroy();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+ClassBPingSlotTest::DoRun()
+{
+    NS_LOG_DEBUG("ClassBPingSlotTest");
+
+    Ptr<ClassBBeaconTimeline> timeline = CreateObject<ClassBBeaconTimeline>();
+    LoraDeviceAddress address(uint8_t(54), uint32_t(1864));
+    for (uint8_t periodicity = 0; periodicity <= 7; periodicity++)
+    {
+        CheckPingSlots(timeline, address, periodicity);
+    }
+
+    // The offset changes with the beacon time and with the device address
+    std::set<uint32_t> offsets;
+    for (uint32_t beacon = 0; beacon < 8; beacon++)
+    {
+        offsets.insert(ClassBBeaconTimeline::GetPingOffset(128 * beacon, address, 4096));
+    }
+    NS_TEST_EXPECT_MSG_GT(offsets.size(), 1, "The offset does not change with the beacon");
+    offsets.clear();
+    for (uint32_t nwkAddr = 0; nwkAddr < 8; nwkAddr++)
+    {
+        LoraDeviceAddress other(uint8_t(54), nwkAddr);
+        offsets.insert(ClassBBeaconTimeline::GetPingOffset(0, other, 4096));
+    }
+    NS_TEST_EXPECT_MSG_GT(offsets.size(), 1, "The offset does not change with the address");
+
+    CheckPingSlotActions();
+    CheckNetworkServerSlot();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the TraceReplaySender replays CSV and binary traces
+ */
+class TraceReplaySenderTest : public TestCase
+{
+  public:
+    TraceReplaySenderTest();           //!< Default constructor
+    ~TraceReplaySenderTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * An uplink sent by a device.
+     */
+    struct Uplink
+    {
+        Time time;       //!< The time the uplink was sent
+        uint32_t device; //!< The index of the device
+        uint32_t size;   //!< The size of the packet, headers included
+        bool confirmed;  //!< Whether the uplink is confirmed
+    };
+
+    /**
+     * Callback for the SentNewPacket trace source of a device.
+     *
+     * \param index The index of the device.
+     * \param packet The packet, with its headers.
+     * \param sf The spreading factor of the packet.
+     */
+    void SentNewPacket(uint32_t index, Ptr<const Packet> packet, uint8_t sf);
+
+    /**
+     * Replay a trace on two devices, starting at 1 s.
+     *
+     * \param filename The path of the trace file.
+     * \param format The format of the trace file.
+     * \param rebase Whether the first record is sent at the start of the replay.
+     * \return The sender, after the replay and before the simulator is destroyed.
+     */
+    Ptr<TraceReplaySender> Replay(std::string filename,
+                                  TraceReplaySender::Format format,
+                                  bool rebase);
+
+    /**
+     * Check the uplinks sent during the last replay.
+     *
+     * \param expected The expected uplinks, with the payload size.
+     */
+    void CheckUplinks(const std::vector<Uplink>& expected);
+
+    std::vector<Uplink> m_uplinks; //!< The uplinks sent during the last replay
+};
+
+// Add some help text to this case to describe what it is intended to test
+TraceReplaySenderTest::TraceReplaySenderTest()
+    : TestCase("Verify that the TraceReplaySender replays CSV and binary traces")
+{
+}
+
+// Reminder that the test case should clean up after itself
+TraceReplaySenderTest::~TraceReplaySenderTest()
+{
+}
+
+void
+TraceReplaySenderTest::SentNewPacket(uint32_t index, Ptr<const Packet> packet, uint8_t sf)
+{
+    Ptr<Packet> copy = packet->Copy();
+    LorawanMacHeader mHdr;
+    copy->RemoveHeader(mHdr);
+    m_uplinks.push_back({Simulator::Now(),
+                         index,
+                         packet->GetSize(),
+                         mHdr.GetMType() == LorawanMacHeader::CONFIRMED_DATA_UP});
+}
+
+Ptr<TraceReplaySender>
+TraceReplaySenderTest::Replay(std::string filename, TraceReplaySender::Format format, bool rebase)
+{
+    m_uplinks.clear();
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices = CreateEndDevices(2, mobility, channel);
+
+    // Use the shortest time on air, so that the duty cycle does not postpone
+    // the uplinks, and do not retransmit confirmed ones
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        Ptr<EndDeviceLorawanMac> mac = GetMacLayerFromNode<EndDeviceLorawanMac>(endDevices.Get(i));
+        mac->SetDataRate(5);
+        mac->SetMaxNumberOfTransmissions(1);
+        mac->TraceConnectWithoutContext(
+            "SentNewPacket",
+            MakeCallback(&TraceReplaySenderTest::SentNewPacket, this).Bind(i));
+    }
+
+    Ptr<TraceReplaySender> sender = CreateObject<TraceReplaySender>();
+    sender->SetAttribute("TraceFile", StringValue(filename));
+    sender->SetAttribute("Format", EnumValue(format));
+    sender->SetAttribute("RebaseTimestamps", BooleanValue(rebase));
+    sender->AddDevices(endDevices);
+    sender->Start(Seconds(1));
+
+    Simulator::Stop(Seconds(200));
+    Simulator::Run();
+
+    return sender;
+}
+
+void
+TraceReplaySenderTest::CheckUplinks(const std::vector<Uplink>& expected)
+{
+    NS_TEST_ASSERT_MSG_EQ(m_uplinks.size(), expected.size(), "Wrong number of uplinks");
+
+    // The headers add the same number of bytes to every uplink
+    uint32_t overhead = m_uplinks[0].size - expected[0].size;
+    NS_TEST_EXPECT_MSG_GT(overhead, 0, "The uplinks have no headers");
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_uplinks[i].time, expected[i].time, "Wrong time of uplink " << i);
+        NS_TEST_EXPECT_MSG_EQ(m_uplinks[i].device,
+                              expected[i].device,
+                              "Wrong device of uplink " << i);
+        NS_TEST_EXPECT_MSG_EQ(m_uplinks[i].size,
+                              expected[i].size + overhead,
+                              "Wrong size of uplink " << i);
+        NS_TEST_EXPECT_MSG_EQ(m_uplinks[i].confirmed,
+                              expected[i].confirmed,
+                              "Wrong message type of uplink " << i);
+    }
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+TraceReplaySenderTest::DoRun()
+{
+    NS_LOG_DEBUG("TraceReplaySenderTest");
+
+    // A CSV trace with a header, a comment, an empty line, a CRLF line
+    // ending, four malformed records (among which trailing garbage and an
+    // extra column) and no newline at the end of the last record
+    std::string csvFilename = CreateTempDirFilename("lorawan-replay-trace.csv");
+    std::ofstream csv(csvFilename);
+    csv << "deviceId,timestamp,size,confirmed\n"
+        << "# A comment\n"
+        << "0,100.5,10,0\n"
+        << "1,101,20,1\n"
+        << "\n"
+        << "2,soon,30,0\n"
+        << "3,130.25,15,0\r\n"
+        << "1,140,25\n"
+        << "2,150,20,1xyz\n"
+        << "3,160,20,0,7\n"
+        << "0,190,5,1";
+    csv.close();
+
+    // The first record is sent at the start of the replay, and devices are
+    // picked by id modulo the number of devices
+    Ptr<TraceReplaySender> sender = Replay(csvFilename, TraceReplaySender::CSV, true);
+    CheckUplinks({{Seconds(1), 0, 10, false},
+                  {Seconds(1.5), 1, 20, true},
+                  {Seconds(30.75), 1, 15, false},
+                  {Seconds(90.5), 0, 5, true}});
+    NS_TEST_EXPECT_MSG_EQ(sender->GetNSentPackets(), 4, "Wrong number of sent packets");
+    NS_TEST_EXPECT_MSG_EQ(sender->GetNMalformedRecords(), 4, "Wrong number of malformed records");
+    Simulator::Destroy();
+
+    // A binary trace of little endian 15-byte records, ending with a
+    // truncated one
+    std::string binaryFilename = CreateTempDirFilename("lorawan-replay-trace.bin");
+    std::ofstream binary(binaryFilename, std::ios::binary);
+    auto writeRecord =
+        [&binary](uint32_t deviceId, uint64_t timestampUs, uint16_t size, uint8_t confirmed) {
+            for (int i = 0; i < 4; i++)
+            {
+                binary.put(static_cast<char>((deviceId >> (8 * i)) & 0xff));
+            }
+            for (int i = 0; i < 8; i++)
+            {
+                binary.put(static_cast<char>((timestampUs >> (8 * i)) & 0xff));
+            }
+            binary.put(static_cast<char>(size & 0xff));
+            binary.put(static_cast<char>(size >> 8));
+            binary.put(static_cast<char>(confirmed));
+        };
+    writeRecord(0, 5000000, 12, 0);
+    writeRecord(1, 5250000, 200, 1);
+    writeRecord(2, 65000000, 8, 0);
+    binary.write("\x01\x00\x00\x00\x00\x00\x00", 7);
+    binary.close();
+
+    // Timestamps are relative to the start of the replay
+    sender = Replay(binaryFilename, TraceReplaySender::BINARY, false);
+    CheckUplinks({{Seconds(6), 0, 12, false},
+                  {Seconds(6.25), 1, 200, true},
+                  {Seconds(66), 0, 8, false}});
+    NS_TEST_EXPECT_MSG_EQ(sender->GetNSentPackets(), 3, "Wrong number of sent packets");
+    NS_TEST_EXPECT_MSG_EQ(sender->GetNMalformedRecords(), 1, "Wrong number of malformed records");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * An end device PHY whose state can be driven directly
+ */
+class ControlledEndDeviceLoraPhy : public SimpleEndDeviceLoraPhy
+{
+  public:
+    using EndDeviceLoraPhy::SwitchToRx;
+    using EndDeviceLoraPhy::SwitchToTx;
+};
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests the projections of the LoraLifetimeProjector on a controlled
+ * schedule of PHY states
+ */
+class LifetimeProjectorTest : public TestCase
+{
+  public:
+    LifetimeProjectorTest();           //!< Default constructor
+    ~LifetimeProjectorTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Create an end device node with a ControlledEndDeviceLoraPhy.
+     *
+     * \return The node.
+     */
+    Ptr<Node> CreateControlledEndDevice();
+};
+
+// Add some help text to this case to describe what it is intended to test
+LifetimeProjectorTest::LifetimeProjectorTest()
+    : TestCase("Verify the lifetime projections on a controlled schedule")
+{
+}
+
+// Reminder that the test case should clean up after itself
+LifetimeProjectorTest::~LifetimeProjectorTest()
+{
+}
+
+Ptr<Node>
+LifetimeProjectorTest::CreateControlledEndDevice()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<LoraNetDevice> device = CreateObject<LoraNetDevice>();
+    device->SetPhy(CreateObject<ControlledEndDeviceLoraPhy>());
+    device->SetMac(CreateObject<ClassAEndDeviceLorawanMac>());
+    node->AddDevice(device);
+    return node;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+LifetimeProjectorTest::DoRun()
+{
+    NS_LOG_DEBUG("LifetimeProjectorTest");
+
+    const double rxCurrentA = 0.01;
+    const double standbyCurrentA = 0.001;
+    const double sleepCurrentA = 0.00001;
+    const double capacityC = 1000 * 3.6;
+
+    NodeContainer endDevices;
+    for (int i = 0; i < 3; i++)
+    {
+        endDevices.Add(CreateControlledEndDevice());
+    }
+    std::vector<Ptr<ControlledEndDeviceLoraPhy>> phys;
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        phys.push_back(DynamicCast<ControlledEndDeviceLoraPhy>(
+            endDevices.Get(i)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy()));
+    }
+
+    Ptr<LoraTxCurrentModel> txCurrentModel = CreateObject<LinearLoraTxCurrentModel>();
+    LoraLifetimeProjector projector;
+    projector.SetTxCurrentModel(txCurrentModel);
+    projector.SetCurrents(rxCurrentA, standbyCurrentA, sleepCurrentA);
+    projector.SetBatteryCapacity(1000);
+    projector.Install(endDevices);
+
+    // The window starts in the future, and ends before the simulation
+    projector.SetWindow(Seconds(5), Seconds(100));
+
+    // Device 0 transmits at two powers and receives, device 1 sleeps and
+    // device 2 receives from the start
+    Ptr<ControlledEndDeviceLoraPhy> phy = phys[0];
+    Simulator::Schedule(Seconds(10), [phy]() { phy->SwitchToStandby(); });
+    Simulator::Schedule(Seconds(11), [phy]() { phy->SwitchToTx(14); });
+    Simulator::Schedule(Seconds(12), [phy]() { phy->SwitchToStandby(); });
+    Simulator::Schedule(Seconds(13), [phy]() { phy->SwitchToTx(10); });
+    Simulator::Schedule(Seconds(15), [phy]() { phy->SwitchToStandby(); });
+    Simulator::Schedule(Seconds(16), [phy]() { phy->SwitchToRx(); });
+    Simulator::Schedule(Seconds(18), [phy]() { phy->SwitchToStandby(); });
+    Simulator::Schedule(Seconds(20), [phy]() { phy->SwitchToSleep(); });
+    phy = phys[2];
+    Simulator::Schedule(Seconds(1), [phy]() { phy->SwitchToStandby(); });
+    Simulator::Schedule(Seconds(2), [phy]() { phy->SwitchToRx(); });
+
+    // Nothing is observed before the window starts
+    Simulator::Schedule(Seconds(3), [this, &projector]() {
+        for (const auto& p : projector.Project())
+        {
+            NS_TEST_EXPECT_MSG_EQ(p.sleepFraction, 0, "Time observed before the window");
+            NS_TEST_EXPECT_MSG_EQ(p.averageCurrentA, 0, "Current observed before the window");
+            NS_TEST_EXPECT_MSG_EQ(std::isinf(p.lifetimeS), true, "Finite lifetime");
+        }
+    });
+
+    Simulator::Stop(Seconds(150));
+    Simulator::Run();
+
+    std::vector<LoraLifetimeProjector::Projection> projections = projector.Project();
+    NS_TEST_ASSERT_MSG_EQ(projections.size(), 3, "Wrong number of projections");
+
+    // Device 0, over the 95 s of the window: 85 s in SLEEP, 5 s in STANDBY,
+    // 2 s in RX, and 1 s in TX at 14 dBm and 2 s at 10 dBm
+    const double windowS = 95;
+    const LoraLifetimeProjector::Projection& p = projections[0];
+    NS_TEST_EXPECT_MSG_EQ_TOL(p.txFraction, 3 / windowS, 1e-12, "Wrong TX fraction");
+    NS_TEST_EXPECT_MSG_EQ_TOL(p.rxFraction, 2 / windowS, 1e-12, "Wrong RX fraction");
+    NS_TEST_EXPECT_MSG_EQ_TOL(p.standbyFraction, 5 / windowS, 1e-12, "Wrong STANDBY fraction");
+    NS_TEST_EXPECT_MSG_EQ_TOL(p.sleepFraction, 85 / windowS, 1e-12, "Wrong SLEEP fraction");
+    NS_TEST_EXPECT_MSG_EQ(p.nTransmissions, 2, "Wrong number of transmissions");
+    NS_TEST_EXPECT_MSG_NE(txCurrentModel->CalcTxCurrent(14),
+                          txCurrentModel->CalcTxCurrent(10),
+                          "The TX current does not depend on the power");
+    double txChargeC =
+        txCurrentModel->CalcTxCurrent(14) * 1 + txCurrentModel->CalcTxCurrent(10) * 2;
+    double averageCurrentA =
+        (txChargeC + 2 * rxCurrentA + 5 * standbyCurrentA + 85 * sleepCurrentA) / windowS;
+    NS_TEST_EXPECT_MSG_EQ_TOL(p.averageCurrentA, averageCurrentA, 1e-15, "Wrong average current");
+    NS_TEST_EXPECT_MSG_EQ_TOL(p.lifetimeS / (capacityC / averageCurrentA),
+                              1,
+                              1e-12,
+                              "Wrong lifetime");
+
+    NS_TEST_EXPECT_MSG_EQ(projections[1].sleepFraction, 1, "Device 1 did not sleep");
+    NS_TEST_EXPECT_MSG_EQ_TOL(projections[1].lifetimeS / (capacityC / sleepCurrentA),
+                              1,
+                              1e-12,
+                              "Wrong lifetime of device 1");
+    NS_TEST_EXPECT_MSG_EQ(projections[2].rxFraction, 1, "Device 2 did not receive");
+    NS_TEST_EXPECT_MSG_EQ_TOL(projections[2].lifetimeS / (capacityC / rxCurrentA),
+                              1,
+                              1e-12,
+                              "Wrong lifetime of device 2");
+
+    // Device 2 drains its battery first and device 1 last
+    NS_TEST_ASSERT_MSG_LT(projections[2].lifetimeS, p.lifetimeS, "Wrong lifetime order");
+    NS_TEST_ASSERT_MSG_LT(p.lifetimeS, projections[1].lifetimeS, "Wrong lifetime order");
+    NS_TEST_EXPECT_MSG_EQ(projector.GetLifetimeQuantile(0),
+                          projections[2].lifetimeS,
+                          "Wrong minimum lifetime");
+    NS_TEST_EXPECT_MSG_EQ(projector.GetLifetimeQuantile(0.5),
+                          p.lifetimeS,
+                          "Wrong median lifetime");
+    NS_TEST_EXPECT_MSG_EQ(projector.GetLifetimeQuantile(1),
+                          projections[1].lifetimeS,
+                          "Wrong maximum lifetime");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It tests that the AlarmTrafficHelper triggers the devices within the radius
+ * of an event when it reaches them, and accounts for the delivery of their
+ * alarms
+ */
+class AlarmTrafficTest : public TestCase
+{
+  public:
+    AlarmTrafficTest();           //!< Default constructor
+    ~AlarmTrafficTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Callback for tracing StartSending.
+     *
+     * \param index The index of the end device.
+     * \param packet The packet being sent.
+     * \param nodeId The id of the sending node.
+     */
+    void StartSending(uint32_t index, Ptr<const Packet> packet, uint32_t nodeId);
+
+    std::vector<std::pair<Time, uint32_t>> m_sends; //!< The time and device of each alarm
+};
+
+// Add some help text to this case to describe what it is intended to test
+AlarmTrafficTest::AlarmTrafficTest()
+    : TestCase("Verify the triggers and the delivery accounting of alarm traffic")
+{
+}
+
+// Reminder that the test case should clean up after itself
+AlarmTrafficTest::~AlarmTrafficTest()
+{
+}
+
+void
+AlarmTrafficTest::StartSending(uint32_t index, Ptr<const Packet> packet, uint32_t nodeId)
+{
+    m_sends.emplace_back(Simulator::Now(), index);
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+AlarmTrafficTest::DoRun()
+{
+    NS_LOG_DEBUG("AlarmTrafficTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    Ptr<ListPositionAllocator> gatewayAllocator = CreateObject<ListPositionAllocator>();
+    gatewayAllocator->Add(Vector(0, 0, 15));
+    mobility.SetPositionAllocator(gatewayAllocator);
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+
+    // Out of order, so that the triggers have to be sorted: the device at
+    // 50 km is out of the range of the gateway, the one at 100 km out of the
+    // radius of the event
+    const double distances[] = {600, 100, 50000, 300, 100000};
+    Ptr<ListPositionAllocator> deviceAllocator = CreateObject<ListPositionAllocator>();
+    for (double distance : distances)
+    {
+        deviceAllocator->Add(Vector(distance, 0, 0));
+    }
+    mobility.SetPositionAllocator(deviceAllocator);
+    NodeContainer endDevices = CreateEndDevices(5, mobility, channel);
+    CreateNetworkServer(endDevices, gateways);
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        GetMacLayerFromNode<EndDeviceLorawanMac>(endDevices.Get(i))->SetDataRate(5);
+        Ptr<LoraPhy> phy = endDevices.Get(i)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+        phy->TraceConnectWithoutContext(
+            "StartSending",
+            MakeCallback(&AlarmTrafficTest::StartSending, this).Bind(i));
+    }
+
+    // The event reaches a device after distance / 100 m/s, which reacts 0.5 s
+    // later; undelivered alarms are dropped 100 s after the last trigger
+    AlarmTrafficHelper alarmHelper;
+    alarmHelper.SetPropagationSpeed(100);
+    alarmHelper.SetRadius(60000);
+    Ptr<ConstantRandomVariable> reaction = CreateObject<ConstantRandomVariable>();
+    reaction->SetAttribute("Constant", DoubleValue(0.5));
+    alarmHelper.SetReactionDelay(reaction);
+    alarmHelper.SetDeliveryTimeout(Seconds(100));
+    alarmHelper.Install(endDevices);
+    alarmHelper.MonitorGateways(gateways);
+    alarmHelper.AddEvent(Seconds(10), Vector(0, 0, 0));
+
+    // The alarms of the three devices in range are delivered before the
+    // device at 50 km is triggered, and its alarm is tracked until 100 s after
+    // its trigger, at 510.5 s
+    std::vector<uint32_t> tracked;
+    for (double t : {500.0, 520.0, 610.0, 611.0})
+    {
+        Simulator::Schedule(Seconds(t), [&tracked, &alarmHelper]() {
+            tracked.push_back(alarmHelper.GetNTrackedAlarms());
+        });
+    }
+
+    Simulator::Stop(Seconds(700));
+    Simulator::Run();
+
+    const std::vector<std::pair<Time, uint32_t>> expectedSends = {{Seconds(11.5), 1},
+                                                                  {Seconds(13.5), 3},
+                                                                  {Seconds(16.5), 0},
+                                                                  {Seconds(510.5), 2}};
+    NS_TEST_ASSERT_MSG_EQ(m_sends.size(), expectedSends.size(), "Wrong number of alarms");
+    for (uint32_t i = 0; i < m_sends.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_sends[i].first, expectedSends[i].first, "Wrong trigger time");
+        NS_TEST_EXPECT_MSG_EQ(m_sends[i].second, expectedSends[i].second, "Wrong device");
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(alarmHelper.GetBursts().size(), 1, "Wrong number of bursts");
+    const AlarmTrafficHelper::Burst& burst = alarmHelper.GetBursts()[0];
+    NS_TEST_EXPECT_MSG_EQ(burst.eventTime, Seconds(10), "Wrong event time");
+    NS_TEST_EXPECT_MSG_EQ(burst.nTriggered, 4, "Wrong number of triggered devices");
+    NS_TEST_EXPECT_MSG_EQ(burst.nDelivered, 3, "Wrong number of delivered alarms");
+    NS_TEST_EXPECT_MSG_EQ_TOL(alarmHelper.GetDeliveryRatio(0), 0.75, 1e-9, "Wrong ratio");
+
+    // The first report is the reception of the alarm of the closest device,
+    // at the end of its airtime at SF7
+    Time ttfr = alarmHelper.GetTimeToFirstReport(0);
+    NS_TEST_EXPECT_MSG_GT(ttfr, Seconds(1.5), "Time to first report before the first alarm");
+    NS_TEST_EXPECT_MSG_LT(ttfr, Seconds(1.6), "Time to first report after its airtime");
+
+    const std::vector<uint32_t> expectedTracked = {0, 1, 1, 0};
+    NS_TEST_ASSERT_MSG_EQ(tracked.size(), expectedTracked.size(), "Missing checks");
+    for (uint32_t i = 0; i < tracked.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(tracked[i], expectedTracked[i], "Wrong number of tracked alarms");
+    }
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup lorawan
  *
@@ -1627,6 +4275,23 @@ LorawanTestSuite::LorawanTestSuite()
     AddTestCase(new LogicalLoraChannelTest, Duration::QUICK);
     AddTestCase(new TimeOnAirTest, Duration::QUICK);
     AddTestCase(new PhyConnectivityTest, Duration::QUICK);
+    AddTestCase(new PacketPoolTest, Duration::QUICK);
+    AddTestCase(new TxCurrentModelTest, Duration::QUICK);
+    AddTestCase(new FarFieldTest, Duration::QUICK);
+    AddTestCase(new VirtualFleetTest, Duration::QUICK);
+    AddTestCase(new PhyReplayTest, Duration::QUICK);
+    AddTestCase(new HypothesesTest, Duration::QUICK);
+    AddTestCase(new RegionDataRateTest, Duration::QUICK);
+    AddTestCase(new DeferralCounterTest, Duration::QUICK);
+    AddTestCase(new CalendarQueueTest, Duration::QUICK);
+    AddTestCase(new FleetTrafficSchedulerTest, Duration::QUICK);
+    AddTestCase(new FleetEnergyTrackerTest, Duration::QUICK);
+    AddTestCase(new LazyEnergyAccountingTest, Duration::QUICK);
+    AddTestCase(new ClassCEndDeviceTest, Duration::QUICK);
+    AddTestCase(new ClassBPingSlotTest, Duration::QUICK);
+    AddTestCase(new TraceReplaySenderTest, Duration::QUICK);
+    AddTestCase(new LifetimeProjectorTest, Duration::QUICK);
+    AddTestCase(new AlarmTrafficTest, Duration::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
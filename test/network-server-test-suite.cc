@@ -9,6 +9,8 @@
 /*
  * This file includes testing for the following components:
  * - NetworkServer
+ * - ClassAEndDeviceLorawanMac (lazy receive windows)
+ * - MulticastSession
  */
 
 // Include headers of classes to test
@@ -17,12 +19,19 @@
 #include "ns3/callback.h"
 #include "ns3/core-module.h"
 #include "ns3/log.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-memory-census.h"
+#include "ns3/mobility-model.h"
+#include "ns3/multicast-session.h"
 #include "ns3/network-server-helper.h"
 #include "ns3/network-server.h"
+#include "ns3/periodic-sender-helper.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <sstream>
+
 using namespace ns3;
 using namespace lorawan;
 
@@ -337,6 +346,575 @@ LinkCheckTest::DoRun()
     NS_ASSERT(m_receivedPacketAtEd);
 }
 
+/**
+ * \ingroup lorawan
+ *
+ * It verifies that end devices skipping their receive windows deliver the
+ * same uplinks, at the same times and with the same outcomes, as end devices
+ * opening them
+ */
+class LazyReceiveWindowsTest : public TestCase
+{
+  public:
+    LazyReceiveWindowsTest();           //!< Default constructor
+    ~LazyReceiveWindowsTest() override; //!< Destructor
+
+    /**
+     * Callback for tracing StartSending.
+     *
+     * \param index The index of the end device.
+     * \param packet The packet being sent.
+     * \param nodeId The id of the sending node.
+     */
+    void StartSending(uint32_t index, Ptr<const Packet> packet, uint32_t nodeId);
+
+    /**
+     * Callback for tracing RequiredTransmissions.
+     *
+     * \param index The index of the end device.
+     * \param requiredTransmissions The number of transmissions of the packet.
+     * \param sf The spreading factor of the last transmission.
+     * \param success Whether the packet was delivered.
+     * \param firstAttempt The time of the first transmission.
+     * \param packet The packet.
+     */
+    void RequiredTransmissions(uint32_t index,
+                               uint8_t requiredTransmissions,
+                               uint8_t sf,
+                               bool success,
+                               Time firstAttempt,
+                               Ptr<Packet> packet);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Run a network of devices sending periodic uplinks, some of them
+     * confirmed and some of them out of range of the gateway.
+     *
+     * \param lazy Whether the end devices skip their receive windows.
+     */
+    void Run(bool lazy);
+
+    std::vector<std::string> m_events; //!< The uplink events of the current run
+};
+
+// Add some help text to this case to describe what it is intended to test
+LazyReceiveWindowsTest::LazyReceiveWindowsTest()
+    : TestCase("Verify that lazy receive windows do not change the uplink outcomes")
+{
+}
+
+// Reminder that the test case should clean up after itself
+LazyReceiveWindowsTest::~LazyReceiveWindowsTest()
+{
+}
+
+void
+LazyReceiveWindowsTest::StartSending(uint32_t index, Ptr<const Packet> packet, uint32_t nodeId)
+{
+    std::ostringstream event;
+    event << Simulator::Now().GetNanoSeconds() << " device " << index << " sends "
+          << packet->GetSize() << " bytes";
+    m_events.push_back(event.str());
+}
+
+void
+LazyReceiveWindowsTest::RequiredTransmissions(uint32_t index,
+                                              uint8_t requiredTransmissions,
+                                              uint8_t sf,
+                                              bool success,
+                                              Time firstAttempt,
+                                              Ptr<Packet> packet)
+{
+    std::ostringstream event;
+    event << Simulator::Now().GetNanoSeconds() << " device " << index << " used "
+          << unsigned(requiredTransmissions) << " transmissions at SF" << unsigned(sf)
+          << (success ? ", delivered" : ", failed") << ", first attempt at "
+          << firstAttempt.GetNanoSeconds();
+    m_events.push_back(event.str());
+}
+
+void
+LazyReceiveWindowsTest::Run(bool lazy)
+{
+    RngSeedManager::ResetNextStreamIndex();
+    m_events.clear();
+
+    NetworkComponents components = InitializeNetwork(4, 1);
+    NodeContainer endDevices = components.endDevices;
+
+    // Odd devices send confirmed uplinks, and the last one is out of range,
+    // so that it goes through all its retransmissions
+    for (uint32_t i = 0; i < endDevices.GetN(); i++)
+    {
+        Ptr<ClassAEndDeviceLorawanMac> mac =
+            GetMacLayerFromNode<ClassAEndDeviceLorawanMac>(endDevices.Get(i));
+        mac->SetAttribute("LazyReceiveWindows", BooleanValue(lazy));
+        mac->SetMaxNumberOfTransmissions(4);
+        if (i % 2 == 1)
+        {
+            mac->SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
+        }
+        mac->TraceConnectWithoutContext(
+            "RequiredTransmissions",
+            MakeCallback(&LazyReceiveWindowsTest::RequiredTransmissions, this).Bind(i));
+        Ptr<LoraPhy> phy = endDevices.Get(i)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+        phy->TraceConnectWithoutContext(
+            "StartSending",
+            MakeCallback(&LazyReceiveWindowsTest::StartSending, this).Bind(i));
+    }
+    endDevices.Get(3)->GetObject<MobilityModel>()->SetPosition(Vector(20000, 0, 0));
+
+    PeriodicSenderHelper periodicSenderHelper;
+    periodicSenderHelper.SetPeriod(Minutes(10));
+    periodicSenderHelper.Install(endDevices);
+
+    Simulator::Stop(Hours(1));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+LazyReceiveWindowsTest::DoRun()
+{
+    NS_LOG_DEBUG("LazyReceiveWindowsTest");
+
+    Run(false);
+    std::vector<std::string> eager = m_events;
+    Run(true);
+    std::vector<std::string> lazy = m_events;
+
+    NS_TEST_ASSERT_MSG_GT(eager.size(), 0, "No uplink was sent");
+    NS_TEST_ASSERT_MSG_EQ(lazy.size(), eager.size(), "Different number of uplink events");
+    for (std::size_t i = 0; i < eager.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(lazy[i], eager[i], "Different uplink event " << i);
+    }
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * Network controller component asking for a reply to a single uplink, which
+ * the end device does not solicit
+ */
+class ReplyToUplinkComponent : public NetworkControllerComponent
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param uplink The number of the uplink to reply to, starting from 1.
+     */
+    ReplyToUplinkComponent(uint32_t uplink);
+
+    void OnReceivedPacket(Ptr<const Packet> packet,
+                          Ptr<EndDeviceStatus> status,
+                          Ptr<NetworkStatus> networkStatus) override;
+
+    void BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
+
+    void OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
+
+  private:
+    uint32_t m_uplink;  //!< The number of the uplink to reply to
+    uint32_t m_uplinks; //!< The number of uplinks received so far
+};
+
+ReplyToUplinkComponent::ReplyToUplinkComponent(uint32_t uplink)
+    : m_uplink(uplink),
+      m_uplinks(0)
+{
+}
+
+void
+ReplyToUplinkComponent::OnReceivedPacket(Ptr<const Packet> packet,
+                                         Ptr<EndDeviceStatus> status,
+                                         Ptr<NetworkStatus> networkStatus)
+{
+    if (++m_uplinks != m_uplink)
+    {
+        return;
+    }
+
+    LorawanMacHeader mHdr;
+    LoraFrameHeader fHdr;
+    fHdr.SetAsUplink();
+    Ptr<Packet> myPacket = packet->Copy();
+    myPacket->RemoveHeader(mHdr);
+    myPacket->RemoveHeader(fHdr);
+
+    status->m_reply.frameHeader.SetAsDownlink();
+    status->m_reply.frameHeader.SetAddress(fHdr.GetAddress());
+    status->m_reply.macHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+    status->m_reply.needsReply = true;
+}
+
+void
+ReplyToUplinkComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status,
+                                           Ptr<NetworkStatus> networkStatus)
+{
+}
+
+void
+ReplyToUplinkComponent::OnFailedReply(Ptr<EndDeviceStatus> status,
+                                      Ptr<NetworkStatus> networkStatus)
+{
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It verifies that the NetworkServer application makes an end device skipping
+ * its receive windows open them when a reply is needed
+ */
+class MaterializeReceiveWindowsTest : public TestCase
+{
+  public:
+    MaterializeReceiveWindowsTest();           //!< Default constructor
+    ~MaterializeReceiveWindowsTest() override; //!< Destructor
+
+    /**
+     * Callback for tracing EndDeviceState.
+     *
+     * \param oldState The previous state of the PHY.
+     * \param newState The new state of the PHY.
+     */
+    void StateChanged(EndDeviceLoraPhy::State oldState, EndDeviceLoraPhy::State newState);
+
+    /**
+     * Callback for tracing ReceivedPacket.
+     *
+     * \param packet The packet received.
+     */
+    void ReceivedPacket(Ptr<const Packet> packet);
+
+  private:
+    void DoRun() override;
+
+    std::vector<Time> m_standbyTimes; //!< The times the PHY switched to standby
+    std::vector<Time> m_receiveTimes; //!< The times the MAC received a downlink
+};
+
+// Add some help text to this case to describe what it is intended to test
+MaterializeReceiveWindowsTest::MaterializeReceiveWindowsTest()
+    : TestCase("Verify that lazy receive windows are opened when the network server "
+               "needs to reply")
+{
+}
+
+// Reminder that the test case should clean up after itself
+MaterializeReceiveWindowsTest::~MaterializeReceiveWindowsTest()
+{
+}
+
+void
+MaterializeReceiveWindowsTest::StateChanged(EndDeviceLoraPhy::State oldState,
+                                            EndDeviceLoraPhy::State newState)
+{
+    if (newState == EndDeviceLoraPhy::STANDBY)
+    {
+        m_standbyTimes.push_back(Simulator::Now());
+    }
+}
+
+void
+MaterializeReceiveWindowsTest::ReceivedPacket(Ptr<const Packet> packet)
+{
+    m_receiveTimes.push_back(Simulator::Now());
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+MaterializeReceiveWindowsTest::DoRun()
+{
+    NS_LOG_DEBUG("MaterializeReceiveWindowsTest");
+
+    NetworkComponents components = InitializeNetwork(1, 1);
+    Ptr<Node> endDevice = components.endDevices.Get(0);
+
+    // The device sends unconfirmed uplinks without MAC commands, so it only
+    // opens its receive windows if the network server asks it to
+    Ptr<ClassAEndDeviceLorawanMac> mac = GetMacLayerFromNode<ClassAEndDeviceLorawanMac>(endDevice);
+    mac->SetAttribute("LazyReceiveWindows", BooleanValue(true));
+    mac->TraceConnectWithoutContext(
+        "ReceivedPacket",
+        MakeCallback(&MaterializeReceiveWindowsTest::ReceivedPacket, this));
+    endDevice->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy()->TraceConnectWithoutContext(
+        "EndDeviceState",
+        MakeCallback(&MaterializeReceiveWindowsTest::StateChanged, this));
+
+    // Only reply to the second uplink
+    components.nsNode->GetApplication(0)->GetObject<NetworkServer>()->AddComponent(
+        CreateObject<ReplyToUplinkComponent>(2));
+
+    for (int i = 0; i < 2; i++)
+    {
+        Simulator::Schedule(Seconds(1 + 10 * i), [endDevice]() {
+            endDevice->GetDevice(0)->Send(Create<Packet>(20), Address(), 0);
+        });
+    }
+    Simulator::Stop(Seconds(20));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    // No window is opened after the first uplink, and the reply to the second
+    // one is received in one of its windows
+    NS_TEST_ASSERT_MSG_GT(m_standbyTimes.size(), 0, "No receive window was opened");
+    NS_TEST_EXPECT_MSG_GT(m_standbyTimes.front(), Seconds(11), "A window was not skipped");
+    NS_TEST_ASSERT_MSG_EQ(m_receiveTimes.size(), 1, "The reply was not received");
+    NS_TEST_EXPECT_MSG_GT(m_receiveTimes.front(), m_standbyTimes.front(), "Wrong reception time");
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It verifies that a MulticastSession keeps track of the fragments received
+ * by each member, and completes once every member received every fragment
+ */
+class MulticastSessionTest : public TestCase
+{
+  public:
+    MulticastSessionTest();           //!< Default constructor
+    ~MulticastSessionTest() override; //!< Destructor
+
+    /**
+     * Callback for tracing ReceivedMulticast.
+     *
+     * \param index The index of the member.
+     * \param packet The received packet.
+     * \param groupAddress The multicast address the packet was sent to.
+     * \param fCnt The frame counter of the downlink.
+     */
+    void ReceivedMulticast(uint32_t index,
+                           Ptr<const Packet> packet,
+                           LoraDeviceAddress groupAddress,
+                           uint16_t fCnt);
+
+    /**
+     * Callback for tracing Completed.
+     *
+     * \param completionTime The time it took to complete the campaign.
+     */
+    void Completed(Time completionTime);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Run a campaign of 3 fragments, repeated up to twice, to a group of 3
+     * Class C devices.
+     *
+     * \param farMember Whether the last member is out of range of the gateway.
+     * \return The session, after the campaign and before the simulator is
+     * destroyed.
+     */
+    Ptr<MulticastSession> Run(bool farMember);
+
+    std::vector<uint32_t> m_receptions; //!< The fragments received by each member
+    std::vector<Time> m_completions;    //!< The completion times traced by the session
+};
+
+// Add some help text to this case to describe what it is intended to test
+MulticastSessionTest::MulticastSessionTest()
+    : TestCase("Verify the per-member bookkeeping of multicast sessions")
+{
+}
+
+// Reminder that the test case should clean up after itself
+MulticastSessionTest::~MulticastSessionTest()
+{
+}
+
+void
+MulticastSessionTest::ReceivedMulticast(uint32_t index,
+                                        Ptr<const Packet> packet,
+                                        LoraDeviceAddress groupAddress,
+                                        uint16_t fCnt)
+{
+    m_receptions[index]++;
+}
+
+void
+MulticastSessionTest::Completed(Time completionTime)
+{
+    m_completions.push_back(completionTime);
+}
+
+Ptr<MulticastSession>
+MulticastSessionTest::Run(bool farMember)
+{
+    const uint32_t nDevices = 3;
+    m_receptions.assign(nDevices, 0);
+    m_completions.clear();
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices;
+    endDevices.Create(nDevices);
+    mobility.Install(endDevices);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    LorawanMacHelper macHelper;
+    macHelper.SetDeviceType(LorawanMacHelper::ED_C);
+    macHelper.SetAddressGenerator(CreateObject<LoraDeviceAddressGenerator>());
+    LoraHelper helper;
+    helper.Install(phyHelper, macHelper, endDevices);
+    NodeContainer gateways = CreateGateways(1, mobility, channel);
+    Ptr<Node> nsNode = CreateNetworkServer(endDevices, gateways);
+
+    if (farMember)
+    {
+        endDevices.Get(nDevices - 1)->GetObject<MobilityModel>()->SetPosition(Vector(50000, 0, 0));
+    }
+
+    // The fragments are sent in the second receive window parameters the
+    // devices listen to
+    Ptr<MulticastSession> session = CreateObject<MulticastSession>();
+    session->SetAttribute("NFragments", UintegerValue(3));
+    session->SetAttribute("FragmentSize", UintegerValue(10));
+    session->SetAttribute("Repetitions", UintegerValue(2));
+    session->SetGroupAddress(LoraDeviceAddress(uint8_t(54), uint32_t(0x1ffffff)));
+    for (uint32_t i = 0; i < nDevices; i++)
+    {
+        Ptr<ClassCEndDeviceLorawanMac> mac =
+            GetMacLayerFromNode<ClassCEndDeviceLorawanMac>(endDevices.Get(i));
+        session->AddMember(mac);
+        mac->TraceConnectWithoutContext(
+            "ReceivedMulticast",
+            MakeCallback(&MulticastSessionTest::ReceivedMulticast, this).Bind(i));
+    }
+    session->TraceConnectWithoutContext("Completed",
+                                        MakeCallback(&MulticastSessionTest::Completed, this));
+    nsNode->GetApplication(0)->GetObject<NetworkServer>()->AddMulticastSession(session,
+                                                                               Seconds(1));
+
+    Simulator::Stop(Seconds(300));
+    Simulator::Run();
+
+    return session;
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+MulticastSessionTest::DoRun()
+{
+    NS_LOG_DEBUG("MulticastSessionTest");
+
+    // Every member is in range: the sequence is not repeated once they all
+    // received every fragment
+    Ptr<MulticastSession> session = Run(false);
+    NS_TEST_EXPECT_MSG_EQ(session->IsComplete(), true, "The campaign did not complete");
+    NS_TEST_EXPECT_MSG_EQ(session->GetNCompletedMembers(), 3, "Wrong number of completed members");
+    NS_TEST_ASSERT_MSG_EQ(m_completions.size(), 1, "The completion was not traced once");
+    NS_TEST_EXPECT_MSG_EQ(m_completions[0],
+                          session->GetCompletionTime(),
+                          "Wrong traced completion time");
+    NS_TEST_EXPECT_MSG_GT(session->GetCompletionTime(), Seconds(0), "Wrong completion time");
+    for (uint32_t i = 0; i < m_receptions.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_receptions[i], 3, "Wrong number of fragments at member " << i);
+    }
+    NS_TEST_ASSERT_MSG_EQ(session->GetAirtimePerGateway().size(), 1, "Wrong number of gateways");
+    Time sequenceAirtime = session->GetAirtimePerGateway().begin()->second;
+    NS_TEST_EXPECT_MSG_GT(sequenceAirtime, Seconds(0), "No airtime was spent");
+    Simulator::Destroy();
+
+    // The last member receives nothing: the sequence is repeated, and the
+    // repeated fragments do not count twice for the other members
+    session = Run(true);
+    NS_TEST_EXPECT_MSG_EQ(session->IsComplete(), false, "The campaign completed");
+    NS_TEST_EXPECT_MSG_EQ(session->GetNCompletedMembers(), 2, "Wrong number of completed members");
+    NS_TEST_EXPECT_MSG_EQ(session->GetCompletionTime(), Time::Max(), "Wrong completion time");
+    NS_TEST_EXPECT_MSG_EQ(m_completions.size(), 0, "The completion was traced");
+    NS_TEST_EXPECT_MSG_EQ(m_receptions[0], 6, "The sequence was not repeated");
+    NS_TEST_EXPECT_MSG_EQ(m_receptions[1], 6, "The sequence was not repeated");
+    NS_TEST_EXPECT_MSG_EQ(m_receptions[2], 0, "The far member received fragments");
+    NS_TEST_ASSERT_MSG_EQ(session->GetAirtimePerGateway().size(), 1, "Wrong number of gateways");
+    NS_TEST_EXPECT_MSG_EQ(session->GetAirtimePerGateway().begin()->second,
+                          sequenceAirtime * 2,
+                          "Wrong airtime of the repeated sequence");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup lorawan
+ *
+ * It verifies that the LoraMemoryCensus counts the state kept by the gateway
+ * PHY and by the network server for the uplinks of a device
+ */
+class MemoryCensusTest : public TestCase
+{
+  public:
+    MemoryCensusTest();           //!< Default constructor
+    ~MemoryCensusTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+// Add some help text to this case to describe what it is intended to test
+MemoryCensusTest::MemoryCensusTest()
+    : TestCase("Verify that the LoraMemoryCensus counts the state of the uplinks")
+{
+}
+
+// Reminder that the test case should clean up after itself
+MemoryCensusTest::~MemoryCensusTest()
+{
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+MemoryCensusTest::DoRun()
+{
+    NS_LOG_DEBUG("MemoryCensusTest");
+
+    NetworkComponents components = InitializeNetwork(1, 1);
+    Ptr<Node> endDevice = components.endDevices.Get(0);
+
+    LoraMemoryCensus census;
+    census.AddPhys(components.gateways);
+    census.SetNetworkServer(components.nsNode);
+
+    LoraMemoryCensus::Census before = census.TakeCensus();
+    NS_TEST_EXPECT_MSG_EQ(before.GetTotalBytes(), 0, "The census of an idle network is not empty");
+
+    // Two uplinks, far enough apart for the duty cycle
+    for (int i = 0; i < 2; i++)
+    {
+        Simulator::Schedule(Seconds(1 + 10 * i), [endDevice]() {
+            endDevice->GetDevice(0)->Send(Create<Packet>(20), Address(), 0);
+        });
+    }
+    Simulator::Stop(Seconds(20));
+    Simulator::Run();
+
+    LoraMemoryCensus::Census after = census.TakeCensus();
+    NS_TEST_EXPECT_MSG_EQ(after.receivedPackets, 2, "Wrong number of received packets");
+    NS_TEST_EXPECT_MSG_GT(after.receivedPacketBytes, 0, "The received packets have no bytes");
+    NS_TEST_EXPECT_MSG_GT(after.interferenceEvents, 0, "The gateway keeps no events");
+    NS_TEST_EXPECT_MSG_EQ(after.maxPhyEvents,
+                          after.interferenceEvents,
+                          "A single PHY should hold all the events");
+    NS_TEST_EXPECT_MSG_EQ(after.GetTotalBytes(),
+                          after.interferenceBytes + after.chaseCombiningBytes +
+                              after.receivedPacketBytes,
+                          "Wrong total bytes");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup lorawan
  *
@@ -373,6 +951,10 @@ NetworkServerTestSuite::NetworkServerTestSuite()
     AddTestCase(new UplinkPacketTest, Duration::QUICK);
     AddTestCase(new DownlinkPacketTest, Duration::QUICK);
     AddTestCase(new LinkCheckTest, Duration::QUICK);
+    AddTestCase(new LazyReceiveWindowsTest, Duration::QUICK);
+    AddTestCase(new MaterializeReceiveWindowsTest, Duration::QUICK);
+    AddTestCase(new MulticastSessionTest, Duration::QUICK);
+    AddTestCase(new MemoryCensusTest, Duration::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,507 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * Micro-benchmarks of the hot kernels of the lorawan module.
+ *
+ * Each benchmark runs a kernel for a fixed number of iterations per
+ * repetition, after some warm-up repetitions, and reports the median, the
+ * 10th and 90th percentiles and the extremes of the time per iteration over
+ * the repetitions, in nanoseconds. The results are written as JSON, so that
+ * they can be stored and compared against later runs to catch regressions.
+ *
+ * Usage: ./ns3 run "lorawan-bench --repetitions=20 --output=bench.json"
+ */
+
+#include "ns3/class-a-end-device-lorawan-mac.h"
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/end-device-lora-phy.h"
+#include "ns3/end-device-status.h"
+#include "ns3/log.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-interference-helper.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-packet-tracker.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lora-tag.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mac48-address.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanBench");
+
+/**
+ * Run the benchmarks and collect their results.
+ */
+class Benchmarker
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param warmUp The number of repetitions run before the measured ones.
+     * \param repetitions The number of measured repetitions.
+     * \param filter Only the benchmarks whose name contains it are run.
+     */
+    Benchmarker(uint32_t warmUp, uint32_t repetitions, std::string filter)
+        : m_warmUp(warmUp),
+          m_repetitions(repetitions),
+          m_filter(filter)
+    {
+    }
+
+    /**
+     * Check whether a benchmark is selected by the filter.
+     *
+     * \param name The name of the benchmark.
+     * \return True if the benchmark must be run.
+     */
+    bool
+    IsSelected(const std::string& name) const
+    {
+        return name.find(m_filter) != std::string::npos;
+    }
+
+    /**
+     * Run a benchmark.
+     *
+     * \param name The name of the benchmark.
+     * \param iterations The number of iterations of each repetition.
+     * \param setup Called before each repetition, and not measured.
+     * \param body Called at each iteration, with the index of the iteration.
+     */
+    void
+    Run(const std::string& name,
+        uint32_t iterations,
+        std::function<void()> setup,
+        std::function<void(uint32_t)> body)
+    {
+        NS_LOG_INFO("Running " << name);
+
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        for (uint32_t r = 0; r < m_warmUp + m_repetitions; r++)
+        {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                body(i);
+            }
+            auto stop = std::chrono::steady_clock::now();
+            if (r >= m_warmUp)
+            {
+                std::chrono::duration<double, std::nano> elapsed = stop - start;
+                result.samples.push_back(elapsed.count() / iterations);
+            }
+        }
+        std::sort(result.samples.begin(), result.samples.end());
+        m_results.push_back(result);
+
+        NS_LOG_INFO(name << ": median " << Percentile(result.samples, 0.5) << " ns");
+    }
+
+    /**
+     * Write the results as a JSON document.
+     *
+     * \param os The output stream.
+     */
+    void
+    WriteJson(std::ostream& os) const
+    {
+        os << "{\n  \"module\": \"lorawan\",\n  \"warmup\": " << m_warmUp
+           << ",\n  \"repetitions\": " << m_repetitions << ",\n  \"benchmarks\": [";
+        for (uint32_t i = 0; i < m_results.size(); i++)
+        {
+            const Result& r = m_results[i];
+            os << (i > 0 ? "," : "") << "\n    {\"name\": \"" << r.name
+               << "\", \"iterations\": " << r.iterations
+               << ", \"median_ns\": " << Percentile(r.samples, 0.5)
+               << ", \"p10_ns\": " << Percentile(r.samples, 0.1)
+               << ", \"p90_ns\": " << Percentile(r.samples, 0.9)
+               << ", \"min_ns\": " << r.samples.front() << ", \"max_ns\": " << r.samples.back()
+               << "}";
+        }
+        os << "\n  ]\n}" << std::endl;
+    }
+
+  private:
+    /**
+     * The results of a benchmark.
+     */
+    struct Result
+    {
+        std::string name;            //!< The name of the benchmark
+        uint32_t iterations;         //!< The iterations of each repetition
+        std::vector<double> samples; //!< The time per iteration [ns], sorted
+    };
+
+    /**
+     * Get a percentile of sorted samples, interpolating between them.
+     *
+     * \param samples The sorted samples.
+     * \param q The quantile, between 0 and 1.
+     * \return The percentile.
+     */
+    static double
+    Percentile(const std::vector<double>& samples, double q)
+    {
+        double rank = q * (samples.size() - 1);
+        uint32_t lower = rank;
+        uint32_t upper = std::min<uint32_t>(lower + 1, samples.size() - 1);
+        return samples[lower] + (rank - lower) * (samples[upper] - samples[lower]);
+    }
+
+    uint32_t m_warmUp;             //!< The number of warm-up repetitions
+    uint32_t m_repetitions;        //!< The number of measured repetitions
+    std::string m_filter;          //!< The filter of the benchmark names
+    std::vector<Result> m_results; //!< The results of the benchmarks run
+};
+
+/**
+ * Create an uplink packet, with its MAC and frame headers and its LoraTag.
+ *
+ * \param fCnt The frame counter.
+ * \return The packet.
+ */
+Ptr<Packet>
+CreateUplink(uint16_t fCnt)
+{
+    Ptr<Packet> packet = Create<Packet>(10);
+    LoraFrameHeader frameHdr;
+    frameHdr.SetAsUplink();
+    frameHdr.SetAddress(LoraDeviceAddress(1));
+    frameHdr.SetFCnt(fCnt);
+    packet->AddHeader(frameHdr);
+    LorawanMacHeader macHdr;
+    macHdr.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_UP);
+    packet->AddHeader(macHdr);
+    LoraTag tag(7);
+    tag.SetFrequency(868.1);
+    tag.SetReceivePower(-100);
+    packet->AddPacketTag(tag);
+    return packet;
+}
+
+/**
+ * Benchmark LoraInterferenceHelper::IsDestroyedByInterference.
+ *
+ * \param bench The benchmarker.
+ * \param nEvents The number of live events in the helper.
+ */
+void
+BenchInterference(Benchmarker& bench, uint32_t nEvents)
+{
+    std::string name = "interference/" + std::to_string(nEvents);
+    if (!bench.IsSelected(name))
+    {
+        return;
+    }
+
+    // Live events spread over the three default channels and all the SFs
+    LoraInterferenceHelper interference;
+    Ptr<Packet> packet = Create<Packet>(10);
+    const double frequencies[] = {868.1, 868.3, 868.5};
+    Ptr<LoraInterferenceHelper::Event> event;
+    for (uint32_t i = 0; i < nEvents; i++)
+    {
+        event = interference.Add(Seconds(1 + 0.001 * i),
+                                 -120 + (i % 40),
+                                 7 + (i % 6),
+                                 0,
+                                 i,
+                                 packet,
+                                 frequencies[i % 3]);
+    }
+
+    bench.Run(
+        name,
+        100000 / nEvents,
+        [] {},
+        [&](uint32_t) { interference.IsDestroyedByInterference(event); });
+}
+
+/**
+ * Benchmark the fan-out of LoraChannel::Send to the PHY layers of the channel.
+ *
+ * \param bench The benchmarker.
+ * \param nPhys The number of PHY layers connected to the channel.
+ */
+void
+BenchChannelSend(Benchmarker& bench, uint32_t nPhys)
+{
+    std::string name = "channel-send/" + std::to_string(nPhys);
+    if (!bench.IsSelected(name))
+    {
+        return;
+    }
+
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                  "rho",
+                                  DoubleValue(5000),
+                                  "X",
+                                  DoubleValue(0.0),
+                                  "Y",
+                                  DoubleValue(0.0));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    NodeContainer endDevices;
+    endDevices.Create(nPhys);
+    mobility.Install(endDevices);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(channel);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    LorawanMacHelper macHelper;
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    LoraHelper helper;
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    Ptr<LoraPhy> sender = endDevices.Get(0)->GetDevice(0)->GetObject<LoraNetDevice>()->GetPhy();
+    Ptr<Packet> packet = CreateUplink(0);
+    LoraTxParameters txParams;
+    txParams.sf = 7;
+    Time duration = LoraPhy::GetOnAirTime(packet, txParams);
+
+    // The receptions scheduled by the previous repetition are run before the
+    // next one: the receivers are sleeping, and drop them
+    bench.Run(
+        name,
+        10,
+        [] { Simulator::Run(); },
+        [&](uint32_t) { channel->Send(sender, packet, 14, txParams, duration, 868.1); });
+    Simulator::Run();
+}
+
+/**
+ * Benchmark LoraPhy::GetOnAirTime, over all the SFs.
+ *
+ * \param bench The benchmarker.
+ */
+void
+BenchOnAirTime(Benchmarker& bench)
+{
+    std::string name = "on-air-time";
+    if (!bench.IsSelected(name))
+    {
+        return;
+    }
+
+    Ptr<Packet> packet = CreateUplink(0);
+    LoraTxParameters txParams;
+    bench.Run(
+        name,
+        100000,
+        [] {},
+        [&](uint32_t i) {
+            txParams.sf = 7 + (i % 6);
+            LoraPhy::GetOnAirTime(packet, txParams);
+        });
+}
+
+/**
+ * Benchmark the serialization and deserialization of a LoraFrameHeader with
+ * MAC commands in its FOpts field.
+ *
+ * \param bench The benchmarker.
+ */
+void
+BenchFrameHeader(Benchmarker& bench)
+{
+    std::string name = "frame-header-fopts";
+    if (!bench.IsSelected(name))
+    {
+        return;
+    }
+
+    LoraFrameHeader header;
+    header.SetAsDownlink();
+    header.SetAddress(LoraDeviceAddress(1));
+    header.SetFCnt(42);
+    header.SetAck(true);
+    header.AddLinkCheckAns(10, 2);
+    header.AddLinkAdrReq(5, 1, {0, 1, 2}, 1);
+    header.AddDevStatusReq();
+
+    Buffer buffer;
+    buffer.AddAtStart(header.GetSerializedSize());
+    bench.Run(
+        name,
+        100000,
+        [] {},
+        [&](uint32_t) {
+            header.Serialize(buffer.Begin());
+            LoraFrameHeader received;
+            received.SetAsDownlink();
+            received.Deserialize(buffer.Begin());
+        });
+}
+
+/**
+ * Benchmark EndDeviceStatus::InsertReceivedPacket, each packet being received
+ * by several gateways.
+ *
+ * \param bench The benchmarker.
+ * \param nGateways The number of gateways receiving each packet.
+ */
+void
+BenchInsertReceivedPacket(Benchmarker& bench, uint32_t nGateways)
+{
+    std::string name = "insert-received-packet/" + std::to_string(nGateways);
+    if (!bench.IsSelected(name))
+    {
+        return;
+    }
+
+    const uint32_t nPackets = 1000;
+    std::vector<Ptr<Packet>> packets;
+    for (uint32_t i = 0; i < nPackets; i++)
+    {
+        packets.push_back(CreateUplink(i));
+    }
+    std::vector<Address> gateways;
+    for (uint32_t i = 0; i < nGateways; i++)
+    {
+        gateways.emplace_back(Mac48Address::Allocate());
+    }
+
+    // Each repetition fills a new status
+    Ptr<EndDeviceStatus> status;
+    bench.Run(
+        name,
+        nPackets * nGateways,
+        [&] {
+            status = CreateObject<EndDeviceStatus>(LoraDeviceAddress(1),
+                                                   Ptr<ClassAEndDeviceLorawanMac>());
+        },
+        [&](uint32_t i) {
+            status->InsertReceivedPacket(packets[i / nGateways], gateways[i % nGateways]);
+        });
+}
+
+/**
+ * Benchmark the queries of a LoraPacketTracker holding many packets.
+ *
+ * \param bench The benchmarker.
+ * \param nPackets The number of packets in the tracker.
+ */
+void
+BenchPacketTracker(Benchmarker& bench, uint32_t nPackets)
+{
+    std::string macName = "tracker-mac-global/" + std::to_string(nPackets);
+    std::string phyName = "tracker-phy-per-gw/" + std::to_string(nPackets);
+    if (!bench.IsSelected(macName) && !bench.IsSelected(phyName))
+    {
+        return;
+    }
+
+    // One packet per second, received by one of four gateways
+    LoraPacketTracker tracker;
+    for (uint32_t i = 0; i < nPackets; i++)
+    {
+        Ptr<Packet> packet = CreateUplink(i);
+        uint32_t gwId = i % 4;
+        Simulator::ScheduleWithContext(i, Seconds(i), [&tracker, packet, i, gwId]() {
+            tracker.TransmissionCallback(packet, i);
+            tracker.MacTransmissionCallback(packet, 7);
+        });
+        Simulator::ScheduleWithContext(gwId, Seconds(i + 0.5), [&tracker, packet, gwId]() {
+            tracker.PacketReceptionCallback(packet, gwId);
+            tracker.MacGwReceptionCallback(packet);
+        });
+    }
+    Simulator::Run();
+
+    Time stop = Seconds(nPackets / 2);
+    if (bench.IsSelected(macName))
+    {
+        bench.Run(
+            macName,
+            10,
+            [] {},
+            [&](uint32_t) { tracker.CountMacPacketsGlobally(Seconds(0), stop); });
+    }
+    if (bench.IsSelected(phyName))
+    {
+        bench.Run(
+            phyName,
+            10,
+            [] {},
+            [&](uint32_t i) { tracker.CountPhyPacketsPerGw(Seconds(0), stop, i % 4); });
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t warmUp = 2;
+    uint32_t repetitions = 10;
+    std::string filter = "";
+    std::string output = "";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("warmUp", "Number of repetitions run before the measured ones", warmUp);
+    cmd.AddValue("repetitions", "Number of measured repetitions", repetitions);
+    cmd.AddValue("filter", "Only run the benchmarks whose name contains this string", filter);
+    cmd.AddValue("output", "File of the JSON results (standard output if empty)", output);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(repetitions == 0, "At least one repetition is needed");
+
+    Benchmarker bench(warmUp, repetitions, filter);
+
+    for (uint32_t nEvents : {10, 100, 1000})
+    {
+        BenchInterference(bench, nEvents);
+    }
+    for (uint32_t nPhys : {1000, 10000})
+    {
+        BenchChannelSend(bench, nPhys);
+    }
+    BenchOnAirTime(bench);
+    BenchFrameHeader(bench);
+    for (uint32_t nGateways : {1, 4, 16})
+    {
+        BenchInsertReceivedPacket(bench, nGateways);
+    }
+    BenchPacketTracker(bench, 100000);
+
+    if (output.empty())
+    {
+        bench.WriteJson(std::cout);
+    }
+    else
+    {
+        std::ofstream file(output);
+        NS_ABORT_MSG_IF(!file.is_open(), "Cannot open " << output);
+        bench.WriteJson(file);
+    }
+
+    Simulator::Destroy();
+
+    return 0;
+}